@@ -0,0 +1,269 @@
+#include "BindlessTable.h"
+#include "FrameUniforms.h"
+#include "Texture.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	// Samplers left in each stage for the classic set 0 texture and the set 1 shadow map
+	constexpr uint32_t kReservedSamplers = 8;
+	// Below this the table is not worth the separate path
+	constexpr uint32_t kMinTextures = 64;
+
+	uint32_t textureCapacity(VkPhysicalDevice physicalDevice)
+	{
+		VkPhysicalDeviceProperties properties{};
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		const VkPhysicalDeviceLimits& limits = properties.limits;
+		const uint32_t limit = std::min({ limits.maxPerStageDescriptorSamplers, limits.maxPerStageDescriptorSampledImages,
+			limits.maxDescriptorSetSamplers, limits.maxDescriptorSetSampledImages });
+		return limit > kReservedSamplers ? std::min(limit - kReservedSamplers, BindlessTable::kMaxTextures) : 0;
+	}
+}
+
+bool BindlessTable::supported(VkPhysicalDevice physicalDevice)
+{
+	VkPhysicalDeviceVulkan12Features features12{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+	VkPhysicalDeviceFeatures2 features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+	features.pNext = &features12;
+	vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+	// The texture index comes from a push constant via the material buffer, so it is dynamically uniform:
+	// core dynamic indexing is enough and non-uniform indexing is not required
+	return features12.descriptorIndexing && features12.runtimeDescriptorArray && features12.descriptorBindingPartiallyBound
+		&& features.features.shaderSampledImageArrayDynamicIndexing && textureCapacity(physicalDevice) >= kMinTextures;
+}
+
+void BindlessTable::enableFeatures(VkPhysicalDeviceVulkan12Features& features)
+{
+	features.descriptorIndexing = VK_TRUE;
+	features.runtimeDescriptorArray = VK_TRUE;
+	features.descriptorBindingPartiallyBound = VK_TRUE;
+}
+
+void BindlessTable::create(VkDevice device, VkPhysicalDevice physicalDevice, GpuAllocator* allocator, const FrameUniforms* uniforms,
+	uint32_t framesInFlight, VkImageView defaultView, VkSampler defaultSampler)
+{
+	if (allocator == nullptr || uniforms == nullptr || framesInFlight == 0) {
+		throw std::runtime_error("BindlessTable: an allocator, frame uniforms and at least one frame are required");
+	}
+	if (!uniforms->objectStorageFits()) {
+		throw std::runtime_error("BindlessTable: the object slots of one frame exceed maxStorageBufferRange");
+	}
+
+	_device = device;
+	_allocator = allocator;
+	_textureCapacity = textureCapacity(physicalDevice);
+	if (_textureCapacity < kMinTextures) {
+		throw std::runtime_error("BindlessTable: the device allows " + std::to_string(_textureCapacity) + " textures per stage");
+	}
+
+	std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+	bindings[0].binding = 0; // materials
+	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[0].descriptorCount = 1;
+	bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	bindings[1].binding = 1; // model matrices
+	bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[1].descriptorCount = 1;
+	bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	bindings[2].binding = 2; // textures
+	bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[2].descriptorCount = _textureCapacity;
+	bindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	// Slots past the registered textures are never written, and never indexed
+	const std::array<VkDescriptorBindingFlags, 3> bindingFlags{ 0, 0, VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT };
+	VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO };
+	flagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+	flagsInfo.pBindingFlags = bindingFlags.data();
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+	layoutInfo.pNext = &flagsInfo;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+	if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &_layout) != VK_SUCCESS) {
+		throw std::runtime_error("BindlessTable: failed to create the descriptor set layout");
+	}
+
+	const std::array<VkDescriptorPoolSize, 2> poolSizes{ {
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * framesInFlight },
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, _textureCapacity * framesInFlight },
+	} };
+	VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+	poolInfo.maxSets = framesInFlight;
+	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+	poolInfo.pPoolSizes = poolSizes.data();
+	if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &_pool) != VK_SUCCESS) {
+		throw std::runtime_error("BindlessTable: failed to create the descriptor pool");
+	}
+
+	const std::vector<VkDescriptorSetLayout> layouts(framesInFlight, _layout);
+	VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+	allocInfo.descriptorPool = _pool;
+	allocInfo.descriptorSetCount = framesInFlight;
+	allocInfo.pSetLayouts = layouts.data();
+	_sets.resize(framesInFlight);
+	if (vkAllocateDescriptorSets(device, &allocInfo, _sets.data()) != VK_SUCCESS) {
+		throw std::runtime_error("BindlessTable: failed to allocate descriptor sets");
+	}
+
+	// Materials are written once when added, to slots no recorded frame reads yet, so one mapped copy is enough
+	allocator->createBuffer(sizeof(MaterialGpu) * kMaxMaterials, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, GpuMemoryCategory::Uniform, "bindless materials",
+		_materialBuffer, _materialAllocation);
+	_materials = static_cast<MaterialGpu*>(_materialAllocation.mapped);
+	if (_materials == nullptr) {
+		throw std::runtime_error("BindlessTable: material memory is not mapped");
+	}
+	_materialCount = 0;
+
+	const VkDescriptorBufferInfo materialInfo{ _materialBuffer, 0, VK_WHOLE_SIZE };
+	for (uint32_t i = 0; i < framesInFlight; ++i) {
+		const VkDescriptorBufferInfo objectInfo = uniforms->objectStorageInfo(i);
+
+		std::array<VkWriteDescriptorSet, 2> writes{};
+		writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[0].dstSet = _sets[i];
+		writes[0].dstBinding = 0;
+		writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writes[0].descriptorCount = 1;
+		writes[0].pBufferInfo = &materialInfo;
+
+		writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[1].dstSet = _sets[i];
+		writes[1].dstBinding = 1;
+		writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writes[1].descriptorCount = 1;
+		writes[1].pBufferInfo = &objectInfo;
+
+		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+	}
+
+	_slots.clear();
+	_textureIndices.clear();
+	_slots.push_back(Slot{ nullptr, defaultView, defaultSampler });
+	_writtenViews.assign(framesInFlight, {});
+	_descriptorWrites = 0;
+}
+
+void BindlessTable::destroy()
+{
+	if (_device == VK_NULL_HANDLE) return;
+	if (_allocator != nullptr) {
+		_allocator->destroyBuffer(_materialBuffer, _materialAllocation);
+	}
+	if (_pool != VK_NULL_HANDLE) {
+		vkDestroyDescriptorPool(_device, _pool, nullptr);
+		_pool = VK_NULL_HANDLE;
+	}
+	if (_layout != VK_NULL_HANDLE) {
+		vkDestroyDescriptorSetLayout(_device, _layout, nullptr);
+		_layout = VK_NULL_HANDLE;
+	}
+	_sets.clear();
+	_writtenViews.clear();
+	_slots.clear();
+	_textureIndices.clear();
+	_materials = nullptr;
+	_materialCount = 0;
+	_allocator = nullptr;
+	_device = VK_NULL_HANDLE;
+}
+
+uint32_t BindlessTable::addTexture(Texture* texture)
+{
+	if (texture == nullptr) return kDefaultTexture;
+
+	const auto it = _textureIndices.find(texture);
+	if (it != _textureIndices.end()) return it->second;
+
+	if (_slots.size() >= _textureCapacity) {
+		throw std::runtime_error("BindlessTable: all " + std::to_string(_textureCapacity) + " texture slots are in use");
+	}
+	const uint32_t index = static_cast<uint32_t>(_slots.size());
+	_slots.push_back(Slot{ texture });
+	_textureIndices.emplace(texture, index);
+	return index;
+}
+
+uint32_t BindlessTable::addMaterial(const Material& material)
+{
+	MaterialGpu entry{};
+	entry.albedo = material.albedoColour();
+	entry.metallic = material.metallic();
+	entry.roughness = material.roughness();
+	entry.textureIndex = addTexture(material.texture());
+
+	// Scene objects of one type share a material, so most adds find an existing entry
+	for (uint32_t i = 0; i < _materialCount; ++i) {
+		const MaterialGpu& existing = _materials[i];
+		if (existing.albedo == entry.albedo && existing.metallic == entry.metallic && existing.roughness == entry.roughness
+			&& existing.textureIndex == entry.textureIndex) {
+			return i;
+		}
+	}
+
+	if (_materialCount >= kMaxMaterials) {
+		throw std::runtime_error("BindlessTable: all " + std::to_string(kMaxMaterials) + " material slots are in use");
+	}
+	_materials[_materialCount] = entry;
+	return _materialCount++;
+}
+
+void BindlessTable::currentDescriptor(const Slot& slot, VkImageView& view, VkSampler& sampler) const
+{
+	// Textures are read at update time rather than when added, so a streamed image swap is followed
+	view = slot.texture != nullptr ? slot.texture->getTextureImageView() : slot.view;
+	sampler = slot.texture != nullptr ? slot.texture->getTextureSampler() : slot.sampler;
+}
+
+void BindlessTable::update(uint32_t frame)
+{
+	std::vector<VkImageView>& written = _writtenViews.at(frame);
+	written.resize(_slots.size(), VK_NULL_HANDLE);
+
+	std::vector<VkDescriptorImageInfo> infos;
+	std::vector<uint32_t> indices;
+	for (uint32_t i = 0; i < _slots.size(); ++i) {
+		VkDescriptorImageInfo info{};
+		info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		currentDescriptor(_slots[i], info.imageView, info.sampler);
+		if (info.imageView == VK_NULL_HANDLE || info.imageView == written[i]) continue;
+		infos.push_back(info);
+		indices.push_back(i);
+		written[i] = info.imageView;
+	}
+	if (infos.empty()) return;
+
+	std::vector<VkWriteDescriptorSet> writes(infos.size());
+	for (size_t i = 0; i < infos.size(); ++i) {
+		writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[i].dstSet = _sets[frame];
+		writes[i].dstBinding = 2;
+		writes[i].dstArrayElement = indices[i];
+		writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		writes[i].descriptorCount = 1;
+		writes[i].pImageInfo = &infos[i];
+	}
+	vkUpdateDescriptorSets(_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+	_descriptorWrites += static_cast<uint32_t>(writes.size());
+}
+
+VkPushConstantRange BindlessTable::pushConstantRange()
+{
+	return VkPushConstantRange{ VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(DrawConstants) };
+}
+
+BindlessTable::Stats BindlessTable::stats() const
+{
+	Stats s;
+	s.textures = static_cast<uint32_t>(_slots.size());
+	s.textureCapacity = _textureCapacity;
+	s.materials = _materialCount;
+	s.descriptorWrites = _descriptorWrites;
+	return s;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "GpuAllocator.h"
+#include "Material.h"
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class FrameUniforms;
+
+// Set 2, binding 0: one entry per distinct material, indexed by BindlessTable::DrawConstants::materialIndex
+struct MaterialGpu {
+	alignas(16) glm::vec4 albedo;
+	float metallic = 0.0f;
+	float roughness = 1.0f;
+	uint32_t textureIndex = 0; // into the set 2, binding 2 texture array
+	uint32_t pad = 0;
+};
+
+// Every texture in one sampled-image array and every material in one storage buffer, so a pass binds one
+// set and each draw selects its model matrix, material and texture with a push constant instead of a set.
+// Set 2 layout:
+//   binding 0: MaterialGpu[]   (storage buffer, shared by every frame)
+//   binding 1: mat4 models[]   (FrameUniforms object slots of the frame, as a storage buffer)
+//   binding 2: sampler2D[]     (partially bound; index 0 is the default texture)
+// Each frame in flight has its own set. update() rewrites a frame's texture descriptors after its fence has
+// signalled, so streamed images are picked up without UPDATE_AFTER_BIND.
+class BindlessTable final
+{
+public:
+	static constexpr uint32_t kMaxTextures = 1024;
+	static constexpr uint32_t kMaxMaterials = 4096;
+	static constexpr uint32_t kDefaultTexture = 0;
+
+	// Per-draw selection pushed to the vertex and fragment stages
+	struct DrawConstants {
+		uint32_t objectIndex;   // FrameUniforms::objectIndex(slot)
+		uint32_t materialIndex;
+	};
+
+	struct Stats {
+		uint32_t textures = 0;
+		uint32_t textureCapacity = 0;
+		uint32_t materials = 0;
+		uint32_t descriptorWrites = 0; // texture descriptors written by update() since create
+	};
+
+	BindlessTable() = default;
+	~BindlessTable() = default;
+
+	// Owns a pool, a layout and the material buffer; release them through destroy()
+	BindlessTable(const BindlessTable&) = delete;
+	BindlessTable& operator=(const BindlessTable&) = delete;
+	BindlessTable(BindlessTable&&) = delete;
+	BindlessTable& operator=(BindlessTable&&) = delete;
+
+	// True when the device has the descriptor-indexing features the table needs (core in Vulkan 1.2)
+	static bool supported(VkPhysicalDevice physicalDevice);
+	// Sets those features on a struct chained into VkDeviceCreateInfo
+	static void enableFeatures(VkPhysicalDeviceVulkan12Features& features);
+
+	// defaultView/defaultSampler fill index 0, which materials without a texture use
+	void create(VkDevice device, VkPhysicalDevice physicalDevice, GpuAllocator* allocator, const FrameUniforms* uniforms,
+		uint32_t framesInFlight, VkImageView defaultView, VkSampler defaultSampler);
+	void destroy();
+	bool valid() const { return _layout != VK_NULL_HANDLE; }
+
+	// Returns the texture's index, registering it on first use; null textures map to kDefaultTexture.
+	// Throws when the array is full.
+	uint32_t addTexture(Texture* texture);
+	// Returns the index of an identical material if one was added before; throws when the buffer is full
+	uint32_t addMaterial(const Material& material);
+
+	// Writes texture descriptors added, or whose image was swapped by streaming, since this frame's set was
+	// last updated. Call once the frame's fence has signalled and before recording.
+	void update(uint32_t frame);
+
+	VkDescriptorSetLayout layout() const { return _layout; }
+	VkDescriptorSet set(uint32_t frame) const { return _sets.at(frame); }
+	// Push-constant range matching DrawConstants, for pipeline layouts that include the table
+	static VkPushConstantRange pushConstantRange();
+
+	Stats stats() const;
+
+private:
+	struct Slot {
+		Texture* texture{ nullptr }; // null for the default texture
+		VkImageView view{ VK_NULL_HANDLE };
+		VkSampler sampler{ VK_NULL_HANDLE };
+	};
+
+	void currentDescriptor(const Slot& slot, VkImageView& view, VkSampler& sampler) const;
+
+	VkDevice _device{ VK_NULL_HANDLE };
+	GpuAllocator* _allocator{ nullptr };
+	uint32_t _textureCapacity{ 0 };
+
+	VkDescriptorSetLayout _layout{ VK_NULL_HANDLE };
+	// Separate from DescriptorAllocator: one set here holds more samplers than its pool ratios provide for
+	VkDescriptorPool _pool{ VK_NULL_HANDLE };
+	std::vector<VkDescriptorSet> _sets;
+	std::vector<std::vector<VkImageView>> _writtenViews; // per frame, the view each slot's descriptor holds
+
+	VkBuffer _materialBuffer{ VK_NULL_HANDLE };
+	GpuAllocation _materialAllocation{};
+	MaterialGpu* _materials{ nullptr };
+	uint32_t _materialCount{ 0 };
+
+	std::vector<Slot> _slots;
+	std::unordered_map<const Texture*, uint32_t> _textureIndices;
+	uint32_t _descriptorWrites{ 0 };
+};
@@ -23,8 +23,8 @@ class Cactus final : public IWorldObject
     bool _isSunny = true;
 
 public:
-    Cactus(const glm::vec3& position, textureManager* textureMgr)
-        : IWorldObject(position, kModelPath, textureMgr, "cactus")
+    Cactus(const glm::vec3& position, textureManager* textureMgr, MeshLibrary* meshLibrary)
+        : IWorldObject(position, kModelPath, textureMgr, meshLibrary, "cactus")
     {
     }
 
@@ -10,8 +10,8 @@ class Camel final : public IWorldObject
 {
     static constexpr const char* kModelPath = "models/camel.obj";
 public:
-    Camel(const glm::vec3& position, textureManager* textureMgr)
-        : IWorldObject(position, kModelPath, textureMgr, "camel")
+    Camel(const glm::vec3& position, textureManager* textureMgr, MeshLibrary* meshLibrary)
+        : IWorldObject(position, kModelPath, textureMgr, meshLibrary, "camel")
     {
     }
 
@@ -16,8 +16,8 @@ class Candle final : public IWorldObject
     Light _light{};
 
 public:
-    Candle(const glm::vec3& position, textureManager* textureMgr)
-        : IWorldObject(position, kModelPath, textureMgr, "candle")
+    Candle(const glm::vec3& position, textureManager* textureMgr, MeshLibrary* meshLibrary)
+        : IWorldObject(position, kModelPath, textureMgr, meshLibrary, "candle")
     {
         // Set up the point light for the candle flame
         _light.setType(LightType::Point);
@@ -39,6 +39,7 @@ public:
     ~Candle() override final;
 	void initializeFlame(const RenderContext& ctx);
 	void update(float& deltaTime) override final;
+	particleSystem* particles() override final { return &_flameParticles; }
     void drawFlame(VkCommandBuffer cmd, VkPipeline pipeline, VkBuffer quadVB, VkBuffer quadIB, uint32_t quadIndexCount) const
     {
         _flameParticles.recordDraw(cmd, pipeline, quadVB, quadIB, quadIndexCount);
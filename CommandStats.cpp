@@ -0,0 +1,46 @@
+#include "CommandStats.h"
+#include <atomic>
+
+namespace {
+	std::array<std::atomic<uint64_t>, CommandStats::KindCount> g_counts{};
+}
+
+uint64_t CommandStats::Counts::total() const
+{
+	uint64_t sum = 0;
+	for (uint64_t count : byKind) {
+		sum += count;
+	}
+	return sum;
+}
+
+CommandStats::Counts CommandStats::Counts::operator-(const Counts& earlier) const
+{
+	Counts difference;
+	for (uint32_t kind = 0; kind < KindCount; ++kind) {
+		difference.byKind[kind] = byKind[kind] - earlier.byKind[kind];
+	}
+	return difference;
+}
+
+CommandStats::Counts& CommandStats::Counts::operator+=(const Counts& other)
+{
+	for (uint32_t kind = 0; kind < KindCount; ++kind) {
+		byKind[kind] += other.byKind[kind];
+	}
+	return *this;
+}
+
+void CommandStats::add(Kind kind, uint64_t count)
+{
+	g_counts[kind].fetch_add(count, std::memory_order_relaxed);
+}
+
+CommandStats::Counts CommandStats::read()
+{
+	Counts counts;
+	for (uint32_t kind = 0; kind < KindCount; ++kind) {
+		counts.byKind[kind] = g_counts[kind].load(std::memory_order_relaxed);
+	}
+	return counts;
+}
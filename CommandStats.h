@@ -0,0 +1,28 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+// Commands recorded through the engine's draw helpers, summed over every recording thread. The counters are
+// relaxed atomics, so the difference between two reads is exact when nothing else records in between.
+class CommandStats final
+{
+public:
+	enum Kind : uint32_t { PipelineBind, DescriptorBind, BufferBind, PushConstants, DynamicState, Draw, KindCount };
+
+	struct Counts {
+		std::array<uint64_t, KindCount> byKind{};
+
+		uint64_t total() const;
+		// Pipeline, descriptor set and vertex/index buffer binds
+		uint64_t binds() const { return byKind[PipelineBind] + byKind[DescriptorBind] + byKind[BufferBind]; }
+		uint64_t draws() const { return byKind[Draw]; }
+
+		Counts operator-(const Counts& earlier) const;
+		Counts& operator+=(const Counts& other);
+	};
+
+	CommandStats() = delete;
+
+	static void add(Kind kind, uint64_t count = 1);
+	static Counts read();
+};
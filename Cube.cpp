@@ -34,7 +34,7 @@ void Cube::create() {
          {{ glm::vec3(0.5f,  0.5f, -0.5f) + getPos() }, {1,1,1}, {0,1}, {0,0,-1}},
 	});
 
-     setIndices({
+     setIndices(std::vector<uint16_t>{
         // F1
         0, 1, 2, 2, 3, 0,
         // F2
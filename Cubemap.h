@@ -4,36 +4,23 @@
 #include <cstdint>
 #include <stdexcept>
 #include "Image.h"
+#include "UploadBatcher.h"
 class Cubemap final
 {
 
-    struct Staging
-    {
-        VkBuffer buffer{ VK_NULL_HANDLE };
-		VkDeviceMemory memory{ VK_NULL_HANDLE };
-        Staging() = default;
-
-        Staging(const Staging& other) = default;
-
-        Staging& operator=(const Staging& other) = default;
-
-
-        Staging(Staging&& other) = default;
-        
-        Staging& operator=(Staging&& other) = default;
-    };
-
     // Largest composite object first (class with dynamic resources)
     Image _image{};
 
     // Handles and lightweight PODs next
     VkDevice _device;
+    UploadBatcher* _uploader = nullptr;
     VkImage _imageHandle = VK_NULL_HANDLE;
-    VkDeviceMemory _imageMemory = VK_NULL_HANDLE;
+    GpuAllocation _imageAllocation{};
     VkImageView _imageView = VK_NULL_HANDLE;
     VkSampler _sampler = VK_NULL_HANDLE;
 
     uint32_t _size = 0;
+    uint32_t _mipLevels = 1;
     VkFormat _format = VK_FORMAT_UNDEFINED;
 
     void createGpuImage();
@@ -41,24 +28,25 @@ class Cubemap final
     void createView();
 	void createSampler(const VkSamplerCreateInfo& samplerInfo);
 
-    Staging createAndFillStaging(const void* pixels, VkDeviceSize byteSize);
-
 public:
 	Cubemap() = default;
 
-    Cubemap(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue graphicsQueue)
-        : _image(device, physicalDevice, commandPool, graphicsQueue),
-        _device(device) {
+    Cubemap(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue graphicsQueue, UploadBatcher* uploader, GpuAllocator* allocator)
+        : _image(device, physicalDevice, commandPool, graphicsQueue, allocator),
+        _device(device),
+        _uploader(uploader) {
     }
 
     Cubemap(const Cubemap& other)
         : _image(), // keep default-constructed; no resource copy
         _device(other._device),
+        _uploader(other._uploader),
         _imageHandle(VK_NULL_HANDLE),
-        _imageMemory(VK_NULL_HANDLE),
+        _imageAllocation(),
         _imageView(VK_NULL_HANDLE),
         _sampler(VK_NULL_HANDLE),
         _size(0),
+        _mipLevels(1),
         _format(VK_FORMAT_UNDEFINED)
     {
     }
@@ -71,11 +59,13 @@ public:
         // Intentionally no copying of Vulkan resources; preserves current semantics.
         // Keep device consistent with source object.
         _device = other._device;
+        _uploader = other._uploader;
         _imageHandle = VK_NULL_HANDLE;
-        _imageMemory = VK_NULL_HANDLE;
+        _imageAllocation = {};
         _imageView = VK_NULL_HANDLE;
         _sampler = VK_NULL_HANDLE;
         _size = 0;
+        _mipLevels = 1;
         _format = VK_FORMAT_UNDEFINED;
         _image = Image{}; // reset to default; no resource copy
         return *this;
@@ -85,14 +75,16 @@ public:
     Cubemap(Cubemap&& other)
         : _image(std::move(other._image)),
         _device(other._device),
+        _uploader(other._uploader),
         _imageHandle(other._imageHandle),
-        _imageMemory(other._imageMemory),
+        _imageAllocation(other._imageAllocation),
         _imageView(other._imageView),
         _sampler(other._sampler),
         _size(other._size),
+        _mipLevels(other._mipLevels),
         _format(other._format) {
         other._imageHandle = VK_NULL_HANDLE;
-        other._imageMemory = VK_NULL_HANDLE;
+        other._imageAllocation = {};
         other._imageView = VK_NULL_HANDLE;
         other._sampler = VK_NULL_HANDLE;
         other._size = 0;
@@ -105,15 +97,17 @@ public:
 
             _image = std::move(other._image);
             _device = other._device;
+            _uploader = other._uploader;
             _imageHandle = other._imageHandle;
-            _imageMemory = other._imageMemory;
+            _imageAllocation = other._imageAllocation;
             _imageView = other._imageView;
             _sampler = other._sampler;
             _size = other._size;
+            _mipLevels = other._mipLevels;
             _format = other._format;
 
             other._imageHandle = VK_NULL_HANDLE;
-            other._imageMemory = VK_NULL_HANDLE;
+            other._imageAllocation = {};
             other._imageView = VK_NULL_HANDLE;
             other._sampler = VK_NULL_HANDLE;
             other._size = 0;
@@ -130,6 +124,7 @@ public:
 	VkImageView view() const { return _imageView; }
 	VkSampler sampler() const { return _sampler; }
 	uint32_t size() const { return _size; }
+	uint32_t mipLevels() const { return _mipLevels; }
 	VkFormat format() const { return _format; }
 
     static VkSamplerCreateInfo DefaultSamplerCreateInfo() {
@@ -146,10 +141,10 @@ public:
         si.unnormalizedCoordinates = VK_FALSE;
         si.compareEnable = VK_FALSE;
         si.compareOp = VK_COMPARE_OP_ALWAYS;
-        si.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        si.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         si.mipLodBias = 0.0f;
         si.minLod = 0.0f;
-        si.maxLod = 0.0f;
+        si.maxLod = VK_LOD_CLAMP_NONE; // clamped to the generated chain in createSampler
         return si;
     }
 };
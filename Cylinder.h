@@ -20,6 +20,7 @@ public:
 
     void create() override;
     void move() override;
+    size_t localDataBytes() const override { return _localVertices.capacity() * sizeof(Vertex) + _localIndices.capacity() * sizeof(uint16_t); }
 
 };
 
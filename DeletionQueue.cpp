@@ -0,0 +1,54 @@
+#include "DeletionQueue.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+void DeletionQueue::create(uint32_t framesInFlight)
+{
+	if (framesInFlight == 0) {
+		throw std::runtime_error("DeletionQueue: at least one frame in flight is required");
+	}
+	_frameSerials.assign(framesInFlight, 0);
+	_pending.clear();
+	_submitted = 0;
+	_completed = 0;
+	_stats = {};
+}
+
+void DeletionQueue::retire(std::function<void()> destroy)
+{
+	if (!destroy) return;
+	_pending.push_back({ _submitted, std::move(destroy) });
+	++_stats.retired;
+	_stats.pending = static_cast<uint32_t>(_pending.size());
+	_stats.peakPending = std::max(_stats.peakPending, _stats.pending);
+}
+
+void DeletionQueue::submitted(uint32_t frame)
+{
+	_frameSerials.at(frame) = ++_submitted;
+}
+
+void DeletionQueue::collect(uint32_t frame)
+{
+	_completed = std::max(_completed, _frameSerials.at(frame));
+	runUpTo(_completed);
+}
+
+void DeletionQueue::flush()
+{
+	_completed = _submitted;
+	runUpTo(std::numeric_limits<uint64_t>::max());
+}
+
+void DeletionQueue::runUpTo(uint64_t serial)
+{
+	while (!_pending.empty() && _pending.front().serial <= serial) {
+		// Pop first so a callback that retires something else does not see itself at the front
+		std::function<void()> destroy = std::move(_pending.front().destroy);
+		_pending.pop_front();
+		destroy();
+		++_stats.destroyed;
+	}
+	_stats.pending = static_cast<uint32_t>(_pending.size());
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+// Destroys Vulkan objects once the GPU can no longer be using them, without waiting for the device to idle.
+// Every queue submission a frame makes gets the next serial; an object retired after submission N is
+// destroyed the first time collect() sees a frame fence that covers N. Submissions to one queue complete
+// in order, so a frame's fence signalling means every earlier serial has completed too.
+class DeletionQueue final
+{
+public:
+	struct Stats {
+		uint64_t retired = 0;
+		uint64_t destroyed = 0;
+		uint32_t pending = 0;
+		uint32_t peakPending = 0;
+	};
+
+	DeletionQueue() = default;
+	~DeletionQueue() = default;
+
+	// Holds destroy callbacks that capture handles; run them through collect() or flush()
+	DeletionQueue(const DeletionQueue&) = delete;
+	DeletionQueue& operator=(const DeletionQueue&) = delete;
+	DeletionQueue(DeletionQueue&&) = delete;
+	DeletionQueue& operator=(DeletionQueue&&) = delete;
+
+	void create(uint32_t framesInFlight);
+
+	// Queues destroy to run once every submission made so far has completed
+	void retire(std::function<void()> destroy);
+	// Records that frame's submission went to the queue; call after vkQueueSubmit signals the frame's fence
+	void submitted(uint32_t frame);
+	// Runs the callbacks the frame's fence now covers; call once that fence has signalled
+	void collect(uint32_t frame);
+	// Runs every pending callback; only after vkDeviceWaitIdle
+	void flush();
+
+	const Stats& stats() const { return _stats; }
+
+private:
+	struct Entry {
+		uint64_t serial;
+		std::function<void()> destroy;
+	};
+
+	void runUpTo(uint64_t serial);
+
+	std::deque<Entry> _pending;           // serials never decrease front to back
+	std::vector<uint64_t> _frameSerials;  // per frame, the serial of its last submission
+	uint64_t _submitted{ 0 };
+	uint64_t _completed{ 0 };
+	Stats _stats;
+};
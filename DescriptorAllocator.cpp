@@ -0,0 +1,167 @@
+#include "DescriptorAllocator.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+void DescriptorAllocator::create(VkDevice device, uint32_t framesInFlight, std::vector<PoolRatio> ratios, uint32_t setsPerPool)
+{
+	if (framesInFlight == 0 || ratios.empty()) {
+		throw std::runtime_error("DescriptorAllocator: at least one frame and one descriptor type are required");
+	}
+
+	_device = device;
+	_ratios = std::move(ratios);
+	_setsPerPool = std::clamp(setsPerPool, 1u, kMaxSetsPerPool);
+	_persistent = {};
+	_persistent.nextSets = _setsPerPool;
+	_frames.assign(framesInFlight, PoolChain{});
+	for (PoolChain& frame : _frames) {
+		frame.nextSets = _setsPerPool;
+	}
+	_owners.clear();
+	_peakTransientSets = 0;
+}
+
+void DescriptorAllocator::destroy()
+{
+	std::lock_guard lock(_mutex);
+	if (_device == VK_NULL_HANDLE) return;
+	for (VkDescriptorPool pool : _persistent.pools) {
+		vkDestroyDescriptorPool(_device, pool, nullptr);
+	}
+	for (PoolChain& frame : _frames) {
+		for (VkDescriptorPool pool : frame.pools) {
+			vkDestroyDescriptorPool(_device, pool, nullptr);
+		}
+	}
+	_persistent = {};
+	_frames.clear();
+	_owners.clear();
+	_device = VK_NULL_HANDLE;
+}
+
+VkDescriptorPool DescriptorAllocator::createPool(uint32_t maxSets, VkDescriptorPoolCreateFlags flags)
+{
+	std::vector<VkDescriptorPoolSize> sizes;
+	sizes.reserve(_ratios.size());
+	for (const PoolRatio& ratio : _ratios) {
+		sizes.push_back({ ratio.type, std::max(1u, static_cast<uint32_t>(ratio.perSet * static_cast<float>(maxSets))) });
+	}
+
+	VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+	poolInfo.flags = flags;
+	poolInfo.maxSets = maxSets;
+	poolInfo.poolSizeCount = static_cast<uint32_t>(sizes.size());
+	poolInfo.pPoolSizes = sizes.data();
+
+	VkDescriptorPool pool = VK_NULL_HANDLE;
+	if (vkCreateDescriptorPool(_device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+		throw std::runtime_error("DescriptorAllocator: failed to create a pool of " + std::to_string(maxSets) + " sets");
+	}
+	return pool;
+}
+
+VkDescriptorPool DescriptorAllocator::allocateFromChain(PoolChain& chain, VkDescriptorPoolCreateFlags flags,
+	const VkDescriptorSetAllocateInfo& info, VkDescriptorSet* sets)
+{
+	VkDescriptorSetAllocateInfo allocInfo = info;
+
+	// Earlier pools may have room again after frees; try from the one that last succeeded onwards
+	for (; chain.current < chain.pools.size(); ++chain.current) {
+		allocInfo.descriptorPool = chain.pools[chain.current];
+		const VkResult result = vkAllocateDescriptorSets(_device, &allocInfo, sets);
+		if (result == VK_SUCCESS) return allocInfo.descriptorPool;
+		if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) {
+			throw std::runtime_error("DescriptorAllocator: vkAllocateDescriptorSets failed");
+		}
+	}
+
+	// Every pool is full: chain a bigger one so a growing scene needs fewer pools
+	const uint32_t maxSets = std::max(chain.nextSets, info.descriptorSetCount);
+	chain.nextSets = std::min(maxSets * 2, kMaxSetsPerPool);
+	chain.pools.push_back(createPool(maxSets, flags));
+	chain.current = chain.pools.size() - 1;
+
+	allocInfo.descriptorPool = chain.pools.back();
+	if (vkAllocateDescriptorSets(_device, &allocInfo, sets) != VK_SUCCESS) {
+		throw std::runtime_error("DescriptorAllocator: a new pool could not hold " + std::to_string(info.descriptorSetCount)
+			+ " sets; check the pool ratios cover the layout");
+	}
+	return allocInfo.descriptorPool;
+}
+
+void DescriptorAllocator::allocate(VkDescriptorSetLayout layout, uint32_t count, VkDescriptorSet* sets)
+{
+	if (count == 0) return;
+	const std::vector<VkDescriptorSetLayout> layouts(count, layout);
+	VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+	allocInfo.descriptorSetCount = count;
+	allocInfo.pSetLayouts = layouts.data();
+
+	std::lock_guard lock(_mutex);
+	const VkDescriptorPool pool = allocateFromChain(_persistent, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT, allocInfo, sets);
+	for (uint32_t i = 0; i < count; ++i) {
+		_owners.emplace(sets[i], pool);
+	}
+}
+
+VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout layout)
+{
+	VkDescriptorSet set = VK_NULL_HANDLE;
+	allocate(layout, 1, &set);
+	return set;
+}
+
+void DescriptorAllocator::free(uint32_t count, VkDescriptorSet* sets)
+{
+	std::lock_guard lock(_mutex);
+	for (uint32_t i = 0; i < count; ++i) {
+		const auto it = sets[i] != VK_NULL_HANDLE ? _owners.find(sets[i]) : _owners.end();
+		if (it != _owners.end()) {
+			vkFreeDescriptorSets(_device, it->second, 1, &sets[i]);
+			_owners.erase(it);
+		}
+		sets[i] = VK_NULL_HANDLE;
+	}
+	// The freed space may be in any pool, so the next allocation walks the chain from the start
+	_persistent.current = 0;
+}
+
+VkDescriptorSet DescriptorAllocator::allocateTransient(uint32_t frame, VkDescriptorSetLayout layout)
+{
+	VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &layout;
+
+	std::lock_guard lock(_mutex);
+	PoolChain& chain = _frames.at(frame);
+	VkDescriptorSet set = VK_NULL_HANDLE;
+	allocateFromChain(chain, 0, allocInfo, &set);
+	_peakTransientSets = std::max(_peakTransientSets, ++chain.allocated);
+	return set;
+}
+
+void DescriptorAllocator::resetFrame(uint32_t frame)
+{
+	std::lock_guard lock(_mutex);
+	PoolChain& chain = _frames.at(frame);
+	// Pools past current were never used since the last reset
+	for (size_t i = 0; i <= chain.current && i < chain.pools.size(); ++i) {
+		vkResetDescriptorPool(_device, chain.pools[i], 0);
+	}
+	chain.current = 0;
+	chain.allocated = 0;
+}
+
+DescriptorAllocator::Stats DescriptorAllocator::stats() const
+{
+	std::lock_guard lock(_mutex);
+	Stats s;
+	s.pools = static_cast<uint32_t>(_persistent.pools.size());
+	s.liveSets = static_cast<uint32_t>(_owners.size());
+	for (const PoolChain& frame : _frames) {
+		s.transientPools += static_cast<uint32_t>(frame.pools.size());
+	}
+	s.peakTransientSets = _peakTransientSets;
+	return s;
+}
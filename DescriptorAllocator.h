@@ -0,0 +1,81 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Hands out descriptor sets from chains of pools that grow on demand, so the number of objects a scene can
+// hold is not fixed when the pools are created.
+// Long-lived sets come from pools created with FREE_DESCRIPTOR_SET and stay valid until they are freed
+// or the allocator is destroyed. Swapchain recreation does not touch them.
+// Transient sets come from per-frame pools. They are valid until resetFrame() for that frame, which
+// resets each of the frame's pools in one call, however many sets were taken.
+class DescriptorAllocator final
+{
+public:
+	// Descriptors of one type reserved per set in each pool
+	struct PoolRatio {
+		VkDescriptorType type;
+		float perSet;
+	};
+
+	static constexpr uint32_t kDefaultSetsPerPool = 64;
+	static constexpr uint32_t kMaxSetsPerPool = 4096;
+
+	struct Stats {
+		uint32_t pools = 0;            // long-lived pools in the chain
+		uint32_t liveSets = 0;         // long-lived sets allocated and not yet freed
+		uint32_t transientPools = 0;   // across every frame
+		uint32_t peakTransientSets = 0; // most sets taken by one frame between resets
+	};
+
+	DescriptorAllocator() = default;
+	~DescriptorAllocator() = default;
+
+	// Owns Vulkan pools; release them through destroy()
+	DescriptorAllocator(const DescriptorAllocator&) = delete;
+	DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+	DescriptorAllocator(DescriptorAllocator&&) = delete;
+	DescriptorAllocator& operator=(DescriptorAllocator&&) = delete;
+
+	// ratios cover every descriptor type the layouts allocated from here use
+	void create(VkDevice device, uint32_t framesInFlight, std::vector<PoolRatio> ratios, uint32_t setsPerPool = kDefaultSetsPerPool);
+	// Destroys every pool, which frees all sets allocated from them
+	void destroy();
+
+	// Allocates count long-lived sets with the same layout; a new, larger pool is chained when the current ones are full
+	void allocate(VkDescriptorSetLayout layout, uint32_t count, VkDescriptorSet* sets);
+	VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+	// Returns sets to their pools; null handles are skipped and every handle is reset
+	void free(uint32_t count, VkDescriptorSet* sets);
+
+	// A set valid until resetFrame(frame); the caller must not free it
+	VkDescriptorSet allocateTransient(uint32_t frame, VkDescriptorSetLayout layout);
+	// Call once frame's fence has signalled, before recording into it again
+	void resetFrame(uint32_t frame);
+
+	Stats stats() const;
+
+private:
+	struct PoolChain {
+		std::vector<VkDescriptorPool> pools;
+		size_t current = 0;       // pools before this one are full
+		uint32_t nextSets = 0;    // maxSets for the next pool created
+		uint32_t allocated = 0;   // sets taken since the last reset (transient chains only)
+	};
+
+	VkDescriptorPool createPool(uint32_t maxSets, VkDescriptorPoolCreateFlags flags);
+	VkDescriptorPool allocateFromChain(PoolChain& chain, VkDescriptorPoolCreateFlags flags, const VkDescriptorSetAllocateInfo& info,
+		VkDescriptorSet* sets);
+
+	VkDevice _device{ VK_NULL_HANDLE };
+	std::vector<PoolRatio> _ratios;
+	uint32_t _setsPerPool{ kDefaultSetsPerPool };
+
+	mutable std::mutex _mutex;
+	PoolChain _persistent;
+	std::unordered_map<VkDescriptorSet, VkDescriptorPool> _owners; // long-lived set -> the pool to free it to
+	std::vector<PoolChain> _frames;
+	uint32_t _peakTransientSets{ 0 };
+};
@@ -0,0 +1,58 @@
+#include "FrameLatency.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+	double millisecondsBetween(FrameLatency::Clock::time_point from, FrameLatency::Clock::time_point to)
+	{
+		return std::chrono::duration<double, std::milli>(to - from).count();
+	}
+}
+
+void FrameLatency::create(uint32_t framesInFlight)
+{
+	if (framesInFlight == 0) {
+		throw std::runtime_error("FrameLatency: at least one frame in flight is required");
+	}
+	_slots.assign(framesInFlight, Slot{});
+	reset();
+}
+
+void FrameLatency::reset()
+{
+	for (Slot& slot : _slots) {
+		slot.pending = false;
+	}
+	_presentTotalMs = 0.0;
+	_completeTotalMs = 0.0;
+	_presented = 0;
+	_stats = {};
+}
+
+void FrameLatency::presented(uint32_t frame, Clock::time_point sampled, Clock::time_point now)
+{
+	Slot& slot = _slots.at(frame);
+	slot.sampled = sampled;
+	slot.pending = true;
+
+	const double ms = millisecondsBetween(sampled, now);
+	++_presented;
+	_presentTotalMs += ms;
+	_stats.presentLastMs = ms;
+	_stats.presentAverageMs = _presentTotalMs / static_cast<double>(_presented);
+	_stats.presentPeakMs = std::max(_stats.presentPeakMs, ms);
+}
+
+void FrameLatency::completed(uint32_t frame, Clock::time_point now)
+{
+	Slot& slot = _slots.at(frame);
+	if (!slot.pending) return;
+	slot.pending = false;
+
+	const double ms = millisecondsBetween(slot.sampled, now);
+	++_stats.frames;
+	_completeTotalMs += ms;
+	_stats.completeLastMs = ms;
+	_stats.completeAverageMs = _completeTotalMs / static_cast<double>(_stats.frames);
+	_stats.completePeakMs = std::max(_stats.completePeakMs, ms);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Time from the input a frame was built from to that frame reaching the display. Two points are measured per
+// frame: when vkQueuePresentKHR returned (all CPU work done, image queued) and when the frame's fence was first
+// seen signalled (GPU work done). Neither includes the wait in the presentation engine's queue, which the
+// swapchain depth and present mode decide; the fence point is observed at the next frame start, not the moment
+// it signalled, so it is an upper bound on GPU completion.
+class FrameLatency final
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Stats {
+		uint64_t frames = 0;
+		double presentLastMs = 0.0;
+		double presentAverageMs = 0.0;
+		double presentPeakMs = 0.0;
+		double completeLastMs = 0.0;
+		double completeAverageMs = 0.0;
+		double completePeakMs = 0.0;
+	};
+
+	// One slot per frame in flight the renderer may use
+	void create(uint32_t framesInFlight);
+	void reset();
+
+	// The frame in slot frame was presented; sampled is when the input it was built from was polled
+	void presented(uint32_t frame, Clock::time_point sampled, Clock::time_point now = Clock::now());
+	// Call once the slot's fence is known to have signalled; does nothing if no frame of the slot is pending
+	void completed(uint32_t frame, Clock::time_point now = Clock::now());
+	bool pending(uint32_t frame) const { return _slots.at(frame).pending; }
+
+	const Stats& stats() const { return _stats; }
+
+private:
+	struct Slot {
+		Clock::time_point sampled{};
+		bool pending = false;
+	};
+
+	std::vector<Slot> _slots;
+	double _presentTotalMs{ 0.0 };
+	double _completeTotalMs{ 0.0 };
+	uint64_t _presented{ 0 };
+	Stats _stats;
+};
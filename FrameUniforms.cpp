@@ -0,0 +1,112 @@
+#include "FrameUniforms.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	constexpr VkDeviceSize alignUp(VkDeviceSize v, VkDeviceSize a) {
+		return (v + a - 1) / a * a;
+	}
+}
+
+void FrameUniforms::create(GpuAllocator* allocator, VkPhysicalDevice physicalDevice, uint32_t framesInFlight, uint32_t objectCapacity)
+{
+	if (allocator == nullptr || framesInFlight == 0 || objectCapacity == 0) {
+		throw std::runtime_error("FrameUniforms: an allocator, at least one frame and one object slot are required");
+	}
+
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	// Slots are also read as one storage array, so strides must be whole mat4s and satisfy both offset alignments
+	const VkDeviceSize alignment = std::max({ properties.limits.minUniformBufferOffsetAlignment,
+		properties.limits.minStorageBufferOffsetAlignment, static_cast<VkDeviceSize>(sizeof(ObjectUniforms)) });
+
+	_allocator = allocator;
+	_framesInFlight = framesInFlight;
+	_capacity = objectCapacity;
+	_cameraStride = alignUp(sizeof(CameraUniforms), alignment);
+	_objectStride = alignUp(sizeof(ObjectUniforms), alignment);
+	_objectsBase = _cameraStride * framesInFlight;
+	_frameStride = _objectStride * objectCapacity;
+	_maxStorageRange = properties.limits.maxStorageBufferRange;
+
+	_size = _objectsBase + _frameStride * framesInFlight;
+	if (_size - _objectStride > UINT32_MAX) {
+		throw std::runtime_error("FrameUniforms: " + std::to_string(objectCapacity) + " object slots put dynamic offsets past 4 GiB");
+	}
+	allocator->createBuffer(_size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, GpuMemoryCategory::Uniform, "frame uniforms", _buffer, _allocation);
+	_mapped = static_cast<uint8_t*>(_allocation.mapped);
+	if (_mapped == nullptr) {
+		throw std::runtime_error("FrameUniforms: uniform memory is not mapped");
+	}
+
+	// Hand out low slots first so a small scene stays in the first few pages
+	_freeSlots.resize(objectCapacity);
+	for (uint32_t i = 0; i < objectCapacity; ++i) {
+		_freeSlots[i] = objectCapacity - 1 - i;
+	}
+}
+
+void FrameUniforms::destroy()
+{
+	if (_allocator != nullptr) {
+		_allocator->destroyBuffer(_buffer, _allocation);
+	}
+	_mapped = nullptr;
+	_freeSlots.clear();
+	_capacity = 0;
+	_size = 0;
+	_allocator = nullptr;
+}
+
+uint32_t FrameUniforms::acquireSlot()
+{
+	if (_freeSlots.empty()) {
+		throw std::runtime_error("FrameUniforms: all " + std::to_string(_capacity) + " object slots are in use");
+	}
+	const uint32_t slot = _freeSlots.back();
+	_freeSlots.pop_back();
+	return slot;
+}
+
+void FrameUniforms::releaseSlot(uint32_t& slot)
+{
+	if (slot != kInvalidSlot && slot < _capacity) {
+		_freeSlots.push_back(slot);
+	}
+	slot = kInvalidSlot;
+}
+
+void FrameUniforms::writeCamera(uint32_t frame, const CameraUniforms& camera)
+{
+	std::memcpy(_mapped + _cameraStride * frame, &camera, sizeof(camera));
+}
+
+void FrameUniforms::writeObject(uint32_t frame, uint32_t slot, const glm::mat4& model)
+{
+	const ObjectUniforms object{ model };
+	std::memcpy(_mapped + objectOffset(frame, slot), &object, sizeof(object));
+}
+
+uint32_t FrameUniforms::objectOffset(uint32_t frame, uint32_t slot) const
+{
+	return static_cast<uint32_t>(_objectsBase + _frameStride * frame + _objectStride * slot);
+}
+
+VkDescriptorBufferInfo FrameUniforms::objectBufferInfo() const
+{
+	return VkDescriptorBufferInfo{ _buffer, 0, sizeof(ObjectUniforms) };
+}
+
+VkDescriptorBufferInfo FrameUniforms::cameraBufferInfo(uint32_t frame) const
+{
+	return VkDescriptorBufferInfo{ _buffer, _cameraStride * frame, sizeof(CameraUniforms) };
+}
+
+VkDescriptorBufferInfo FrameUniforms::objectStorageInfo(uint32_t frame) const
+{
+	return VkDescriptorBufferInfo{ _buffer, _objectsBase + _frameStride * frame, _frameStride };
+}
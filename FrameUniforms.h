@@ -0,0 +1,85 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "GpuAllocator.h"
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <vector>
+
+// Set 0, binding 5: written once per frame, shared by every draw
+struct CameraUniforms {
+	alignas(16) glm::mat4 view;
+	alignas(16) glm::mat4 proj;
+	alignas(16) glm::vec4 eye; // world-space camera position, w = 1
+};
+
+// Set 0, binding 0 (dynamic): one slot per object
+struct ObjectUniforms {
+	alignas(16) glm::mat4 model;
+};
+
+// One persistently mapped buffer holding a camera block and an object slot array per frame in flight.
+// Objects keep the same slot for their lifetime and bind it with a dynamic offset, so no object owns a buffer
+// and a frame writes one camera block plus one model matrix per object.
+class FrameUniforms final
+{
+public:
+	static constexpr uint32_t kInvalidSlot = UINT32_MAX;
+
+	FrameUniforms() = default;
+	~FrameUniforms() = default;
+
+	// Owns the buffer; release it through destroy()
+	FrameUniforms(const FrameUniforms&) = delete;
+	FrameUniforms& operator=(const FrameUniforms&) = delete;
+	FrameUniforms(FrameUniforms&&) = delete;
+	FrameUniforms& operator=(FrameUniforms&&) = delete;
+
+	// Size objectCapacity from the loaded scene; there is no growing later, since descriptor sets and recorded
+	// dynamic offsets point into the buffer. Throws when the last slot's offset does not fit the 32-bit dynamic offset.
+	void create(GpuAllocator* allocator, VkPhysicalDevice physicalDevice, uint32_t framesInFlight, uint32_t objectCapacity);
+	void destroy();
+
+	// Throws when every slot is taken
+	uint32_t acquireSlot();
+	void releaseSlot(uint32_t& slot);
+
+	void writeCamera(uint32_t frame, const CameraUniforms& camera);
+	void writeObject(uint32_t frame, uint32_t slot, const glm::mat4& model);
+
+	// Dynamic offset for binding 0 of a set written with objectBufferInfo()
+	uint32_t objectOffset(uint32_t frame, uint32_t slot) const;
+
+	// Binding 0: the whole buffer at offset 0, one slot wide; the dynamic offset picks the frame and slot
+	VkDescriptorBufferInfo objectBufferInfo() const;
+	// Binding 5: the camera block of one frame
+	VkDescriptorBufferInfo cameraBufferInfo(uint32_t frame) const;
+
+	// The same object slots read as a storage buffer of mat4, for draws that pick their slot by index
+	// (BindlessTable) rather than by dynamic offset: every slot of one frame
+	VkDescriptorBufferInfo objectStorageInfo(uint32_t frame) const;
+	// Whether objectStorageInfo()'s range is within the device's maxStorageBufferRange
+	bool objectStorageFits() const { return _frameStride <= _maxStorageRange; }
+	// Index of slot's model matrix in objectStorageInfo(); slots are padded to the offset alignment
+	uint32_t objectIndex(uint32_t slot) const { return slot * static_cast<uint32_t>(_objectStride / sizeof(ObjectUniforms)); }
+
+	uint32_t capacity() const { return _capacity; }
+	uint32_t slotsInUse() const { return _capacity - static_cast<uint32_t>(_freeSlots.size()); }
+	VkDeviceSize bufferSize() const { return _size; }
+
+private:
+	GpuAllocator* _allocator{ nullptr };
+	VkBuffer _buffer{ VK_NULL_HANDLE };
+	GpuAllocation _allocation{};
+	uint8_t* _mapped{ nullptr };
+
+	uint32_t _framesInFlight{ 0 };
+	uint32_t _capacity{ 0 };
+	VkDeviceSize _size{ 0 };
+	VkDeviceSize _cameraStride{ 0 };
+	VkDeviceSize _objectStride{ 0 };
+	VkDeviceSize _objectsBase{ 0 };  // first object slot of frame 0
+	VkDeviceSize _frameStride{ 0 };  // bytes between a slot in frame n and the same slot in frame n + 1
+	VkDeviceSize _maxStorageRange{ 0 };
+
+	std::vector<uint32_t> _freeSlots;
+};
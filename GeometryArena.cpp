@@ -0,0 +1,217 @@
+#include "GeometryArena.h"
+#include "CommandStats.h"
+#include "UploadBatcher.h"
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	uint64_t indexSize(VkIndexType type) {
+		return type == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+	}
+
+	// Index ranges are padded to 4 bytes so a 32-bit range can follow any 16-bit one
+	uint64_t indexBytes(uint32_t count, VkIndexType type) {
+		return (count * indexSize(type) + 3) & ~uint64_t(3);
+	}
+
+	// Innermost Recording open on this thread. A command buffer is only recorded by one thread at a time, so
+	// secondaries recorded in parallel each find their own.
+	thread_local GeometryArena::Recording* t_open = nullptr;
+}
+
+void GeometryArena::FreeList::reset(uint64_t capacity)
+{
+	_free.clear();
+	if (capacity > 0) _free.emplace(0, capacity);
+}
+
+bool GeometryArena::FreeList::allocate(uint64_t size, uint64_t alignment, uint64_t& offset)
+{
+	for (auto it = _free.begin(); it != _free.end(); ++it) {
+		const uint64_t start = (it->first + alignment - 1) / alignment * alignment;
+		const uint64_t end = it->first + it->second;
+		if (start + size > end) continue;
+
+		const uint64_t blockOffset = it->first;
+		_free.erase(it);
+		if (start > blockOffset) _free.emplace(blockOffset, start - blockOffset);
+		if (start + size < end) _free.emplace(start + size, end - (start + size));
+		offset = start;
+		return true;
+	}
+	return false;
+}
+
+void GeometryArena::FreeList::release(uint64_t offset, uint64_t size)
+{
+	auto next = _free.lower_bound(offset);
+	if (next != _free.end() && offset + size == next->first) {
+		size += next->second;
+		next = _free.erase(next);
+	}
+	if (next != _free.begin()) {
+		auto prev = std::prev(next);
+		if (prev->first + prev->second == offset) {
+			prev->second += size;
+			return;
+		}
+	}
+	_free.emplace(offset, size);
+}
+
+void GeometryArena::create(GpuAllocator* allocator, UploadBatcher* uploader, VkDeviceSize vertexBytes, VkDeviceSize indexBytes)
+{
+	if (allocator == nullptr || uploader == nullptr) {
+		throw std::runtime_error("GeometryArena: an allocator and an uploader are required");
+	}
+	_allocator = allocator;
+	_uploader = uploader;
+
+	const uint64_t vertexCapacity = vertexBytes / sizeof(Vertex);
+	allocator->createBuffer(vertexCapacity * sizeof(Vertex), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuMemoryCategory::Geometry, "geometry arena vertices", _vertexBuffer, _vertexAllocation);
+	allocator->createBuffer(indexBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuMemoryCategory::Geometry, "geometry arena indices", _indexBuffer, _indexAllocation);
+
+	_vertices.reset(vertexCapacity);
+	_indices.reset(indexBytes);
+	_stats = {};
+	_stats.vertexCapacity = vertexCapacity * sizeof(Vertex);
+	_stats.indexCapacity = indexBytes;
+	_binds = 0;
+	_draws = 0;
+}
+
+void GeometryArena::destroy()
+{
+	if (_allocator == nullptr) return;
+	_allocator->destroyBuffer(_indexBuffer, _indexAllocation);
+	_allocator->destroyBuffer(_vertexBuffer, _vertexAllocation);
+	_vertices.reset(0);
+	_indices.reset(0);
+	_allocator = nullptr;
+	_uploader = nullptr;
+}
+
+GeometryRange GeometryArena::add(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, VkIndexType indexType)
+{
+	if (!valid()) {
+		throw std::runtime_error("GeometryArena: add() before create()");
+	}
+	if (vertices.empty() || indices.empty()) return {};
+
+	const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+	const uint32_t indexCount = static_cast<uint32_t>(indices.size());
+	const uint64_t width = indexSize(indexType);
+	const uint64_t bytes = indexBytes(indexCount, indexType);
+
+	uint64_t firstVertex = 0;
+	if (!_vertices.allocate(vertexCount, 1, firstVertex)) {
+		throw std::runtime_error("GeometryArena: out of vertex space for " + std::to_string(vertexCount) + " vertices");
+	}
+	uint64_t indexOffset = 0;
+	if (!_indices.allocate(bytes, width, indexOffset)) {
+		_vertices.release(firstVertex, vertexCount);
+		throw std::runtime_error("GeometryArena: out of index space for " + std::to_string(indexCount) + " indices");
+	}
+
+	_uploader->uploadBuffer(_vertexBuffer, vertices.data(), vertexCount * sizeof(Vertex), firstVertex * sizeof(Vertex));
+	if (indexType == VK_INDEX_TYPE_UINT16) {
+		std::vector<uint16_t> narrow;
+		narrow.reserve(indexCount);
+		for (uint32_t i : indices) narrow.push_back(static_cast<uint16_t>(i));
+		_uploader->uploadBuffer(_indexBuffer, narrow.data(), indexCount * width, indexOffset);
+	}
+	else {
+		_uploader->uploadBuffer(_indexBuffer, indices.data(), indexCount * width, indexOffset);
+	}
+
+	GeometryRange range;
+	range.firstVertex = static_cast<uint32_t>(firstVertex);
+	range.vertexCount = vertexCount;
+	range.firstIndex = static_cast<uint32_t>(indexOffset / width);
+	range.indexCount = indexCount;
+	range.indexType = indexType;
+
+	++_stats.ranges;
+	_stats.vertexBytes += vertexCount * sizeof(Vertex);
+	_stats.indexBytes += bytes;
+	return range;
+}
+
+void GeometryArena::remove(GeometryRange& range)
+{
+	if (!range || !valid()) {
+		range = {};
+		return;
+	}
+	const uint64_t bytes = indexBytes(range.indexCount, range.indexType);
+	_vertices.release(range.firstVertex, range.vertexCount);
+	_indices.release(range.firstIndex * indexSize(range.indexType), bytes);
+
+	--_stats.ranges;
+	_stats.vertexBytes -= range.vertexCount * sizeof(Vertex);
+	_stats.indexBytes -= bytes;
+	range = {};
+}
+
+GeometryArena::Recording::Recording(GeometryArena& arena, VkCommandBuffer cmd, VkIndexType indexType)
+	: _arena(arena), _cmd(cmd), _indexType(indexType), _outer(t_open)
+{
+	_arena.bindBuffers(cmd, indexType);
+	t_open = this;
+}
+
+GeometryArena::Recording::~Recording()
+{
+	t_open = _outer;
+}
+
+GeometryArena::Recording& GeometryArena::recording(VkCommandBuffer cmd) const
+{
+	for (Recording* r = t_open; r != nullptr; r = r->_outer) {
+		if (r->_cmd == cmd && &r->_arena == this) return *r;
+	}
+	throw std::runtime_error("GeometryArena: command buffer has no open Recording on this thread");
+}
+
+void GeometryArena::bindBuffers(VkCommandBuffer cmd, VkIndexType indexType)
+{
+	const VkDeviceSize offset = 0;
+	vkCmdBindVertexBuffers(cmd, 0, 1, &_vertexBuffer, &offset);
+	vkCmdBindIndexBuffer(cmd, _indexBuffer, 0, indexType);
+	_binds.fetch_add(2, std::memory_order_relaxed);
+	CommandStats::add(CommandStats::BufferBind, 2);
+}
+
+void GeometryArena::bind(VkCommandBuffer cmd, VkIndexType indexType)
+{
+	Recording& r = recording(cmd);
+	bindBuffers(cmd, indexType);
+	r._indexType = indexType;
+}
+
+void GeometryArena::draw(VkCommandBuffer cmd, const GeometryRange& range, uint32_t instanceCount)
+{
+	if (!range || !valid()) return;
+	Recording& r = recording(cmd);
+	if (range.indexType != r._indexType) {
+		vkCmdBindIndexBuffer(cmd, _indexBuffer, 0, range.indexType);
+		r._indexType = range.indexType;
+		_binds.fetch_add(1, std::memory_order_relaxed);
+		CommandStats::add(CommandStats::BufferBind);
+	}
+	vkCmdDrawIndexed(cmd, range.indexCount, instanceCount, range.firstIndex, static_cast<int32_t>(range.firstVertex), 0);
+	_draws.fetch_add(1, std::memory_order_relaxed);
+	CommandStats::add(CommandStats::Draw);
+}
+
+GeometryArena::Stats GeometryArena::stats() const
+{
+	Stats s = _stats;
+	s.binds = _binds.load(std::memory_order_relaxed);
+	s.draws = _draws.load(std::memory_order_relaxed);
+	return s;
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "GpuAllocator.h"
+#include "Vertex.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+class UploadBatcher;
+
+// Where a mesh lives inside the arena. Indices are mesh-local; vertexOffset rebases them at draw time,
+// so 16-bit meshes stay 16-bit wherever they land in the shared vertex buffer.
+struct GeometryRange {
+	uint32_t firstVertex = 0;
+	uint32_t vertexCount = 0;
+	uint32_t firstIndex = 0; // in units of indexType
+	uint32_t indexCount = 0;
+	VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+
+	explicit operator bool() const { return indexCount != 0; }
+};
+
+// One device-local vertex buffer and one index buffer shared by every mesh, so a pass binds geometry once
+// and each draw only passes firstIndex/vertexOffset. 16- and 32-bit index ranges share the index buffer;
+// switching width between draws rebinds it at offset 0 with the other type.
+// Draws go through a Recording open on the command buffer, on the thread recording it. Several threads may
+// record at once, each its own command buffer; add() and remove() are for the owning thread only.
+class GeometryArena final
+{
+public:
+	// The arena's bindings in one command buffer for as long as it is being recorded. Open one right after
+	// vkBeginCommandBuffer, on the recording thread, and keep it open until the last draw. Recordings nest, so a
+	// secondary can be recorded in the middle of recording a primary. Nothing carries over between
+	// recordings, so a reset and re-recorded command buffer always binds again.
+	class Recording {
+	public:
+		// Binds the vertex buffer and the index buffer as indexType
+		Recording(GeometryArena& arena, VkCommandBuffer cmd, VkIndexType indexType = VK_INDEX_TYPE_UINT16);
+		~Recording();
+
+		Recording(const Recording&) = delete;
+		Recording& operator=(const Recording&) = delete;
+		Recording(Recording&&) = delete;
+		Recording& operator=(Recording&&) = delete;
+
+	private:
+		friend class GeometryArena;
+		GeometryArena& _arena;
+		VkCommandBuffer _cmd;
+		VkIndexType _indexType;
+		Recording* _outer; // the recording open on this thread before this one
+	};
+
+	static constexpr VkDeviceSize kDefaultVertexBytes = 32ull * 1024 * 1024;
+	static constexpr VkDeviceSize kDefaultIndexBytes = 16ull * 1024 * 1024;
+
+	struct Stats {
+		uint32_t ranges = 0;
+		uint64_t vertexBytes = 0;  // live
+		uint64_t indexBytes = 0;   // live, including alignment padding
+		uint64_t vertexCapacity = 0;
+		uint64_t indexCapacity = 0;
+		uint64_t binds = 0;        // vertex + index buffer binds recorded
+		uint64_t draws = 0;        // indexed draws recorded
+	};
+
+	GeometryArena() = default;
+	~GeometryArena() = default;
+
+	// Owns the shared buffers; release them through destroy()
+	GeometryArena(const GeometryArena&) = delete;
+	GeometryArena& operator=(const GeometryArena&) = delete;
+	GeometryArena(GeometryArena&&) = delete;
+	GeometryArena& operator=(GeometryArena&&) = delete;
+
+	void create(GpuAllocator* allocator, UploadBatcher* uploader,
+		VkDeviceSize vertexBytes = kDefaultVertexBytes, VkDeviceSize indexBytes = kDefaultIndexBytes);
+
+	// Frees both buffers; the GPU must be done with every range
+	void destroy();
+
+	// Copies the mesh into free space through the uploader. indexType UINT16 narrows the indices, which must fit.
+	// Throws when either buffer is out of space.
+	GeometryRange add(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, VkIndexType indexType);
+
+	// Returns the range to the free lists; the GPU must no longer read it. The range is reset.
+	void remove(GeometryRange& range);
+
+	// Binds both buffers again in cmd's open Recording, after recording anything that binds other vertex/index
+	// buffers; bindings survive render pass boundaries. Throws if cmd has no open Recording.
+	void bind(VkCommandBuffer cmd, VkIndexType indexType = VK_INDEX_TYPE_UINT16);
+
+	// Records the indexed draw, rebinding the index buffer only if the range's width differs from the one cmd's
+	// Recording has bound. Throws if cmd has no open Recording.
+	void draw(VkCommandBuffer cmd, const GeometryRange& range, uint32_t instanceCount = 1);
+
+	VkBuffer vertexBuffer() const { return _vertexBuffer; }
+	VkBuffer indexBuffer() const { return _indexBuffer; }
+	bool valid() const { return _vertexBuffer != VK_NULL_HANDLE; }
+	Stats stats() const;
+
+private:
+	// First-fit free list over [0, capacity), coalescing neighbours on release
+	class FreeList {
+	public:
+		void reset(uint64_t capacity);
+		bool allocate(uint64_t size, uint64_t alignment, uint64_t& offset);
+		void release(uint64_t offset, uint64_t size);
+	private:
+		std::map<uint64_t, uint64_t> _free; // offset -> size
+	};
+
+	GpuAllocator* _allocator{ nullptr };
+	UploadBatcher* _uploader{ nullptr };
+
+	VkBuffer _vertexBuffer{ VK_NULL_HANDLE };
+	VkBuffer _indexBuffer{ VK_NULL_HANDLE };
+	GpuAllocation _vertexAllocation{};
+	GpuAllocation _indexAllocation{};
+
+	void bindBuffers(VkCommandBuffer cmd, VkIndexType indexType);
+	Recording& recording(VkCommandBuffer cmd) const;
+
+	FreeList _vertices; // in vertices
+	FreeList _indices;  // in bytes
+
+	Stats _stats; // binds and draws are kept in the counters below
+	std::atomic<uint64_t> _binds{ 0 };
+	std::atomic<uint64_t> _draws{ 0 };
+};
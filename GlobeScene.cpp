@@ -1,18 +1,87 @@
 #include "GlobeScene.h"
+#include "SceneFile.h"
+#include "JobSystem.h"
+#include "CommandStats.h"
+#include "RenderQueue.h"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <new>
 #include <stdexcept>
+#include <thread>
+
+namespace
+{
+    // Placement-constructs one object type from the scene file's type table
+    struct ObjectFactory {
+        const char* name;
+        size_t size;
+        size_t alignment;
+        IWorldObject* (*construct)(void* where, const glm::vec3& position, textureManager* textureMgr, MeshLibrary* meshLibrary);
+    };
+
+    template <typename T>
+    IWorldObject* constructAt(void* where, const glm::vec3& position, textureManager* textureMgr, MeshLibrary* meshLibrary)
+    {
+        return new (where) T(position, textureMgr, meshLibrary);
+    }
+
+    constexpr ObjectFactory kObjectFactories[] = {
+        { "Cactus", sizeof(Cactus), alignof(Cactus), &constructAt<Cactus> },
+        { "Rock", sizeof(Rock), alignof(Rock), &constructAt<Rock> },
+        { "Camel", sizeof(Camel), alignof(Camel), &constructAt<Camel> },
+        { "Candle", sizeof(Candle), alignof(Candle), &constructAt<Candle> },
+    };
+
+    const ObjectFactory* findFactory(std::string_view name)
+    {
+        for (const auto& factory : kObjectFactories)
+        {
+            if (name == factory.name) return &factory;
+        }
+        return nullptr;
+    }
+
+    // Below this many instances per thread the spawn cost outweighs the construction work
+    constexpr size_t kMinInstancesPerThread = 4096;
+
+    // Objects per job when updates and uniform writes fan out over a JobSystem
+    constexpr size_t kObjectsPerJob = 256;
+}
 
 GlobeScene::~GlobeScene()
+{
+    releaseObjects();
+}
+
+void GlobeScene::releaseObjects()
 {
     for (auto obj : _objects)
     {
-        delete obj;
+        const std::byte* address = reinterpret_cast<const std::byte*>(obj);
+        const bool inBlock = std::any_of(_objectBlocks.begin(), _objectBlocks.end(), [address](const ObjectBlock& block) {
+            return address >= block.storage && address < block.storage + block.bytes;
+        });
+        if (inBlock) obj->~IWorldObject();
+        else delete obj;
     }
+    _objects.clear();
+    for (const auto& block : _objectBlocks)
+    {
+        ::operator delete(block.storage, std::align_val_t(block.alignment));
+    }
+    _objectBlocks.clear();
 }
 
 GlobeScene::GlobeScene(GlobeScene&& other) noexcept
     : _objects(std::move(other._objects)),
+    _objectBlocks(std::move(other._objectBlocks)),
     _textureMgr(other._textureMgr),
     _cameraMgr(other._cameraMgr),
+    _meshLibrary(other._meshLibrary),
     _configLoader(std::move(other._configLoader)),
     _isRaining(other._isRaining),
     timeSinceRain(other.timeSinceRain),
@@ -29,6 +98,7 @@ GlobeScene::GlobeScene(GlobeScene&& other) noexcept
 {
     other._textureMgr = nullptr;
     other._cameraMgr = nullptr;
+    other._meshLibrary = nullptr;
     other._rainParticleSystem = nullptr;
 }
 
@@ -36,14 +106,13 @@ GlobeScene& GlobeScene::operator=(GlobeScene&& other) noexcept
 {
     if (this != &other)
     {
-        for (auto obj : _objects)
-        {
-            delete obj;
-        }
+        releaseObjects();
         delete _rainParticleSystem;
         _objects = std::move(other._objects);
+        _objectBlocks = std::move(other._objectBlocks);
         _textureMgr = other._textureMgr;
         _cameraMgr = other._cameraMgr;
+        _meshLibrary = other._meshLibrary;
         _configLoader = std::move(other._configLoader);
         _isRaining = other._isRaining;
         timeSinceRain = other.timeSinceRain;
@@ -60,6 +129,7 @@ GlobeScene& GlobeScene::operator=(GlobeScene&& other) noexcept
 
         other._textureMgr = nullptr;
         other._cameraMgr = nullptr;
+        other._meshLibrary = nullptr;
         other._rainParticleSystem = nullptr;
     }
     return *this;
@@ -95,15 +165,44 @@ void GlobeScene::drawScene(VkCommandBuffer& commandBuffer, VkPipelineLayout pipe
     }
 }
 
-void GlobeScene::updateScene(float deltaTime)
+void GlobeScene::updateScene(float deltaTime, JobSystem* jobs)
 {
     _timeOfDay += deltaTime;
     if (_timeOfDay >= _dayNightCycleDuration) _timeOfDay -= _dayNightCycleDuration;
-    for (auto obj : _objects)
+
+    // Objects only touch their own state in update(), so disjoint ranges may run on different threads
+    auto updateRange = [this, deltaTime](size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            float objectDelta = deltaTime;
+            _objects[i]->update(objectDelta);
+        }
+    };
+    if (jobs != nullptr)
+    {
+        jobs->parallelFor(_objects.size(), kObjectsPerJob, updateRange);
+    }
+    else
+    {
+        updateRange(0, _objects.size());
+    }
+
+    if (_rainParticleSystem)
     {
-        obj->update(deltaTime);
-	}
+        _rainParticleSystem->setEmitter(rainEmitter());
+    }
+}
 
+ParticleEmitter GlobeScene::rainEmitter() const
+{
+    ParticleEmitter emitter;
+    emitter.center = glm::vec3(0.0f, 10.0f, 0.0f);
+    emitter.halfExtentXZ = glm::vec2(_rainAreaSize * 0.5f);
+    emitter.speed = glm::vec2(_rainParticleSpeed * 0.8f, _rainParticleSpeed * 1.2f);
+    emitter.lifetime = glm::vec2(1.5f, 2.5f);
+    emitter.ratePerSecond = _isRaining ? 10000.0f : 0.0f;
+    return emitter;
 }
 
 void GlobeScene::drawPostProcessables(VkCommandBuffer& commandBuffer, VkPipelineLayout pipelineLayout, VkPipeline graphicsPipeline, uint32_t currentFrame)
@@ -114,12 +213,113 @@ void GlobeScene::drawPostProcessables(VkCommandBuffer& commandBuffer, VkPipeline
     }
 }
 
+void GlobeScene::drawSceneBindless(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout)
+{
+    _postProcessObjects.clear();
+    for (auto obj : _objects)
+    {
+        obj->drawBindless(commandBuffer, pipelineLayout);
+    }
+}
+
+void GlobeScene::drawPostProcessablesBindless(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout)
+{
+    for (auto* obj : _postProcessObjects)
+    {
+        obj->drawBindless(commandBuffer, pipelineLayout);
+    }
+}
+
+void GlobeScene::drawObjects(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, VkPipeline graphicsPipeline, uint32_t currentFrame,
+    size_t first, size_t last) const
+{
+    last = std::min(last, _objects.size());
+    for (size_t i = first; i < last; ++i)
+    {
+        _objects[i]->draw(commandBuffer, graphicsPipeline, pipelineLayout, currentFrame);
+    }
+}
+
+void GlobeScene::drawObjectsBindless(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, size_t first, size_t last) const
+{
+    last = std::min(last, _objects.size());
+    for (size_t i = first; i < last; ++i)
+    {
+        _objects[i]->drawBindless(commandBuffer, pipelineLayout);
+    }
+}
+
+void GlobeScene::queueObjects(RenderQueue& queue, uint32_t pass, VkPipeline pipeline, const glm::mat4& view, const glm::mat4& model,
+    const std::vector<glm::mat4>& objectModels, bool opaqueDepth) const
+{
+    const uint32_t pipelineId = queue.pipelineId(pipeline);
+    const bool captured = objectModels.size() == _objects.size();
+    for (size_t i = 0; i < _objects.size(); ++i)
+    {
+        const IWorldObject* obj = _objects[i];
+        const MeshHandle& asset = obj->meshAsset();
+        if (!asset) continue;
+
+        const RenderQueue::Layer layer = obj->material().albedoColour().a < 1.0f ? RenderQueue::Transparent : RenderQueue::Opaque;
+        float depth = 0.0f;
+        if (opaqueDepth || layer == RenderQueue::Transparent)
+        {
+            const glm::vec4 world = captured ? objectModels[i][3] : model * obj->transform()[3];
+            depth = -(view * world).z;
+        }
+        const uint32_t meshId = queue.meshId(asset.get(), asset->mesh.geometryRange().indexType);
+        queue.push(RenderQueue::makeKey(pass, layer, pipelineId, queue.materialId(obj->texture()), meshId, depth),
+            static_cast<uint32_t>(i));
+    }
+}
+
+void GlobeScene::drawQueued(VkCommandBuffer commandBuffer, const RenderQueue& queue, size_t first, size_t last,
+    VkPipelineLayout pipelineLayout, VkPipeline boundPipeline, uint32_t currentFrame) const
+{
+    const std::vector<RenderQueue::Item>& items = queue.items();
+    last = std::min(last, items.size());
+    for (size_t i = first; i < last; ++i)
+    {
+        const VkPipeline pipeline = queue.pipeline(RenderQueue::decode(items[i].key).pipeline);
+        if (pipeline != boundPipeline)
+        {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            CommandStats::add(CommandStats::PipelineBind);
+            boundPipeline = pipeline;
+        }
+        _objects[items[i].index]->drawWithBoundPipeline(commandBuffer, pipelineLayout, currentFrame);
+    }
+}
+
+void GlobeScene::drawQueuedBindless(VkCommandBuffer commandBuffer, const RenderQueue& queue, size_t first, size_t last,
+    VkPipelineLayout pipelineLayout, VkPipeline boundPipeline) const
+{
+    // Every bindless pipeline shares the layout, so the table and frame sets stay bound across a switch
+    const std::vector<RenderQueue::Item>& items = queue.items();
+    last = std::min(last, items.size());
+    for (size_t i = first; i < last; ++i)
+    {
+        const VkPipeline pipeline = queue.pipeline(RenderQueue::decode(items[i].key).pipeline);
+        if (pipeline != boundPipeline)
+        {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            CommandStats::add(CommandStats::PipelineBind);
+            boundPipeline = pipeline;
+        }
+        _objects[items[i].index]->drawBindless(commandBuffer, pipelineLayout);
+    }
+}
+
 void GlobeScene::destroyScene(const RenderContext& ctx)
 {
     for (auto obj : _objects)
     {
         obj->destroy(ctx);
     }
+    if (_meshLibrary)
+    {
+        _meshLibrary->destroy(ctx);
+    }
     if (_rainParticleSystem)
     {
         _rainParticleSystem->destroy(ctx);
@@ -131,6 +331,10 @@ void GlobeScene::uploadScene(const RenderContext& ctx, uint32_t framesInFlight,
     VkImageView textureImageView, VkSampler textureSampler,
     const std::vector<VkDescriptorBufferInfo>& lightingBufferInfos)
 {
+    if (_meshLibrary)
+    {
+        _meshLibrary->upload(ctx);
+    }
     for (auto obj : _objects)
     {
         obj->upload(ctx, framesInFlight, textureImageView, textureSampler, lightingBufferInfos);
@@ -141,12 +345,74 @@ void GlobeScene::uploadScene(const RenderContext& ctx, uint32_t framesInFlight,
     }
 }
 
-void GlobeScene::updateSceneUniformBuffers(uint32_t frameIndex,
-    const glm::mat4& model, const glm::mat4& view, const glm::mat4& proj)
+void GlobeScene::updateSceneUniformBuffers(uint32_t frameIndex, const glm::mat4& model, JobSystem* jobs)
 {
-    for (auto obj : _objects)
+    // Each object writes only its own FrameUniforms slot
+    auto writeRange = [this, frameIndex, &model](size_t first, size_t last)
     {
-        obj->updateUniformBuffer(frameIndex, model, view, proj);
+        for (size_t i = first; i < last; ++i)
+        {
+            _objects[i]->updateUniformBuffer(frameIndex, model);
+        }
+    };
+    if (jobs != nullptr)
+    {
+        jobs->parallelFor(_objects.size(), kObjectsPerJob, writeRange);
+    }
+    else
+    {
+        writeRange(0, _objects.size());
+    }
+}
+
+void GlobeScene::captureModelMatrices(const glm::mat4& model, std::vector<glm::mat4>& out, JobSystem* jobs) const
+{
+    out.resize(_objects.size());
+    auto captureRange = [this, &model, &out](size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            out[i] = model * _objects[i]->transform();
+        }
+    };
+    if (jobs != nullptr)
+    {
+        jobs->parallelFor(_objects.size(), kObjectsPerJob, captureRange);
+    }
+    else
+    {
+        captureRange(0, _objects.size());
+    }
+}
+
+void GlobeScene::writeModelMatrices(uint32_t frameIndex, const std::vector<glm::mat4>& matrices, JobSystem* jobs) const
+{
+    const size_t count = std::min(matrices.size(), _objects.size());
+    auto writeRange = [this, frameIndex, &matrices](size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            _objects[i]->writeModelMatrix(frameIndex, matrices[i]);
+        }
+    };
+    if (jobs != nullptr)
+    {
+        jobs->parallelFor(count, kObjectsPerJob, writeRange);
+    }
+    else
+    {
+        writeRange(0, count);
+    }
+}
+
+void GlobeScene::collectParticleSystems(std::vector<particleSystem*>& out) const
+{
+    for (IWorldObject* obj : _objects)
+    {
+        if (particleSystem* particles = obj->particles())
+        {
+            out.push_back(particles);
+        }
     }
 }
 
@@ -183,58 +449,178 @@ std::vector<Light> GlobeScene::getCandleLights() const
     return candleLights;
 }
 
+void GlobeScene::collectCpuMemory(std::vector<CpuMemoryEntry>& out) const
+{
+    uint64_t geometry = 0;
+    for (const IWorldObject* obj : _objects)
+    {
+        geometry += obj->cpuGeometryBytes();
+    }
+    out.push_back({ "shape vertices", "scene objects", geometry });
+
+    uint64_t blocks = 0;
+    for (const auto& block : _objectBlocks)
+    {
+        blocks += block.bytes;
+    }
+    out.push_back({ "scene objects", "object blocks", blocks });
+}
+
 void GlobeScene::loadSceneFromFile(const std::string& filename)
 {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Could not open scene file: " << filename << std::endl;
+    try
+    {
+        const bool isBinary = std::filesystem::path(filename).extension() == ".scenebin";
+        loadSceneBinary(isBinary ? filename : SceneFile::convertIfStale(filename));
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Could not load scene file: " << filename << ": " << e.what() << std::endl;
         return;
     }
+    std::cout << "Loaded " << _objects.size() << " objects from file";
+    if (_meshLibrary) std::cout << " sharing " << _meshLibrary->assetCount() << " meshes";
+    std::cout << "." << std::endl;
+}
 
-    std::string line;
-    bool isFirstLine = true;
-    while (std::getline(file, line))
+void GlobeScene::loadSceneBinary(const std::string& filename)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    SceneFile scene;
+    scene.open(filename);
+    const size_t count = scene.instanceCount();
+    const size_t typeCount = scene.typeCount();
+    if (count > UINT32_MAX)
     {
-        // Skip header
-        if (isFirstLine) {
-            isFirstLine = false;
-            continue;
-        }
+        throw std::runtime_error("GlobeScene: too many instances in " + filename);
+    }
+    if (_meshLibrary == nullptr)
+    {
+        throw std::runtime_error("GlobeScene: a MeshLibrary is required to load " + filename);
+    }
 
-        std::istringstream iss(line);
-        std::string type, sx, sy, sz;
+    // Counting pass: each instance's slot inside its type's block
+    std::vector<const ObjectFactory*> factories(typeCount);
+    std::vector<size_t> typeCounts(typeCount, 0);
+    std::vector<uint32_t> slots(count);
+    for (size_t t = 0; t < typeCount; ++t)
+    {
+        factories[t] = findFactory(scene.typeName(t));
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        slots[i] = static_cast<uint32_t>(typeCounts[scene.type(i)]++);
+    }
 
-        if (!std::getline(iss, type, ',')) {
-            std::cerr << "Failed to parse type in line: " << line << std::endl;
+    // _objects gains one run per type, in type-table order, so instances sharing a mesh draw back to back
+    const size_t base = _objects.size();
+    std::vector<size_t> firstObject(typeCount, 0);
+    std::vector<ObjectBlock> blocks(typeCount);
+    size_t total = 0;
+    for (size_t t = 0; t < typeCount; ++t)
+    {
+        if (typeCounts[t] == 0) continue;
+        if (!factories[t])
+        {
+            std::cerr << "Unknown object type: " << scene.typeName(t) << " (" << typeCounts[t] << " instances skipped)" << std::endl;
             continue;
         }
-        if (!std::getline(iss, sx, ',')) {
-            std::cerr << "Failed to parse x in line: " << line << std::endl;
-            continue;
+        firstObject[t] = base + total;
+        total += typeCounts[t];
+    }
+
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto fill = [&](size_t begin, size_t end) {
+        try
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const uint16_t t = scene.type(i);
+                IWorldObject*& slot = _objects[firstObject[t] + slots[i]];
+                if (!factories[t] || slot) continue;
+
+                void* where = blocks[t].storage + size_t(slots[i]) * factories[t]->size;
+                IWorldObject* obj = factories[t]->construct(where, scene.position(i), _textureMgr, _meshLibrary);
+                slot = obj;
+                obj->setPlacement(scene.position(i), scene.rotation(i), scene.scale(i));
+            }
         }
-        if (!std::getline(iss, sy, ',')) {
-            std::cerr << "Failed to parse y in line: " << line << std::endl;
-            continue;
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
         }
-        if (!std::getline(iss, sz, ',')) {
-            std::cerr << "Failed to parse z in line: " << line << std::endl;
-            continue;
+    };
+
+    unsigned threadCount = 1;
+    _objects.resize(base + total, nullptr);
+    try
+    {
+        for (size_t t = 0; t < typeCount; ++t)
+        {
+            if (!factories[t] || typeCounts[t] == 0) continue;
+            blocks[t].alignment = factories[t]->alignment;
+            blocks[t].bytes = factories[t]->size * typeCounts[t];
+            blocks[t].storage = static_cast<std::byte*>(::operator new(blocks[t].bytes, std::align_val_t(blocks[t].alignment)));
         }
 
-        float x = std::stof(sx);
-        float y = std::stof(sy);
-        float z = std::stof(sz);
+        // The first instance of each type loads its mesh on this thread; after that every constructor
+        // only reads the MeshLibrary and textureManager, so the rest can be built concurrently
+        std::vector<bool> warmed(typeCount, false);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint16_t t = scene.type(i);
+            if (factories[t] && !warmed[t])
+            {
+                warmed[t] = true;
+                fill(i, i + 1);
+            }
+        }
 
-        std::cout << "Parsed: " << type << " at (" << x << "," << y << "," << z << ")" << std::endl;
+        if (!error)
+        {
+            const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+            threadCount = static_cast<unsigned>(std::clamp<size_t>(count / kMinInstancesPerThread, 1, hardware));
+            const size_t chunk = (count + threadCount - 1) / threadCount;
+            std::vector<std::thread> workers;
+            for (unsigned w = 1; w < threadCount; ++w)
+            {
+                workers.emplace_back(fill, std::min(count, w * chunk), std::min(count, (w + 1) * chunk));
+            }
+            fill(0, std::min(count, chunk));
+            for (auto& worker : workers) worker.join();
+        }
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) error = std::current_exception();
+    }
 
-        IWorldObject* obj = nullptr;
-        if (type == "Cactus") obj = new Cactus(glm::vec3(x, y, z), _textureMgr);
-        else if (type == "Rock") obj = new Rock(glm::vec3(x, y, z), _textureMgr);
-        else if (type == "Camel") obj = new Camel(glm::vec3(x, y, z), _textureMgr);
-        else if (type == "Candle") obj = new Candle(glm::vec3(x, y, z), _textureMgr);
+    if (error)
+    {
+        // Undo this load only; objects from earlier loads are untouched
+        for (size_t i = base; i < _objects.size(); ++i)
+        {
+            if (_objects[i]) _objects[i]->~IWorldObject();
+        }
+        _objects.resize(base);
+        for (const auto& block : blocks)
+        {
+            if (block.storage) ::operator delete(block.storage, std::align_val_t(block.alignment));
+        }
+        std::rethrow_exception(error);
+    }
 
-        if (obj) addObject(obj);
-        else std::cerr << "Unknown object type: " << type << std::endl;
+    for (const auto& block : blocks)
+    {
+        if (block.storage) _objectBlocks.push_back(block);
     }
-    std::cout << "Loaded " << _objects.size() << " objects from file." << std::endl;
-}
\ No newline at end of file
+
+    const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "Scene: " << total << " instances of " << typeCount << " types from " << filename
+        << " in " << seconds * 1000.0 << " ms on " << threadCount << " threads ("
+        << (seconds > 0.0 ? static_cast<double>(total) / seconds : 0.0) << " instances/s)" << std::endl;
+}
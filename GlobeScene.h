@@ -1,6 +1,7 @@
 #pragma once
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
+#include <cstddef>
 #include <unordered_set>
 #include "IWorldObject.h"
 #include "CameraManager.h"
@@ -13,12 +14,24 @@
 #include "Candle.h"
 #include "Camel.h"
 
+class JobSystem;
+class RenderQueue;
 
 class GlobeScene final
 {
+    // Contiguous storage for the instances of one object type loaded from a .scenebin
+    struct ObjectBlock {
+        std::byte* storage{ nullptr };
+        size_t bytes{ 0 };
+        size_t alignment{ 0 };
+    };
+
     std::vector<IWorldObject*> _objects;
+    // Objects inside these blocks are destroyed in place; everything else in _objects was added with new
+    std::vector<ObjectBlock> _objectBlocks;
     textureManager* _textureMgr{ nullptr };
     CameraManager* _cameraMgr{ nullptr };
+    MeshLibrary* _meshLibrary{ nullptr };
 
     const std::string _sceneConfigPath{ "configs/sceneConfig.json" };
     configLoader _configLoader{};
@@ -46,7 +59,7 @@ class GlobeScene final
 public:
     GlobeScene() = default;
     ~GlobeScene();
-    GlobeScene(textureManager& textureMgr, CameraManager& cameraMgr) : _textureMgr(&textureMgr), _cameraMgr(&cameraMgr), _configLoader(configLoader{}) {}
+    GlobeScene(textureManager& textureMgr, CameraManager& cameraMgr, MeshLibrary& meshLibrary) : _textureMgr(&textureMgr), _cameraMgr(&cameraMgr), _meshLibrary(&meshLibrary), _configLoader(configLoader{}) {}
     // Non-copyable: owning raw pointers and GPU resources cannot be copied safely
     GlobeScene(const GlobeScene&) = delete;
     GlobeScene& operator=(const GlobeScene&) = delete;
@@ -59,23 +72,58 @@ public:
     void uploadScene(const RenderContext& ctx, uint32_t framesInFlight,
         VkImageView textureImageView, VkSampler textureSampler,
         const std::vector<VkDescriptorBufferInfo>& lightingBufferInfos);
-    void updateSceneUniformBuffers(uint32_t frameIndex,
-        const glm::mat4& model, const glm::mat4& view, const glm::mat4& proj);
+    // Writes each object's model matrix (model * object transform); view/proj live in the frame's camera block.
+    // With jobs, ranges of objects are written in parallel.
+    void updateSceneUniformBuffers(uint32_t frameIndex, const glm::mat4& model, JobSystem* jobs = nullptr);
+    // The same split across threads: the simulation captures each object's model matrix, in getObjects()
+    // order, and the renderer later writes the captured matrices to the objects' slots
+    void captureModelMatrices(const glm::mat4& model, std::vector<glm::mat4>& out, JobSystem* jobs = nullptr) const;
+    void writeModelMatrices(uint32_t frameIndex, const std::vector<glm::mat4>& matrices, JobSystem* jobs = nullptr) const;
+    // Appends the particle systems objects step in their update()
+    void collectParticleSystems(std::vector<particleSystem*>& out) const;
 
     // This will be used in a mask render pass: only draw post-process targets
     void drawPostProcessables(VkCommandBuffer& commandBuffer, VkPipelineLayout pipelineLayout, VkPipeline graphicsPipeline, uint32_t currentFrame);
+    // Bindless variants: the caller binds the pipeline and descriptor sets once for the whole pass
+    void drawSceneBindless(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout);
+    void drawPostProcessablesBindless(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout);
+    // Objects [first, last) of getObjects(), for recording the scene in ranges. Disjoint ranges may be
+    // recorded from different threads; the caller binds the pass state in each command buffer first.
+    void drawObjects(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, VkPipeline graphicsPipeline, uint32_t currentFrame,
+        size_t first, size_t last) const;
+    void drawObjectsBindless(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, size_t first, size_t last) const;
+    // Pushes one item per drawable object for pass, keyed by pipeline, texture, mesh and view-space depth under
+    // view. World matrices come from objectModels when it has one per object, else model * transform().
+    // Without opaqueDepth, opaque objects are ordered by state alone, so the order holds while the camera moves.
+    void queueObjects(RenderQueue& queue, uint32_t pass, VkPipeline pipeline, const glm::mat4& view, const glm::mat4& model,
+        const std::vector<glm::mat4>& objectModels, bool opaqueDepth) const;
+    // Items [first, last) of the sorted queue. The pass has bound boundPipeline; a pipeline is only bound where
+    // the items' pipeline changes, so objects sharing one no longer bind it each.
+    void drawQueued(VkCommandBuffer commandBuffer, const RenderQueue& queue, size_t first, size_t last,
+        VkPipelineLayout pipelineLayout, VkPipeline boundPipeline, uint32_t currentFrame) const;
+    void drawQueuedBindless(VkCommandBuffer commandBuffer, const RenderQueue& queue, size_t first, size_t last,
+        VkPipelineLayout pipelineLayout, VkPipeline boundPipeline) const;
+    // drawScene empties the post-process set before drawing; ranged recording calls this once per frame instead
+    void clearPostProcessables() { _postProcessObjects.clear(); }
     void destroyScene(const RenderContext& ctx);
     const std::vector<IWorldObject*>& getObjects() const { return _objects; }
     CameraManager* getCameraManager() const { return _cameraMgr; }
-    void updateScene(float deltaTime);
+    MeshLibrary* getMeshLibrary() const { return _meshLibrary; }
+    // Advances the day-night cycle and every object; with jobs, object updates run in parallel ranges
+    void updateScene(float deltaTime, JobSystem* jobs = nullptr);
     void initializeScene();
     void loadScene();
     float getTimeOfDay() const { return _timeOfDay; }
     float getDayNightCycleDuration() const { return _dayNightCycleDuration; }
     void setRainParticleSystem(particleSystem* rainParticleSystem) { _rainParticleSystem = rainParticleSystem; }
     bool isRaining() const { return _isRaining; }
+    // Emitter for the rain particle system, built from the rain settings; emits only while it is raining
+    ParticleEmitter rainEmitter() const;
     std::vector<Light> getCandleLights() const;
+	// Accepts the CSV (converted to a .scenebin next to it when stale) or a .scenebin directly
 	void loadSceneFromFile(const std::string& filename);
+    // Maps a .scenebin and constructs its instances in parallel, one block per object type
+    void loadSceneBinary(const std::string& filename);
 
     // NEW: expose current set for debugging if needed
     const std::unordered_set<IWorldObject*>& getPostProcessObjects() const { return _postProcessObjects; }
@@ -84,4 +132,11 @@ public:
     void setObjectPostProcess(IWorldObject* obj, bool enable);
 
     void reset();
+
+    // Geometry held by the objects' own meshes plus the .scenebin object blocks; shared assets are
+    // reported by the MeshLibrary
+    void collectCpuMemory(std::vector<CpuMemoryEntry>& out) const;
+
+private:
+    void releaseObjects();
 };
\ No newline at end of file
@@ -0,0 +1,477 @@
+#include "GpuAllocator.h"
+#include <algorithm>
+#include <bit>
+#include <iomanip>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+struct GpuMemoryBlock {
+	VkDeviceMemory memory{ VK_NULL_HANDLE };
+	VkDeviceSize size{ 0 };
+	uint8_t* mapped{ nullptr };
+	size_t pool{ 0 };
+	bool linear{ false };
+	uint32_t live{ 0 };
+
+	// Linear: bump pointer, rewound when the last live range is freed
+	VkDeviceSize head{ 0 };
+
+	// Buddy: free node offsets per order, node size kMinBuddyNode << order
+	std::vector<std::set<VkDeviceSize>> freeLists;
+};
+
+namespace
+{
+	constexpr VkDeviceSize alignUp(VkDeviceSize v, VkDeviceSize a) {
+		return (v + a - 1) / a * a;
+	}
+
+	uint32_t orderFor(VkDeviceSize nodeSize) {
+		return static_cast<uint32_t>(std::countr_zero(nodeSize / GpuAllocator::kMinBuddyNode));
+	}
+
+	bool buddyAllocate(GpuMemoryBlock& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset, VkDeviceSize& reserved) {
+		// Nodes are aligned to their own size, so rounding up to the alignment is enough
+		const VkDeviceSize need = std::bit_ceil(std::max({ size, alignment, GpuAllocator::kMinBuddyNode }));
+		if (need > block.size) return false;
+		const uint32_t order = orderFor(need);
+
+		uint32_t found = order;
+		while (found < block.freeLists.size() && block.freeLists[found].empty()) ++found;
+		if (found == block.freeLists.size()) return false;
+
+		offset = *block.freeLists[found].begin();
+		block.freeLists[found].erase(block.freeLists[found].begin());
+		while (found > order) {
+			--found;
+			block.freeLists[found].insert(offset + (GpuAllocator::kMinBuddyNode << found));
+		}
+		reserved = need;
+		return true;
+	}
+
+	void buddyFree(GpuMemoryBlock& block, VkDeviceSize offset, VkDeviceSize reserved) {
+		uint32_t order = orderFor(reserved);
+		while (order + 1 < block.freeLists.size()) {
+			const VkDeviceSize buddy = offset ^ (GpuAllocator::kMinBuddyNode << order);
+			if (block.freeLists[order].erase(buddy) == 0) break;
+			offset = std::min(offset, buddy);
+			++order;
+		}
+		block.freeLists[order].insert(offset);
+	}
+
+	bool linearAllocate(GpuMemoryBlock& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset, VkDeviceSize& reserved) {
+		const VkDeviceSize start = alignUp(block.head, alignment);
+		if (start + size > block.size) return false;
+		offset = start;
+		reserved = start + size - block.head;
+		block.head = start + size;
+		return true;
+	}
+}
+
+const char* gpuMemoryCategoryName(GpuMemoryCategory category)
+{
+	switch (category) {
+	case GpuMemoryCategory::Geometry: return "geometry";
+	case GpuMemoryCategory::Uniform: return "uniform";
+	case GpuMemoryCategory::Texture: return "texture";
+	case GpuMemoryCategory::RenderTarget: return "render target";
+	case GpuMemoryCategory::Staging: return "staging";
+	case GpuMemoryCategory::Particles: return "particles";
+	default: return "unknown";
+	}
+}
+
+GpuAllocator::GpuAllocator() = default;
+GpuAllocator::~GpuAllocator() = default;
+
+void GpuAllocator::create(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize, bool memoryBudget)
+{
+	_device = device;
+	_physicalDevice = physicalDevice;
+	_memoryBudget = memoryBudget;
+	_blockSize = std::bit_floor(std::max(blockSize, kMinBuddyNode));
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &_memoryProperties);
+
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	_bufferImageGranularity = std::max<VkDeviceSize>(properties.limits.bufferImageGranularity, 1);
+	_stats = {};
+	_stats.maxDeviceAllocations = properties.limits.maxMemoryAllocationCount;
+	_stats.memoryBudget = memoryBudget;
+	_stats.heaps.resize(_memoryProperties.memoryHeapCount);
+	for (uint32_t i = 0; i < _memoryProperties.memoryHeapCount; ++i) {
+		_stats.heaps[i].size = _memoryProperties.memoryHeaps[i].size;
+		_stats.heaps[i].flags = _memoryProperties.memoryHeaps[i].flags;
+	}
+}
+
+void GpuAllocator::destroy()
+{
+	std::lock_guard lock(_mutex);
+	for (Pool& pool : _pools) {
+		for (auto& block : pool.blocks) {
+			vkFreeMemory(_device, block->memory, nullptr);
+		}
+	}
+	_pools.clear();
+	// Keep the high-water marks so a report written after shutdown still shows them
+	_stats.deviceAllocations = 0;
+	_stats.dedicatedAllocations = 0;
+	_stats.blockBytes = 0;
+	_stats.dedicatedBytes = 0;
+	for (CategoryStats& c : _stats.categories) {
+		c.allocations = c.bytes = c.reserved = 0;
+	}
+	for (OwnerStats& o : _stats.owners) {
+		o.allocations = o.bytes = 0;
+	}
+	for (HeapStats& h : _stats.heaps) {
+		h.allocated = 0;
+	}
+}
+
+uint32_t GpuAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+	for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++) {
+		if ((typeFilter & (1u << i)) && (_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+			return i;
+		}
+	}
+	throw std::runtime_error("GpuAllocator: failed to find suitable memory type!");
+}
+
+void GpuAllocator::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, GpuMemoryCategory category,
+	std::string_view owner, VkBuffer& buffer, GpuAllocation& allocation)
+{
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = usage;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (vkCreateBuffer(_device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+		throw std::runtime_error("GpuAllocator: failed to create buffer!");
+	}
+
+	VkMemoryDedicatedRequirements dedicatedReq{};
+	dedicatedReq.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+	VkMemoryRequirements2 req{};
+	req.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+	req.pNext = &dedicatedReq;
+	VkBufferMemoryRequirementsInfo2 reqInfo{};
+	reqInfo.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+	reqInfo.buffer = buffer;
+	vkGetBufferMemoryRequirements2(_device, &reqInfo, &req);
+
+	try {
+		const bool dedicated = dedicatedReq.prefersDedicatedAllocation || dedicatedReq.requiresDedicatedAllocation;
+		allocation = allocate(req.memoryRequirements, properties, category, owner, false, dedicated, DedicatedTarget{ VK_NULL_HANDLE, buffer });
+	}
+	catch (...) {
+		vkDestroyBuffer(_device, buffer, nullptr);
+		buffer = VK_NULL_HANDLE;
+		throw;
+	}
+	vkBindBufferMemory(_device, buffer, allocation.memory, allocation.offset);
+}
+
+void GpuAllocator::createImage(const VkImageCreateInfo& info, VkMemoryPropertyFlags properties, GpuMemoryCategory category,
+	std::string_view owner, VkImage& image, GpuAllocation& allocation, bool dedicated)
+{
+	if (vkCreateImage(_device, &info, nullptr, &image) != VK_SUCCESS) {
+		throw std::runtime_error("GpuAllocator: failed to create image!");
+	}
+
+	VkMemoryDedicatedRequirements dedicatedReq{};
+	dedicatedReq.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+	VkMemoryRequirements2 req{};
+	req.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+	req.pNext = &dedicatedReq;
+	VkImageMemoryRequirementsInfo2 reqInfo{};
+	reqInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+	reqInfo.image = image;
+	vkGetImageMemoryRequirements2(_device, &reqInfo, &req);
+
+	try {
+		dedicated = dedicated || dedicatedReq.prefersDedicatedAllocation || dedicatedReq.requiresDedicatedAllocation;
+		allocation = allocate(req.memoryRequirements, properties, category, owner, info.tiling == VK_IMAGE_TILING_OPTIMAL, dedicated,
+			DedicatedTarget{ image, VK_NULL_HANDLE });
+	}
+	catch (...) {
+		vkDestroyImage(_device, image, nullptr);
+		image = VK_NULL_HANDLE;
+		throw;
+	}
+	vkBindImageMemory(_device, image, allocation.memory, allocation.offset);
+}
+
+void GpuAllocator::destroyBuffer(VkBuffer& buffer, GpuAllocation& allocation)
+{
+	if (buffer != VK_NULL_HANDLE) vkDestroyBuffer(_device, buffer, nullptr);
+	buffer = VK_NULL_HANDLE;
+	free(allocation);
+}
+
+void GpuAllocator::destroyImage(VkImage& image, GpuAllocation& allocation)
+{
+	if (image != VK_NULL_HANDLE) vkDestroyImage(_device, image, nullptr);
+	image = VK_NULL_HANDLE;
+	free(allocation);
+}
+
+VkDeviceMemory GpuAllocator::allocateMemory(VkDeviceSize size, uint32_t memoryType, void** mapped, const void* pNext)
+{
+	VkMemoryAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.pNext = pNext;
+	allocInfo.allocationSize = size;
+	allocInfo.memoryTypeIndex = memoryType;
+
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	if (vkAllocateMemory(_device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+		throw std::runtime_error("GpuAllocator: vkAllocateMemory failed for " + std::to_string(size) + " bytes");
+	}
+
+	*mapped = nullptr;
+	if (_memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		if (vkMapMemory(_device, memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS || *mapped == nullptr) {
+			vkFreeMemory(_device, memory, nullptr);
+			throw std::runtime_error("GpuAllocator: vkMapMemory failed");
+		}
+	}
+	++_stats.deviceAllocations;
+	HeapStats& heap = _stats.heaps[_memoryProperties.memoryTypes[memoryType].heapIndex];
+	heap.allocated += size;
+	heap.peakAllocated = std::max(heap.peakAllocated, heap.allocated);
+	return memory;
+}
+
+void GpuAllocator::freeMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType)
+{
+	vkFreeMemory(_device, memory, nullptr);
+	--_stats.deviceAllocations;
+	_stats.heaps[_memoryProperties.memoryTypes[memoryType].heapIndex].allocated -= size;
+}
+
+uint32_t GpuAllocator::ownerFor(std::string_view owner, GpuMemoryCategory category)
+{
+	// A few dozen owners at most, and they are looked up once per resource, not per frame
+	for (size_t i = 0; i < _stats.owners.size(); ++i) {
+		if (_stats.owners[i].category == category && _stats.owners[i].name == owner) return static_cast<uint32_t>(i);
+	}
+	OwnerStats& added = _stats.owners.emplace_back();
+	added.name = owner.empty() ? std::string("unnamed") : std::string(owner);
+	added.category = category;
+	return static_cast<uint32_t>(_stats.owners.size() - 1);
+}
+
+GpuAllocator::Pool& GpuAllocator::poolFor(uint32_t memoryType, bool optimalImage, Strategy strategy)
+{
+	// With a granularity of 1 buffers and images can share blocks safely
+	const bool optimalImages = optimalImage && _bufferImageGranularity > 1;
+	for (Pool& pool : _pools) {
+		if (pool.memoryType == memoryType && pool.optimalImages == optimalImages && pool.strategy == strategy) return pool;
+	}
+	Pool& pool = _pools.emplace_back();
+	pool.memoryType = memoryType;
+	pool.optimalImages = optimalImages;
+	pool.strategy = strategy;
+	return pool;
+}
+
+GpuAllocation GpuAllocator::allocateDedicated(VkDeviceSize size, uint32_t memoryType, GpuMemoryCategory category, uint32_t owner,
+	DedicatedTarget target)
+{
+	VkMemoryDedicatedAllocateInfo dedicatedInfo{};
+	dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+	dedicatedInfo.image = target.image;
+	dedicatedInfo.buffer = target.buffer;
+
+	GpuAllocation allocation;
+	allocation.memory = allocateMemory(size, memoryType, &allocation.mapped,
+		(target.image != VK_NULL_HANDLE || target.buffer != VK_NULL_HANDLE) ? &dedicatedInfo : nullptr);
+	allocation.size = size;
+	allocation.reserved = size;
+	allocation.category = category;
+	allocation.owner = owner;
+	allocation.memoryType = memoryType;
+	++_stats.dedicatedAllocations;
+	_stats.dedicatedBytes += size;
+	account(allocation, true);
+	return allocation;
+}
+
+GpuAllocation GpuAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, GpuMemoryCategory category,
+	std::string_view owner, bool optimalImage, bool dedicated, DedicatedTarget target)
+{
+	const uint32_t memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+
+	std::lock_guard lock(_mutex);
+	const uint32_t ownerIndex = ownerFor(owner, category);
+
+	// Keep blocks at most an eighth of their heap so small heaps are not exhausted by one block
+	const VkDeviceSize heapSize = _memoryProperties.memoryHeaps[_memoryProperties.memoryTypes[memoryType].heapIndex].size;
+	const VkDeviceSize blockSize = std::max(kMinBuddyNode, std::min(_blockSize, heapSize ? std::bit_floor(heapSize / 8) : _blockSize));
+
+	if (dedicated || requirements.size >= blockSize / 2) {
+		return allocateDedicated(requirements.size, memoryType, category, ownerIndex, target);
+	}
+
+	const Strategy strategy = category == GpuMemoryCategory::Uniform ? Strategy::Linear : Strategy::Buddy;
+	Pool& pool = poolFor(memoryType, optimalImage, strategy);
+	const VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+
+	GpuAllocation allocation;
+	allocation.size = requirements.size;
+	allocation.category = category;
+	allocation.owner = ownerIndex;
+	allocation.memoryType = memoryType;
+
+	auto tryBlock = [&](GpuMemoryBlock& block) {
+		return block.linear ? linearAllocate(block, requirements.size, alignment, allocation.offset, allocation.reserved)
+			: buddyAllocate(block, requirements.size, alignment, allocation.offset, allocation.reserved);
+	};
+
+	GpuMemoryBlock* chosen = nullptr;
+	for (auto& block : pool.blocks) {
+		if (tryBlock(*block)) { chosen = block.get(); break; }
+	}
+
+	if (chosen == nullptr) {
+		auto block = std::make_unique<GpuMemoryBlock>();
+		void* mapped = nullptr;
+		block->memory = allocateMemory(blockSize, memoryType, &mapped, nullptr);
+		block->mapped = static_cast<uint8_t*>(mapped);
+		block->size = blockSize;
+		block->pool = static_cast<size_t>(&pool - _pools.data());
+		block->linear = strategy == Strategy::Linear;
+		if (!block->linear) {
+			block->freeLists.resize(orderFor(blockSize) + 1);
+			block->freeLists.back().insert(0);
+		}
+		_stats.blockBytes += blockSize;
+
+		chosen = block.get();
+		pool.blocks.push_back(std::move(block));
+		if (!tryBlock(*chosen)) {
+			throw std::runtime_error("GpuAllocator: allocation does not fit in a new block");
+		}
+	}
+
+	++chosen->live;
+	allocation.block = chosen;
+	allocation.memory = chosen->memory;
+	allocation.mapped = chosen->mapped ? chosen->mapped + allocation.offset : nullptr;
+	account(allocation, true);
+	return allocation;
+}
+
+void GpuAllocator::free(GpuAllocation& allocation)
+{
+	if (allocation.memory == VK_NULL_HANDLE) return;
+
+	std::lock_guard lock(_mutex);
+	account(allocation, false);
+
+	GpuMemoryBlock* block = allocation.block;
+	if (block == nullptr) {
+		freeMemory(allocation.memory, allocation.reserved, allocation.memoryType);
+		--_stats.dedicatedAllocations;
+		_stats.dedicatedBytes -= allocation.reserved;
+		allocation = {};
+		return;
+	}
+
+	if (block->linear) {
+		if (block->live == 1) block->head = 0;
+	}
+	else {
+		buddyFree(*block, allocation.offset, allocation.reserved);
+	}
+	--block->live;
+
+	// Keep one empty block per pool around so alloc/free churn does not hit vkAllocateMemory
+	Pool& pool = _pools[block->pool];
+	if (block->live == 0) {
+		const auto empty = std::count_if(pool.blocks.begin(), pool.blocks.end(), [](const auto& b) { return b->live == 0; });
+		if (empty > 1) {
+			const auto it = std::find_if(pool.blocks.begin(), pool.blocks.end(), [block](const auto& b) { return b.get() == block; });
+			freeMemory(block->memory, block->size, pool.memoryType);
+			_stats.blockBytes -= block->size;
+			pool.blocks.erase(it);
+		}
+	}
+	allocation = {};
+}
+
+void GpuAllocator::account(GpuAllocation& allocation, bool add)
+{
+	CategoryStats& s = _stats.categories[static_cast<size_t>(allocation.category)];
+	if (add) {
+		++s.allocations;
+		s.bytes += allocation.size;
+		s.reserved += allocation.reserved;
+		s.peakBytes = std::max(s.peakBytes, s.bytes);
+	}
+	else {
+		--s.allocations;
+		s.bytes -= allocation.size;
+		s.reserved -= allocation.reserved;
+	}
+
+	OwnerStats& o = _stats.owners[allocation.owner];
+	if (add) {
+		++o.allocations;
+		o.bytes += allocation.size;
+		o.peakBytes = std::max(o.peakBytes, o.bytes);
+	}
+	else {
+		--o.allocations;
+		o.bytes -= allocation.size;
+	}
+}
+
+GpuAllocator::Stats GpuAllocator::stats() const
+{
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+	budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+	VkPhysicalDeviceMemoryProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+	properties.pNext = &budget;
+	if (_memoryBudget) {
+		vkGetPhysicalDeviceMemoryProperties2(_physicalDevice, &properties);
+	}
+
+	std::lock_guard lock(_mutex);
+	for (size_t i = 0; i < _stats.heaps.size(); ++i) {
+		HeapStats& heap = _stats.heaps[i];
+		heap.budget = _memoryBudget ? budget.heapBudget[i] : heap.size;
+		heap.usage = _memoryBudget ? budget.heapUsage[i] : heap.allocated;
+		heap.peakUsage = std::max(heap.peakUsage, heap.usage);
+	}
+	return _stats;
+}
+
+void GpuAllocator::printStats(std::ostream& out) const
+{
+	const Stats s = stats();
+	constexpr double kMiB = 1.0 / (1024.0 * 1024.0);
+	out << std::fixed << std::setprecision(2)
+		<< "GpuAllocator: " << s.deviceAllocations << " device allocations (limit " << s.maxDeviceAllocations << "), "
+		<< s.blockBytes * kMiB << " MiB in blocks, " << s.dedicatedAllocations << " dedicated (" << s.dedicatedBytes * kMiB << " MiB)\n";
+	for (size_t i = 0; i < s.categories.size(); ++i) {
+		const CategoryStats& c = s.categories[i];
+		out << "  " << std::left << std::setw(14) << gpuMemoryCategoryName(static_cast<GpuMemoryCategory>(i)) << std::right
+			<< c.allocations << " ranges, " << c.bytes * kMiB << " MiB used, " << c.reserved * kMiB << " MiB reserved, peak "
+			<< c.peakBytes * kMiB << " MiB\n";
+	}
+	for (size_t i = 0; i < s.heaps.size(); ++i) {
+		const HeapStats& h = s.heaps[i];
+		out << "  heap " << i << ((h.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? " (device local) " : " ") << h.usage * kMiB << " / "
+			<< h.budget * kMiB << " MiB " << (s.memoryBudget ? "budget" : "heap size") << ", " << h.allocated * kMiB << " MiB ours\n";
+	}
+	out << std::defaultfloat;
+}
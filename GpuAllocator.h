@@ -0,0 +1,166 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// What a piece of device memory is used for; drives the sub-allocation strategy and the usage report
+enum class GpuMemoryCategory : uint8_t {
+	Geometry,     // vertex and index buffers
+	Uniform,      // per-frame and per-object UBOs
+	Texture,      // sampled images
+	RenderTarget, // depth, shadow, offscreen and mask attachments
+	Staging,      // upload ring and oversized staging buffers
+	Particles,    // particle instance buffers
+	Count
+};
+
+const char* gpuMemoryCategoryName(GpuMemoryCategory category);
+
+struct GpuMemoryBlock;
+
+// A bound range of device memory. Host-visible memory is persistently mapped; mapped points at offset.
+struct GpuAllocation {
+	VkDeviceMemory memory{ VK_NULL_HANDLE };
+	VkDeviceSize offset{ 0 };
+	VkDeviceSize size{ 0 };
+	void* mapped{ nullptr };
+
+	GpuMemoryBlock* block{ nullptr }; // null for dedicated allocations
+	VkDeviceSize reserved{ 0 };       // bytes taken from the block, including alignment
+	GpuMemoryCategory category{ GpuMemoryCategory::Count };
+	uint32_t owner{ 0 };      // index into Stats::owners
+	uint32_t memoryType{ 0 };
+
+	explicit operator bool() const { return memory != VK_NULL_HANDLE; }
+};
+
+// Sub-allocates buffers and images from large vkAllocateMemory blocks, one block list per memory type.
+// Uniform buffers use linear blocks (bump pointer, reset once every range in the block is freed);
+// everything else uses buddy blocks. Resources at least half a block in size, or ones the driver
+// prefers dedicated, get their own allocation. Linear and optimal-tiling resources never share a
+// block when bufferImageGranularity > 1, so neighbours cannot alias on a granularity page.
+class GpuAllocator final
+{
+public:
+	static constexpr VkDeviceSize kDefaultBlockSize = 64ull * 1024 * 1024;
+	static constexpr VkDeviceSize kMinBuddyNode = 256;
+
+	struct CategoryStats {
+		uint64_t allocations = 0; // live ranges
+		uint64_t bytes = 0;       // live bytes requested
+		uint64_t reserved = 0;    // live bytes taken from blocks or dedicated memory
+		uint64_t peakBytes = 0;
+	};
+
+	// Live ranges tagged with one owner name in one category, e.g. "shadow map" / render target
+	struct OwnerStats {
+		std::string name;
+		GpuMemoryCategory category = GpuMemoryCategory::Count;
+		uint64_t allocations = 0;
+		uint64_t bytes = 0;
+		uint64_t peakBytes = 0;
+	};
+
+	// budget and usage come from VK_EXT_memory_budget when it is enabled; otherwise budget is the heap
+	// size and usage is what this allocator has taken from the heap
+	struct HeapStats {
+		VkDeviceSize size = 0;
+		VkMemoryHeapFlags flags = 0;
+		uint64_t allocated = 0;     // live vkAllocateMemory bytes from this allocator
+		uint64_t peakAllocated = 0;
+		uint64_t budget = 0;
+		uint64_t usage = 0;         // whole process, including memory this allocator does not own
+		uint64_t peakUsage = 0;     // highest usage seen by stats()
+	};
+
+	struct Stats {
+		std::array<CategoryStats, static_cast<size_t>(GpuMemoryCategory::Count)> categories{};
+		uint32_t deviceAllocations = 0; // live vkAllocateMemory calls: blocks plus dedicated
+		uint32_t dedicatedAllocations = 0;
+		uint64_t blockBytes = 0;
+		uint64_t dedicatedBytes = 0;
+		uint32_t maxDeviceAllocations = 0; // maxMemoryAllocationCount
+		std::vector<OwnerStats> owners;
+		std::vector<HeapStats> heaps;
+		bool memoryBudget = false; // heaps[].budget/usage come from VK_EXT_memory_budget
+	};
+
+	GpuAllocator();
+	~GpuAllocator();
+
+	GpuAllocator(const GpuAllocator&) = delete;
+	GpuAllocator& operator=(const GpuAllocator&) = delete;
+	GpuAllocator(GpuAllocator&&) = delete;
+	GpuAllocator& operator=(GpuAllocator&&) = delete;
+
+	// memoryBudget: VK_EXT_memory_budget is enabled on device, so stats() can report driver budgets per heap
+	void create(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize = kDefaultBlockSize, bool memoryBudget = false);
+
+	// Frees every block; resources still bound to them must already be destroyed
+	void destroy();
+
+	// Creates the buffer and binds it to a sub-allocated range. owner names what the memory is for in the
+	// report; ranges with the same owner and category are summed.
+	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, GpuMemoryCategory category,
+		std::string_view owner, VkBuffer& buffer, GpuAllocation& allocation);
+	// Creates the image and binds it; dedicated forces its own allocation (swapchain-sized attachments)
+	void createImage(const VkImageCreateInfo& info, VkMemoryPropertyFlags properties, GpuMemoryCategory category,
+		std::string_view owner, VkImage& image, GpuAllocation& allocation, bool dedicated = false);
+
+	// Destroy the resource and release its range; both handles are reset. Null handles are ignored.
+	void destroyBuffer(VkBuffer& buffer, GpuAllocation& allocation);
+	void destroyImage(VkImage& image, GpuAllocation& allocation);
+
+	void free(GpuAllocation& allocation);
+
+	uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+	// Also samples the heap budgets, so the usage high-water marks are only as fine as the calls to this
+	Stats stats() const;
+	void printStats(std::ostream& out) const;
+
+	VkDevice device() const { return _device; }
+
+private:
+	enum class Strategy : uint8_t { Linear, Buddy };
+
+	struct Pool {
+		uint32_t memoryType = 0;
+		bool optimalImages = false;
+		Strategy strategy = Strategy::Buddy;
+		std::vector<std::unique_ptr<GpuMemoryBlock>> blocks;
+	};
+
+	struct DedicatedTarget {
+		VkImage image = VK_NULL_HANDLE;
+		VkBuffer buffer = VK_NULL_HANDLE;
+	};
+
+	GpuAllocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, GpuMemoryCategory category,
+		std::string_view owner, bool optimalImage, bool dedicated, DedicatedTarget target);
+	GpuAllocation allocateDedicated(VkDeviceSize size, uint32_t memoryType, GpuMemoryCategory category, uint32_t owner,
+		DedicatedTarget target);
+	Pool& poolFor(uint32_t memoryType, bool optimalImage, Strategy strategy);
+	VkDeviceMemory allocateMemory(VkDeviceSize size, uint32_t memoryType, void** mapped, const void* pNext);
+	void freeMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType);
+	uint32_t ownerFor(std::string_view owner, GpuMemoryCategory category);
+	void account(GpuAllocation& allocation, bool add);
+
+	VkDevice _device{ VK_NULL_HANDLE };
+	VkPhysicalDevice _physicalDevice{ VK_NULL_HANDLE };
+	VkPhysicalDeviceMemoryProperties _memoryProperties{};
+	VkDeviceSize _blockSize{ kDefaultBlockSize };
+	VkDeviceSize _bufferImageGranularity{ 1 };
+	bool _memoryBudget{ false };
+
+	mutable std::mutex _mutex;
+	std::vector<Pool> _pools;
+	// Updated by stats(), which is const so callers holding a const allocator can still report
+	mutable Stats _stats;
+};
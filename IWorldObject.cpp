@@ -4,25 +4,41 @@ IWorldObject::~IWorldObject() = default;
 
 void IWorldObject::draw(VkCommandBuffer cmd, VkPipeline pipeline, VkPipelineLayout layout, uint32_t currentFrame)
 {
-    _mesh.draw(cmd, pipeline, layout, currentFrame);
+    if (!_meshAsset) return;
+    _mesh.bindDescriptors(cmd, pipeline, layout, currentFrame);
+    _meshAsset->mesh.drawGeometry(cmd);
+}
+
+void IWorldObject::drawWithBoundPipeline(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t currentFrame)
+{
+    if (!_meshAsset) return;
+    _mesh.bindObjectSet(cmd, layout, currentFrame);
+    _meshAsset->mesh.drawGeometry(cmd);
+}
+
+void IWorldObject::drawBindless(VkCommandBuffer cmd, VkPipelineLayout layout)
+{
+    if (!_meshAsset) return;
+    _mesh.pushDrawConstants(cmd, layout);
+    _meshAsset->mesh.drawGeometry(cmd);
 }
 
 void IWorldObject::upload(const RenderContext& ctx, uint32_t framesInFlight,
     VkImageView textureImageView, VkSampler textureSampler,
     const std::vector<VkDescriptorBufferInfo>& lightingBufferInfos)
 {
-    _mesh.upload(ctx, framesInFlight, _texture->getTextureImageView(), _texture->getTextureSampler(), lightingBufferInfos);
+    // Geometry is uploaded once per asset by the MeshLibrary
+    _mesh.uploadDescriptors(ctx, framesInFlight, _texture->getTextureImageView(), _texture->getTextureSampler(), lightingBufferInfos);
 }
 
 void IWorldObject::destroy(const RenderContext& ctx)
 {
-    _mesh.destroy(ctx);
+    _mesh.destroyDescriptors(ctx);
 }
 
-void IWorldObject::updateUniformBuffer(uint32_t frameIndex,
-    const glm::mat4& model, const glm::mat4& view, const glm::mat4& proj) const
+void IWorldObject::updateUniformBuffer(uint32_t frameIndex, const glm::mat4& model) const
 {
-    _mesh.updateUniformBuffer(frameIndex, model, view, proj);
+    _mesh.updateUniformBuffer(frameIndex, model * _transform);
 }
 
 void IWorldObject::update(float& /*deltaTime*/)
@@ -1,14 +1,26 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <Mesh.h>
+#include <MeshLibrary.h>
 #include <Material.h>
 #include <textureManager.h>
 
+class particleSystem;
+
 // Non-copyable interface base for scene objects sharing Mesh/Material lifecycle and rendering.
 class IWorldObject
 {
     glm::vec3 _position{};
+    glm::quat _rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+    glm::vec3 _scale{ 1.0f };
+    glm::mat4 _transform{ 1.0f };
     Material _material{ glm::vec4(1.0f), 0.0f, 1.0f, nullptr };
+
+    // Shared object-space geometry from the MeshLibrary
+    MeshHandle _meshAsset{};
+    // Per-object UBOs and descriptor sets only; never holds geometry
     Mesh _mesh{ glm::vec3(0.0f), _material, "" };
 
     textureManager* _textureMgr{ nullptr };
@@ -22,8 +34,10 @@ protected:
     explicit IWorldObject(const glm::vec3& position,
         const std::string& modelPath,
         textureManager* textureMgr,
+        MeshLibrary* meshLibrary,
         const char* textureKeyOrNull)
         : _position(position)
+        , _transform(glm::translate(glm::mat4(1.0f), position))
         , _material(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), 0.0f, 1.0f, nullptr)
         , _mesh(position,
             Material(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), 0.0f, 1.0f,
@@ -36,31 +50,41 @@ protected:
             ? textureMgr->getTexture(textureKeyOrNull)
             : nullptr)
     {
+        if (meshLibrary == nullptr) {
+            throw std::runtime_error("IWorldObject: a MeshLibrary is required for " + modelPath);
+        }
         _material.setTexture(_texture);
-        _mesh.create();
+        _meshAsset = meshLibrary->acquire(modelPath);
     }
 
-    // Copy support for derived classes
+    // Copy support for derived classes: the copy shares the source's geometry
     IWorldObject(const IWorldObject& other)
         : _position(other._position)
+        , _rotation(other._rotation)
+        , _scale(other._scale)
+        , _transform(other._transform)
         , _material(other._material)
+        , _meshAsset(other._meshAsset)
         , _mesh(other._position, other._material, other._mesh.getModelPath())
         , _textureMgr(other._textureMgr)
         , _texture(other._texture)
         , _usePostProcess(other._usePostProcess)
     {
         _material.setTexture(_texture);
-        _mesh.create();
     }
 
     IWorldObject& operator=(const IWorldObject& other)
     {
         if (this == &other) return *this;
         _position = other._position;
+        _rotation = other._rotation;
+        _scale = other._scale;
+        _transform = other._transform;
 
         const Material materialCopy = other._material;
         _material = materialCopy;
 
+        _meshAsset = other._meshAsset;
         _mesh = Mesh(other._position, materialCopy, other._mesh.getModelPath());
 
         _textureMgr = other._textureMgr;
@@ -69,13 +93,16 @@ protected:
         _usePostProcess = other._usePostProcess;
 
         _material.setTexture(_texture);
-        _mesh.create();
         return *this;
     }
 
     IWorldObject(IWorldObject&& other) noexcept
         : _position(std::move(other._position))
+        , _rotation(other._rotation)
+        , _scale(other._scale)
+        , _transform(other._transform)
         , _material(std::move(other._material))
+        , _meshAsset(std::move(other._meshAsset))
         , _mesh(other._position, other._material, other._mesh.getModelPath())
         , _textureMgr(other._textureMgr)
         , _texture(other._texture)
@@ -91,6 +118,10 @@ protected:
         if (this == &other) return *this;
 
         _position = std::move(other._position);
+        _rotation = other._rotation;
+        _scale = other._scale;
+        _transform = other._transform;
+        _meshAsset = std::move(other._meshAsset);
         Material materialMoved = std::move(other._material);
         _material = std::move(materialMoved);
 
@@ -114,6 +145,10 @@ public:
 
     // Common rendering lifecycle
     virtual void draw(VkCommandBuffer cmd, VkPipeline pipeline, VkPipelineLayout layout, uint32_t currentFrame);
+    // Bindless path: pipeline and BindlessTable set are already bound by the pass
+    virtual void drawBindless(VkCommandBuffer cmd, VkPipelineLayout layout);
+    // As draw(), with the pipeline already bound in cmd
+    virtual void drawWithBoundPipeline(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t currentFrame);
 
     virtual void upload(const RenderContext& ctx, uint32_t framesInFlight,
         VkImageView textureImageView, VkSampler textureSampler,
@@ -121,17 +156,38 @@ public:
 
     virtual void destroy(const RenderContext& ctx);
 
-    virtual void updateUniformBuffer(uint32_t frameIndex,
-        const glm::mat4& model, const glm::mat4& view, const glm::mat4& proj) const;
+    virtual void updateUniformBuffer(uint32_t frameIndex, const glm::mat4& model) const;
 
     // Optional hook for per-frame updates
     virtual void update(float& /*deltaTime*/);
+    // Particles the object steps in update(), if any
+    virtual particleSystem* particles() { return nullptr; }
+
+    // Writes a model matrix captured earlier, e.g. model * transform() taken on another thread
+    void writeModelMatrix(uint32_t frameIndex, const glm::mat4& world) const { _mesh.updateUniformBuffer(frameIndex, world); }
 
     // Accessors
     const glm::vec3 position() const { return _position; }
-    void setPosition(const glm::vec3& pos) { _position = pos; }
+    void setPosition(const glm::vec3& pos)
+    {
+        setPlacement(pos, _rotation, _scale);
+    }
+    // Model matrix is translate * rotate * scale
+    void setPlacement(const glm::vec3& pos, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        _position = pos;
+        _rotation = rotation;
+        _scale = scale;
+        _transform = glm::scale(glm::translate(glm::mat4(1.0f), pos) * glm::mat4_cast(rotation), scale);
+    }
+    const glm::quat& rotation() const { return _rotation; }
+    const glm::vec3& scale() const { return _scale; }
+    const glm::mat4& transform() const { return _transform; }
+    const MeshHandle& meshAsset() const { return _meshAsset; }
 
     const Mesh mesh() const { return _mesh; }
+    // CPU geometry held by this object's own Mesh; the shared asset is counted by the MeshLibrary
+    size_t cpuGeometryBytes() const { return _mesh.vertexDataBytes() + _mesh.localDataBytes(); }
     const Material material() const { return _material; }
     Texture* texture() const { return _texture; }
     textureManager* textureMgr() const { return _textureMgr; }
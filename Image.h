@@ -1,21 +1,25 @@
 #pragma once
 #include "vulkan/vulkan.h"
 #include <stdexcept>
+#include <string_view>
+#include "GpuAllocator.h"
 class Image final
 {
 	VkQueue _graphicsQueue;
 	VkCommandPool _commandPool;
 	VkPhysicalDevice _physicalDevice;
 	VkDevice _device;
+	GpuAllocator* _allocator{ nullptr };
 
 
 	public:
 		Image() = default;
-		Image(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue graphicsQueue)
+		Image(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue graphicsQueue, GpuAllocator* allocator)
 			: _graphicsQueue(graphicsQueue)
 			, _commandPool(commandPool)
 			, _physicalDevice(physicalDevice)
 			, _device(device)
+			, _allocator(allocator)
 		{
 		}
 
@@ -25,8 +29,8 @@ class Image final
 		Image& operator=(const Image& other) = default;
 
 		~Image() = default;
-		void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
-		VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+		void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, std::string_view owner, VkImage& image, GpuAllocation& imageAllocation, uint32_t mipLevels = 1);
+		VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1);
 		void transitionImageLayout(VkImage& image, VkImageLayout oldLayout, VkImageLayout newLayout);
 		void transitionDepthImageLayout(VkImage& image, VkImageLayout oldLayout, VkImageLayout newLayout);
 		void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
@@ -34,5 +38,7 @@ class Image final
 		void endSingleTimeCommands(VkCommandBuffer commandBuffer);
 		uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 		VkDevice device() const { return _device; }
+		VkPhysicalDevice physicalDevice() const { return _physicalDevice; }
+		GpuAllocator* allocator() const { return _allocator; }
 };
 
@@ -0,0 +1,201 @@
+#include "ImageDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+DecodedImage::DecodedImage(DecodedImage&& other) noexcept
+	: path(std::move(other.path))
+	, width(other.width)
+	, height(other.height)
+	, pixels(std::exchange(other.pixels, nullptr))
+	, decodeMs(other.decodeMs)
+{
+}
+
+DecodedImage& DecodedImage::operator=(DecodedImage&& other) noexcept
+{
+	if (this != &other) {
+		release();
+		path = std::move(other.path);
+		width = other.width;
+		height = other.height;
+		pixels = std::exchange(other.pixels, nullptr);
+		decodeMs = other.decodeMs;
+	}
+	return *this;
+}
+
+void DecodedImage::release()
+{
+	if (pixels) {
+		stbi_image_free(pixels);
+		pixels = nullptr;
+	}
+}
+
+DecodedImage DecodedImage::load(const std::string& path)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	DecodedImage img;
+	img.path = path;
+	int channels = 0;
+	img.pixels = stbi_load(path.c_str(), &img.width, &img.height, &channels, STBI_rgb_alpha);
+	if (!img.pixels) {
+		throw std::runtime_error("ImageDecoder: failed to load image: " + path);
+	}
+
+	img.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	return img;
+}
+
+ImageDecoder::~ImageDecoder()
+{
+	// Let in-flight decodes finish so no worker touches a destroyed decoder
+	_nextIndex = _paths.size();
+	join();
+}
+
+void ImageDecoder::start(std::vector<std::string> paths, unsigned threadCount)
+{
+	join();
+	_paths = std::move(paths);
+	_nextIndex = 0;
+	_done.clear();
+	_error = nullptr;
+	_returned = 0;
+	_totalDecodeMs = 0.0;
+
+	if (threadCount == 0) {
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	const size_t count = std::min<size_t>(threadCount, _paths.size());
+	for (size_t i = 0; i < count; ++i) {
+		_workers.emplace_back(&ImageDecoder::worker, this);
+	}
+}
+
+void ImageDecoder::worker()
+{
+	for (size_t i = _nextIndex++; i < _paths.size(); i = _nextIndex++) {
+		Result r;
+		r.index = i;
+		try {
+			r.image = DecodedImage::load(_paths[i]);
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (!_error) _error = std::current_exception();
+			_ready.notify_all();
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_totalDecodeMs += r.image.decodeMs;
+		_done.push_back(std::move(r));
+		_ready.notify_all();
+	}
+}
+
+bool ImageDecoder::next(Result& out)
+{
+	if (_returned == _paths.size()) {
+		join();
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_ready.wait(lock, [this]() { return !_done.empty() || _error; });
+	if (_error) {
+		std::exception_ptr e = _error;
+		lock.unlock();
+		_nextIndex = _paths.size();
+		join();
+		std::rethrow_exception(e);
+	}
+
+	out = std::move(_done.front());
+	_done.pop_front();
+	++_returned;
+	return true;
+}
+
+void ImageDecoder::join()
+{
+	for (auto& w : _workers) {
+		if (w.joinable()) w.join();
+	}
+	_workers.clear();
+}
+
+uint64_t ImageStreamer::request(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (!_worker.joinable()) {
+		_stopping = false;
+		_worker = std::thread(&ImageStreamer::worker, this);
+	}
+	const uint64_t ticket = _nextTicket++;
+	_queue.emplace_back(ticket, path);
+	++_pending;
+	_wake.notify_one();
+	return ticket;
+}
+
+size_t ImageStreamer::poll(std::vector<Result>& out, size_t maxResults)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	size_t moved = 0;
+	while (moved < maxResults && !_done.empty()) {
+		out.push_back(std::move(_done.front()));
+		_done.pop_front();
+		--_pending;
+		++moved;
+	}
+	return moved;
+}
+
+void ImageStreamer::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+		_pending -= _queue.size() + _done.size();
+		_queue.clear();
+		_done.clear();
+		_wake.notify_all();
+	}
+	if (_worker.joinable()) _worker.join();
+}
+
+void ImageStreamer::worker()
+{
+	for (;;) {
+		std::pair<uint64_t, std::string> job;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wake.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+			if (_stopping) return;
+			job = std::move(_queue.front());
+			_queue.pop_front();
+		}
+
+		Result r;
+		r.ticket = job.first;
+		try {
+			r.image = DecodedImage::load(job.second);
+		}
+		catch (const std::exception& e) {
+			r.image.path = job.second;
+			r.error = e.what();
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_stopping) {
+			--_pending;
+			return;
+		}
+		_done.push_back(std::move(r));
+	}
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <stb_image.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// RGBA8 pixels decoded by stb_image; owns and frees them.
+struct DecodedImage
+{
+	std::string path;
+	int width = 0;
+	int height = 0;
+	stbi_uc* pixels = nullptr;
+	double decodeMs = 0.0;
+
+	DecodedImage() = default;
+	~DecodedImage() { release(); }
+
+	DecodedImage(const DecodedImage&) = delete;
+	DecodedImage& operator=(const DecodedImage&) = delete;
+	DecodedImage(DecodedImage&& other) noexcept;
+	DecodedImage& operator=(DecodedImage&& other) noexcept;
+
+	size_t byteSize() const { return static_cast<size_t>(width) * static_cast<size_t>(height) * 4; }
+	void release();
+
+	// Throws std::runtime_error if the file cannot be decoded
+	static DecodedImage load(const std::string& path);
+};
+
+// Fixed worker pool that decodes a list of image files concurrently.
+// Results are handed back in completion order so the caller can upload each one as soon as it is ready.
+class ImageDecoder final
+{
+public:
+	struct Result {
+		size_t index = 0; // position in the submitted list
+		DecodedImage image;
+	};
+
+	ImageDecoder() = default;
+	~ImageDecoder();
+
+	ImageDecoder(const ImageDecoder&) = delete;
+	ImageDecoder& operator=(const ImageDecoder&) = delete;
+	ImageDecoder(ImageDecoder&&) = delete;
+	ImageDecoder& operator=(ImageDecoder&&) = delete;
+
+	// Starts decoding immediately; threadCount == 0 uses hardware_concurrency
+	void start(std::vector<std::string> paths, unsigned threadCount = 0);
+
+	// Blocks until the next image finishes. Returns false once every image has been returned.
+	// Rethrows the first decode error.
+	bool next(Result& out);
+
+	// Sum of per-image decode time across workers
+	double totalDecodeMs() const { return _totalDecodeMs; }
+	size_t size() const { return _paths.size(); }
+
+private:
+	void worker();
+	void join();
+
+	std::vector<std::string> _paths;
+	std::vector<std::thread> _workers;
+	std::atomic<size_t> _nextIndex{ 0 };
+
+	std::mutex _mutex;
+	std::condition_variable _ready;
+	std::deque<Result> _done;
+	std::exception_ptr _error;
+	size_t _returned = 0;
+	double _totalDecodeMs = 0.0;
+};
+
+// Long-lived background decoder for streaming: requests can be queued at any time and finished
+// images are collected without blocking. A failed decode is returned with null pixels and its error.
+class ImageStreamer final
+{
+public:
+	struct Result {
+		uint64_t ticket = 0; // value returned by request()
+		DecodedImage image;
+		std::string error;   // set when image.pixels is null
+	};
+
+	ImageStreamer() = default;
+	~ImageStreamer() { stop(); }
+
+	ImageStreamer(const ImageStreamer&) = delete;
+	ImageStreamer& operator=(const ImageStreamer&) = delete;
+	ImageStreamer(ImageStreamer&&) = delete;
+	ImageStreamer& operator=(ImageStreamer&&) = delete;
+
+	// Queues a decode, starting the worker on first use
+	uint64_t request(const std::string& path);
+
+	// Moves up to maxResults finished images into out; never waits
+	size_t poll(std::vector<Result>& out, size_t maxResults = SIZE_MAX);
+
+	// Requested but not yet collected by poll()
+	size_t pending() const { return _pending.load(); }
+
+	// Drops queued requests and joins the worker once its current decode finishes
+	void stop();
+
+private:
+	void worker();
+
+	std::thread _worker;
+	std::mutex _mutex;
+	std::condition_variable _wake;
+	std::deque<std::pair<uint64_t, std::string>> _queue;
+	std::deque<Result> _done;
+	std::atomic<size_t> _pending{ 0 };
+	uint64_t _nextTicket = 1;
+	bool _stopping = false;
+};
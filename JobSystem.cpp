@@ -0,0 +1,235 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+	// Which system's worker the current thread is, if any
+	struct ThreadSlot {
+		const JobSystem* owner;
+		unsigned index;
+	};
+	thread_local ThreadSlot t_thread{ nullptr, 0 };
+}
+
+JobSystem::~JobSystem()
+{
+	// Workers must not outlive the system even if destroy() was never reached
+	destroy();
+}
+
+void JobSystem::create(unsigned threadCount)
+{
+	destroy();
+	if (threadCount == 0) {
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	_queues = std::make_unique<Worker[]>(threadCount + kMaxAttachedThreads);
+	_queued = 0;
+	_attached = 0;
+	_sleepers = 0;
+	_stopping = false;
+	_serial = threadCount == 1;
+	_threadCount = threadCount;
+	_workers.reserve(threadCount - 1);
+	for (unsigned i = 1; i < threadCount; ++i) {
+		_workers.emplace_back(&JobSystem::workerLoop, this, i);
+	}
+}
+
+void JobSystem::destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_stopping = true;
+	}
+	_wake.notify_all();
+	for (auto& w : _workers) {
+		if (w.joinable()) w.join();
+	}
+	_workers.clear();
+	_queues.reset();
+	_threadCount = 1;
+	_serial = true;
+}
+
+unsigned JobSystem::currentThread() const
+{
+	return t_thread.owner == this ? t_thread.index : 0;
+}
+
+unsigned JobSystem::attachThread()
+{
+	if (t_thread.owner == this) {
+		throw std::runtime_error("JobSystem: the thread already has an index of its own");
+	}
+	uint32_t attached = _attached.load();
+	for (;;) {
+		unsigned bit = 0;
+		while (bit < kMaxAttachedThreads && (attached & (1u << bit)) != 0) ++bit;
+		if (bit == kMaxAttachedThreads) {
+			throw std::runtime_error("JobSystem: more than " + std::to_string(kMaxAttachedThreads) + " threads attached");
+		}
+		if (_attached.compare_exchange_weak(attached, attached | (1u << bit))) {
+			t_thread = { this, _threadCount + bit };
+			return t_thread.index;
+		}
+	}
+}
+
+void JobSystem::detachThread()
+{
+	if (t_thread.owner != this || t_thread.index < _threadCount) return;
+	_attached.fetch_and(~(1u << (t_thread.index - _threadCount)));
+	t_thread = { nullptr, 0 };
+}
+
+void JobSystem::submit(Group& group, Job job)
+{
+	group._pending.fetch_add(1, std::memory_order_relaxed);
+	Queued queued{ std::move(job), &group };
+	const unsigned thread = currentThread();
+	if (_serial) {
+		run(queued, thread);
+		return;
+	}
+
+	// Counted before it is visible, so a thread that pops it never sees the count go below zero
+	_queued.fetch_add(1);
+	{
+		Worker& own = _queues[thread];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		own.jobs.push_back(std::move(queued));
+	}
+	// A worker counts itself as a sleeper before it checks _queued, so one of the two always sees the other
+	if (_sleepers.load() > 0) {
+		{
+			std::lock_guard<std::mutex> lock(_sleepMutex);
+		}
+		_wake.notify_one();
+	}
+}
+
+void JobSystem::wait(Group& group)
+{
+	const unsigned thread = currentThread();
+	while (!group.done()) {
+		// The last jobs of the group may be running elsewhere with nothing left to steal
+		if (!tryRunOne(thread)) std::this_thread::yield();
+	}
+
+	std::exception_ptr error;
+	{
+		std::lock_guard<std::mutex> lock(group._errorMutex);
+		error = std::exchange(group._error, nullptr);
+	}
+	if (error) std::rethrow_exception(error);
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const RangeJob& job)
+{
+	if (count == 0) return;
+
+	const size_t target = static_cast<size_t>(threadCount()) * kRangesPerThread;
+	const size_t rangeSize = std::max({ grain, size_t{ 1 }, (count + target - 1) / target });
+	if (_serial || rangeSize >= count) {
+		job(0, count);
+		return;
+	}
+
+	Group group;
+	for (size_t begin = rangeSize; begin < count; begin += rangeSize) {
+		const size_t end = std::min(count, begin + rangeSize);
+		submit(group, [&job, begin, end] { job(begin, end); });
+	}
+
+	// The first range runs here while the others are stolen; the rest must finish before job goes out of scope
+	std::exception_ptr error;
+	try {
+		job(0, rangeSize);
+	}
+	catch (...) {
+		error = std::current_exception();
+	}
+	wait(group);
+	if (error) std::rethrow_exception(error);
+}
+
+JobSystem::Stats JobSystem::stats() const
+{
+	Stats s;
+	if (!_queues) return s;
+	for (unsigned i = 0; i < slotCount(); ++i) {
+		s.jobs += _queues[i].jobsRun.load(std::memory_order_relaxed);
+		s.steals += _queues[i].steals.load(std::memory_order_relaxed);
+	}
+	return s;
+}
+
+bool JobSystem::tryRunOne(unsigned thread)
+{
+	Queued queued;
+	bool stolen = false;
+	{
+		Worker& own = _queues[thread];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.jobs.empty()) {
+			queued = std::move(own.jobs.back());
+			own.jobs.pop_back();
+		}
+	}
+
+	// Oldest first from the others: those are the biggest pieces of work left
+	const unsigned count = slotCount();
+	for (unsigned i = 1; i < count && !queued.job; ++i) {
+		Worker& victim = _queues[(thread + i) % count];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty()) {
+			queued = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			stolen = true;
+		}
+	}
+
+	if (!queued.job) return false;
+	_queued.fetch_sub(1);
+	if (stolen) {
+		_queues[thread].steals.fetch_add(1, std::memory_order_relaxed);
+	}
+	run(queued, thread);
+	return true;
+}
+
+void JobSystem::run(Queued& queued, unsigned thread)
+{
+	Group& group = *queued.group;
+	try {
+		queued.job();
+	}
+	catch (...) {
+		std::lock_guard<std::mutex> lock(group._errorMutex);
+		if (!group._error) group._error = std::current_exception();
+	}
+	// Released before the group can complete, since the waiter may unwind what the job captured
+	queued.job = nullptr;
+	if (_queues) {
+		_queues[thread].jobsRun.fetch_add(1, std::memory_order_relaxed);
+	}
+	group._pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void JobSystem::workerLoop(unsigned thread)
+{
+	t_thread = { this, thread };
+	for (;;) {
+		if (tryRunOne(thread)) continue;
+
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_sleepers.fetch_add(1);
+		_wake.wait(lock, [this] { return _stopping || _queued.load() > 0; });
+		_sleepers.fetch_sub(1);
+		if (_stopping) return;
+	}
+}
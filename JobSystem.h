@@ -0,0 +1,130 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads that share work by stealing. Every thread has its own deque: the owner pushes
+// and pops at the back, so it keeps working on what it just spawned while it is still in cache, and an idle
+// thread steals the oldest job from the front of someone else's. Thread 0 is whichever thread is not a worker
+// (normally the main thread); it takes part in the work while it waits on a Group. Another long-lived thread
+// that submits work at the same time as thread 0, such as a render thread, attaches to get a deque and
+// thread index of its own.
+// In serial mode every job runs on the submitting thread the moment it is submitted, so a frame runs in one
+// fixed order on one thread; use it to rule out the scheduler when chasing a bug.
+class JobSystem final
+{
+public:
+	using Job = std::function<void()>;
+	// Runs items [begin, end)
+	using RangeJob = std::function<void(size_t begin, size_t end)>;
+
+	// parallelFor() aims for this many ranges per thread so a slow range can be balanced by stealing
+	static constexpr size_t kRangesPerThread = 4;
+	// Threads besides thread 0 that may be attached at once
+	static constexpr unsigned kMaxAttachedThreads = 2;
+
+	// Jobs submitted against a group; wait() on it returns once every one of them has run
+	class Group final
+	{
+	public:
+		Group() = default;
+		Group(const Group&) = delete;
+		Group& operator=(const Group&) = delete;
+
+		bool done() const { return _pending.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+		std::atomic<uint32_t> _pending{ 0 };
+		std::mutex _errorMutex;
+		std::exception_ptr _error; // the first exception a job threw
+	};
+
+	struct Stats {
+		uint64_t jobs = 0;   // jobs run, including serial ones
+		uint64_t steals = 0; // jobs taken from another thread's deque
+	};
+
+	JobSystem() = default;
+	~JobSystem();
+
+	// Owns threads; release them through destroy()
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+	JobSystem(JobSystem&&) = delete;
+	JobSystem& operator=(JobSystem&&) = delete;
+
+	// threadCount includes the calling thread; 0 uses hardware_concurrency and 1 starts no workers
+	void create(unsigned threadCount = 0);
+	// Joins the workers; jobs still queued are dropped
+	void destroy();
+
+	unsigned threadCount() const { return _threadCount; }
+	// Thread indices currentThread() can return: thread 0, the workers and the attached threads
+	unsigned slotCount() const { return _threadCount + kMaxAttachedThreads; }
+	// Index of the calling thread: 1..threadCount()-1 for this system's workers, threadCount() and up for
+	// attached threads, 0 for any other thread
+	unsigned currentThread() const;
+
+	// Gives the calling thread, which must not be a worker, its own index until detachThread(). Throws when
+	// kMaxAttachedThreads are already attached.
+	unsigned attachThread();
+	// Call once the thread has waited on everything it submitted
+	void detachThread();
+
+	// Jobs submitted after the switch run in the new mode; jobs already queued still run
+	void setSerial(bool serial) { _serial = serial || _threadCount == 1; }
+	bool serial() const { return _serial; }
+
+	// Queues job on the calling thread's deque. The job may run on any thread, including the caller's.
+	void submit(Group& group, Job job);
+	// Runs queued jobs on the calling thread until every job in group has finished, then rethrows the first
+	// exception one of them threw
+	void wait(Group& group);
+
+	// Splits [0, count) into ranges of at least grain items, runs them across the threads and returns once all
+	// have run. In serial mode the whole of [0, count) is one range on the calling thread.
+	void parallelFor(size_t count, size_t grain, const RangeJob& job);
+
+	Stats stats() const;
+
+private:
+	struct Queued {
+		Job job;
+		Group* group{ nullptr };
+	};
+
+	// Padded so owners pushing to neighbouring deques do not share a cache line
+	struct alignas(64) Worker {
+		std::mutex mutex;
+		std::deque<Queued> jobs;
+		std::atomic<uint64_t> jobsRun{ 0 };
+		std::atomic<uint64_t> steals{ 0 };
+	};
+
+	void workerLoop(unsigned thread);
+	// Pops from the thread's own deque, or steals; false when every deque is empty
+	bool tryRunOne(unsigned thread);
+	void run(Queued& queued, unsigned thread);
+
+	std::unique_ptr<Worker[]> _queues; // one per slot; [0] is shared by every thread neither a worker nor attached
+	std::vector<std::thread> _workers;  // worker i runs as thread i + 1
+	unsigned _threadCount{ 1 };         // fixed before the workers start, since they read it
+	std::atomic<uint32_t> _attached{ 0 }; // bit i set while slot threadCount() + i is taken
+	std::atomic<bool> _serial{ true };
+
+	// Idle workers sleep here until a job is queued
+	std::mutex _sleepMutex;
+	std::condition_variable _wake;
+	std::atomic<uint32_t> _queued{ 0 };   // jobs sitting in any deque
+	std::atomic<uint32_t> _sleepers{ 0 }; // workers waiting on _wake
+	bool _stopping{ false };
+};
@@ -4,20 +4,17 @@
 #include "Light.h"
 #include "glm/glm.hpp"
 #include "RenderContext.h"
+#include "GpuAllocator.h"
 
 class LightingSystem final
 {
 	std::vector<VkBuffer> _buffers;
-	std::vector<VkDeviceMemory> _memories;
+	std::vector<GpuAllocation> _allocations;
 	std::vector<void*> _mapped;
 	std::vector<VkDescriptorBufferInfo> _descriptorInfos;
 
 	uint32_t _framesInFlight{ 0 };
 
-	static uint32_t findMemoryType(VkPhysicalDevice phys, uint32_t typeFilter, VkMemoryPropertyFlags props);
-
-	void createBuffer(const RenderContext& ctx, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) const;
-
 public:
 	
 	LightingSystem() = default;
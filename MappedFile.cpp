@@ -0,0 +1,152 @@
+#include "MappedFile.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& filename)
+{
+	open(filename);
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other) {
+		close();
+		_data = std::exchange(other._data, nullptr);
+		_size = std::exchange(other._size, 0);
+		_open = std::exchange(other._open, false);
+#ifdef _WIN32
+		_file = std::exchange(other._file, nullptr);
+		_mapping = std::exchange(other._mapping, nullptr);
+#else
+		_fd = std::exchange(other._fd, -1);
+#endif
+	}
+	return *this;
+}
+
+#ifdef _WIN32
+
+void MappedFile::open(const std::string& filename)
+{
+	close();
+
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		throw std::runtime_error("MappedFile: failed to open file: " + filename);
+	}
+
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		throw std::runtime_error("MappedFile: failed to query size: " + filename);
+	}
+
+	_file = file;
+	_size = static_cast<size_t>(fileSize.QuadPart);
+	_open = true;
+	if (_size == 0) {
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		close();
+		throw std::runtime_error("MappedFile: failed to create mapping: " + filename);
+	}
+	_mapping = mapping;
+
+	_data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!_data) {
+		close();
+		throw std::runtime_error("MappedFile: failed to map view: " + filename);
+	}
+}
+
+void MappedFile::close()
+{
+	if (_data) {
+		UnmapViewOfFile(_data);
+	}
+	if (_mapping) {
+		CloseHandle(static_cast<HANDLE>(_mapping));
+	}
+	if (_file) {
+		CloseHandle(static_cast<HANDLE>(_file));
+	}
+	_data = nullptr;
+	_mapping = nullptr;
+	_file = nullptr;
+	_size = 0;
+	_open = false;
+}
+
+#else
+
+void MappedFile::open(const std::string& filename)
+{
+	close();
+
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw std::runtime_error("MappedFile: failed to open file: " + filename);
+	}
+
+	struct stat st {};
+	if (fstat(fd, &st) != 0) {
+		::close(fd);
+		throw std::runtime_error("MappedFile: failed to query size: " + filename);
+	}
+
+	_fd = fd;
+	_size = static_cast<size_t>(st.st_size);
+	_open = true;
+	if (_size == 0) {
+		return;
+	}
+
+	void* ptr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (ptr == MAP_FAILED) {
+		close();
+		throw std::runtime_error("MappedFile: failed to map file: " + filename);
+	}
+	madvise(ptr, _size, MADV_SEQUENTIAL);
+	_data = static_cast<const char*>(ptr);
+}
+
+void MappedFile::close()
+{
+	if (_data) {
+		munmap(const_cast<char*>(_data), _size);
+	}
+	if (_fd >= 0) {
+		::close(_fd);
+	}
+	_data = nullptr;
+	_fd = -1;
+	_size = 0;
+	_open = false;
+}
+
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Falls back to an empty view for zero-length files.
+class MappedFile final
+{
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::string& filename);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	void open(const std::string& filename);
+	void close();
+
+	const char* data() const { return _data; }
+	size_t size() const { return _size; }
+	bool isOpen() const { return _open; }
+
+private:
+	const char* _data = nullptr;
+	size_t _size = 0;
+	bool _open = false;
+#ifdef _WIN32
+	void* _file = nullptr;
+	void* _mapping = nullptr;
+#else
+	int _fd = -1;
+#endif
+};
@@ -24,5 +24,9 @@ public:
 	VkSampler getTextureSampler() const { return (_texture != nullptr) ? _texture->getTextureSampler() : VK_NULL_HANDLE; }
 	VkImageView getTextureImageView() const { return (_texture != nullptr) ? _texture->getTextureImageView() : VK_NULL_HANDLE; }
 	void setTexture(Texture* texture) { _texture = texture; }
+	const glm::vec4& albedoColour() const { return _albedoColour; }
+	float metallic() const { return _metallic; }
+	float roughness() const { return _roughness; }
+	Texture* texture() const { return _texture; }
 };
 
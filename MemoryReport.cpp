@@ -0,0 +1,132 @@
+#include "MemoryReport.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+	// Names are paths and fixed labels; only quotes, backslashes and control characters need escaping
+	void writeString(std::ostream& out, const std::string& text)
+	{
+		out << '"';
+		for (const char c : text) {
+			switch (c) {
+			case '"': out << "\\\""; break;
+			case '\\': out << "\\\\"; break;
+			case '\n': out << "\\n"; break;
+			case '\t': out << "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					char escaped[8];
+					std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+					out << escaped;
+				}
+				else {
+					out << c;
+				}
+			}
+		}
+		out << '"';
+	}
+}
+
+void MemoryReport::sampleCpu(const std::vector<CpuMemoryEntry>& entries)
+{
+	for (CpuOwner& owner : _cpu) {
+		owner.bytes = 0;
+	}
+	for (const CpuMemoryEntry& entry : entries) {
+		auto it = std::find_if(_cpu.begin(), _cpu.end(), [&](const CpuOwner& o) {
+			return o.category == entry.category && o.owner == entry.owner;
+		});
+		if (it == _cpu.end()) {
+			it = _cpu.insert(_cpu.end(), CpuOwner{ entry.category, entry.owner });
+		}
+		it->bytes += entry.bytes;
+	}
+
+	_cpuBytes = 0;
+	for (CpuOwner& owner : _cpu) {
+		owner.peakBytes = std::max(owner.peakBytes, owner.bytes);
+		_cpuBytes += owner.bytes;
+	}
+	_cpuPeakBytes = std::max(_cpuPeakBytes, _cpuBytes);
+}
+
+void MemoryReport::writeJson(std::ostream& out, const GpuAllocator& allocator, double seconds) const
+{
+	const GpuAllocator::Stats s = allocator.stats();
+
+	out << "{\n  \"seconds\": " << seconds << ",\n  \"gpu\": {\n"
+		<< "    \"deviceAllocations\": " << s.deviceAllocations << ",\n"
+		<< "    \"maxDeviceAllocations\": " << s.maxDeviceAllocations << ",\n"
+		<< "    \"blockBytes\": " << s.blockBytes << ",\n"
+		<< "    \"dedicatedAllocations\": " << s.dedicatedAllocations << ",\n"
+		<< "    \"dedicatedBytes\": " << s.dedicatedBytes << ",\n"
+		<< "    \"budgetSource\": \"" << (s.memoryBudget ? "VK_EXT_memory_budget" : "heap size") << "\",\n";
+
+	out << "    \"categories\": [";
+	for (size_t i = 0; i < s.categories.size(); ++i) {
+		const GpuAllocator::CategoryStats& c = s.categories[i];
+		out << (i ? ",\n" : "\n") << "      { \"name\": ";
+		writeString(out, gpuMemoryCategoryName(static_cast<GpuMemoryCategory>(i)));
+		out << ", \"allocations\": " << c.allocations << ", \"bytes\": " << c.bytes << ", \"reservedBytes\": " << c.reserved
+			<< ", \"peakBytes\": " << c.peakBytes << " }";
+	}
+	out << "\n    ],\n";
+
+	out << "    \"owners\": [";
+	for (size_t i = 0; i < s.owners.size(); ++i) {
+		const GpuAllocator::OwnerStats& o = s.owners[i];
+		out << (i ? ",\n" : "\n") << "      { \"name\": ";
+		writeString(out, o.name);
+		out << ", \"category\": ";
+		writeString(out, gpuMemoryCategoryName(o.category));
+		out << ", \"allocations\": " << o.allocations << ", \"bytes\": " << o.bytes << ", \"peakBytes\": " << o.peakBytes << " }";
+	}
+	out << "\n    ],\n";
+
+	out << "    \"heaps\": [";
+	for (size_t i = 0; i < s.heaps.size(); ++i) {
+		const GpuAllocator::HeapStats& h = s.heaps[i];
+		out << (i ? ",\n" : "\n") << "      { \"index\": " << i
+			<< ", \"deviceLocal\": " << ((h.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "true" : "false")
+			<< ", \"size\": " << h.size << ", \"budget\": " << h.budget << ", \"usage\": " << h.usage << ", \"peakUsage\": " << h.peakUsage
+			<< ", \"allocated\": " << h.allocated << ", \"peakAllocated\": " << h.peakAllocated << " }";
+	}
+	out << "\n    ]\n  },\n";
+
+	out << "  \"cpu\": {\n    \"bytes\": " << _cpuBytes << ",\n    \"peakBytes\": " << _cpuPeakBytes << ",\n    \"entries\": [";
+	for (size_t i = 0; i < _cpu.size(); ++i) {
+		const CpuOwner& o = _cpu[i];
+		out << (i ? ",\n" : "\n") << "      { \"category\": ";
+		writeString(out, o.category);
+		out << ", \"owner\": ";
+		writeString(out, o.owner);
+		out << ", \"bytes\": " << o.bytes << ", \"peakBytes\": " << o.peakBytes << " }";
+	}
+	out << "\n    ]\n  }\n}\n";
+}
+
+void MemoryReport::write(const std::string& path, const GpuAllocator& allocator, double seconds) const
+{
+	const std::string temporary = path + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::trunc);
+		if (!file) {
+			throw std::runtime_error("MemoryReport: failed to open " + temporary);
+		}
+		writeJson(file, allocator, seconds);
+		if (!file) {
+			throw std::runtime_error("MemoryReport: failed to write " + temporary);
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, path, error);
+	if (error) {
+		throw std::runtime_error("MemoryReport: failed to replace " + path + ": " + error.message());
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "GpuAllocator.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// CPU-side memory the allocator cannot see, such as the geometry copies meshes keep after upload
+struct CpuMemoryEntry {
+	std::string category; // e.g. "mesh local vertices"
+	std::string owner;    // e.g. the model path
+	uint64_t bytes = 0;
+};
+
+// Combines GpuAllocator stats (categories, owners, heap budgets) with sampled CPU usage into one JSON
+// document, so automated runs can diff the numbers between builds. High-water marks for CPU entries
+// are kept across samples; GPU high-water marks come from the allocator.
+class MemoryReport final
+{
+public:
+	// Replaces the current CPU sample. Entries with the same category and owner are summed; owners missing
+	// from this sample drop to zero but keep their peaks.
+	void sampleCpu(const std::vector<CpuMemoryEntry>& entries);
+
+	void writeJson(std::ostream& out, const GpuAllocator& allocator, double seconds) const;
+	// Writes to a temporary file first and renames it, so a reader never sees half a report
+	void write(const std::string& path, const GpuAllocator& allocator, double seconds) const;
+
+	uint64_t cpuBytes() const { return _cpuBytes; }
+	uint64_t cpuPeakBytes() const { return _cpuPeakBytes; }
+
+private:
+	struct CpuOwner {
+		std::string category;
+		std::string owner;
+		uint64_t bytes = 0;
+		uint64_t peakBytes = 0;
+	};
+
+	std::vector<CpuOwner> _cpu;
+	uint64_t _cpuBytes{ 0 };
+	uint64_t _cpuPeakBytes{ 0 };
+};
@@ -1,35 +1,121 @@
 #include "Mesh.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
 
+namespace
+{
+	// Bitwise pos/uv/normal of a corner; colour is constant for OBJ meshes
+	struct WeldKey {
+		std::array<uint32_t, 8> bits;
 
+		static WeldKey from(const Vertex& v) {
+			const float f[8] = { v.pos.x, v.pos.y, v.pos.z, v.texCoord.x, v.texCoord.y, v.normal.x, v.normal.y, v.normal.z };
+			WeldKey k{};
+			std::memcpy(k.bits.data(), f, sizeof(f));
+			return k;
+		}
 
-void Mesh::create() {
+		bool operator==(const WeldKey& o) const { return bits == o.bits; }
+	};
+
+	struct WeldKeyHash {
+		size_t operator()(const WeldKey& k) const {
+			uint64_t h = 1469598103934665603ull; // FNV-1a over the words
+			for (uint32_t b : k.bits) {
+				h = (h ^ b) * 1099511628211ull;
+			}
+			return static_cast<size_t>(h ^ (h >> 32));
+		}
+	};
+}
+
+
+
+MeshData Mesh::loadMeshData(const std::string& filePath) {
+    MeshData data;
+    if (MeshCache::load(filePath, data)) {
+        return data;
+    }
+
+    data = parseMeshData(filePath);
+
+    // Baked once into the cache, so the reorder costs nothing on later startups
+    const MeshOptimizer::Report report = MeshOptimizer::optimize(data);
+    std::cout << "Mesh: " << filePath << " reordered in " << report.ms << " ms, ACMR " << report.before.acmr << " -> " << report.after.acmr
+        << ", ATVR " << report.before.atvr << " -> " << report.after.atvr << " (" << report.clusters << " overdraw clusters)" << std::endl;
+
+    MeshCache::store(filePath, data);
+    return data;
+}
+
+MeshData Mesh::parseMeshData(const std::string& filePath) {
+    MeshData data;
     ObjLoader loader;
-    auto [coords, textures, normals, faceIndices, textureIndices, normalIndices] = loader.loadFile(_filePath);
+    auto [coords, textures, normals, faceIndices, textureIndices, normalIndices] = loader.loadFileMapped(filePath);
+
+    data.indices.reserve(faceIndices.size());
 
-    _localVertices.clear();
-    _localVertices.reserve(faceIndices.size());
+    // Weld identical corners so the index buffer actually shares vertices
+    std::unordered_map<WeldKey, uint32_t, WeldKeyHash> welded;
+    welded.reserve(faceIndices.size());
 
     for (size_t i = 0; i < faceIndices.size(); ++i) {
-        const uint16_t vi = faceIndices[i];
-		const uint16_t ti = textureIndices[i];
-		const uint16_t ni = normalIndices[i];
+        const uint32_t vi = faceIndices[i];
+		const uint32_t ti = textureIndices[i];
+		const uint32_t ni = normalIndices[i];
 
         Vertex v{};
-		v.pos = glm::vec3(coords[vi].x, coords[vi].y, coords[vi].z) + getPos();
-		v.texCoord = glm::vec2(textures[ti].u, 1.0f - textures[ti].v);
-		v.normal = glm::vec3(normals[ni].x, normals[ni].y, normals[ni].z);
+		v.pos = vi < coords.size() ? glm::vec3(coords[vi].x, coords[vi].y, coords[vi].z) : glm::vec3(0.0f);
+		v.texCoord = ti < textures.size() ? glm::vec2(textures[ti].u, 1.0f - textures[ti].v) : glm::vec2(0.0f);
+		v.normal = ni < normals.size() ? glm::vec3(normals[ni].x, normals[ni].y, normals[ni].z) : glm::vec3(0.0f);
 		v.color = glm::vec3(1.0f, 1.0f, 1.0f); // Default color; can be modified later
 
-        _localVertices.push_back(v);
+        const auto [it, inserted] = welded.try_emplace(WeldKey::from(v), static_cast<uint32_t>(data.vertices.size()));
+        if (inserted) {
+            data.vertices.push_back(v);
+        }
+        data.indices.push_back(it->second);
     }
 
-    _localIndices.resize(static_cast<uint16_t>(_localVertices.size()));
-    for (uint16_t i = 0; i < static_cast<uint16_t>(_localIndices.size()); ++i) {
-        _localIndices[i] = i;
+    if (!data.vertices.empty()) {
+        data.boundsMin = data.boundsMax = data.vertices.front().pos;
+        for (const Vertex& v : data.vertices) {
+            data.boundsMin = glm::min(data.boundsMin, v.pos);
+            data.boundsMax = glm::max(data.boundsMax, v.pos);
+        }
+    }
+
+    std::cout << "Mesh: " << filePath << " welded " << faceIndices.size() << " corners to " << data.vertices.size()
+        << " vertices (" << (faceIndices.empty() ? 0.0 : 100.0 * (faceIndices.size() - data.vertices.size()) / faceIndices.size())
+        << "% fewer)" << std::endl;
+
+    return data;
+}
+
+void Mesh::create() {
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    MeshData data = loadMeshData(_filePath);
+    _localVertices = std::move(data.vertices);
+    _localIndices = std::move(data.indices);
+    _boundsMin = data.boundsMin;
+    _boundsMax = data.boundsMax;
+
+    // Cached vertices are object space; bake the placement in as before
+    const glm::vec3 offset = getPos();
+    for (Vertex& v : _localVertices) {
+        v.pos += offset;
     }
 
     setVertices(_localVertices);
     setIndices(_localIndices);
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "Mesh: " << _filePath << " ready in " << ms << " ms (" << _localVertices.size() << " vertices, "
+        << (getIndexType() == VK_INDEX_TYPE_UINT16 ? 16 : 32) << "-bit indices)" << std::endl;
 }
 
 void Mesh::move() {
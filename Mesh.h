@@ -4,6 +4,7 @@
 #include "ObjLoader.h"
 #include "glm/glm.hpp"
 #include "RenderContext.h"
+#include "MeshCache.h"
 #include <vector>
 #include <string>
 
@@ -12,7 +13,9 @@ class Mesh :
 {
     std::string _filePath;
 	std::vector<Vertex> _localVertices;
-	std::vector<uint16_t> _localIndices;
+	std::vector<uint32_t> _localIndices;
+	glm::vec3 _boundsMin{ 0.0f };
+	glm::vec3 _boundsMax{ 0.0f };
 
     public:
         Mesh(const glm::vec3& position, const Material& material, const std::string& filePath) : Shape(position, material), _filePath(filePath) {};
@@ -21,5 +24,14 @@ class Mesh :
         void create() override;
 		void move() override;
 		const std::string getModelPath() const { return _filePath; }
+		// Object-space bounds from the last create()
+		glm::vec3 getBoundsMin() const { return _boundsMin; }
+		glm::vec3 getBoundsMax() const { return _boundsMax; }
+		size_t localDataBytes() const override { return _localVertices.capacity() * sizeof(Vertex) + _localIndices.capacity() * sizeof(uint32_t); }
+
+		// Welded, reordered object-space mesh for filePath, from the .meshbin cache when it is current
+		static MeshData loadMeshData(const std::string& filePath);
+		// Parses and welds the OBJ without touching the cache or reordering
+		static MeshData parseMeshData(const std::string& filePath);
 };
 
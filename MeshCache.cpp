@@ -0,0 +1,189 @@
+#include "MeshCache.h"
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+	constexpr char kMagic[8] = { 'M', 'E', 'S', 'H', 'B', 'I', 'N', '\0' };
+
+	// On-disk layout: header, then vertexCount Vertex, then indexCount uint32_t, each at its recorded offset
+	struct MeshBinHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t vertexStride;
+		uint64_t sourceSize;
+		int64_t sourceMtime;
+		uint64_t sourceHash;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+		float boundsMin[3];
+		float boundsMax[3];
+	};
+
+	struct SourceStamp {
+		uint64_t size = 0;
+		int64_t mtime = 0;
+		uint64_t hash = 0;
+	};
+
+	uint64_t hashBytes(const char* data, size_t size) {
+		uint64_t h = 1469598103934665603ull; // FNV-1a
+		for (size_t i = 0; i < size; ++i) {
+			h = (h ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+		}
+		return h;
+	}
+
+	// Size and mtime come from the directory entry; the OBJ is only read when hashed
+	bool statSource(const std::string& objPath, SourceStamp& stamp) {
+		std::error_code ec;
+		const auto mtime = std::filesystem::last_write_time(objPath, ec);
+		if (ec) return false;
+		const auto size = std::filesystem::file_size(objPath, ec);
+		if (ec) return false;
+
+		stamp.size = size;
+		stamp.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+		return true;
+	}
+
+	void hashSource(const std::string& objPath, SourceStamp& stamp) {
+		MappedFile obj(objPath);
+		stamp.hash = hashBytes(obj.data(), obj.size());
+	}
+
+	// Best effort: a cache whose OBJ was only touched gets the new mtime, so the next load skips the hash again
+	void restampCache(const std::string& cachePath, int64_t mtime) {
+		std::fstream file(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+		if (!file.is_open()) return;
+		file.seekp(static_cast<std::streamoff>(offsetof(MeshBinHeader, sourceMtime)));
+		file.write(reinterpret_cast<const char*>(&mtime), sizeof(mtime));
+	}
+
+	// Size and mtime together are trusted as they are by build tools. Only a new mtime on a same-size OBJ, as after
+	// a fresh checkout or copy, pays for reading and hashing the whole file; touched reports that it matched then.
+	bool readCache(const std::string& cachePath, const std::string& objPath, SourceStamp& stamp, MeshData& out, bool& touched) {
+		MappedFile file(cachePath);
+		if (file.size() < sizeof(MeshBinHeader)) return false;
+
+		MeshBinHeader h{};
+		std::memcpy(&h, file.data(), sizeof(h));
+		if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != MeshCache::kVersion || h.vertexStride != sizeof(Vertex)) {
+			return false;
+		}
+		if (h.sourceSize != stamp.size) {
+			return false;
+		}
+		if (h.sourceMtime != stamp.mtime) {
+			hashSource(objPath, stamp);
+			if (h.sourceHash != stamp.hash) return false;
+			touched = true;
+		}
+
+		const uint64_t vertexBytes = uint64_t(h.vertexCount) * sizeof(Vertex);
+		const uint64_t indexBytes = uint64_t(h.indexCount) * sizeof(uint32_t);
+		if (h.vertexOffset + vertexBytes > file.size() || h.indexOffset + indexBytes > file.size()) {
+			return false;
+		}
+
+		// One bulk copy per array straight out of the mapping
+		out.vertices.resize(h.vertexCount);
+		out.indices.resize(h.indexCount);
+		std::memcpy(out.vertices.data(), file.data() + h.vertexOffset, static_cast<size_t>(vertexBytes));
+		std::memcpy(out.indices.data(), file.data() + h.indexOffset, static_cast<size_t>(indexBytes));
+		out.boundsMin = glm::vec3(h.boundsMin[0], h.boundsMin[1], h.boundsMin[2]);
+		out.boundsMax = glm::vec3(h.boundsMax[0], h.boundsMax[1], h.boundsMax[2]);
+		return true;
+	}
+
+	constexpr uint64_t alignUp(uint64_t v, uint64_t a) {
+		return (v + a - 1) & ~(a - 1);
+	}
+}
+
+std::string MeshCache::cachePathFor(const std::string& objPath)
+{
+	return std::filesystem::path(objPath).replace_extension(".meshbin").string();
+}
+
+bool MeshCache::load(const std::string& objPath, MeshData& out)
+{
+	const std::string cachePath = cachePathFor(objPath);
+	std::error_code ec;
+	if (!std::filesystem::exists(cachePath, ec)) return false;
+
+	try {
+		SourceStamp stamp;
+		if (!statSource(objPath, stamp)) return false;
+
+		bool touched = false;
+		if (!readCache(cachePath, objPath, stamp, out, touched)) return false;
+
+		// The mapping is closed by now, so the header can be rewritten on every platform
+		if (touched) restampCache(cachePath, stamp.mtime);
+		return true;
+	}
+	catch (const std::exception&) {
+		return false;
+	}
+}
+
+bool MeshCache::store(const std::string& objPath, const MeshData& data)
+{
+	const std::string cachePath = cachePathFor(objPath);
+	const std::string tmpPath = cachePath + ".tmp";
+
+	try {
+		SourceStamp stamp;
+		if (!statSource(objPath, stamp)) return false;
+		hashSource(objPath, stamp);
+
+		MeshBinHeader h{};
+		std::memcpy(h.magic, kMagic, sizeof(kMagic));
+		h.version = kVersion;
+		h.vertexStride = sizeof(Vertex);
+		h.sourceSize = stamp.size;
+		h.sourceMtime = stamp.mtime;
+		h.sourceHash = stamp.hash;
+		h.vertexCount = static_cast<uint32_t>(data.vertices.size());
+		h.indexCount = static_cast<uint32_t>(data.indices.size());
+		h.vertexOffset = alignUp(sizeof(MeshBinHeader), 16);
+		h.indexOffset = alignUp(h.vertexOffset + uint64_t(h.vertexCount) * sizeof(Vertex), 16);
+		for (int i = 0; i < 3; ++i) {
+			h.boundsMin[i] = data.boundsMin[i];
+			h.boundsMax[i] = data.boundsMax[i];
+		}
+
+		{
+			std::ofstream fout(tmpPath, std::ios::binary | std::ios::trunc);
+			if (!fout.is_open()) return false;
+
+			const char pad[16] = {};
+			fout.write(reinterpret_cast<const char*>(&h), sizeof(h));
+			fout.write(pad, static_cast<std::streamsize>(h.vertexOffset - sizeof(h)));
+			fout.write(reinterpret_cast<const char*>(data.vertices.data()), static_cast<std::streamsize>(data.vertices.size() * sizeof(Vertex)));
+			fout.write(pad, static_cast<std::streamsize>(h.indexOffset - (h.vertexOffset + uint64_t(h.vertexCount) * sizeof(Vertex))));
+			fout.write(reinterpret_cast<const char*>(data.indices.data()), static_cast<std::streamsize>(data.indices.size() * sizeof(uint32_t)));
+			if (!fout) return false;
+		}
+
+		// Replace atomically so a crash never leaves a half-written cache behind
+		std::error_code ec;
+		std::filesystem::rename(tmpPath, cachePath, ec);
+		if (ec) {
+			std::filesystem::remove(tmpPath, ec);
+			return false;
+		}
+		return true;
+	}
+	catch (const std::exception& e) {
+		std::cerr << "MeshCache: failed to write " << cachePath << ": " << e.what() << std::endl;
+		return false;
+	}
+}
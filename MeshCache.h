@@ -0,0 +1,32 @@
+#pragma once
+#include "Vertex.h"
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Welded, object-space mesh ready for upload
+struct MeshData {
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	glm::vec3 boundsMin{ 0.0f };
+	glm::vec3 boundsMax{ 0.0f };
+};
+
+// Versioned binary cache written next to an OBJ (models/foo.obj -> models/foo.meshbin).
+// Invalidated when the OBJ's size changes, when its mtime changes and its content hash no longer matches, or when
+// the Vertex layout changes. A matching size and mtime are accepted without reading the OBJ.
+class MeshCache final
+{
+public:
+	// 2: indices and vertices are stored in MeshOptimizer order
+	static constexpr uint32_t kVersion = 2;
+
+	static std::string cachePathFor(const std::string& objPath);
+
+	// Returns false on a miss or a stale/corrupt cache; out is left untouched then.
+	static bool load(const std::string& objPath, MeshData& out);
+
+	// Best effort: a failed write only costs the next startup a re-parse.
+	static bool store(const std::string& objPath, const MeshData& data);
+};
@@ -0,0 +1,61 @@
+#include "MeshLibrary.h"
+
+MeshHandle MeshLibrary::acquire(const std::string& modelPath)
+{
+	auto it = _assets.find(modelPath);
+	if (it != _assets.end()) {
+		return it->second;
+	}
+
+	auto asset = std::make_shared<MeshAsset>();
+	asset->path = modelPath;
+	asset->mesh = Mesh(glm::vec3(0.0f), Material(glm::vec4(1.0f), 0.0f, 1.0f, nullptr), modelPath);
+	asset->mesh.create();
+
+	_assets.emplace(modelPath, asset);
+	return asset;
+}
+
+void MeshLibrary::upload(const RenderContext& ctx)
+{
+	for (auto& [path, asset] : _assets) {
+		if (!asset->mesh.hasGeometry()) {
+			asset->mesh.uploadGeometry(ctx);
+		}
+	}
+}
+
+void MeshLibrary::destroy(const RenderContext& ctx)
+{
+	for (auto& [path, asset] : _assets) {
+		asset->mesh.destroyGeometry(ctx);
+	}
+}
+
+void MeshLibrary::releaseUnused(const RenderContext& ctx)
+{
+	for (auto it = _assets.begin(); it != _assets.end();) {
+		if (it->second.use_count() == 1) {
+			it->second->mesh.destroyGeometry(ctx);
+			it = _assets.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+long MeshLibrary::useCount(const std::string& modelPath) const
+{
+	auto it = _assets.find(modelPath);
+	// The library's own reference is not a user
+	return it == _assets.end() ? 0 : it->second.use_count() - 1;
+}
+
+void MeshLibrary::collectCpuMemory(std::vector<CpuMemoryEntry>& out) const
+{
+	for (const auto& [path, asset] : _assets) {
+		out.push_back({ "mesh local vertices", path, asset->mesh.localDataBytes() });
+		out.push_back({ "shape vertices", path, asset->mesh.vertexDataBytes() });
+	}
+}
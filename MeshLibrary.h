@@ -0,0 +1,49 @@
+#pragma once
+#include "Mesh.h"
+#include "MemoryReport.h"
+#include "RenderContext.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// One parsed mesh and one range of the geometry arena per model path, shared by every world object using it.
+struct MeshAsset {
+	std::string path;
+	Mesh mesh; // object space, geometry only; per-object descriptors live on the instances
+};
+
+using MeshHandle = std::shared_ptr<const MeshAsset>;
+
+class MeshLibrary final
+{
+	std::unordered_map<std::string, std::shared_ptr<MeshAsset>> _assets;
+
+public:
+	MeshLibrary() = default;
+	~MeshLibrary() = default;
+
+	// Owns arena ranges that must be released through destroy(ctx)
+	MeshLibrary(const MeshLibrary&) = delete;
+	MeshLibrary& operator=(const MeshLibrary&) = delete;
+	MeshLibrary(MeshLibrary&&) = default;
+	MeshLibrary& operator=(MeshLibrary&&) = default;
+
+	// Loads the model on first use; later calls for the same path share it.
+	// Once a path is loaded, acquiring it again only reads the map and is safe from several threads.
+	MeshHandle acquire(const std::string& modelPath);
+
+	// Uploads geometry for assets that have none yet
+	void upload(const RenderContext& ctx);
+
+	// Returns arena ranges but keeps the CPU meshes so upload() can restore them
+	void destroy(const RenderContext& ctx);
+
+	// Drops assets no longer referenced by any handle
+	void releaseUnused(const RenderContext& ctx);
+
+	size_t assetCount() const { return _assets.size(); }
+	long useCount(const std::string& modelPath) const;
+
+	// One entry per asset for each CPU copy of its geometry, named by model path
+	void collectCpuMemory(std::vector<CpuMemoryEntry>& out) const;
+};
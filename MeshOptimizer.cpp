@@ -0,0 +1,380 @@
+#include "MeshOptimizer.h"
+#include "Mesh.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	// Forsyth's scoring; the cache being optimized for is modelled as LRU
+	constexpr int kForsythCacheSize = 32;
+	constexpr float kCacheDecayPower = 1.5f;
+	constexpr float kLastTriScore = 0.75f;
+	constexpr float kValenceBoostScale = 2.0f;
+	constexpr float kValenceBoostPower = 0.5f;
+	constexpr uint32_t kMaxValence = 64;
+
+	struct ScoreTable {
+		float cache[kForsythCacheSize];
+		float valence[kMaxValence];
+
+		ScoreTable() {
+			for (int i = 0; i < kForsythCacheSize; ++i) {
+				// The three vertices of the last triangle score the same so the next one can go either way round
+				cache[i] = i < 3 ? kLastTriScore
+					: std::pow(1.0f - float(i - 3) / float(kForsythCacheSize - 3), kCacheDecayPower);
+			}
+			valence[0] = 0.0f;
+			for (uint32_t i = 1; i < kMaxValence; ++i) {
+				valence[i] = kValenceBoostScale * std::pow(float(i), -kValenceBoostPower);
+			}
+		}
+
+		float score(int cachePosition, uint32_t remaining) const {
+			if (remaining == 0) return -1.0f;
+			const float c = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+			return c + valence[std::min(remaining, kMaxValence - 1)];
+		}
+	};
+
+	const ScoreTable& scoreTable() {
+		static const ScoreTable table;
+		return table;
+	}
+
+	// FIFO post-transform cache; returns how many of the triangle's vertices missed
+	struct FifoCache {
+		std::vector<uint32_t> stamp; // time each vertex entered the cache
+		uint32_t time;
+		uint32_t size;
+
+		FifoCache(size_t vertexCount, uint32_t cacheSize) : stamp(vertexCount, 0), time(cacheSize + 1), size(cacheSize) {}
+
+		void reset() { time += size + 1; }
+
+		uint32_t add(const uint32_t* tri) {
+			uint32_t misses = 0;
+			for (int k = 0; k < 3; ++k) {
+				const uint32_t v = tri[k];
+				if (time - stamp[v] > size) {
+					stamp[v] = time++;
+					++misses;
+				}
+			}
+			return misses;
+		}
+	};
+
+	bool indicesInRange(const std::vector<uint32_t>& indices, size_t vertexCount) {
+		return std::all_of(indices.begin(), indices.end(), [vertexCount](uint32_t i) { return i < vertexCount; });
+	}
+}
+
+MeshOptimizer::CacheStats MeshOptimizer::analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+{
+	CacheStats stats;
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0 || vertexCount == 0) return stats;
+
+	FifoCache cache(vertexCount, cacheSize);
+	size_t misses = 0;
+	for (size_t t = 0; t < triangleCount; ++t) {
+		misses += cache.add(&indices[t * 3]);
+	}
+
+	std::vector<bool> used(vertexCount, false);
+	size_t unique = 0;
+	for (uint32_t i : indices) {
+		if (!used[i]) { used[i] = true; ++unique; }
+	}
+
+	stats.acmr = double(misses) / double(triangleCount);
+	stats.atvr = unique ? double(misses) / double(unique) : 0.0;
+	return stats;
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount < 2) return;
+
+	const ScoreTable& table = scoreTable();
+
+	// Vertex -> triangle adjacency in one flat array
+	std::vector<uint32_t> remaining(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; ++i) ++remaining[indices[i]];
+
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] = offsets[v] + remaining[v];
+
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	{
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for (uint32_t t = 0; t < triangleCount; ++t) {
+			for (int k = 0; k < 3; ++k) adjacency[fill[indices[t * 3 + k]]++] = t;
+		}
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t v = 0; v < vertexCount; ++v) vertexScore[v] = table.score(-1, remaining[v]);
+
+	std::vector<float> triangleScore(triangleCount);
+	for (size_t t = 0; t < triangleCount; ++t) {
+		triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> result;
+	result.reserve(triangleCount * 3);
+
+	// Room for the cache plus the three vertices pushed in front of it
+	uint32_t cache[kForsythCacheSize + 3];
+	uint32_t cacheUsed = 0;
+
+	size_t scanCursor = 0;
+	int64_t best = 0;
+	for (size_t t = 1; t < triangleCount; ++t) {
+		if (triangleScore[t] > triangleScore[best]) best = int64_t(t);
+	}
+
+	while (true) {
+		if (best < 0) {
+			// Nothing adjacent to the cache is left; restart from the next unemitted triangle
+			while (scanCursor < triangleCount && emitted[scanCursor]) ++scanCursor;
+			if (scanCursor == triangleCount) break;
+			best = int64_t(scanCursor);
+		}
+
+		const uint32_t* tri = &indices[size_t(best) * 3];
+		emitted[size_t(best)] = true;
+		result.insert(result.end(), tri, tri + 3);
+
+		// Drop the emitted triangle from each corner's adjacency list
+		for (int k = 0; k < 3; ++k) {
+			const uint32_t v = tri[k];
+			uint32_t* begin = &adjacency[offsets[v]];
+			uint32_t* end = begin + remaining[v];
+			*std::find(begin, end, uint32_t(best)) = *(end - 1);
+			--remaining[v];
+		}
+
+		// LRU update: the triangle's corners move to the front
+		uint32_t next[kForsythCacheSize + 3];
+		uint32_t nextUsed = 0;
+		for (int k = 0; k < 3; ++k) next[nextUsed++] = tri[k];
+		for (uint32_t i = 0; i < cacheUsed; ++i) {
+			const uint32_t v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2]) next[nextUsed++] = v;
+		}
+		for (uint32_t i = kForsythCacheSize; i < nextUsed; ++i) {
+			const uint32_t v = next[i];
+			cachePosition[v] = -1;
+			const float score = table.score(-1, remaining[v]);
+			for (uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; ++a) {
+				triangleScore[adjacency[a]] += score - vertexScore[v];
+			}
+			vertexScore[v] = score;
+		}
+		cacheUsed = std::min<uint32_t>(nextUsed, kForsythCacheSize);
+		std::copy(next, next + cacheUsed, cache);
+
+		for (uint32_t i = 0; i < cacheUsed; ++i) {
+			cachePosition[cache[i]] = int(i);
+		}
+
+		// Rescore the cached vertices and the triangles touching them, keeping the best as the next pick
+		for (uint32_t i = 0; i < cacheUsed; ++i) {
+			const uint32_t v = cache[i];
+			const float score = table.score(int(i), remaining[v]);
+			for (uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; ++a) {
+				triangleScore[adjacency[a]] += score - vertexScore[v];
+			}
+			vertexScore[v] = score;
+		}
+		best = -1;
+		float bestScore = -1.0f;
+		for (uint32_t i = 0; i < cacheUsed; ++i) {
+			const uint32_t v = cache[i];
+			for (uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; ++a) {
+				const uint32_t t = adjacency[a];
+				if (triangleScore[t] > bestScore) {
+					bestScore = triangleScore[t];
+					best = int64_t(t);
+				}
+			}
+		}
+	}
+
+	indices.swap(result);
+}
+
+size_t MeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, float threshold)
+{
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount < 2) return triangleCount;
+
+	// Hard boundaries: the cache fully missed, so starting a cluster here costs nothing
+	std::vector<size_t> hard;
+	{
+		FifoCache cache(vertices.size(), kReportCacheSize);
+		for (size_t t = 0; t < triangleCount; ++t) {
+			if (cache.add(&indices[t * 3]) == 3) hard.push_back(t);
+		}
+		if (hard.empty() || hard.front() != 0) hard.insert(hard.begin(), 0);
+		hard.push_back(triangleCount);
+	}
+
+	// Soft boundaries inside each hard cluster wherever the prefix is already at least as cache friendly as the whole cluster
+	std::vector<size_t> clusters;
+	{
+		FifoCache cache(vertices.size(), kReportCacheSize);
+		for (size_t h = 0; h + 1 < hard.size(); ++h) {
+			const size_t start = hard[h], end = hard[h + 1];
+
+			cache.reset();
+			size_t clusterMisses = 0;
+			for (size_t t = start; t < end; ++t) clusterMisses += cache.add(&indices[t * 3]);
+			const double target = double(clusterMisses) / double(end - start) * threshold;
+
+			cache.reset();
+			clusters.push_back(start);
+			size_t misses = 0, count = 0;
+			for (size_t t = start; t < end; ++t) {
+				misses += cache.add(&indices[t * 3]);
+				++count;
+				if (t + 1 < end && double(misses) / double(count) <= target && count >= 8) {
+					clusters.push_back(t + 1);
+					cache.reset();
+					misses = count = 0;
+				}
+			}
+		}
+		clusters.push_back(triangleCount);
+	}
+
+	const size_t clusterCount = clusters.size() - 1;
+	if (clusterCount < 2) return clusterCount;
+
+	// Area-weighted centroid and normal per cluster
+	glm::dvec3 meshCentroid(0.0);
+	double meshArea = 0.0;
+	std::vector<glm::dvec3> centroids(clusterCount, glm::dvec3(0.0));
+	std::vector<glm::dvec3> normals(clusterCount, glm::dvec3(0.0));
+	std::vector<double> areas(clusterCount, 0.0);
+
+	for (size_t c = 0; c < clusterCount; ++c) {
+		for (size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+			const glm::dvec3 p0(vertices[indices[t * 3]].pos);
+			const glm::dvec3 p1(vertices[indices[t * 3 + 1]].pos);
+			const glm::dvec3 p2(vertices[indices[t * 3 + 2]].pos);
+			const glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+			const double area = glm::length(n);
+			centroids[c] += (p0 + p1 + p2) * (area / 3.0);
+			normals[c] += n;
+			areas[c] += area;
+		}
+		meshCentroid += centroids[c];
+		meshArea += areas[c];
+	}
+	if (meshArea > 0.0) meshCentroid /= meshArea;
+
+	std::vector<double> sortKey(clusterCount, 0.0);
+	for (size_t c = 0; c < clusterCount; ++c) {
+		if (areas[c] <= 0.0) continue;
+		const glm::dvec3 centroid = centroids[c] / areas[c];
+		const double nl = glm::length(normals[c]);
+		if (nl > 0.0) sortKey[c] = glm::dot(centroid - meshCentroid, normals[c] / nl);
+	}
+
+	// Clusters facing away from the middle are likely in front of the rest, so draw them first
+	std::vector<size_t> order(clusterCount);
+	for (size_t c = 0; c < clusterCount; ++c) order[c] = c;
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (size_t c : order) {
+		result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+	}
+	indices.swap(result);
+	return clusterCount;
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+	constexpr uint32_t kUnassigned = UINT32_MAX;
+	std::vector<uint32_t> remap(vertices.size(), kUnassigned);
+	std::vector<Vertex> reordered;
+	reordered.reserve(vertices.size());
+
+	for (uint32_t& index : indices) {
+		if (remap[index] == kUnassigned) {
+			remap[index] = static_cast<uint32_t>(reordered.size());
+			reordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+	vertices.swap(reordered);
+}
+
+MeshOptimizer::Report MeshOptimizer::optimize(MeshData& data)
+{
+	Report report;
+	if (data.indices.size() % 3 != 0 || !indicesInRange(data.indices, data.vertices.size())) {
+		return report;
+	}
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	report.before = analyzeVertexCache(data.indices, data.vertices.size());
+
+	optimizeVertexCache(data.indices, data.vertices.size());
+	const std::vector<uint32_t> cacheOrder = data.indices;
+	report.clusters = optimizeOverdraw(data.indices, data.vertices);
+
+	// Cluster boundaries can still cost a little reuse; never trade more than the threshold for it
+	const CacheStats cacheOnly = analyzeVertexCache(cacheOrder, data.vertices.size());
+	if (analyzeVertexCache(data.indices, data.vertices.size()).acmr > cacheOnly.acmr * 1.05) {
+		data.indices = cacheOrder;
+		report.clusters = 1;
+	}
+
+	optimizeVertexFetch(data.vertices, data.indices);
+	report.after = analyzeVertexCache(data.indices, data.vertices.size());
+	report.ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	return report;
+}
+
+int runMeshOptimizerReport(const std::string& modelDir)
+{
+	std::vector<std::filesystem::path> models;
+	for (const auto& entry : std::filesystem::directory_iterator(modelDir)) {
+		std::string ext = entry.path().extension().string();
+		std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		if (entry.is_regular_file() && ext == ".obj") models.push_back(entry.path());
+	}
+	std::sort(models.begin(), models.end());
+
+	std::cout << std::fixed << std::setprecision(3)
+		<< "Mesh optimizer (FIFO " << MeshOptimizer::kReportCacheSize << "): model, triangles, ACMR before -> after, ATVR before -> after, clusters, ms" << std::endl;
+
+	int failures = 0;
+	for (const auto& path : models) {
+		try {
+			MeshData data = Mesh::parseMeshData(path.string());
+			const MeshOptimizer::Report r = MeshOptimizer::optimize(data);
+			std::cout << "  " << path.filename().string() << ", " << data.indices.size() / 3
+				<< ", " << r.before.acmr << " -> " << r.after.acmr
+				<< ", " << r.before.atvr << " -> " << r.after.atvr
+				<< ", " << r.clusters << ", " << r.ms << std::endl;
+		}
+		catch (const std::exception& e) {
+			std::cerr << "  " << path.string() << ": " << e.what() << std::endl;
+			++failures;
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "MeshCache.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Offline reordering applied to welded meshes before they are written to the .meshbin cache.
+// Triangles are ordered for the post-transform vertex cache (Forsyth's linear-speed algorithm),
+// then grouped into clusters sorted outside-in to cut overdraw, then vertices are renumbered in
+// first-use order so vertex fetch walks memory forwards. Geometry and winding are unchanged.
+class MeshOptimizer final
+{
+public:
+	// Simulated post-transform FIFO size used for reporting and overdraw cluster boundaries
+	static constexpr uint32_t kReportCacheSize = 16;
+
+	struct CacheStats {
+		double acmr = 0.0; // vertex shader invocations per triangle (0.5 is the floor for a regular grid, 3 is no reuse)
+		double atvr = 0.0; // vertex shader invocations per unique vertex (1 is ideal)
+	};
+
+	struct Report {
+		CacheStats before;
+		CacheStats after;
+		size_t clusters = 0;
+		double ms = 0.0;
+	};
+
+	static CacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = kReportCacheSize);
+
+	// Reorders triangles; the index count and the set of triangles are preserved
+	static void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+	// Splits the cache-ordered list into clusters and draws the outward-facing ones first.
+	// Cluster boundaries are only placed where ACMR stays within threshold of the input order. Returns the cluster count.
+	static size_t optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, float threshold = 1.05f);
+
+	// Renumbers vertices in the order the index buffer first references them; unreferenced vertices are dropped
+	static void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+	// Runs all three stages in order. Meshes with out-of-range indices are left untouched.
+	static Report optimize(MeshData& data);
+};
+
+// Parses each OBJ in modelDir (bypassing the cache) and prints ACMR/ATVR before and after optimize().
+// Returns non-zero if a model failed to load.
+int runMeshOptimizerReport(const std::string& modelDir = "models");
@@ -0,0 +1,286 @@
+#include "MipChain.h"
+#include "UploadBatcher.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIPCHAIN_SSE2 1
+#endif
+
+namespace
+{
+	// 14-bit linear values: four samples plus the rounding bias still fit a 16-bit lane
+	constexpr uint32_t kLinearMax = 16383;
+
+	struct ConversionTables {
+		std::array<uint16_t, 256> srgbToLinear{};
+		std::array<uint16_t, 256> unormToLinear{};
+		std::vector<uint8_t> linearToSrgb;
+		std::vector<uint8_t> linearToUnorm;
+	};
+
+	const ConversionTables& tables()
+	{
+		static const ConversionTables t = [] {
+			ConversionTables c;
+			for (uint32_t i = 0; i < 256; ++i) {
+				const double s = i / 255.0;
+				const double l = s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4);
+				c.srgbToLinear[i] = static_cast<uint16_t>(std::lround(l * kLinearMax));
+				c.unormToLinear[i] = static_cast<uint16_t>((i * kLinearMax + 127) / 255);
+			}
+			c.linearToSrgb.resize(kLinearMax + 1);
+			c.linearToUnorm.resize(kLinearMax + 1);
+			for (uint32_t v = 0; v <= kLinearMax; ++v) {
+				const double l = static_cast<double>(v) / kLinearMax;
+				const double s = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+				c.linearToSrgb[v] = static_cast<uint8_t>(std::clamp(std::lround(s * 255.0), 0L, 255L));
+				c.linearToUnorm[v] = static_cast<uint8_t>((v * 255 + kLinearMax / 2) / kLinearMax);
+			}
+			return c;
+		}();
+		return t;
+	}
+
+	// Alpha is always treated as linear
+	void decode(const uint8_t* rgba, size_t texels, bool srgb, uint16_t* out)
+	{
+		const ConversionTables& t = tables();
+		const auto& colour = srgb ? t.srgbToLinear : t.unormToLinear;
+		for (size_t i = 0; i < texels * 4; i += 4) {
+			out[i + 0] = colour[rgba[i + 0]];
+			out[i + 1] = colour[rgba[i + 1]];
+			out[i + 2] = colour[rgba[i + 2]];
+			out[i + 3] = t.unormToLinear[rgba[i + 3]];
+		}
+	}
+
+	void encode(const uint16_t* in, size_t texels, bool srgb, uint8_t* rgba)
+	{
+		const ConversionTables& t = tables();
+		const auto& colour = srgb ? t.linearToSrgb : t.linearToUnorm;
+		for (size_t i = 0; i < texels * 4; i += 4) {
+			rgba[i + 0] = colour[in[i + 0]];
+			rgba[i + 1] = colour[in[i + 1]];
+			rgba[i + 2] = colour[in[i + 2]];
+			rgba[i + 3] = t.linearToUnorm[in[i + 3]];
+		}
+	}
+
+	void boxTexel(const uint16_t* src, uint32_t width, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, uint16_t* out)
+	{
+		const uint16_t* a = src + (size_t(y0) * width + x0) * 4;
+		const uint16_t* b = src + (size_t(y0) * width + x1) * 4;
+		const uint16_t* c = src + (size_t(y1) * width + x0) * 4;
+		const uint16_t* d = src + (size_t(y1) * width + x1) * 4;
+		for (int ch = 0; ch < 4; ++ch) {
+			out[ch] = static_cast<uint16_t>((a[ch] + b[ch] + c[ch] + d[ch] + 2) >> 2);
+		}
+	}
+}
+
+uint32_t MipChain::levelCount(uint32_t width, uint32_t height)
+{
+	uint32_t levels = 1;
+	for (uint32_t size = std::max(width, height); size > 1; size >>= 1) {
+		++levels;
+	}
+	return levels;
+}
+
+bool MipChain::canBlit(VkPhysicalDevice physicalDevice, VkFormat format)
+{
+	VkFormatProperties props{};
+	vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
+	const VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT
+		| VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	return (props.optimalTilingFeatures & needed) == needed;
+}
+
+bool MipChain::isSrgb(VkFormat format)
+{
+	return format == VK_FORMAT_R8G8B8A8_SRGB || format == VK_FORMAT_B8G8R8A8_SRGB;
+}
+
+void MipChain::upload(UploadBatcher& uploader, VkPhysicalDevice physicalDevice, VkImage image, VkFormat format,
+	uint32_t width, uint32_t height, const void* const* layers, uint32_t layerCount, uint32_t mipLevels)
+{
+	mipLevels = std::min(mipLevels, levelCount(width, height));
+	if (mipLevels <= 1) {
+		uploader.uploadImage(image, width, height, 4, layers, layerCount);
+		return;
+	}
+
+	if (canBlit(physicalDevice, format)) {
+		uploader.uploadImage(image, width, height, 4, layers, layerCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
+		recordBlits(uploader.commandBuffer(), image, width, height, mipLevels, layerCount);
+		return;
+	}
+
+	// No linear blit for this format: filter on the CPU and stage every level
+	const bool srgb = isSrgb(format);
+	std::vector<std::vector<Level>> chains(layerCount);
+	for (uint32_t layer = 0; layer < layerCount; ++layer) {
+		chains[layer] = buildCpu(static_cast<const uint8_t*>(layers[layer]), width, height, srgb);
+	}
+
+	std::vector<std::vector<const void*>> levelLayers(mipLevels, std::vector<const void*>(layerCount));
+	std::vector<UploadBatcher::ImageLevel> levels(mipLevels);
+	levels[0] = { width, height, layers };
+	for (uint32_t level = 1; level < mipLevels; ++level) {
+		for (uint32_t layer = 0; layer < layerCount; ++layer) {
+			levelLayers[level][layer] = chains[layer][level - 1].rgba.data();
+		}
+		const Level& first = chains[0][level - 1];
+		levels[level] = { first.width, first.height, levelLayers[level].data() };
+	}
+	uploader.uploadImageLevels(image, levels.data(), mipLevels, mipLevels, 4, layerCount);
+}
+
+void MipChain::recordBlits(VkCommandBuffer cmd, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layerCount)
+{
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = layerCount;
+	barrier.subresourceRange.levelCount = 1;
+
+	int32_t mipWidth = static_cast<int32_t>(width);
+	int32_t mipHeight = static_cast<int32_t>(height);
+
+	for (uint32_t level = 1; level < mipLevels; ++level) {
+		// Previous level becomes the blit source
+		barrier.subresourceRange.baseMipLevel = level - 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		const int32_t nextWidth = std::max(1, mipWidth / 2);
+		const int32_t nextHeight = std::max(1, mipHeight / 2);
+
+		VkImageBlit blit{};
+		blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = level - 1;
+		blit.srcSubresource.baseArrayLayer = 0;
+		blit.srcSubresource.layerCount = layerCount;
+		blit.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.mipLevel = level;
+		blit.dstSubresource.baseArrayLayer = 0;
+		blit.dstSubresource.layerCount = layerCount;
+		vkCmdBlitImage(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1, &blit, VK_FILTER_LINEAR);
+
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		mipWidth = nextWidth;
+		mipHeight = nextHeight;
+	}
+
+	// Last level was only ever written
+	barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+std::vector<MipChain::Level> MipChain::buildCpu(const uint8_t* rgba, uint32_t width, uint32_t height, bool srgb)
+{
+	std::vector<Level> levels;
+	const uint32_t count = levelCount(width, height);
+	if (count <= 1) return levels;
+	levels.reserve(count - 1);
+
+	std::vector<uint16_t> current(size_t(width) * height * 4);
+	std::vector<uint16_t> next;
+	decode(rgba, size_t(width) * height, srgb, current.data());
+
+	for (uint32_t level = 1; level < count; ++level) {
+		const uint32_t nextWidth = std::max(1u, width / 2);
+		const uint32_t nextHeight = std::max(1u, height / 2);
+		next.resize(size_t(nextWidth) * nextHeight * 4);
+		downsample(current.data(), width, height, next.data());
+
+		Level out;
+		out.width = nextWidth;
+		out.height = nextHeight;
+		out.rgba.resize(next.size());
+		encode(next.data(), size_t(nextWidth) * nextHeight, srgb, out.rgba.data());
+		levels.push_back(std::move(out));
+
+		current.swap(next);
+		width = nextWidth;
+		height = nextHeight;
+	}
+	return levels;
+}
+
+void MipChain::downsampleReference(const uint16_t* src, uint32_t width, uint32_t height, uint16_t* dst)
+{
+	const uint32_t dstWidth = std::max(1u, width / 2);
+	const uint32_t dstHeight = std::max(1u, height / 2);
+	for (uint32_t y = 0; y < dstHeight; ++y) {
+		const uint32_t y0 = std::min(2 * y, height - 1);
+		const uint32_t y1 = std::min(2 * y + 1, height - 1);
+		for (uint32_t x = 0; x < dstWidth; ++x) {
+			const uint32_t x0 = std::min(2 * x, width - 1);
+			const uint32_t x1 = std::min(2 * x + 1, width - 1);
+			boxTexel(src, width, x0, x1, y0, y1, dst + (size_t(y) * dstWidth + x) * 4);
+		}
+	}
+}
+
+void MipChain::downsample(const uint16_t* src, uint32_t width, uint32_t height, uint16_t* dst)
+{
+#ifdef MIPCHAIN_SSE2
+	if (width < 4 || height < 2) {
+		downsampleReference(src, width, height, dst);
+		return;
+	}
+
+	const uint32_t dstWidth = width / 2;
+	const uint32_t dstHeight = height / 2;
+	const __m128i bias = _mm_set1_epi16(2);
+	for (uint32_t y = 0; y < dstHeight; ++y) {
+		const uint16_t* row0 = src + size_t(2 * y) * width * 4;
+		const uint16_t* row1 = row0 + size_t(width) * 4;
+		uint16_t* out = dst + size_t(y) * dstWidth * 4;
+
+		// Two destination texels from four source columns per step
+		uint32_t x = 0;
+		for (; x + 2 <= dstWidth; x += 2) {
+			const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8 * x));
+			const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8 * x + 8));
+			const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8 * x));
+			const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8 * x + 8));
+			const __m128i s0 = _mm_add_epi16(a0, b0); // columns 2x, 2x+1
+			const __m128i s1 = _mm_add_epi16(a1, b1); // columns 2x+2, 2x+3
+			const __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * x), _mm_srli_epi16(_mm_add_epi16(sum, bias), 2));
+		}
+		for (; x < dstWidth; ++x) {
+			boxTexel(src, width, 2 * x, std::min(2 * x + 1, width - 1), 2 * y, 2 * y + 1, out + 4 * x);
+		}
+	}
+#else
+	downsampleReference(src, width, height, dst);
+#endif
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+class UploadBatcher;
+
+// Full mip chains for RGBA8 textures, built on the upload path.
+// Uses a GPU blit chain when the format supports linear blits, otherwise a CPU 2x2 box filter.
+class MipChain final
+{
+public:
+	struct Level {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<uint8_t> rgba;
+	};
+
+	static uint32_t levelCount(uint32_t width, uint32_t height);
+
+	// True when optimal-tiling images of this format can be blitted with linear filtering
+	static bool canBlit(VkPhysicalDevice physicalDevice, VkFormat format);
+
+	// Stages level 0 of every layer and fills the remaining levels. The image must have TRANSFER_SRC usage
+	// when blits are available; it ends in SHADER_READ_ONLY_OPTIMAL once the batch is flushed.
+	static void upload(UploadBatcher& uploader, VkPhysicalDevice physicalDevice, VkImage image, VkFormat format,
+		uint32_t width, uint32_t height, const void* const* layers, uint32_t layerCount, uint32_t mipLevels);
+
+	// Blits each level into the next; every level must be in TRANSFER_DST_OPTIMAL and all end in SHADER_READ_ONLY_OPTIMAL
+	static void recordBlits(VkCommandBuffer cmd, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layerCount);
+
+	// Levels 1..n-1 of an RGBA8 image. sRGB colour channels are filtered in linear light.
+	static std::vector<Level> buildCpu(const uint8_t* rgba, uint32_t width, uint32_t height, bool srgb);
+
+	// One 2x2 box step over 16-bit RGBA into max(1, width/2) x max(1, height/2); SSE2 where available
+	static void downsample(const uint16_t* src, uint32_t width, uint32_t height, uint16_t* dst);
+
+	// Scalar version of downsample that the SIMD path must match exactly
+	static void downsampleReference(const uint16_t* src, uint32_t width, uint32_t height, uint16_t* dst);
+
+	static bool isSrgb(VkFormat format);
+};
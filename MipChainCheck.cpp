@@ -0,0 +1,135 @@
+#include "MipChainCheck.h"
+#include "MipChain.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Largest difference in 8-bit codes from the float reference. The CPU chain keeps 14-bit linear values between
+	// levels, so rounding adds up over a deep chain; a wrong lane or table is off by far more.
+	constexpr int kTolerance = 1;
+
+	struct Size {
+		uint32_t width;
+		uint32_t height;
+	};
+
+	constexpr Size kSizes[] = {
+		{ 1, 1 }, { 2, 2 }, { 4, 4 }, { 64, 64 }, { 256, 256 },
+		{ 3, 5 }, { 5, 3 }, { 7, 9 }, { 100, 37 }, { 255, 129 }, { 513, 257 },
+		{ 1, 37 }, { 37, 1 }, { 1, 1024 }, { 1024, 1 },
+	};
+
+	float toLinear(uint8_t value, bool srgb)
+	{
+		const float s = value / 255.0f;
+		if (!srgb) return s;
+		return s <= 0.04045f ? s / 12.92f : std::pow((s + 0.055f) / 1.055f, 2.4f);
+	}
+
+	uint8_t fromLinear(float l, bool srgb)
+	{
+		const float s = !srgb ? l : (l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f);
+		return static_cast<uint8_t>(std::clamp(std::lround(s * 255.0f), 0L, 255L));
+	}
+
+	// Same footprint as MipChain: texel (x, y) averages source columns 2x, 2x+1 and rows 2y, 2y+1, each clamped
+	// to the edge, so a 1-texel dimension repeats itself and an odd one drops its last row or column
+	std::vector<float> boxStep(const std::vector<float>& src, uint32_t width, uint32_t height)
+	{
+		const uint32_t dstWidth = std::max(1u, width / 2);
+		const uint32_t dstHeight = std::max(1u, height / 2);
+		std::vector<float> dst(size_t(dstWidth) * dstHeight * 4);
+		for (uint32_t y = 0; y < dstHeight; ++y) {
+			const uint32_t y0 = std::min(2 * y, height - 1);
+			const uint32_t y1 = std::min(2 * y + 1, height - 1);
+			for (uint32_t x = 0; x < dstWidth; ++x) {
+				const uint32_t x0 = std::min(2 * x, width - 1);
+				const uint32_t x1 = std::min(2 * x + 1, width - 1);
+				for (uint32_t ch = 0; ch < 4; ++ch) {
+					const float sum = src[(size_t(y0) * width + x0) * 4 + ch] + src[(size_t(y0) * width + x1) * 4 + ch]
+						+ src[(size_t(y1) * width + x0) * 4 + ch] + src[(size_t(y1) * width + x1) * 4 + ch];
+					dst[(size_t(y) * dstWidth + x) * 4 + ch] = sum * 0.25f;
+				}
+			}
+		}
+		return dst;
+	}
+
+	// Worst channel difference over every level, or -1 if the level count or sizes differ
+	int compareChain(const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height, bool srgb)
+	{
+		const std::vector<MipChain::Level> levels = MipChain::buildCpu(rgba.data(), width, height, srgb);
+		if (levels.size() + 1 != MipChain::levelCount(width, height)) return -1;
+
+		// Alpha is linear in either format, as in MipChain
+		std::vector<float> current(rgba.size());
+		for (size_t i = 0; i < rgba.size(); ++i) current[i] = toLinear(rgba[i], srgb && i % 4 != 3);
+
+		int worst = 0;
+		for (const MipChain::Level& level : levels) {
+			current = boxStep(current, width, height);
+			width = std::max(1u, width / 2);
+			height = std::max(1u, height / 2);
+			if (level.width != width || level.height != height || level.rgba.size() != current.size()) return -1;
+			for (size_t i = 0; i < current.size(); ++i) {
+				const int expected = fromLinear(current[i], srgb && i % 4 != 3);
+				worst = std::max(worst, std::abs(expected - static_cast<int>(level.rgba[i])));
+			}
+		}
+		return worst;
+	}
+
+	// downsample must match downsampleReference exactly, including the edges the SIMD loop leaves to scalar code
+	bool sameDownsample(std::mt19937& rng, uint32_t width, uint32_t height)
+	{
+		std::uniform_int_distribution<uint32_t> value(0, 16383);
+		std::vector<uint16_t> src(size_t(width) * height * 4);
+		for (uint16_t& v : src) v = static_cast<uint16_t>(value(rng));
+		const size_t dstSize = size_t(std::max(1u, width / 2)) * std::max(1u, height / 2) * 4;
+		std::vector<uint16_t> simd(dstSize);
+		std::vector<uint16_t> scalar(dstSize);
+		MipChain::downsample(src.data(), width, height, simd.data());
+		MipChain::downsampleReference(src.data(), width, height, scalar.data());
+		return simd == scalar;
+	}
+}
+
+int runMipChainCheck()
+{
+	std::mt19937 rng(0x5eed);
+	std::uniform_int_distribution<uint32_t> byte(0, 255);
+	bool ok = true;
+
+	std::cout << "MipChain check: buildCpu against a float box filter, tolerance " << kTolerance << std::endl;
+	for (const Size& size : kSizes) {
+		std::vector<uint8_t> noise(size_t(size.width) * size.height * 4);
+		for (uint8_t& v : noise) v = static_cast<uint8_t>(byte(rng));
+		std::vector<uint8_t> flat(noise.size());
+		for (size_t i = 0; i < flat.size(); ++i) flat[i] = static_cast<uint8_t>(i % 4 == 3 ? 255 : 37 * (i % 4 + 1));
+
+		for (const bool srgb : { false, true }) {
+			const int noiseError = compareChain(noise, size.width, size.height, srgb);
+			// A constant image filters to itself at every level
+			const int flatError = compareChain(flat, size.width, size.height, srgb);
+			const bool pass = noiseError >= 0 && noiseError <= kTolerance && flatError == 0;
+			ok = ok && pass;
+			std::cout << "  " << size.width << "x" << size.height << (srgb ? " sRGB " : " UNORM")
+				<< ": max error " << noiseError << ", flat " << flatError << (pass ? "" : "  MISMATCH") << std::endl;
+		}
+
+		if (!sameDownsample(rng, size.width, size.height)) {
+			ok = false;
+			std::cout << "  " << size.width << "x" << size.height << ": downsample differs from downsampleReference" << std::endl;
+		}
+	}
+
+	std::cout << (ok ? "MipChain check passed" : "MipChain check FAILED") << std::endl;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Compares MipChain::buildCpu against a scalar float box filter on UNORM and sRGB images of power-of-two,
+// non-power-of-two and 1xN sizes, and MipChain::downsample against downsampleReference bit for bit.
+// Returns non-zero if any level is further from the float reference than the 14-bit path allows, or the
+// SIMD step differs from the scalar one.
+int runMipChainCheck();
@@ -1,10 +1,139 @@
 #include "ObjLoader.h"
+#include "MappedFile.h"
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <string_view>
+#include <thread>
 
+namespace {
+    // Per-chunk results of loadFileMapped, concatenated in file order afterwards.
+    struct ObjChunk {
+        std::vector<Coordinates> coordinates;
+        std::vector<ObjTexCoord> textures;
+        std::vector<Normal> normals;
+        std::vector<uint32_t> vertexIndices;
+        std::vector<uint32_t> textureIndices;
+        std::vector<uint32_t> normalIndices;
+    };
 
+    // Chunks smaller than this are not worth a thread.
+    constexpr size_t kMinChunkBytes = 64 * 1024;
 
+    inline bool isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    inline std::string_view nextToken(const char*& p, const char* end) {
+        while (p < end && isBlank(*p)) ++p;
+        const char* start = p;
+        while (p < end && !isBlank(*p)) ++p;
+        return std::string_view(start, static_cast<size_t>(p - start));
+    }
+
+    inline float parseFloat(std::string_view token) {
+        float value = 0.0f;
+        const char* first = token.data();
+        const char* last = first + token.size();
+        if (first < last && *first == '+') ++first;
+        std::from_chars(first, last, value);
+        return value;
+    }
+
+    // Mirrors the std::stoi based conversion in loadFile: 1-based to 0-based, missing -> UINT32_MAX.
+    inline uint32_t parseIndex(std::string_view token) {
+        if (token.empty()) {
+            return UINT32_MAX;
+        }
+        const char* first = token.data();
+        const char* last = first + token.size();
+        if (*first == '+') ++first;
+        int value = 0;
+        std::from_chars(first, last, value);
+        return static_cast<uint32_t>(value) - 1;
+    }
+
+    void parseChunk(const char* p, const char* end, ObjChunk& out) {
+        std::vector<uint32_t> vIdx;
+        std::vector<uint32_t> tIdx;
+        std::vector<uint32_t> nIdx;
+
+        while (p < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+            if (!lineEnd) lineEnd = end;
+
+            const std::string_view tag = nextToken(p, lineEnd);
+            if (tag == "v") {
+                Coordinates v{};
+                v.x = parseFloat(nextToken(p, lineEnd));
+                v.y = parseFloat(nextToken(p, lineEnd));
+                v.z = parseFloat(nextToken(p, lineEnd));
+                out.coordinates.push_back(v);
+            }
+            else if (tag == "vt") {
+                ObjTexCoord t{};
+                t.u = parseFloat(nextToken(p, lineEnd));
+                t.v = parseFloat(nextToken(p, lineEnd));
+                out.textures.push_back(t);
+            }
+            else if (tag == "vn") {
+                Normal n{};
+                n.x = parseFloat(nextToken(p, lineEnd));
+                n.y = parseFloat(nextToken(p, lineEnd));
+                n.z = parseFloat(nextToken(p, lineEnd));
+                out.normals.push_back(n);
+            }
+            else if (tag == "f") {
+                vIdx.clear();
+                tIdx.clear();
+                nIdx.clear();
+
+                for (std::string_view token = nextToken(p, lineEnd); !token.empty(); token = nextToken(p, lineEnd)) {
+                    const size_t firstSlash = token.find('/');
+                    if (firstSlash == std::string_view::npos) {
+                        vIdx.push_back(parseIndex(token));
+                        tIdx.push_back(UINT32_MAX);
+                        nIdx.push_back(UINT32_MAX);
+                        continue;
+                    }
+
+                    vIdx.push_back(parseIndex(token.substr(0, firstSlash)));
+                    const size_t secondSlash = token.find('/', firstSlash + 1);
+                    if (secondSlash == std::string_view::npos) {
+                        tIdx.push_back(parseIndex(token.substr(firstSlash + 1)));
+                        nIdx.push_back(UINT32_MAX);
+                    }
+                    else {
+                        tIdx.push_back(parseIndex(token.substr(firstSlash + 1, secondSlash - firstSlash - 1)));
+                        nIdx.push_back(parseIndex(token.substr(secondSlash + 1)));
+                    }
+                }
+
+                for (size_t j = 1; j + 1 < vIdx.size(); ++j) {
+                    out.vertexIndices.insert(out.vertexIndices.end(), { vIdx[0], vIdx[j], vIdx[j + 1] });
+                    out.textureIndices.insert(out.textureIndices.end(), { tIdx[0], tIdx[j], tIdx[j + 1] });
+                    out.normalIndices.insert(out.normalIndices.end(), { nIdx[0], nIdx[j], nIdx[j + 1] });
+                }
+            }
+
+            p = lineEnd + 1;
+        }
+    }
+
+    template <typename T>
+    void appendAll(std::vector<T>& dst, const std::vector<ObjChunk>& chunks, std::vector<T> ObjChunk::* member) {
+        size_t total = 0;
+        for (const auto& c : chunks) total += (c.*member).size();
+        dst.reserve(total);
+        for (const auto& c : chunks) dst.insert(dst.end(), (c.*member).begin(), (c.*member).end());
+    }
+}
 
 
-std::tuple<std::vector<Coordinates>, std::vector<ObjTexCoord>, std::vector<Normal>, std::vector<uint16_t>, std::vector<uint16_t>, std::vector<uint16_t>> ObjLoader::loadFile(const std::string& filename) const
+
+
+
+std::tuple<std::vector<Coordinates>, std::vector<ObjTexCoord>, std::vector<Normal>, std::vector<uint32_t>, std::vector<uint32_t>, std::vector<uint32_t>> ObjLoader::loadFile(const std::string& filename) const
 {    
     std::ifstream fin(filename);
     if (!fin.is_open()) {
@@ -50,9 +179,9 @@ std::tuple<std::vector<Coordinates>, std::vector<ObjTexCoord>, std::vector<Norma
             }
 
             std::istringstream sline(line);
-            std::vector<uint16_t> vIdx;
-            std::vector<uint16_t> tIdx;
-            std::vector<uint16_t> nIdx;
+            std::vector<uint32_t> vIdx;
+            std::vector<uint32_t> tIdx;
+            std::vector<uint32_t> nIdx;
 
             std::string token;
             while (sline >> token) {
@@ -96,9 +225,9 @@ std::tuple<std::vector<Coordinates>, std::vector<ObjTexCoord>, std::vector<Norma
                     }
                 }
 
-                const uint16_t vi = hasVi ? static_cast<uint16_t>(vi_u32 - 1) : UINT16_MAX;
-                const uint16_t ti = hasTi ? static_cast<uint16_t>(ti_u32 - 1) : UINT16_MAX;
-                const uint16_t ni = hasNi ? static_cast<uint16_t>(ni_u32 - 1) : UINT16_MAX;
+                const uint32_t vi = hasVi ? vi_u32 - 1 : UINT32_MAX;
+                const uint32_t ti = hasTi ? ti_u32 - 1 : UINT32_MAX;
+                const uint32_t ni = hasNi ? ni_u32 - 1 : UINT32_MAX;
 
                 vIdx.push_back(vi);
                 tIdx.push_back(ti);
@@ -121,9 +250,9 @@ std::tuple<std::vector<Coordinates>, std::vector<ObjTexCoord>, std::vector<Norma
         }
     }
 
-    std::vector<uint16_t> allVertexIndices;
-    std::vector<uint16_t> allTextureIndices;
-    std::vector<uint16_t> allNormalIndices;
+    std::vector<uint32_t> allVertexIndices;
+    std::vector<uint32_t> allTextureIndices;
+    std::vector<uint32_t> allNormalIndices;
 
     for (const auto& o : obj) {
         allVertexIndices.insert(allVertexIndices.end(), o.vertexIndices.begin(), o.vertexIndices.end());
@@ -134,5 +263,65 @@ std::tuple<std::vector<Coordinates>, std::vector<ObjTexCoord>, std::vector<Norma
     return { coordinates, textures, normals, allVertexIndices, allTextureIndices, allNormalIndices };
 }
 
+std::tuple<std::vector<Coordinates>, std::vector<ObjTexCoord>, std::vector<Normal>, std::vector<uint32_t>, std::vector<uint32_t>, std::vector<uint32_t>> ObjLoader::loadFileMapped(const std::string& filename, unsigned threadCount) const
+{
+    MappedFile file(filename);
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount, file.size() / kMinChunkBytes));
+
+    // Split on line boundaries so no line straddles two chunks
+    std::vector<const char*> bounds(chunkCount + 1, end);
+    bounds[0] = begin;
+    for (size_t i = 1; i < chunkCount; ++i) {
+        const char* p = std::max(begin + file.size() * i / chunkCount, bounds[i - 1]);
+        const char* nl = p < end ? static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p))) : nullptr;
+        bounds[i] = nl ? nl + 1 : end;
+    }
+
+    std::vector<ObjChunk> chunks(chunkCount);
+    if (chunkCount == 1) {
+        parseChunk(bounds[0], bounds[1], chunks[0]);
+    }
+    else {
+        std::vector<std::exception_ptr> errors(chunkCount);
+        std::vector<std::thread> workers;
+        workers.reserve(chunkCount - 1);
+        for (size_t i = 1; i < chunkCount; ++i) {
+            workers.emplace_back([&, i]() {
+                try { parseChunk(bounds[i], bounds[i + 1], chunks[i]); }
+                catch (...) { errors[i] = std::current_exception(); }
+            });
+        }
+        try { parseChunk(bounds[0], bounds[1], chunks[0]); }
+        catch (...) { errors[0] = std::current_exception(); }
+
+        for (auto& w : workers) w.join();
+        for (auto& e : errors) {
+            if (e) std::rethrow_exception(e);
+        }
+    }
+
+    std::vector<Coordinates> coordinates;
+    std::vector<ObjTexCoord> textures;
+    std::vector<Normal> normals;
+    std::vector<uint32_t> allVertexIndices;
+    std::vector<uint32_t> allTextureIndices;
+    std::vector<uint32_t> allNormalIndices;
 
+    // Faces always land in the most recent object, so concatenating chunks in order
+    // reproduces loadFile's per-object concatenation.
+    appendAll(coordinates, chunks, &ObjChunk::coordinates);
+    appendAll(textures, chunks, &ObjChunk::textures);
+    appendAll(normals, chunks, &ObjChunk::normals);
+    appendAll(allVertexIndices, chunks, &ObjChunk::vertexIndices);
+    appendAll(allTextureIndices, chunks, &ObjChunk::textureIndices);
+    appendAll(allNormalIndices, chunks, &ObjChunk::normalIndices);
 
+    return { std::move(coordinates), std::move(textures), std::move(normals),
+        std::move(allVertexIndices), std::move(allTextureIndices), std::move(allNormalIndices) };
+}
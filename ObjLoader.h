@@ -5,13 +5,14 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <tuple>
 #include <glm/glm.hpp>
 
 struct  object
 {
-	std::vector<uint16_t> vertexIndices;
-	std::vector<uint16_t> textureIndices;
-	std::vector<uint16_t> normalIndices;
+	std::vector<uint32_t> vertexIndices;
+	std::vector<uint32_t> textureIndices;
+	std::vector<uint32_t> normalIndices;
 	std::string objectNames;
 	int verticesPerFace;
 };
@@ -33,7 +34,11 @@ class ObjLoader final
 public:
 	ObjLoader() = default;
 	~ObjLoader() = default;
-	std::tuple<std::vector<Coordinates>,std::vector<ObjTexCoord>,std::vector<Normal>, std::vector<uint16_t>, std::vector<uint16_t>, std::vector<uint16_t>> loadFile(const std::string& filename) const;
+	std::tuple<std::vector<Coordinates>,std::vector<ObjTexCoord>,std::vector<Normal>, std::vector<uint32_t>, std::vector<uint32_t>, std::vector<uint32_t>> loadFile(const std::string& filename) const;
+
+	// Same output as loadFile, but maps the file and parses line-aligned chunks on worker threads.
+	// threadCount == 0 uses std::thread::hardware_concurrency().
+	std::tuple<std::vector<Coordinates>, std::vector<ObjTexCoord>, std::vector<Normal>, std::vector<uint32_t>, std::vector<uint32_t>, std::vector<uint32_t>> loadFileMapped(const std::string& filename, unsigned threadCount = 0) const;
 
 };
 
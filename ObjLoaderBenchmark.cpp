@@ -0,0 +1,117 @@
+#include "ObjLoaderBenchmark.h"
+#include "ObjLoader.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <thread>
+
+namespace {
+    using ObjTuple = decltype(std::declval<ObjLoader>().loadFile(std::string()));
+
+    template <typename T>
+    bool sameBytes(const std::vector<T>& a, const std::vector<T>& b) {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+    }
+
+    bool sameResult(const ObjTuple& a, const ObjTuple& b) {
+        return sameBytes(std::get<0>(a), std::get<0>(b)) && sameBytes(std::get<1>(a), std::get<1>(b))
+            && sameBytes(std::get<2>(a), std::get<2>(b)) && sameBytes(std::get<3>(a), std::get<3>(b))
+            && sameBytes(std::get<4>(a), std::get<4>(b)) && sameBytes(std::get<5>(a), std::get<5>(b));
+    }
+
+    // Best-of-N wall time in milliseconds; keeps the last result for comparison
+    template <typename Fn>
+    double timeBest(int runs, ObjTuple& result, Fn&& fn) {
+        double best = 1e300;
+        for (int i = 0; i < runs; ++i) {
+            auto start = std::chrono::high_resolution_clock::now();
+            result = fn();
+            auto stop = std::chrono::high_resolution_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(stop - start).count());
+        }
+        return best;
+    }
+
+    // Square grid of quads sharing one texcoord and one normal
+    void writeSyntheticObj(const std::string& path, size_t faceCount) {
+        const size_t cells = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(faceCount))));
+        const size_t side = cells + 1;
+
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) {
+            throw std::runtime_error("ObjLoaderBenchmark: failed to create " + path);
+        }
+
+        std::fprintf(f, "# synthetic benchmark mesh\no grid\n");
+        for (size_t z = 0; z < side; ++z) {
+            for (size_t x = 0; x < side; ++x) {
+                std::fprintf(f, "v %.4f %.4f %.4f\n", x * 0.01f, std::sin(x * 0.05f) * std::cos(z * 0.05f), z * 0.01f);
+            }
+        }
+        std::fprintf(f, "vt 0.5 0.5\nvn 0.0 1.0 0.0\n");
+
+        size_t written = 0;
+        for (size_t z = 0; z < cells && written < faceCount; ++z) {
+            for (size_t x = 0; x < cells && written < faceCount; ++x, ++written) {
+                const size_t a = z * side + x + 1;
+                const size_t b = a + 1;
+                const size_t c = a + side + 1;
+                const size_t d = a + side;
+                std::fprintf(f, "f %zu/1/1 %zu/1/1 %zu/1/1 %zu/1/1\n", a, b, c, d);
+            }
+        }
+        std::fclose(f);
+    }
+
+    bool benchFile(const std::string& path, int runs) {
+        ObjLoader loader;
+        ObjTuple legacy;
+        ObjTuple mapped;
+
+        const double legacyMs = timeBest(runs, legacy, [&]() { return loader.loadFile(path); });
+        const double mappedMs = timeBest(runs, mapped, [&]() { return loader.loadFileMapped(path); });
+        const bool match = sameResult(legacy, mapped);
+
+        std::cout << std::left << std::setw(36) << path << std::right
+            << std::setw(12) << std::get<3>(legacy).size() / 3
+            << std::fixed << std::setprecision(2)
+            << std::setw(14) << legacyMs
+            << std::setw(14) << mappedMs
+            << std::setw(10) << (mappedMs > 0.0 ? legacyMs / mappedMs : 0.0) << "x"
+            << (match ? "   match" : "   MISMATCH") << std::endl;
+        return match;
+    }
+}
+
+int runObjLoaderBenchmark(size_t syntheticFaces, const std::string& syntheticPath)
+{
+    const char* models[] = {
+        "models/Cabin.obj",
+        "models/camel.obj",
+        "models/candle.obj",
+        "models/rock.obj",
+        "models/cactus.obj",
+    };
+
+    std::cout << "ObjLoader benchmark (" << std::max(1u, std::thread::hardware_concurrency()) << " hardware threads)" << std::endl;
+    std::cout << std::left << std::setw(36) << "file" << std::right
+        << std::setw(12) << "triangles"
+        << std::setw(14) << "loadFile ms"
+        << std::setw(14) << "mapped ms"
+        << std::setw(11) << "speedup" << std::endl;
+
+    bool allMatch = true;
+    for (const char* model : models) {
+        allMatch &= benchFile(model, 10);
+    }
+
+    if (syntheticFaces > 0) {
+        writeSyntheticObj(syntheticPath, syntheticFaces);
+        allMatch &= benchFile(syntheticPath, 1);
+        std::remove(syntheticPath.c_str());
+    }
+
+    return allMatch ? 0 : 1;
+}
@@ -0,0 +1,8 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Times ObjLoader::loadFile against ObjLoader::loadFileMapped on the bundled models and on a
+// generated OBJ with syntheticFaces quads, and checks that both produce identical output.
+// Returns non-zero if any result differs.
+int runObjLoaderBenchmark(size_t syntheticFaces = 3000000, const std::string& syntheticPath = "models/_synthetic_bench.obj");
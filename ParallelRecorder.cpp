@@ -0,0 +1,131 @@
+#include "ParallelRecorder.h"
+#include <algorithm>
+#include <stdexcept>
+
+void ParallelRecorder::create(VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, JobSystem& jobs)
+{
+	if (framesInFlight == 0) {
+		throw std::runtime_error("ParallelRecorder: at least one frame in flight is required");
+	}
+
+	_device = device;
+	VkCommandPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	// Reset as a whole once per frame, never per buffer
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = queueFamily;
+
+	// One pool for every thread index the job system hands out, attached threads included
+	_pools.assign(framesInFlight, std::vector<ThreadPool>(jobs.slotCount()));
+	for (auto& frame : _pools) {
+		for (ThreadPool& thread : frame) {
+			if (vkCreateCommandPool(_device, &poolInfo, nullptr, &thread.pool) != VK_SUCCESS) {
+				throw std::runtime_error("ParallelRecorder: failed to create a recording thread's command pool");
+			}
+		}
+	}
+
+	_jobs = &jobs;
+	_threadCount = jobs.threadCount();
+	_activeThreads = _threadCount;
+	_stats = {};
+}
+
+void ParallelRecorder::destroy()
+{
+	// Destroying a pool frees its secondaries
+	for (auto& frame : _pools) {
+		for (ThreadPool& thread : frame) {
+			vkDestroyCommandPool(_device, thread.pool, nullptr);
+		}
+	}
+	_pools.clear();
+	_jobs = nullptr;
+	_threadCount = 1;
+	_activeThreads = 1;
+	_device = VK_NULL_HANDLE;
+}
+
+void ParallelRecorder::setActiveThreads(unsigned count)
+{
+	_activeThreads = std::clamp(count, 1u, threadCount());
+}
+
+void ParallelRecorder::beginFrame(uint32_t frame)
+{
+	for (ThreadPool& thread : _pools.at(frame)) {
+		vkResetCommandPool(_device, thread.pool, 0);
+		thread.used = 0;
+	}
+}
+
+VkCommandBuffer ParallelRecorder::begin(unsigned thread, uint32_t frame, const VkCommandBufferInheritanceInfo& inheritance)
+{
+	ThreadPool& pool = _pools[frame][thread];
+	if (pool.used == pool.secondaries.size()) {
+		VkCommandBufferAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+		allocInfo.commandPool = pool.pool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		allocInfo.commandBufferCount = 1;
+		VkCommandBuffer cmd = VK_NULL_HANDLE;
+		if (vkAllocateCommandBuffers(_device, &allocInfo, &cmd) != VK_SUCCESS) {
+			throw std::runtime_error("ParallelRecorder: failed to allocate a secondary command buffer");
+		}
+		pool.secondaries.push_back(cmd);
+	}
+	const VkCommandBuffer cmd = pool.secondaries[pool.used++];
+
+	VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	beginInfo.pInheritanceInfo = &inheritance;
+	if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("ParallelRecorder: failed to begin a secondary command buffer");
+	}
+	return cmd;
+}
+
+VkCommandBuffer ParallelRecorder::beginSecondary(uint32_t frame, const VkCommandBufferInheritanceInfo& inheritance)
+{
+	++_stats.secondaries;
+	return begin(_jobs->currentThread(), frame, inheritance);
+}
+
+void ParallelRecorder::endSecondary(VkCommandBuffer cmd)
+{
+	if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
+		throw std::runtime_error("ParallelRecorder: failed to record a secondary command buffer");
+	}
+}
+
+void ParallelRecorder::record(uint32_t frame, const VkCommandBufferInheritanceInfo& inheritance, size_t count,
+	const RecordRange& recordRange, std::vector<VkCommandBuffer>& out)
+{
+	if (count == 0) return;
+
+	const size_t ranges = std::min<size_t>(_activeThreads, (count + kMinItemsPerRange - 1) / kMinItemsPerRange);
+	const size_t rangeSize = (count + ranges - 1) / ranges;
+	const size_t first = out.size();
+	out.resize(first + ranges, VK_NULL_HANDLE);
+
+	// Each range records into the pool of the thread that runs it, which may differ from run to run
+	auto recordOne = [&, first, rangeSize](size_t r) {
+		const size_t begin = r * rangeSize;
+		const size_t end = std::min(count, begin + rangeSize);
+		const VkCommandBuffer cmd = this->begin(_jobs->currentThread(), frame, inheritance);
+		recordRange(cmd, begin, end);
+		endSecondary(cmd);
+		out[first + r] = cmd;
+	};
+
+	if (ranges == 1) {
+		recordOne(0);
+	}
+	else {
+		JobSystem::Group group;
+		for (size_t r = 0; r < ranges; ++r) {
+			_jobs->submit(group, [&recordOne, r] { recordOne(r); });
+		}
+		_jobs->wait(group);
+		++_stats.dispatches;
+	}
+	_stats.secondaries += ranges;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "JobSystem.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Records a pass's draw list on several threads at once. The list is split into contiguous ranges and each
+// range is recorded into its own secondary command buffer by whichever JobSystem thread picks it up; the
+// secondaries come back in list order, so executing them from the primary draws in the same order as
+// recording inline. Every JobSystem thread has its own command pool per frame in flight, so recording never
+// takes a pool lock. Pool 0 belongs to every thread outside the JobSystem that has not attached to it, so
+// only one of those may record through the recorder at a time.
+class ParallelRecorder final
+{
+public:
+	// Records items [begin, end) into cmd, which has begun inside the pass; secondaries inherit no bound state
+	using RecordRange = std::function<void(VkCommandBuffer cmd, size_t begin, size_t end)>;
+
+	// Ranges smaller than this are not worth a secondary of their own
+	static constexpr size_t kMinItemsPerRange = 64;
+
+	struct Stats {
+		uint64_t dispatches = 0;  // record() calls that used more than one thread
+		uint64_t secondaries = 0; // secondaries begun, including beginSecondary()
+	};
+
+	ParallelRecorder() = default;
+	~ParallelRecorder() = default;
+
+	// Owns command pools; release them through destroy()
+	ParallelRecorder(const ParallelRecorder&) = delete;
+	ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+	ParallelRecorder(ParallelRecorder&&) = delete;
+	ParallelRecorder& operator=(ParallelRecorder&&) = delete;
+
+	// Records on jobs' threads; jobs must outlive the recorder
+	void create(VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, JobSystem& jobs);
+	void destroy();
+
+	unsigned threadCount() const { return _threadCount; }
+	// Caps the threads record() uses, from 1 (the calling thread only) to threadCount()
+	void setActiveThreads(unsigned count);
+	unsigned activeThreads() const { return _activeThreads; }
+
+	// Resets every thread's pool for frame; call once the frame's fence has signalled
+	void beginFrame(uint32_t frame);
+
+	// A secondary, from the calling thread's pool, for commands it records inside a pass begun with
+	// VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS; finish it with endSecondary()
+	VkCommandBuffer beginSecondary(uint32_t frame, const VkCommandBufferInheritanceInfo& inheritance);
+	void endSecondary(VkCommandBuffer cmd);
+
+	// Records count items in at most activeThreads() ranges and appends one secondary per range to out, in list
+	// order. The calling thread records ranges too; blocks until every range is recorded and rethrows the
+	// first error a range threw.
+	void record(uint32_t frame, const VkCommandBufferInheritanceInfo& inheritance, size_t count,
+		const RecordRange& recordRange, std::vector<VkCommandBuffer>& out);
+
+	const Stats& stats() const { return _stats; }
+
+private:
+	// One per thread per frame in flight; secondaries are kept and reused after the pool is reset
+	struct ThreadPool {
+		VkCommandPool pool{ VK_NULL_HANDLE };
+		std::vector<VkCommandBuffer> secondaries;
+		size_t used = 0;
+	};
+
+	VkCommandBuffer begin(unsigned thread, uint32_t frame, const VkCommandBufferInheritanceInfo& inheritance);
+
+	VkDevice _device{ VK_NULL_HANDLE };
+	JobSystem* _jobs{ nullptr };
+	std::vector<std::vector<ThreadPool>> _pools; // [frame][JobSystem::currentThread()]
+	unsigned _threadCount{ 1 };
+	unsigned _activeThreads{ 1 };
+
+	Stats _stats;
+};
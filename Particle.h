@@ -1,5 +1,9 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <cmath>
+#include <cstdint>
+
+// 32 bytes, laid out so shader.comp can address it as two vec4s: (position.xyz, velocity.x), (velocity.yz, lifetime, maxLifetime)
 struct Particle
 {
 	glm::vec3 position;
@@ -7,4 +11,70 @@ struct Particle
 	float lifetime;
 	float maxLifetime;
 };
+static_assert(sizeof(Particle) == 32, "Particle must match ParticleGPU in shaders/shader.comp");
+
+// Continuous emission, shared by the CPU path and shader.comp. halfExtentXZ of zero sprays from center in all
+// directions; otherwise particles fall from a random point in the XZ rectangle around center.
+struct ParticleEmitter
+{
+	glm::vec3 center{ 0.0f };
+	glm::vec2 halfExtentXZ{ 0.0f };
+	glm::vec2 speed{ 0.5f, 1.5f };    // min, max
+	glm::vec2 lifetime{ 1.0f, 4.0f }; // min, max
+	glm::vec2 windXZ{ 0.0f };
+	float ratePerSecond{ 0.0f };
+};
+
+// Reference implementation of the spawn and integration steps in shaders/shader.comp. Spawn attributes come
+// from a hash of (seed, index) rather than a stateful RNG, so both paths produce the same particles.
+namespace ParticleSim
+{
+	constexpr float kGravity = -9.8f;
+	constexpr float kDamping = 0.98f;
+
+	inline uint32_t hash(uint32_t v)
+	{
+		const uint32_t state = v * 747796405u + 2891336453u;
+		const uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+		return (word >> 22u) ^ word;
+	}
+
+	// Uniform in [0, 1); 24 bits so the float conversion is exact on both sides
+	inline float next(uint32_t& state)
+	{
+		state = hash(state);
+		return static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+	}
+
+	inline Particle spawn(const ParticleEmitter& emitter, uint32_t seed, uint32_t index)
+	{
+		uint32_t state = seed ^ hash(index);
+		Particle p{};
+		if (emitter.halfExtentXZ.x > 0.0f || emitter.halfExtentXZ.y > 0.0f) {
+			const float x = glm::mix(-emitter.halfExtentXZ.x, emitter.halfExtentXZ.x, next(state));
+			const float z = glm::mix(-emitter.halfExtentXZ.y, emitter.halfExtentXZ.y, next(state));
+			p.position = emitter.center + glm::vec3(x, 0.0f, z);
+			p.velocity = glm::vec3(emitter.windXZ.x, -glm::mix(emitter.speed.x, emitter.speed.y, next(state)), emitter.windXZ.y);
+		}
+		else {
+			const float a = next(state) * 6.2831853f;
+			const float e = next(state) - 0.5f;
+			const glm::vec3 dir = glm::normalize(glm::vec3(std::cos(a), e, std::sin(a)));
+			p.position = emitter.center;
+			p.velocity = dir * glm::mix(emitter.speed.x, emitter.speed.y, next(state));
+		}
+		p.maxLifetime = glm::mix(emitter.lifetime.x, emitter.lifetime.y, next(state));
+		p.lifetime = p.maxLifetime;
+		return p;
+	}
 
+	// Returns false once the particle has expired
+	inline bool integrate(Particle& p, float deltaTime)
+	{
+		p.velocity.y += kGravity * deltaTime;
+		p.velocity *= kDamping;
+		p.position += p.velocity * deltaTime;
+		p.lifetime -= deltaTime;
+		return p.lifetime > 0.0f;
+	}
+}
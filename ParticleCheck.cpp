@@ -0,0 +1,235 @@
+#include "ParticleCheck.h"
+#include "GpuAllocator.h"
+#include "UploadBatcher.h"
+#include "particleSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+	constexpr float kStep = 1.0f / 60.0f;
+	constexpr uint32_t kQuadIndexCount = 6;
+
+	struct Case {
+		const char* name;
+		ParticleEmitter emitter;
+		uint32_t capacity;
+		float tolerance; // relative, and absolute below 1
+	};
+
+	// rain is the emitter the scene uses; spray goes through cos and sin, whose GPU precision is looser.
+	// Both emit faster than their particles die, so the capacity rule is exercised too.
+	Case rainCase()
+	{
+		Case c{ "rain", {}, 8192, 1e-4f };
+		c.emitter.center = glm::vec3(0.0f, 10.0f, 0.0f);
+		c.emitter.halfExtentXZ = glm::vec2(10.0f);
+		c.emitter.speed = glm::vec2(8.0f, 12.0f);
+		c.emitter.lifetime = glm::vec2(0.5f, 1.5f);
+		c.emitter.windXZ = glm::vec2(0.5f, -0.25f);
+		c.emitter.ratePerSecond = 12000.0f;
+		return c;
+	}
+
+	Case sprayCase()
+	{
+		Case c{ "spray", {}, 4096, 1e-2f };
+		c.emitter.center = glm::vec3(0.0f, 2.0f, 0.0f);
+		c.emitter.speed = glm::vec2(0.5f, 1.5f);
+		c.emitter.lifetime = glm::vec2(1.0f, 4.0f);
+		c.emitter.ratePerSecond = 2000.0f;
+		return c;
+	}
+
+	float scaled(float a, float b)
+	{
+		return std::max({ 1.0f, std::abs(a), std::abs(b) });
+	}
+
+	bool near(float a, float b, float tolerance)
+	{
+		return std::abs(a - b) <= tolerance * scaled(a, b);
+	}
+
+	bool same(const Particle& a, const Particle& b, float tolerance)
+	{
+		for (int k = 0; k < 3; ++k) {
+			if (!near(a.position[k], b.position[k], tolerance) || !near(a.velocity[k], b.velocity[k], tolerance)) return false;
+		}
+		return near(a.lifetime, b.lifetime, tolerance) && near(a.maxLifetime, b.maxLifetime, tolerance);
+	}
+
+	// Pairs every CPU particle with an unused GPU particle within tolerance, searching only those whose
+	// maxLifetime is close, which is nearly unique per particle. Returns the first CPU particle left unpaired,
+	// or cpu.size() when every one found a partner.
+	size_t firstUnmatched(std::span<const Particle> cpu, std::span<const Particle> gpu, float tolerance,
+		std::vector<uint32_t>& order, std::vector<uint8_t>& used)
+	{
+		order.resize(gpu.size());
+		for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return gpu[a].maxLifetime < gpu[b].maxLifetime; });
+		used.assign(gpu.size(), 0);
+
+		for (size_t i = 0; i < cpu.size(); ++i) {
+			const Particle& p = cpu[i];
+			const float window = tolerance * scaled(p.maxLifetime, p.maxLifetime);
+			auto it = std::lower_bound(order.begin(), order.end(), p.maxLifetime - window,
+				[&](uint32_t g, float value) { return gpu[g].maxLifetime < value; });
+			bool found = false;
+			for (; it != order.end() && gpu[*it].maxLifetime <= p.maxLifetime + window; ++it) {
+				if (!used[*it] && same(p, gpu[*it], tolerance)) {
+					used[*it] = 1;
+					found = true;
+					break;
+				}
+			}
+			if (!found) return i;
+		}
+		return cpu.size();
+	}
+
+	void printParticle(const char* side, const Particle& p)
+	{
+		std::cout << "    " << side << " position (" << p.position.x << ", " << p.position.y << ", " << p.position.z
+			<< ") velocity (" << p.velocity.x << ", " << p.velocity.y << ", " << p.velocity.z
+			<< ") lifetime " << p.lifetime << " / " << p.maxLifetime << std::endl;
+	}
+
+	// The alive count lands at offset 0 of the readback buffer and the particles one Particle in
+	bool runCase(const RenderContext& ctx, const Case& c, uint32_t steps, VkCommandBuffer cmd, VkBuffer readback, const GpuAllocation& readbackMemory)
+	{
+		particleSystem cpu(c.emitter.center, c.capacity);
+		particleSystem gpu(c.emitter.center, c.capacity);
+		cpu.setEmitter(c.emitter);
+		gpu.setEmitter(c.emitter);
+		gpu.setSimulation(ParticleSimulation::Gpu);
+		cpu.create(ctx);
+		gpu.create(ctx);
+		// The counters are zeroed through the uploader; the first dispatch reads them
+		ctx.uploader->flush();
+		ctx.uploader->wait();
+
+		auto check = [&]() {
+			if (gpu.simulation() != ParticleSimulation::Gpu) {
+				std::cout << "  " << c.name << ": no particle compute pipeline" << std::endl;
+				return false;
+			}
+
+			const auto* mapped = static_cast<const unsigned char*>(readbackMemory.mapped);
+			const auto* gpuParticles = reinterpret_cast<const Particle*>(mapped + sizeof(Particle));
+			std::vector<uint32_t> order;
+			std::vector<uint8_t> used;
+			uint32_t peak = 0;
+
+			for (uint32_t step = 0; step < steps; ++step) {
+				cpu.update(kStep);
+				gpu.update(kStep);
+
+				VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+				beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+				if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS) {
+					throw std::runtime_error("ParticleCheck: vkBeginCommandBuffer failed");
+				}
+				gpu.recordSimulation(cmd, kQuadIndexCount);
+
+				VkMemoryBarrier toTransfer{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+				toTransfer.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+				toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+				vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+					0, 1, &toTransfer, 0, nullptr, 0, nullptr);
+
+				const VkBufferCopy countCopy{ gpu.gpuAliveCountOffset(), 0, sizeof(uint32_t) };
+				vkCmdCopyBuffer(cmd, gpu.gpuCounterBuffer(), readback, 1, &countCopy);
+				const VkBufferCopy particleCopy{ 0, sizeof(Particle), sizeof(Particle) * c.capacity };
+				vkCmdCopyBuffer(cmd, gpu.gpuParticleBuffer(), readback, 1, &particleCopy);
+
+				VkMemoryBarrier toHost{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+				toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+				vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+					0, 1, &toHost, 0, nullptr, 0, nullptr);
+
+				if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
+					throw std::runtime_error("ParticleCheck: vkEndCommandBuffer failed");
+				}
+				VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
+				submitInfo.commandBufferCount = 1;
+				submitInfo.pCommandBuffers = &cmd;
+				if (vkQueueSubmit(ctx.graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+					throw std::runtime_error("ParticleCheck: vkQueueSubmit failed");
+				}
+				vkQueueWaitIdle(ctx.graphicsQueue);
+
+				uint32_t gpuAlive = 0;
+				std::memcpy(&gpuAlive, mapped, sizeof(gpuAlive));
+				const std::span<const Particle> reference = cpu.particles();
+				if (gpuAlive != reference.size()) {
+					std::cout << "  " << c.name << ": step " << step << ": CPU has " << reference.size()
+						<< " particles alive, GPU " << gpuAlive << std::endl;
+					return false;
+				}
+
+				const std::span<const Particle> device(gpuParticles, gpuAlive);
+				const size_t unmatched = firstUnmatched(reference, device, c.tolerance, order, used);
+				if (unmatched != reference.size()) {
+					std::cout << "  " << c.name << ": step " << step << ": CPU particle " << unmatched
+						<< " has no GPU particle within " << c.tolerance << std::endl;
+					printParticle("CPU", reference[unmatched]);
+					return false;
+				}
+				peak = std::max(peak, gpuAlive);
+			}
+
+			std::cout << "  " << c.name << ": " << steps << " steps match, up to " << peak << " of " << c.capacity
+				<< " particles alive" << std::endl;
+			return true;
+		};
+
+		const bool ok = check();
+		cpu.destroy(ctx);
+		gpu.destroy(ctx);
+		return ok;
+	}
+}
+
+int runParticleCheck(const RenderContext& ctx, uint32_t steps)
+{
+	if (!ctx.allocator || !ctx.uploader || ctx.particleCompute == nullptr) {
+		throw std::runtime_error("ParticleCheck: RenderContext has no allocator, uploader or particle compute pipeline");
+	}
+
+	const Case cases[] = { rainCase(), sprayCase() };
+	uint32_t capacity = 0;
+	for (const Case& c : cases) capacity = std::max(capacity, c.capacity);
+
+	VkBuffer readback = VK_NULL_HANDLE;
+	GpuAllocation readbackMemory{};
+	ctx.allocator->createBuffer(sizeof(Particle) * (capacity + 1), VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, GpuMemoryCategory::Staging,
+		"particle check readback", readback, readbackMemory);
+
+	VkCommandBufferAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+	allocInfo.commandPool = ctx.commandPool;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandBufferCount = 1;
+	VkCommandBuffer cmd = VK_NULL_HANDLE;
+	if (vkAllocateCommandBuffers(ctx.device, &allocInfo, &cmd) != VK_SUCCESS) {
+		ctx.allocator->destroyBuffer(readback, readbackMemory);
+		throw std::runtime_error("ParticleCheck: vkAllocateCommandBuffers failed");
+	}
+
+	std::cout << "Particle check: CPU reference against shader.comp, dt " << kStep << std::endl;
+	bool ok = true;
+	for (const Case& c : cases) {
+		ok = runCase(ctx, c, steps, cmd, readback, readbackMemory) && ok;
+	}
+
+	vkFreeCommandBuffers(ctx.device, ctx.commandPool, 1, &cmd);
+	ctx.allocator->destroyBuffer(readback, readbackMemory);
+	std::cout << (ok ? "Particle check passed" : "Particle check FAILED") << std::endl;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "RenderContext.h"
+#include <cstdint>
+
+// Steps a Cpu and a Gpu particleSystem side by side from the same emitter and time step, reads the GPU
+// particles back after every dispatch and compares them with the CPU reference in ParticleSim. The GPU writes
+// its particles in atomic order, so they are matched by value rather than by index.
+// ctx needs the particle compute pipeline, an uploader and an idle graphics queue.
+// Returns non-zero if any step's alive count differs or a particle has no counterpart within tolerance.
+int runParticleCheck(const RenderContext& ctx, uint32_t steps = 300);
@@ -0,0 +1,101 @@
+#include "ParticleCompute.h"
+#include "DescriptorAllocator.h"
+#include <stdexcept>
+
+void ParticleCompute::create(VkDevice device, VkShaderModule computeShader, DescriptorAllocator* descriptors)
+{
+	if (descriptors == nullptr) {
+		throw std::runtime_error("ParticleCompute: a DescriptorAllocator is required");
+	}
+	_device = device;
+	_descriptors = descriptors;
+
+	// 0: counters, 1: source particles, 2: destination particles
+	std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+	for (uint32_t i = 0; i < bindings.size(); ++i) {
+		bindings[i].binding = i;
+		bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+	if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &_setLayout) != VK_SUCCESS) {
+		throw std::runtime_error("ParticleCompute: failed to create descriptor set layout");
+	}
+
+	VkPushConstantRange pushRange{ VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants) };
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &_setLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+	if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &_pipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("ParticleCompute: failed to create pipeline layout");
+	}
+
+	VkComputePipelineCreateInfo pipelineInfo{ VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+	pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.stage.module = computeShader;
+	pipelineInfo.stage.pName = "main";
+	pipelineInfo.layout = _pipelineLayout;
+	if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &_pipeline) != VK_SUCCESS) {
+		throw std::runtime_error("ParticleCompute: failed to create compute pipeline");
+	}
+}
+
+void ParticleCompute::destroy()
+{
+	if (_device == VK_NULL_HANDLE) return;
+	vkDestroyPipeline(_device, _pipeline, nullptr);
+	vkDestroyPipelineLayout(_device, _pipelineLayout, nullptr);
+	vkDestroyDescriptorSetLayout(_device, _setLayout, nullptr);
+	_descriptors = nullptr;
+	_pipeline = VK_NULL_HANDLE;
+	_pipelineLayout = VK_NULL_HANDLE;
+	_setLayout = VK_NULL_HANDLE;
+	_device = VK_NULL_HANDLE;
+}
+
+void ParticleCompute::allocateSets(const std::array<VkBuffer, 2>& particles, VkBuffer counters, std::array<VkDescriptorSet, 2>& sets)
+{
+	_descriptors->allocate(_setLayout, static_cast<uint32_t>(sets.size()), sets.data());
+
+	for (uint32_t side = 0; side < 2; ++side) {
+		const std::array<VkDescriptorBufferInfo, 3> infos{ {
+			{ counters, 0, VK_WHOLE_SIZE },
+			{ particles[side], 0, VK_WHOLE_SIZE },
+			{ particles[1 - side], 0, VK_WHOLE_SIZE },
+		} };
+
+		std::array<VkWriteDescriptorSet, 3> writes{};
+		for (uint32_t i = 0; i < writes.size(); ++i) {
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].dstSet = sets[side];
+			writes[i].dstBinding = i;
+			writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			writes[i].descriptorCount = 1;
+			writes[i].pBufferInfo = &infos[i];
+		}
+		vkUpdateDescriptorSets(_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+	}
+}
+
+void ParticleCompute::freeSets(std::array<VkDescriptorSet, 2>& sets)
+{
+	if (_descriptors != nullptr) {
+		_descriptors->free(static_cast<uint32_t>(sets.size()), sets.data());
+	}
+	sets = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+}
+
+void ParticleCompute::dispatch(VkCommandBuffer cmd, VkDescriptorSet set, const PushConstants& push) const
+{
+	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout, 0, 1, &set, 0, nullptr);
+	vkCmdPushConstants(cmd, _pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &push);
+	vkCmdDispatch(cmd, (push.counts.z + kWorkgroupSize - 1) / kWorkgroupSize, 1, 1);
+}
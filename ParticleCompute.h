@@ -0,0 +1,57 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+
+class DescriptorAllocator;
+
+// The shader.comp pipeline shared by every GPU-simulated particle system. Their sets come from the shared
+// DescriptorAllocator, so there is no fixed limit on the number of systems.
+// A system owns two particle buffers and a counter buffer holding one indexed indirect draw per buffer; each
+// dispatch integrates the source buffer, compacts survivors and emits new particles into the other buffer with
+// atomics on its instanceCount, and the draw reads that count on the GPU. The CPU only pushes emitter parameters.
+class ParticleCompute final
+{
+public:
+	static constexpr uint32_t kWorkgroupSize = 256;     // local_size_x in shader.comp
+	static constexpr VkDeviceSize kCounterStride = 32;  // VkDrawIndexedIndirectCommand padded to 8 uints
+
+	// Matches the push_constant block in shader.comp
+	struct PushConstants {
+		glm::vec4 centerDt;      // xyz emitter center, w delta time
+		glm::vec4 extentWind;    // xy emitter half extent XZ, zw wind XZ
+		glm::vec4 speedLifetime; // xy speed range, zw lifetime range
+		glm::uvec4 counts;       // x particles to emit, y seed, z capacity, w source side (0 or 1)
+	};
+	static_assert(sizeof(PushConstants) == 64, "PushConstants must match shader.comp");
+
+	ParticleCompute() = default;
+	~ParticleCompute() = default;
+
+	// Owns Vulkan objects; release them through destroy()
+	ParticleCompute(const ParticleCompute&) = delete;
+	ParticleCompute& operator=(const ParticleCompute&) = delete;
+	ParticleCompute(ParticleCompute&&) = delete;
+	ParticleCompute& operator=(ParticleCompute&&) = delete;
+
+	// The module is only used during the call; the caller still destroys it. descriptors must hold storage buffers.
+	void create(VkDevice device, VkShaderModule computeShader, DescriptorAllocator* descriptors);
+	void destroy();
+
+	// sets[d] reads particles[d] and writes particles[1 - d]; both use the whole counter buffer
+	void allocateSets(const std::array<VkBuffer, 2>& particles, VkBuffer counters, std::array<VkDescriptorSet, 2>& sets);
+	void freeSets(std::array<VkDescriptorSet, 2>& sets);
+
+	// Binds the pipeline and records a dispatch covering capacity threads
+	void dispatch(VkCommandBuffer cmd, VkDescriptorSet set, const PushConstants& push) const;
+
+	bool valid() const { return _pipeline != VK_NULL_HANDLE; }
+
+private:
+	VkDevice _device{ VK_NULL_HANDLE };
+	VkDescriptorSetLayout _setLayout{ VK_NULL_HANDLE };
+	VkPipelineLayout _pipelineLayout{ VK_NULL_HANDLE };
+	VkPipeline _pipeline{ VK_NULL_HANDLE };
+	DescriptorAllocator* _descriptors{ nullptr };
+};
@@ -1,6 +1,14 @@
 #pragma once
 #include <vulkan/vulkan.h>
 
+class UploadBatcher;
+class GpuAllocator;
+class GeometryArena;
+class FrameUniforms;
+class ParticleCompute;
+class DescriptorAllocator;
+class BindlessTable;
+
 struct RenderContext
 {
 	VkDevice device{};
@@ -8,14 +16,21 @@ struct RenderContext
 	VkQueue graphicsQueue{};
 	VkCommandPool commandPool{};
 	VkDescriptorSetLayout descriptorSetLayout{};
-	VkDescriptorPool descriptorPool{};
+	DescriptorAllocator* descriptors{}; // long-lived sets that outlive the swapchain, and per-frame transient sets
+	UploadBatcher* uploader{}; // staging copies are recorded here and submitted on its next flush
+	GpuAllocator* allocator{}; // every buffer and image allocation goes through this
+	GeometryArena* geometry{}; // shared vertex/index buffers that mesh geometry is uploaded into
+	FrameUniforms* uniforms{}; // per-frame camera block and per-object model slots
+	ParticleCompute* particleCompute{}; // shader.comp pipeline for GPU-simulated particle systems
+	BindlessTable* bindless{}; // shared texture array and material buffer; null when descriptor indexing is unavailable
+	uint32_t framesInFlight{ 1 }; // per-frame resources are ring-buffered this many deep
 
 	RenderContext& operator=(const RenderContext&) = default;
 
 	RenderContext(const RenderContext&) = default;
 
-	RenderContext(VkDevice pDevice, VkPhysicalDevice pPhysicalDevice, VkQueue pGraphicsQueue, VkCommandPool pCommandPool, VkDescriptorSetLayout pDescriptorSetLayout, VkDescriptorPool pDescriptorPool)
-		: device(pDevice), physicalDevice(pPhysicalDevice), graphicsQueue(pGraphicsQueue), commandPool(pCommandPool), descriptorSetLayout(pDescriptorSetLayout), descriptorPool(pDescriptorPool)
+	RenderContext(VkDevice pDevice, VkPhysicalDevice pPhysicalDevice, VkQueue pGraphicsQueue, VkCommandPool pCommandPool, VkDescriptorSetLayout pDescriptorSetLayout, DescriptorAllocator* pDescriptors)
+		: device(pDevice), physicalDevice(pPhysicalDevice), graphicsQueue(pGraphicsQueue), commandPool(pCommandPool), descriptorSetLayout(pDescriptorSetLayout), descriptors(pDescriptors)
 	{
 	}
 
@@ -0,0 +1,144 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+namespace {
+	constexpr uint64_t kDepthMask = (1ull << RenderQueue::kDepthBits) - 1;
+	constexpr uint32_t kMeshIdBits = RenderQueue::kMeshBits - 1; // the top bit is the index width
+	constexpr uint32_t kPassShift = 64 - RenderQueue::kPassBits;
+	constexpr uint32_t kLayerShift = kPassShift - 1;
+
+	uint64_t field(uint64_t key, uint32_t shift, uint32_t bits)
+	{
+		return (key >> shift) & ((1ull << bits) - 1);
+	}
+
+	// The bit pattern of a non-negative float orders like its value, so its top bits are a depth that needs
+	// no far plane to scale by
+	uint64_t quantizeDepth(float depth)
+	{
+		if (!(depth > 0.0f)) return 0;
+		return (std::bit_cast<uint32_t>(depth) >> (32 - RenderQueue::kDepthBits - 1)) & kDepthMask;
+	}
+
+	uint32_t intern(std::unordered_map<const void*, uint32_t>& ids, const void* value, uint32_t bits, const char* what)
+	{
+		const auto it = ids.find(value);
+		if (it != ids.end()) return it->second;
+		const uint32_t id = static_cast<uint32_t>(ids.size());
+		if (id >= (1u << bits)) {
+			throw std::runtime_error(std::string("RenderQueue: more than ") + std::to_string(1u << bits) + " " + what);
+		}
+		ids.emplace(value, id);
+		return id;
+	}
+}
+
+uint32_t RenderQueue::pipelineId(VkPipeline pipeline)
+{
+	const auto it = std::find(_pipelines.begin(), _pipelines.end(), pipeline);
+	if (it != _pipelines.end()) return static_cast<uint32_t>(it - _pipelines.begin());
+	if (_pipelines.size() >= (1u << kPipelineBits)) {
+		throw std::runtime_error("RenderQueue: more than " + std::to_string(1u << kPipelineBits) + " pipelines");
+	}
+	_pipelines.push_back(pipeline);
+	return static_cast<uint32_t>(_pipelines.size() - 1);
+}
+
+uint32_t RenderQueue::materialId(const void* material)
+{
+	return intern(_materials, material, kMaterialBits, "materials");
+}
+
+uint32_t RenderQueue::meshId(const void* mesh, VkIndexType indexType)
+{
+	const uint32_t wide = indexType == VK_INDEX_TYPE_UINT32 ? 1u : 0u;
+	return (wide << kMeshIdBits) | intern(_meshes, mesh, kMeshIdBits, "meshes");
+}
+
+uint64_t RenderQueue::makeKey(uint32_t pass, Layer layer, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth)
+{
+	const uint64_t head = (uint64_t{ pass } << kPassShift) | (uint64_t{ layer } << kLayerShift);
+	const uint64_t state = (uint64_t{ pipeline } << (kMaterialBits + kMeshBits))
+		| (uint64_t{ material } << kMeshBits)
+		| uint64_t{ mesh };
+	const uint64_t quantized = quantizeDepth(depth);
+	if (layer == Opaque) {
+		return head | (state << kDepthBits) | quantized;
+	}
+	return head | ((kDepthMask - quantized) << (kPipelineBits + kMaterialBits + kMeshBits)) | state;
+}
+
+RenderQueue::Fields RenderQueue::decode(uint64_t key)
+{
+	Fields f;
+	f.pass = static_cast<uint32_t>(field(key, kPassShift, kPassBits));
+	f.layer = static_cast<Layer>(field(key, kLayerShift, 1));
+	const uint32_t stateShift = f.layer == Opaque ? kDepthBits : 0;
+	f.pipeline = static_cast<uint32_t>(field(key, stateShift + kMaterialBits + kMeshBits, kPipelineBits));
+	f.material = static_cast<uint32_t>(field(key, stateShift + kMeshBits, kMaterialBits));
+	f.mesh = static_cast<uint32_t>(field(key, stateShift, kMeshBits));
+	f.depth = f.layer == Opaque
+		? static_cast<uint32_t>(field(key, 0, kDepthBits))
+		: static_cast<uint32_t>(kDepthMask - field(key, kPipelineBits + kMaterialBits + kMeshBits, kDepthBits));
+	return f;
+}
+
+void RenderQueue::sort()
+{
+	constexpr uint32_t kDigits = 8;
+	const size_t count = _items.size();
+	++_stats.sorts;
+	_stats.items += count;
+	if (count < 2) return;
+
+	// Every digit's histogram in one read of the keys
+	std::array<std::array<uint32_t, 256>, kDigits> histograms{};
+	for (const Item& item : _items) {
+		for (uint32_t d = 0; d < kDigits; ++d) {
+			++histograms[d][(item.key >> (d * 8)) & 0xff];
+		}
+	}
+
+	_scratch.resize(count);
+	for (uint32_t d = 0; d < kDigits; ++d) {
+		std::array<uint32_t, 256>& histogram = histograms[d];
+		// The pass, layer and unused id bits are often the same in every key; a pass over them moves nothing
+		if (std::find(histogram.begin(), histogram.end(), static_cast<uint32_t>(count)) != histogram.end()) continue;
+
+		uint32_t offset = 0;
+		for (uint32_t& bucket : histogram) {
+			const uint32_t n = bucket;
+			bucket = offset;
+			offset += n;
+		}
+		for (const Item& item : _items) {
+			_scratch[histogram[(item.key >> (d * 8)) & 0xff]++] = item;
+		}
+		_items.swap(_scratch);
+		++_stats.digitPasses;
+	}
+}
+
+std::pair<size_t, size_t> RenderQueue::passRange(uint32_t pass) const
+{
+	auto firstAtLeast = [this](uint64_t key) {
+		return static_cast<size_t>(std::lower_bound(_items.begin(), _items.end(), key,
+			[](const Item& item, uint64_t k) { return item.key < k; }) - _items.begin());
+	};
+	const size_t begin = firstAtLeast(uint64_t{ pass } << kPassShift);
+	const size_t end = pass + 1 < (1u << kPassBits) ? firstAtLeast(uint64_t{ pass + 1 } << kPassShift) : _items.size();
+	return { begin, end };
+}
+
+uint64_t RenderQueue::orderHash() const
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (const Item& item : _items) {
+		hash = (hash ^ ((item.key >> kPassShift) << 32 | item.index)) * 0x100000001b3ull;
+	}
+	return hash;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Draws submitted as packed 64-bit sort keys and radix-sorted, so one pass's draws come out grouped by the
+// state they bind. From the top bit down:
+//   opaque:      pass(2) | layer(1) = 0 | pipeline(7) | material(14) | mesh(16) | depth(24)
+//   transparent: pass(2) | layer(1) = 1 | far-to-near depth(24) | pipeline(7) | material(14) | mesh(16)
+// Opaque draws are grouped by state and go front to back within each group, so early-Z still rejects most
+// hidden fragments; transparent draws come after them in a pass and blend back to front whatever they bind.
+// The top bit of the mesh field is the index width, so 16- and 32-bit meshes are not interleaved.
+// Ids are interned on first use and stay fixed, so the same state gives the same key every frame.
+class RenderQueue final
+{
+public:
+	enum Layer : uint32_t { Opaque = 0, Transparent = 1 };
+
+	static constexpr uint32_t kPassBits = 2;
+	static constexpr uint32_t kPipelineBits = 7;
+	static constexpr uint32_t kMaterialBits = 14;
+	static constexpr uint32_t kMeshBits = 16;
+	static constexpr uint32_t kDepthBits = 24;
+
+	struct Item {
+		uint64_t key = 0;
+		uint32_t index = 0; // the submitter's draw, e.g. a position in GlobeScene::getObjects()
+	};
+
+	struct Fields {
+		uint32_t pass = 0;
+		Layer layer = Opaque;
+		uint32_t pipeline = 0;
+		uint32_t material = 0;
+		uint32_t mesh = 0;
+		uint32_t depth = 0; // quantized, nearest first for either layer
+	};
+
+	struct Stats {
+		uint64_t sorts = 0;
+		uint64_t items = 0;        // sorted, over every sort
+		uint64_t digitPasses = 0;  // 8-bit radix passes run; digits every key shares are skipped
+	};
+
+	// Throw once more distinct values are interned than their field holds
+	uint32_t pipelineId(VkPipeline pipeline);
+	uint32_t materialId(const void* material);
+	uint32_t meshId(const void* mesh, VkIndexType indexType);
+	VkPipeline pipeline(uint32_t id) const { return _pipelines[id]; }
+
+	// depth is any non-negative distance that grows away from the viewer, such as view-space -z; pass 0 to
+	// order by state alone
+	static uint64_t makeKey(uint32_t pass, Layer layer, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth);
+	static Fields decode(uint64_t key);
+
+	// Drops the items; interned ids are kept
+	void clear() { _items.clear(); }
+	void push(uint64_t key, uint32_t index) { _items.push_back({ key, index }); }
+	// Stable LSD radix sort on the keys: draws with equal keys stay in submission order
+	void sort();
+
+	const std::vector<Item>& items() const { return _items; }
+	// [begin, end) of the sorted items in pass
+	std::pair<size_t, size_t> passRange(uint32_t pass) const;
+	// Changes whenever the sorted order does
+	uint64_t orderHash() const;
+
+	const Stats& stats() const { return _stats; }
+
+private:
+	std::vector<Item> _items;
+	std::vector<Item> _scratch;
+
+	std::vector<VkPipeline> _pipelines; // by id; a handful per pass, so looked up linearly
+	std::unordered_map<const void*, uint32_t> _materials;
+	std::unordered_map<const void*, uint32_t> _meshes;
+
+	Stats _stats;
+};
@@ -10,8 +10,8 @@ class Rock final : public IWorldObject
 {
     static constexpr const char* kModelPath = "models/rock.obj";
 public:
-    Rock(const glm::vec3& position, textureManager* textureMgr)
-        : IWorldObject(position, kModelPath, textureMgr, "rock")
+    Rock(const glm::vec3& position, textureManager* textureMgr, MeshLibrary* meshLibrary)
+        : IWorldObject(position, kModelPath, textureMgr, meshLibrary, "rock")
     {
     }
 
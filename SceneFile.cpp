@@ -0,0 +1,327 @@
+#include "SceneFile.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace
+{
+	constexpr char kMagic[8] = { 'S', 'C', 'E', 'N', 'E', 'B', 'I', 'N' };
+
+	// On-disk layout: header, string table of (uint32 length, bytes) entries, then the four columns, each 16-byte aligned
+	struct SceneBinHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t typeCount;
+		uint64_t instanceCount;
+		uint64_t sourceSize;
+		int64_t sourceMtime;
+		uint64_t stringTableOffset;
+		uint64_t stringTableSize;
+		uint64_t typeOffset;     // uint16_t[instanceCount]
+		uint64_t positionOffset; // float[instanceCount * 3]
+		uint64_t rotationOffset; // float[instanceCount * 4], quaternion xyzw
+		uint64_t scaleOffset;    // float[instanceCount * 3]
+	};
+
+	constexpr uint64_t alignUp(uint64_t v, uint64_t a) {
+		return (v + a - 1) & ~(a - 1);
+	}
+
+	bool stampSource(const std::string& path, uint64_t& size, int64_t& mtime) {
+		std::error_code ec;
+		const auto time = std::filesystem::last_write_time(path, ec);
+		if (ec) return false;
+		size = std::filesystem::file_size(path, ec);
+		if (ec) return false;
+		mtime = static_cast<int64_t>(time.time_since_epoch().count());
+		return true;
+	}
+
+	std::string_view trim(std::string_view s) {
+		while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+		while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+		return s;
+	}
+
+	bool parseFloat(std::string_view token, float& value) {
+		token = trim(token);
+		const char* first = token.data();
+		const char* last = first + token.size();
+		if (first < last && *first == '+') ++first;
+		const auto result = std::from_chars(first, last, value);
+		return result.ec == std::errc() && result.ptr == last && first != last;
+	}
+
+	void splitFields(std::string_view line, std::vector<std::string_view>& fields) {
+		fields.clear();
+		size_t start = 0;
+		for (size_t comma = line.find(','); comma != std::string_view::npos; comma = line.find(',', start)) {
+			fields.push_back(trim(line.substr(start, comma - start)));
+			start = comma + 1;
+		}
+		fields.push_back(trim(line.substr(start)));
+	}
+
+	template <typename T>
+	void writeColumn(std::ofstream& out, uint64_t& written, uint64_t offset, const T* data, size_t count) {
+		const char pad[16] = {};
+		out.write(pad, static_cast<std::streamsize>(offset - written));
+		out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+		written = offset + count * sizeof(T);
+	}
+}
+
+std::string SceneFile::binaryPathFor(const std::string& csvPath)
+{
+	return std::filesystem::path(csvPath).replace_extension(".scenebin").string();
+}
+
+SceneFile::Columns SceneFile::parseCsv(const std::string& csvPath)
+{
+	MappedFile file(csvPath);
+	const char* p = file.data();
+	const char* end = p + file.size();
+
+	auto nextLine = [&](std::string_view& line) {
+		if (p >= end) return false;
+		const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+		if (!lineEnd) lineEnd = end;
+		line = std::string_view(p, static_cast<size_t>(lineEnd - p));
+		p = lineEnd + (lineEnd < end ? 1 : 0);
+		return true;
+	};
+
+	// Column index for each known field; -1 when absent
+	enum Field { Type, X, Y, Z, RX, RY, RZ, SX, SY, SZ, FieldCount };
+	static constexpr const char* kFieldNames[FieldCount] = { "type", "x", "y", "z", "rx", "ry", "rz", "sx", "sy", "sz" };
+	int column[FieldCount];
+	std::fill(std::begin(column), std::end(column), -1);
+
+	std::vector<std::string_view> fields;
+	std::string_view line;
+	if (!nextLine(line)) {
+		throw std::runtime_error("SceneFile: empty scene file: " + csvPath);
+	}
+	splitFields(line, fields);
+	for (size_t i = 0; i < fields.size(); ++i) {
+		for (int f = 0; f < FieldCount; ++f) {
+			if (fields[i] == kFieldNames[f]) column[f] = static_cast<int>(i);
+		}
+	}
+	for (int f = Type; f <= Z; ++f) {
+		if (column[f] < 0) {
+			throw std::runtime_error("SceneFile: missing column '" + std::string(kFieldNames[f]) + "' in " + csvPath);
+		}
+	}
+
+	Columns out;
+	std::unordered_map<std::string_view, uint16_t> typeIndex;
+	size_t lineNumber = 1;
+	while (nextLine(line)) {
+		++lineNumber;
+		if (trim(line).empty()) continue;
+		splitFields(line, fields);
+
+		float values[FieldCount] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+		bool ok = column[Type] < static_cast<int>(fields.size()) && !fields[column[Type]].empty();
+		for (int f = X; f < FieldCount && ok; ++f) {
+			if (column[f] < 0) continue;
+			ok = column[f] < static_cast<int>(fields.size()) && parseFloat(fields[column[f]], values[f]);
+		}
+		if (!ok) {
+			std::cerr << "SceneFile: skipping malformed line " << lineNumber << " in " << csvPath << ": " << line << std::endl;
+			continue;
+		}
+
+		const std::string_view name = fields[column[Type]];
+		auto it = typeIndex.find(name);
+		if (it == typeIndex.end()) {
+			if (out.typeNames.size() > UINT16_MAX) {
+				throw std::runtime_error("SceneFile: too many object types in " + csvPath);
+			}
+			it = typeIndex.emplace(name, static_cast<uint16_t>(out.typeNames.size())).first;
+			out.typeNames.emplace_back(name);
+		}
+
+		const glm::quat rotation = glm::quat(glm::radians(glm::vec3(values[RX], values[RY], values[RZ])));
+		out.types.push_back(it->second);
+		out.positions.emplace_back(values[X], values[Y], values[Z]);
+		out.rotations.push_back(rotation);
+		out.scales.emplace_back(values[SX], values[SY], values[SZ]);
+	}
+	return out;
+}
+
+bool SceneFile::store(const std::string& binPath, const Columns& columns, const std::string& csvPath)
+{
+	const std::string tmpPath = binPath + ".tmp";
+	const size_t count = columns.size();
+
+	try {
+		SceneBinHeader h{};
+		std::memcpy(h.magic, kMagic, sizeof(kMagic));
+		h.version = kVersion;
+		h.typeCount = static_cast<uint32_t>(columns.typeNames.size());
+		h.instanceCount = count;
+		if (!csvPath.empty() && !stampSource(csvPath, h.sourceSize, h.sourceMtime)) return false;
+
+		h.stringTableOffset = sizeof(SceneBinHeader);
+		for (const auto& name : columns.typeNames) {
+			h.stringTableSize += sizeof(uint32_t) + name.size();
+		}
+		h.typeOffset = alignUp(h.stringTableOffset + h.stringTableSize, 16);
+		h.positionOffset = alignUp(h.typeOffset + count * sizeof(uint16_t), 16);
+		h.rotationOffset = alignUp(h.positionOffset + count * 3 * sizeof(float), 16);
+		h.scaleOffset = alignUp(h.rotationOffset + count * 4 * sizeof(float), 16);
+
+		// Flatten to plain floats so the layout does not depend on glm's member order
+		std::vector<float> positions(count * 3), rotations(count * 4), scales(count * 3);
+		for (size_t i = 0; i < count; ++i) {
+			const glm::vec3& p = columns.positions[i];
+			const glm::quat& r = columns.rotations[i];
+			const glm::vec3& s = columns.scales[i];
+			positions[i * 3 + 0] = p.x; positions[i * 3 + 1] = p.y; positions[i * 3 + 2] = p.z;
+			rotations[i * 4 + 0] = r.x; rotations[i * 4 + 1] = r.y; rotations[i * 4 + 2] = r.z; rotations[i * 4 + 3] = r.w;
+			scales[i * 3 + 0] = s.x; scales[i * 3 + 1] = s.y; scales[i * 3 + 2] = s.z;
+		}
+
+		{
+			std::ofstream fout(tmpPath, std::ios::binary | std::ios::trunc);
+			if (!fout.is_open()) return false;
+
+			fout.write(reinterpret_cast<const char*>(&h), sizeof(h));
+			for (const auto& name : columns.typeNames) {
+				const uint32_t length = static_cast<uint32_t>(name.size());
+				fout.write(reinterpret_cast<const char*>(&length), sizeof(length));
+				fout.write(name.data(), static_cast<std::streamsize>(name.size()));
+			}
+			uint64_t written = h.stringTableOffset + h.stringTableSize;
+			writeColumn(fout, written, h.typeOffset, columns.types.data(), count);
+			writeColumn(fout, written, h.positionOffset, positions.data(), positions.size());
+			writeColumn(fout, written, h.rotationOffset, rotations.data(), rotations.size());
+			writeColumn(fout, written, h.scaleOffset, scales.data(), scales.size());
+			if (!fout) return false;
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tmpPath, binPath, ec);
+		if (ec) {
+			std::filesystem::remove(tmpPath, ec);
+			return false;
+		}
+		return true;
+	}
+	catch (const std::exception& e) {
+		std::cerr << "SceneFile: failed to write " << binPath << ": " << e.what() << std::endl;
+		return false;
+	}
+}
+
+std::string SceneFile::convertIfStale(const std::string& csvPath)
+{
+	const std::string binPath = binaryPathFor(csvPath);
+
+	uint64_t size = 0;
+	int64_t mtime = 0;
+	if (!stampSource(csvPath, size, mtime)) {
+		// No CSV to convert from: use whatever binary scene is there
+		return binPath;
+	}
+
+	std::error_code ec;
+	if (std::filesystem::exists(binPath, ec)) {
+		try {
+			MappedFile file(binPath);
+			SceneBinHeader h{};
+			if (file.size() >= sizeof(h)) {
+				std::memcpy(&h, file.data(), sizeof(h));
+				if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) == 0 && h.version == kVersion &&
+					h.sourceSize == size && h.sourceMtime == mtime) {
+					return binPath;
+				}
+			}
+		}
+		catch (const std::exception&) {
+			// Unreadable binary: rebuild it below
+		}
+	}
+
+	const Columns columns = parseCsv(csvPath);
+	if (!store(binPath, columns, csvPath)) {
+		throw std::runtime_error("SceneFile: failed to convert " + csvPath + " to " + binPath);
+	}
+	std::cout << "SceneFile: converted " << columns.size() << " instances from " << csvPath << " to " << binPath << std::endl;
+	return binPath;
+}
+
+void SceneFile::open(const std::string& binPath)
+{
+	close();
+	_file.open(binPath);
+
+	SceneBinHeader h{};
+	if (_file.size() < sizeof(h)) {
+		throw std::runtime_error("SceneFile: truncated header in " + binPath);
+	}
+	std::memcpy(&h, _file.data(), sizeof(h));
+	if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kVersion) {
+		throw std::runtime_error("SceneFile: not a version " + std::to_string(kVersion) + " scene: " + binPath);
+	}
+
+	const uint64_t count = h.instanceCount;
+	const uint64_t size = _file.size();
+	if (h.stringTableOffset + h.stringTableSize > size ||
+		h.typeOffset + count * sizeof(uint16_t) > size ||
+		h.positionOffset + count * 3 * sizeof(float) > size ||
+		h.rotationOffset + count * 4 * sizeof(float) > size ||
+		h.scaleOffset + count * 3 * sizeof(float) > size ||
+		(h.typeOffset | h.positionOffset | h.rotationOffset | h.scaleOffset) % 4 != 0) {
+		throw std::runtime_error("SceneFile: truncated or misaligned columns in " + binPath);
+	}
+
+	const char* table = _file.data() + h.stringTableOffset;
+	const char* tableEnd = table + h.stringTableSize;
+	_typeNames.reserve(h.typeCount);
+	for (uint32_t t = 0; t < h.typeCount; ++t) {
+		uint32_t length = 0;
+		if (tableEnd - table < static_cast<ptrdiff_t>(sizeof(length))) {
+			throw std::runtime_error("SceneFile: corrupt string table in " + binPath);
+		}
+		std::memcpy(&length, table, sizeof(length));
+		table += sizeof(length);
+		if (static_cast<uint64_t>(tableEnd - table) < length) {
+			throw std::runtime_error("SceneFile: corrupt string table in " + binPath);
+		}
+		_typeNames.emplace_back(table, length);
+		table += length;
+	}
+
+	// The mapping is page aligned and every column offset is a multiple of 4, so the columns are read in place
+	_instanceCount = static_cast<size_t>(count);
+	_types = reinterpret_cast<const uint16_t*>(_file.data() + h.typeOffset);
+	_positions = reinterpret_cast<const float*>(_file.data() + h.positionOffset);
+	_rotations = reinterpret_cast<const float*>(_file.data() + h.rotationOffset);
+	_scales = reinterpret_cast<const float*>(_file.data() + h.scaleOffset);
+
+	for (size_t i = 0; i < _instanceCount; ++i) {
+		if (_types[i] >= _typeNames.size()) {
+			throw std::runtime_error("SceneFile: type index out of range in " + binPath);
+		}
+	}
+}
+
+void SceneFile::close()
+{
+	_file.close();
+	_instanceCount = 0;
+	_typeNames.clear();
+	_types = nullptr;
+	_positions = nullptr;
+	_rotations = nullptr;
+	_scales = nullptr;
+}
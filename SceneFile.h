@@ -0,0 +1,75 @@
+#pragma once
+#include "MappedFile.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Columnar binary scene (scene_objects.csv -> scene_objects.scenebin).
+// One type string table plus parallel type, position, rotation and scale arrays, read in place from a mapping.
+class SceneFile final
+{
+public:
+	static constexpr uint32_t kVersion = 1;
+
+	// Instance columns as written by store()
+	struct Columns {
+		std::vector<std::string> typeNames;
+		std::vector<uint16_t> types;        // index into typeNames
+		std::vector<glm::vec3> positions;
+		std::vector<glm::quat> rotations;
+		std::vector<glm::vec3> scales;
+
+		size_t size() const { return types.size(); }
+	};
+
+	SceneFile() = default;
+	~SceneFile() = default;
+
+	SceneFile(const SceneFile&) = delete;
+	SceneFile& operator=(const SceneFile&) = delete;
+	SceneFile(SceneFile&&) noexcept = default;
+	SceneFile& operator=(SceneFile&&) noexcept = default;
+
+	static std::string binaryPathFor(const std::string& csvPath);
+
+	// Header "type,x,y,z" with optional rx,ry,rz (degrees, applied Z*Y*X) and sx,sy,sz columns in any order.
+	// Rows with an unparsable field are reported and skipped.
+	static Columns parseCsv(const std::string& csvPath);
+
+	// Writes columns to binPath, stamped with csvPath's size and mtime when csvPath is not empty
+	static bool store(const std::string& binPath, const Columns& columns, const std::string& csvPath = {});
+
+	// Rewrites binaryPathFor(csvPath) when it is missing or older than the CSV. Returns the binary path.
+	static std::string convertIfStale(const std::string& csvPath);
+
+	// Maps and validates the file; throws on a bad header or truncated columns
+	void open(const std::string& binPath);
+	void close();
+
+	size_t instanceCount() const { return _instanceCount; }
+	size_t typeCount() const { return _typeNames.size(); }
+	std::string_view typeName(size_t type) const { return _typeNames[type]; }
+
+	uint16_t type(size_t i) const { return _types[i]; }
+	glm::vec3 position(size_t i) const { return readVec3(_positions + i * 3); }
+	glm::vec3 scale(size_t i) const { return readVec3(_scales + i * 3); }
+	glm::quat rotation(size_t i) const
+	{
+		const float* r = _rotations + i * 4;
+		return glm::quat(r[3], r[0], r[1], r[2]);
+	}
+
+private:
+	static glm::vec3 readVec3(const float* v) { return glm::vec3(v[0], v[1], v[2]); }
+
+	MappedFile _file;
+	size_t _instanceCount{ 0 };
+	std::vector<std::string_view> _typeNames;
+	const uint16_t* _types{ nullptr };
+	const float* _positions{ nullptr };  // xyz
+	const float* _rotations{ nullptr };  // quaternion xyzw
+	const float* _scales{ nullptr };     // xyz
+};
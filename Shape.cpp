@@ -1,98 +1,30 @@
 #include "Shape.h"
+#include "CommandStats.h"
+#include <algorithm>
 #include <span>
 
 
-namespace
-{
-	uint32_t findMemoryType(VkPhysicalDevice phys, uint32_t typeFilter, VkMemoryPropertyFlags props)
-	{
-		VkPhysicalDeviceMemoryProperties memProperties;
-		vkGetPhysicalDeviceMemoryProperties(phys, &memProperties);
-		for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-			if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & props) == props) {
-				return i;
-			}
-		}
-		throw std::runtime_error("failed to find suitable memory type!");
-	}
-
-	void createBuffer(const RenderContext& ctx, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
-		VkBufferCreateInfo bufferInfo{};
-		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bufferInfo.size = size;
-		bufferInfo.usage = usage;
-		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		if (vkCreateBuffer(ctx.device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create buffer!");
-		}
-		VkMemoryRequirements memRequirements;
-		vkGetBufferMemoryRequirements(ctx.device, buffer, &memRequirements);
-		VkMemoryAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocInfo.allocationSize = memRequirements.size;
-		allocInfo.memoryTypeIndex = findMemoryType(ctx.physicalDevice, memRequirements.memoryTypeBits, properties);
-		if (vkAllocateMemory(ctx.device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-			throw std::runtime_error("failed to allocate buffer memory!");
-		}
-		vkBindBufferMemory(ctx.device, buffer, bufferMemory, 0);
-	}
-
-	VkCommandBuffer beginSingleTimeCommands(const RenderContext& ctx) {
-		VkCommandBufferAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = ctx.commandPool;
-		allocInfo.commandBufferCount = 1;
-		VkCommandBuffer commandBuffer;
-		vkAllocateCommandBuffers(ctx.device, &allocInfo, &commandBuffer);
-		VkCommandBufferBeginInfo beginInfo{};
-		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-		vkBeginCommandBuffer(commandBuffer, &beginInfo);
-		return commandBuffer;
-	}
-
-	void endOneTime(const RenderContext& ctx, VkCommandBuffer commandBuffer) {
-		vkEndCommandBuffer(commandBuffer);
-		VkSubmitInfo submitInfo{};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffer;
-		vkQueueSubmit(ctx.graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(ctx.graphicsQueue);
-		vkFreeCommandBuffers(ctx.device, ctx.commandPool, 1, &commandBuffer);
-	}
-
-	void copyBuffer(const RenderContext& ctx, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
-		const VkCommandBuffer commandBuffer = beginSingleTimeCommands(ctx);
-		VkBufferCopy copyRegion{};
-		copyRegion.size = size;
-		vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-		endOneTime(ctx, commandBuffer);
-	}
-}
-
-
 Shape::~Shape() = default;
 
 Shape::Shape(Shape&& other)
 	: GraphicsObject(std::move(other)),
 	_vertices(std::move(other._vertices)),
 	_indices(std::move(other._indices)),
-	_uniformBuffers(std::move(other._uniformBuffers)),
-	_uniformBuffersMemory(std::move(other._uniformBuffersMemory)),
-	_uniformBuffersMapped(std::move(other._uniformBuffersMapped)),
+	_indexType(other._indexType),
+	_uniforms(other._uniforms),
+	_uniformSlot(other._uniformSlot),
+	_descriptors(other._descriptors),
 	_descriptorSets(std::move(other._descriptorSets)),
+	_boundTextureViews(std::move(other._boundTextureViews)),
+	_descriptorDevice(other._descriptorDevice),
+	_materialIndex(other._materialIndex),
 	_material(std::move(other._material)),
-	_vertexBuffer(other._vertexBuffer),
-	_indexBuffer(other._indexBuffer),
-	_vertexBufferMemory(other._vertexBufferMemory),
-	_indexBufferMemory(other._indexBufferMemory)
+	_geometryArena(other._geometryArena),
+	_geometry(other._geometry)
 {
-	other._vertexBuffer = VK_NULL_HANDLE;
-	other._indexBuffer = VK_NULL_HANDLE;
-	other._vertexBufferMemory = VK_NULL_HANDLE;
-	other._indexBufferMemory = VK_NULL_HANDLE;
+	other._descriptors = nullptr;
+	other._geometryArena = nullptr;
+	other._geometry = {};
 }
 
 Shape& Shape::operator=(Shape&& other) {
@@ -100,19 +32,25 @@ Shape& Shape::operator=(Shape&& other) {
 		GraphicsObject::operator=(std::move(other));
 		_vertices = std::move(other._vertices);
 		_indices = std::move(other._indices);
-		_uniformBuffers = std::move(other._uniformBuffers);
-		_uniformBuffersMemory = std::move(other._uniformBuffersMemory);
-		_uniformBuffersMapped = std::move(other._uniformBuffersMapped);
+		_indexType = other._indexType;
+		_uniforms = other._uniforms;
+		_uniformSlot = other._uniformSlot;
+		other._uniforms = nullptr;
+		other._uniformSlot = FrameUniforms::kInvalidSlot;
+		if (_descriptors != nullptr) {
+			_descriptors->free(static_cast<uint32_t>(_descriptorSets.size()), _descriptorSets.data());
+		}
+		_descriptors = other._descriptors;
+		other._descriptors = nullptr;
 		_descriptorSets = std::move(other._descriptorSets);
+		_boundTextureViews = std::move(other._boundTextureViews);
+		_descriptorDevice = other._descriptorDevice;
+		_materialIndex = other._materialIndex;
 		_material = std::move(other._material);
-		_vertexBuffer = other._vertexBuffer;
-		_indexBuffer = other._indexBuffer;
-		_vertexBufferMemory = other._vertexBufferMemory;
-		_indexBufferMemory = other._indexBufferMemory;
-		other._vertexBuffer = VK_NULL_HANDLE;
-		other._indexBuffer = VK_NULL_HANDLE;
-		other._vertexBufferMemory = VK_NULL_HANDLE;
-		other._indexBufferMemory = VK_NULL_HANDLE;
+		_geometryArena = other._geometryArena;
+		_geometry = other._geometry;
+		other._geometryArena = nullptr;
+		other._geometry = {};
 	}
 	return *this;
 }
@@ -121,6 +59,7 @@ Shape::Shape(const Shape& other)
 	: GraphicsObject(other),
 	_vertices(other._vertices),
 	_indices(other._indices),
+	_indexType(other._indexType),
 	_material(other._material)
 {
 
@@ -128,100 +67,92 @@ Shape::Shape(const Shape& other)
 
 Shape& Shape::operator=(const Shape& other) {
 	if (this != &other) {
+		if (_descriptors != nullptr) {
+			_descriptors->free(static_cast<uint32_t>(_descriptorSets.size()), _descriptorSets.data());
+			_descriptors = nullptr;
+		}
 		_descriptorSets = {};
-		_uniformBuffers = {};
-		_uniformBuffersMemory = {};
-		_uniformBuffersMapped = {};
-		_vertexBuffer = VK_NULL_HANDLE;
-		_vertexBufferMemory = VK_NULL_HANDLE;
-		_indexBuffer = VK_NULL_HANDLE;
-		_indexBufferMemory = VK_NULL_HANDLE;
+		_boundTextureViews = {};
+		_descriptorDevice = VK_NULL_HANDLE;
+		_materialIndex = 0;
+		_uniforms = nullptr;
+		_uniformSlot = FrameUniforms::kInvalidSlot;
+		_geometryArena = nullptr;
+		_geometry = {};
 
 		GraphicsObject::operator=(other);
 		_vertices = other._vertices;
 		_indices = other._indices;
+		_indexType = other._indexType;
 		_material = other._material;
 	}
 	return *this;
 }
 
+void Shape::setIndices(const std::vector<uint32_t>& indices) {
+	_indices = indices;
+	const uint32_t maxIndex = _indices.empty() ? 0 : *std::max_element(_indices.begin(), _indices.end());
+	_indexType = maxIndex <= UINT16_MAX ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
+
+void Shape::setIndices(const std::vector<uint16_t>& indices) {
+	_indices.assign(indices.begin(), indices.end());
+	_indexType = VK_INDEX_TYPE_UINT16;
+}
+
 void Shape::upload(const RenderContext& ctx, uint32_t framesInFlight, VkImageView textureImageView, VkSampler textureSampler, const std::vector<VkDescriptorBufferInfo>& lightingBufferInfos) {
-	const VkDeviceSize vSize = sizeof(Vertex) * _vertices.size();
-	VkBuffer vStaging{}; VkDeviceMemory vStageMem{};
-	createBuffer(ctx, vSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		vStaging, vStageMem);
-	void* mapped = nullptr;
-	vkMapMemory(ctx.device, vStageMem, 0, vSize, 0, &mapped);
-	std::memcpy(mapped, _vertices.data(), static_cast<size_t>(vSize));
-	vkUnmapMemory(ctx.device, vStageMem);
-
-	createBuffer(ctx, vSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _vertexBuffer, _vertexBufferMemory);
-	copyBuffer(ctx, vStaging, _vertexBuffer, vSize);
-	vkDestroyBuffer(ctx.device, vStaging, nullptr);
-	vkFreeMemory(ctx.device, vStageMem, nullptr);
-
-	// Index buffer
-	const VkDeviceSize iSize = sizeof(uint16_t) * _indices.size();
-	VkBuffer iStaging{}; VkDeviceMemory iStageMem{};
-	createBuffer(ctx, iSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		iStaging, iStageMem);
-	vkMapMemory(ctx.device, iStageMem, 0, iSize, 0, &mapped);
-	std::memcpy(mapped, _indices.data(), static_cast<size_t>(iSize));
-	vkUnmapMemory(ctx.device, iStageMem);
-
-	createBuffer(ctx, iSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _indexBuffer, _indexBufferMemory);
-	copyBuffer(ctx, iStaging, _indexBuffer, iSize);
-	vkDestroyBuffer(ctx.device, iStaging, nullptr);
-	vkFreeMemory(ctx.device, iStageMem, nullptr);
-
-	// Per-frame UBOs
-	const VkDeviceSize uboSize = sizeof(glm::mat4) * 3; // model, view, proj
-	_uniformBuffers.resize(framesInFlight);
-	_uniformBuffersMemory.resize(framesInFlight);
-	_uniformBuffersMapped.resize(framesInFlight);
+	uploadGeometry(ctx);
+	uploadDescriptors(ctx, framesInFlight, textureImageView, textureSampler, lightingBufferInfos);
+}
 
-	for (uint32_t i = 0; i < framesInFlight; ++i) {
-		createBuffer(ctx, uboSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			_uniformBuffers[i], _uniformBuffersMemory[i]);
-		vkMapMemory(ctx.device, _uniformBuffersMemory[i], 0, uboSize, 0, &_uniformBuffersMapped[i]);
+void Shape::uploadGeometry(const RenderContext& ctx) {
+	if (!ctx.geometry) {
+		throw std::runtime_error("Shape: RenderContext has no geometry arena");
 	}
 
-	// Descriptor sets (UBO + texture sampler)
-	_descriptorSets.resize(framesInFlight);
-	std::vector<VkDescriptorSetLayout> layouts(framesInFlight, ctx.descriptorSetLayout);
+	// Index width stays as chosen in setIndices; indices are mesh-local and rebased by vertexOffset
+	_geometryArena = ctx.geometry;
+	_geometry = ctx.geometry->add(_vertices, _indices, _indexType);
+}
 
-	VkDescriptorSetAllocateInfo alloc{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
-	alloc.descriptorPool = ctx.descriptorPool;
-	alloc.descriptorSetCount = framesInFlight;
-	alloc.pSetLayouts = layouts.data();
-	if (vkAllocateDescriptorSets(ctx.device, &alloc, _descriptorSets.data()) != VK_SUCCESS)
-		throw std::runtime_error("Mesh: allocate descriptor sets failed");
+void Shape::uploadDescriptors(const RenderContext& ctx, uint32_t framesInFlight, VkImageView textureImageView, VkSampler textureSampler, const std::vector<VkDescriptorBufferInfo>& lightingBufferInfos) {
+	if (!ctx.uniforms || !ctx.descriptors) {
+		throw std::runtime_error("Shape: RenderContext has no frame uniforms or descriptor allocator");
+	}
+
+	// One model-matrix slot, shared across frames through the dynamic offset; re-uploading keeps the count flat
+	if (_uniforms != nullptr) {
+		_uniforms->releaseSlot(_uniformSlot);
+	}
+	_uniforms = ctx.uniforms;
+	_uniformSlot = ctx.uniforms->acquireSlot();
+	const VkDescriptorBufferInfo objectInfo = ctx.uniforms->objectBufferInfo();
+
+	// Descriptor sets (UBO + texture sampler); long-lived, so they survive swapchain recreation
+	if (_descriptors != nullptr) {
+		_descriptors->free(static_cast<uint32_t>(_descriptorSets.size()), _descriptorSets.data());
+	}
+	_descriptors = ctx.descriptors;
+	_descriptorSets.resize(framesInFlight);
+	ctx.descriptors->allocate(ctx.descriptorSetLayout, framesInFlight, _descriptorSets.data());
 
 	for (uint32_t i = 0; i < framesInFlight; ++i) {
-		VkDescriptorBufferInfo bufInfo{};
-		bufInfo.buffer = _uniformBuffers[i];
-		bufInfo.offset = 0;
-		bufInfo.range = uboSize;
+		const VkDescriptorBufferInfo cameraInfo = ctx.uniforms->cameraBufferInfo(i);
 
 		VkDescriptorImageInfo imgInfo{};
 		imgInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		imgInfo.imageView = textureImageView;
 		imgInfo.sampler = textureSampler;
 
-		std::array<VkWriteDescriptorSet, 3> writesStorage{};
-		std::span<VkWriteDescriptorSet, 3> writes{writesStorage};
+		std::array<VkWriteDescriptorSet, 4> writesStorage{};
+		std::span<VkWriteDescriptorSet, 4> writes{writesStorage};
 
 		writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 		writes[0].dstSet = _descriptorSets[i];
-		writes[0].dstBinding = 0; // UBO
-		writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		writes[0].dstBinding = 0; // object UBO, dynamic
+		writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 		writes[0].descriptorCount = 1;
-		writes[0].pBufferInfo = &bufInfo;
+		writes[0].pBufferInfo = &objectInfo;
 
 		writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 		writes[1].dstSet = _descriptorSets[i];
@@ -237,60 +168,122 @@ void Shape::upload(const RenderContext& ctx, uint32_t framesInFlight, VkImageVie
 		writes[2].descriptorCount = 1;
 		writes[2].pBufferInfo = &lightingBufferInfos[i];
 
+		writes[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[3].dstSet = _descriptorSets[i];
+		writes[3].dstBinding = 5; // camera UBO
+		writes[3].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		writes[3].descriptorCount = 1;
+		writes[3].pBufferInfo = &cameraInfo;
+
 		vkUpdateDescriptorSets(ctx.device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
 	}
+
+	_descriptorDevice = ctx.device;
+	if (ctx.bindless != nullptr) {
+		_materialIndex = ctx.bindless->addMaterial(_material);
+	}
+	_boundTextureViews.clear();
+	if (textureImageView != VK_NULL_HANDLE && textureImageView == _material.getTextureImageView()) {
+		_boundTextureViews.assign(framesInFlight, textureImageView);
+	}
 }
 
 void Shape::destroy(const RenderContext& ctx) {
-	for (size_t i = 0; i < _uniformBuffers.size(); ++i) {
-		if (_uniformBuffersMapped[i]) vkUnmapMemory(ctx.device, _uniformBuffersMemory[i]);
-		if (_uniformBuffers[i]) vkDestroyBuffer(ctx.device, _uniformBuffers[i], nullptr);
-		if (_uniformBuffersMemory[i]) vkFreeMemory(ctx.device, _uniformBuffersMemory[i], nullptr);
-	}
-	_uniformBuffers.clear(); _uniformBuffersMemory.clear(); _uniformBuffersMapped.clear(); _descriptorSets.clear();
+	destroyDescriptors(ctx);
+	destroyGeometry(ctx);
+}
 
-	if (_indexBuffer) vkDestroyBuffer(ctx.device, _indexBuffer, nullptr);
-	if (_indexBufferMemory) vkFreeMemory(ctx.device, _indexBufferMemory, nullptr);
-	if (_vertexBuffer) vkDestroyBuffer(ctx.device, _vertexBuffer, nullptr);
-	if (_vertexBufferMemory) vkFreeMemory(ctx.device, _vertexBufferMemory, nullptr);
+void Shape::destroyDescriptors(const RenderContext& ctx) {
+	if (_uniforms != nullptr) {
+		_uniforms->releaseSlot(_uniformSlot);
+		_uniforms = nullptr;
+	}
+	if (_descriptors != nullptr) {
+		_descriptors->free(static_cast<uint32_t>(_descriptorSets.size()), _descriptorSets.data());
+		_descriptors = nullptr;
+	}
+	_descriptorSets.clear();
+	_boundTextureViews.clear();
+	_descriptorDevice = VK_NULL_HANDLE;
+}
 
-	_indexBuffer = _vertexBuffer = VK_NULL_HANDLE;
-	_indexBufferMemory = _vertexBufferMemory = VK_NULL_HANDLE;
+void Shape::destroyGeometry(const RenderContext& ctx) {
+	if (!_geometry || _geometryArena == nullptr) return;
+	_geometryArena->remove(_geometry);
+	_geometryArena = nullptr;
 }
 
-void Shape::updateUniformBuffer(uint32_t frameIndex, const glm::mat4& model, const glm::mat4& view, const glm::mat4& proj) const {
-	struct UBO { alignas(16) glm::mat4 m, v, p; } const u{ model, view, proj };
-	std::memcpy(_uniformBuffersMapped[frameIndex], &u, sizeof(u));
+void Shape::updateUniformBuffer(uint32_t frameIndex, const glm::mat4& model) const {
+	if (_uniforms == nullptr) return;
+	_uniforms->writeObject(frameIndex, _uniformSlot, model);
 }
 
 void Shape::draw(VkCommandBuffer cmd, VkPipeline pipeline, VkPipelineLayout layout,
 	uint32_t currentFrame) {
-	if (_vertices.empty() || _indices.empty()) return;
-	if (_vertexBuffer == VK_NULL_HANDLE || _indexBuffer == VK_NULL_HANDLE) return;
+	if (!_geometry) return;
+	if (currentFrame >= _descriptorSets.size()) return;
+
+	bindDescriptors(cmd, pipeline, layout, currentFrame);
+	drawGeometry(cmd);
+}
+
+void Shape::bindDescriptors(VkCommandBuffer cmd, VkPipeline pipeline, VkPipelineLayout layout,
+	uint32_t currentFrame) const {
 	if (currentFrame >= _descriptorSets.size()) return;
 
 	// Bind pipeline
 	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	CommandStats::add(CommandStats::PipelineBind);
 
-	// Bind vertex buffer
-	std::array<VkDeviceSize, 1> offsetsStorage{ 0 };
-	const std::span<VkDeviceSize, 1> offsets{ offsetsStorage };
-	
-	std::array<VkBuffer, 1> vbsStorage{ _vertexBuffer };
-	const std::span < VkBuffer > vbs{ vbsStorage };
-	vkCmdBindVertexBuffers(cmd, 0, 1, vbs.data(), offsets.data());
+	bindObjectSet(cmd, layout, currentFrame);
+}
 
-	// Bind index buffer (uint16_t indices in this code path)
-	vkCmdBindIndexBuffer(cmd, _indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+void Shape::bindObjectSet(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t currentFrame) const {
+	if (currentFrame >= _descriptorSets.size()) return;
 
 	// Bind per-frame descriptor set (set = 0)
 	const VkDescriptorSet set = _descriptorSets[currentFrame];
-	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout,
-		0, 1, &set, 0, nullptr);
 
-	// Issue draw
-	vkCmdDrawIndexed(cmd, static_cast<uint32_t>(_indices.size()), 1, 0, 0, 0);
+	// The frame's fence has been waited on, so its set can be rewritten if the texture was streamed in since
+	if (currentFrame < _boundTextureViews.size()) {
+		const VkImageView view = _material.getTextureImageView();
+		if (view != VK_NULL_HANDLE && view != _boundTextureViews[currentFrame]) {
+			VkDescriptorImageInfo imgInfo{};
+			imgInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			imgInfo.imageView = view;
+			imgInfo.sampler = _material.getTextureSampler();
+
+			VkWriteDescriptorSet write{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+			write.dstSet = set;
+			write.dstBinding = 1; // sampler
+			write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			write.descriptorCount = 1;
+			write.pImageInfo = &imgInfo;
+			vkUpdateDescriptorSets(_descriptorDevice, 1, &write, 0, nullptr);
+			_boundTextureViews[currentFrame] = view;
+		}
+	}
+
+	const uint32_t objectOffset = _uniforms->objectOffset(currentFrame, _uniformSlot);
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout,
+		0, 1, &set, 1, &objectOffset);
+	CommandStats::add(CommandStats::DescriptorBind);
 }
 
+void Shape::pushDrawConstants(VkCommandBuffer cmd, VkPipelineLayout layout) const {
+	if (_uniforms == nullptr) return;
+	const BindlessTable::DrawConstants constants{ _uniforms->objectIndex(_uniformSlot), _materialIndex };
+	vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(constants), &constants);
+	CommandStats::add(CommandStats::PushConstants);
+}
 
+void Shape::drawBindless(VkCommandBuffer cmd, VkPipelineLayout layout) const {
+	if (!_geometry || _uniforms == nullptr) return;
+	pushDrawConstants(cmd, layout);
+	drawGeometry(cmd);
+}
 
+void Shape::drawGeometry(VkCommandBuffer cmd) const {
+	if (!_geometry || _geometryArena == nullptr) return;
+	_geometryArena->draw(cmd, _geometry);
+}
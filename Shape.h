@@ -5,6 +5,11 @@
 #include <vector>
 #include "Vertex.h"
 #include "RenderContext.h"
+#include "GpuAllocator.h"
+#include "GeometryArena.h"
+#include "FrameUniforms.h"
+#include "DescriptorAllocator.h"
+#include "BindlessTable.h"
 #include "Shape.h"
 #include "ObjLoader.h"
 #include "glm/glm.hpp"
@@ -16,17 +21,25 @@ class Shape :
 {
 	
 	std::vector<Vertex> _vertices = {};
-	std::vector<uint16_t> _indices = {};
-	std::vector<VkBuffer> _uniformBuffers;
-	std::vector<VkDeviceMemory> _uniformBuffersMemory;
-	std::vector<void*> _uniformBuffersMapped;
+	std::vector<uint32_t> _indices = {};
+	VkIndexType _indexType{ VK_INDEX_TYPE_UINT16 };
+	// Slot in the shared per-frame object uniforms, bound with a dynamic offset
+	FrameUniforms* _uniforms{ nullptr };
+	uint32_t _uniformSlot{ FrameUniforms::kInvalidSlot };
+	// Sets come from, and are freed back to, the shared descriptor allocator
+	DescriptorAllocator* _descriptors{ nullptr };
 	std::vector<VkDescriptorSet> _descriptorSets;
+	// View written to each frame's sampler binding when it came from _material's texture; empty otherwise.
+	// A streamed texture swaps its image later, and bindDescriptors rewrites that frame's set to follow it.
+	mutable std::vector<VkImageView> _boundTextureViews;
+	VkDevice _descriptorDevice{ VK_NULL_HANDLE };
+	// Entry for _material in the bindless material buffer, when the context has one
+	uint32_t _materialIndex{ 0 };
 	
 	Material _material;
-	VkBuffer _vertexBuffer{ VK_NULL_HANDLE };
-	VkBuffer _indexBuffer{ VK_NULL_HANDLE };
-	VkDeviceMemory _vertexBufferMemory{ VK_NULL_HANDLE };
-	VkDeviceMemory _indexBufferMemory{ VK_NULL_HANDLE };
+	// Range of the shared vertex/index buffers holding this shape's geometry
+	GeometryArena* _geometryArena{ nullptr };
+	GeometryRange _geometry{};
 
 
 
@@ -50,11 +63,37 @@ class Shape :
 		virtual void move() = 0;
 		void upload(const RenderContext& ctx, uint32_t framesInFlight, VkImageView textureImageView, VkSampler textureSampler, const std::vector<VkDescriptorBufferInfo>& lightinBufferInfos);
 		void destroy(const RenderContext& ctx);
-		void updateUniformBuffer(uint32_t frameIndex, const glm::mat4& model, const glm::mat4& view, const glm::mat4& proj) const;
+
+		// Geometry (a range of ctx.geometry) and per-object descriptors (UBOs + sets) can be managed separately,
+		// so one uploaded shape can supply geometry for many objects with their own descriptors.
+		void uploadGeometry(const RenderContext& ctx);
+		void uploadDescriptors(const RenderContext& ctx, uint32_t framesInFlight, VkImageView textureImageView, VkSampler textureSampler, const std::vector<VkDescriptorBufferInfo>& lightinBufferInfos);
+		void destroyGeometry(const RenderContext& ctx);
+		void destroyDescriptors(const RenderContext& ctx);
+		void bindDescriptors(VkCommandBuffer cmd, VkPipeline pipeline, VkPipelineLayout layout, uint32_t currentFrame) const;
+		// Just the object's set, for draws that leave the pipeline to the pass
+		void bindObjectSet(VkCommandBuffer cmd, VkPipelineLayout layout, uint32_t currentFrame) const;
+		// Bindless path: the pass has bound the pipeline and BindlessTable set, so a draw only pushes its
+		// object and material indices
+		void pushDrawConstants(VkCommandBuffer cmd, VkPipelineLayout layout) const;
+		void drawBindless(VkCommandBuffer cmd, VkPipelineLayout layout) const;
+		// Draws from the arena with firstIndex/vertexOffset; needs a GeometryArena::Recording open on cmd
+		void drawGeometry(VkCommandBuffer cmd) const;
+		bool hasGeometry() const { return static_cast<bool>(_geometry); }
+		const GeometryRange& geometryRange() const { return _geometry; }
+		// View and projection come from the frame's camera block; only the model matrix is per object
+		void updateUniformBuffer(uint32_t frameIndex, const glm::mat4& model) const;
 		void setVertices(const std::vector<Vertex>& vertices) { _vertices = vertices; };
-		void setIndices(const std::vector<uint16_t>& indices) { _indices = indices; };
+		// Index width is picked from the largest index: 16-bit when it fits, 32-bit otherwise
+		void setIndices(const std::vector<uint32_t>& indices);
+		void setIndices(const std::vector<uint16_t>& indices);
 		std::vector<Vertex> getVertices() const { return _vertices; };
-		std::vector<uint16_t> getIndices() const { return _indices; };
+		std::vector<uint32_t> getIndices() const { return _indices; };
+		VkIndexType getIndexType() const { return _indexType; }
+		// Heap bytes held by the CPU copy of the geometry in _vertices/_indices
+		size_t vertexDataBytes() const { return _vertices.capacity() * sizeof(Vertex) + _indices.capacity() * sizeof(uint32_t); }
+		// Heap bytes held by a subclass's own build-time copy of the geometry, if it keeps one
+		virtual size_t localDataBytes() const { return 0; }
 		const Material getMaterial() const {
 			return _material;
 		}
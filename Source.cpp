@@ -15,12 +15,18 @@
 #include <chrono>
 #include <vector>
 #include <cstring>
+#include <cmath>
 #include <cstdlib>
 #include <cstdint>
 #include <limits>
 #include <array>
 #include <optional>
 #include <set>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
 #include "ObjLoader.h"
 #include "CameraManager.h"
@@ -38,11 +44,100 @@
 #include "GraphicsPipelineBuilder.h"
 #include "particleSystem.h"
 #include "GlobeScene.h"
+#include "ObjLoaderBenchmark.h"
+#include "MeshOptimizer.h"
+#include "ImageDecoder.h"
+#include "UploadBatcher.h"
+#include "GpuAllocator.h"
+#include "GeometryArena.h"
+#include "FrameUniforms.h"
+#include "ParticleCompute.h"
+#include "ParticleCheck.h"
+#include "MipChain.h"
+#include "MipChainCheck.h"
+#include "MemoryReport.h"
+#include "DescriptorAllocator.h"
+#include "BindlessTable.h"
+#include "CommandStats.h"
+#include "DeletionQueue.h"
+#include "FrameLatency.h"
+#include "JobSystem.h"
+#include "ParallelRecorder.h"
+#include "RenderQueue.h"
+#include "StaticCommandCache.h"
+#include "TaskGraph.h"
+#include "TripleBuffer.h"
 
 const uint32_t WIDTH = 800;
 const uint32_t HEIGHT = 600;
 
-const int MAX_FRAMES_IN_FLIGHT = 2;
+// Per-frame resources are created for the deepest latency profile; a profile cycles through the first
+// framesInFlight of them
+const int MAX_FRAMES_IN_FLIGHT = 3;
+
+// Latency profiles (--latency, F10 cycles them). Fewer frames in flight and a shallower swapchain shorten the
+// time from input to display; more let the CPU run ahead so a slow frame does not stall the GPU.
+enum class LatencyMode : uint8_t { Low, Balanced, Throughput };
+
+struct LatencyProfile {
+    const char* name;
+    uint32_t framesInFlight;
+    uint32_t extraSwapchainImages;                // on top of the surface's minImageCount
+    bool sampleAfterWait;                         // wait for the frame's fence and image before polling input
+    std::array<VkPresentModeKHR, 2> presentModes; // tried in order; FIFO is always supported and the fallback
+};
+
+const std::array<LatencyProfile, 3> LATENCY_PROFILES = { {
+    { "low latency", 1, 0, true, { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR } },
+    { "balanced", 2, 1, false, { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR } },
+    { "throughput", 3, 2, false, { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR } },
+} };
+
+bool parseLatencyMode(const std::string& name, LatencyMode& mode)
+{
+    if (name == "low") mode = LatencyMode::Low;
+    else if (name == "balanced") mode = LatencyMode::Balanced;
+    else if (name == "throughput") mode = LatencyMode::Throughput;
+    else return false;
+    return true;
+}
+
+const char* presentModeName(VkPresentModeKHR mode)
+{
+    switch (mode) {
+    case VK_PRESENT_MODE_IMMEDIATE_KHR: return "immediate";
+    case VK_PRESENT_MODE_MAILBOX_KHR: return "mailbox";
+    case VK_PRESENT_MODE_FIFO_KHR: return "FIFO";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO relaxed";
+    default: return "other";
+    }
+}
+
+// Model matrix slots in the shared uniform buffer besides one per scene object: the frame set, the cabin,
+// cylinder and globe, with room to spare. The buffer is sized once the scene is loaded. Descriptor sets are not
+// capped: the descriptor allocator chains pools as objects are added.
+const uint32_t ENGINE_OBJECT_UNIFORM_SLOTS = 64;
+
+// --bench-record: scene size when none is given, and recordings timed per thread count
+const size_t RECORD_BENCH_OBJECTS = 10000;
+const int RECORD_BENCH_ITERATIONS = 20;
+const char* const RECORD_BENCH_SCENE_PATH = "models/_synthetic_scene.csv";
+
+// --bench-render-thread: frames timed in each mode when none is given, after a warm-up that fills the pipeline
+const size_t PIPELINE_BENCH_FRAMES = 600;
+const int PIPELINE_BENCH_WARMUP = 30;
+
+// --check-particles: steps compared between the CPU reference and shader.comp when none is given
+const uint32_t PARTICLE_CHECK_STEPS = 300;
+
+// The shadow map has a fixed resolution so resizing the window does not touch it or the descriptors that sample it.
+const uint32_t SHADOW_MAP_SIZE = 2048;
+
+// Memory report: F9 writes one on demand, one is written every MEMORY_REPORT_INTERVAL and at shutdown.
+// CPU usage and heap budgets are sampled every MEMORY_SAMPLE_INTERVAL for the high-water marks.
+const char* const MEMORY_REPORT_PATH = "memory_report.json";
+const float MEMORY_SAMPLE_INTERVAL = 1.0f;   // seconds
+const float MEMORY_REPORT_INTERVAL = 30.0f;  // seconds
 
 const std::vector<const char*> validationLayers = {
     "VK_LAYER_KHRONOS_validation"
@@ -90,12 +185,6 @@ struct SwapChainSupportDetails {
     std::vector<VkPresentModeKHR> presentModes;
 };
 
-struct UniformBufferObject {
-    alignas(16) glm::mat4 model;
-    alignas(16) glm::mat4 view;
-    alignas(16) glm::mat4 proj;
-};
-
 struct TimeUBO
 {
 	float time;
@@ -109,6 +198,35 @@ struct ShadowUBO {
     alignas(16) glm::mat4 lightProj;
 };
 
+// Key presses and upkeep acted on by whichever thread draws, so render settings and the allocator have a single owner
+struct FrameRequests {
+    bool toggleParallelRecording = false;
+    bool toggleBindless = false;
+    bool toggleSerialJobs = false;
+    bool printTimings = false;
+    bool writeMemoryReport = false;
+    bool toggleStaticCache = false;
+    bool toggleSortedDraws = false;
+};
+
+// Everything needed to draw one frame, taken from the simulation. In render thread mode the main thread fills
+// one and never touches it again once published; the render thread uploads and records from it alone.
+struct FrameSnapshot {
+    CameraUniforms camera{};
+    glm::mat4 sceneModel{ 1.0f };
+    std::vector<glm::mat4> objectModels;  // per scene object, in GlobeScene::getObjects() order
+    LightingUBOCPU lighting{};
+    ShadowUBO shadow{};
+    bool hasShadow = false;
+    TimeUBO time{};
+    std::chrono::steady_clock::time_point sampleTime{}; // when the input the frame was built from was polled
+    std::vector<ParticleFrame> particles; // one per snapshotParticles entry
+    int framebufferWidth = 0;
+    int framebufferHeight = 0;
+    FrameRequests requests{};
+    bool quit = false;                    // the render thread exits instead of drawing
+};
+
 std::vector<Vertex> vertices = {
     // -X -Y +Z
     { {-1.0f, -1.0f,  1.0f}, {0,0,0}, {0,0} },
@@ -152,13 +270,45 @@ void loadModel()
 
 class HelloTriangleApplication {
 public:
-    void run() {
+    // Returns non-zero when a self-check mode finds a mismatch
+    int run() {
         initWindow();
         initVulkan();
-        mainLoop();
+        int status = 0;
+        if (particleCheckSteps > 0) {
+            status = runParticleCheck(_ctx, particleCheckSteps);
+        }
+        else if (recordBenchObjects > 0) {
+            runRecordingBenchmark();
+        }
+        else if (pipelineBenchFrames > 0) {
+            runPipelineBenchmark();
+        }
+        else {
+            mainLoop();
+        }
         cleanup();
+        return status;
     }
 
+    // Threads in the job system, including the main thread; 0 uses every hardware thread, 1 runs the frame serially
+    void setJobThreads(unsigned threads) { jobThreads = threads; }
+    // Starts in the deterministic single-thread mode that F6 toggles
+    void setSerialJobs(bool serial) { serialJobs = serial; }
+    // Caps the threads parallel command recording uses; 0 uses every job system thread
+    void setRecordThreads(unsigned threads) { recordThreads = threads; }
+    // Loads a synthetic scene of this many objects, prints recording times for 1..N threads and exits
+    void setRecordBenchmark(size_t objects) { recordBenchObjects = objects; }
+    // Starts with recording and submission on their own thread, which F4 toggles
+    void setRenderThread(bool enabled) { renderThreadMode = enabled; }
+    // Times this many frames drawn inline, then as many through the render thread, and exits
+    void setPipelineBenchmark(size_t frames) { pipelineBenchFrames = frames; }
+    // Steps CPU and GPU particle systems side by side for this many frames, compares them and exits
+    void setParticleCheck(uint32_t steps) { particleCheckSteps = steps; }
+    void setLatencyMode(LatencyMode mode) { latencyMode = mode; }
+    void setStaticCaching(bool enabled) { staticCaching = enabled; }
+    void setSortedDraws(bool enabled) { sortedDraws = enabled; }
+
 private:
     GLFWwindow* window;
     Mesh _mesh;
@@ -187,10 +337,11 @@ private:
     VkQueue graphicsQueue;
     VkQueue presentQueue;
 
-    VkSwapchainKHR swapChain;
+    VkSwapchainKHR swapChain = VK_NULL_HANDLE;
     std::vector<VkImage> swapChainImages;
     VkFormat swapChainImageFormat;
     VkExtent2D swapChainExtent;
+    VkPresentModeKHR swapChainPresentMode = VK_PRESENT_MODE_FIFO_KHR;
     std::vector<VkImageView> swapChainImageViews;
     std::vector<VkFramebuffer> swapChainFramebuffers;
 
@@ -205,16 +356,17 @@ private:
     VkCommandPool commandPool;
 
     VkImage depthImage;
-    VkDeviceMemory depthImageMemory;
+    GpuAllocation depthImageAllocation;
     VkImageView depthImageView;
 
     VkImage textureImage;
-    VkDeviceMemory textureImageMemory;
+    GpuAllocation textureImageAllocation;
+    uint32_t textureMipLevels = 1;
     VkImageView textureImageView;
     VkSampler textureSampler;
 
     VkImage shadowImage;
-	VkDeviceMemory shadowImageMemory;
+	GpuAllocation shadowImageAllocation;
 	VkImageView shadowImageView;
 	VkSampler shadowSampler;
 
@@ -225,36 +377,116 @@ private:
 	VkPipelineLayout shadowPipelineLayout = VK_NULL_HANDLE;
 	VkDescriptorSetLayout shadowDescriptorSetLayout = VK_NULL_HANDLE;
     std::vector<VkBuffer> shadowUniformBuffers;
-	std::vector<VkDeviceMemory> shadowUniformBuffersMemory;
+	std::vector<GpuAllocation> shadowUniformBuffersAllocations;
 	std::vector<void*> shadowUniformBuffersMapped;
 	std::vector<VkDescriptorSet> shadowDescriptorSets;
 
-    VkBuffer vertexBuffer;
-    VkDeviceMemory vertexBufferMemory;
-    VkBuffer indexBuffer;
-    VkDeviceMemory indexBufferMemory;
+    // Skybox cube, drawn from the shared geometry arena like every other mesh
+    GeometryRange skyboxGeometry{};
 
-    std::vector<VkBuffer> uniformBuffers;
-    std::vector<VkDeviceMemory> uniformBuffersMemory;
-    std::vector<void*> uniformBuffersMapped;
+    // Camera block per frame plus one model-matrix slot per object; the frame set uses frameObjectSlot
+    FrameUniforms frameUniforms;
+    ParticleCompute particleCompute;
+    uint32_t frameObjectSlot = FrameUniforms::kInvalidSlot;
 
 	std::vector<VkBuffer> lightUniformBuffers;
-	std::vector<VkDeviceMemory> lightUniformBuffersMemory;
+	std::vector<GpuAllocation> lightUniformBuffersAllocations;
 	std::vector<void*> lightUniformBuffersMapped;
 
 	std::vector<VkBuffer> timeBuffer;
-	std::vector<VkDeviceMemory> timeBufferMemory;
+	std::vector<GpuAllocation> timeBufferAllocations;
 	std::vector<void*> timeBuffersMapped;
 
-    VkDescriptorPool descriptorPool;
+    DescriptorAllocator descriptorAllocator;
     std::vector<VkDescriptorSet> descriptorSets;
 
+    // Swapchain-sized objects replaced by a resize, destroyed once the frames that used them have completed
+    DeletionQueue deletionQueue;
+
+    // Descriptor-indexing path: passes bind the frame, shadow and table sets once and each draw pushes
+    // its object and material indices. Objects keep their own sets, so F8 can switch back to them.
+    BindlessTable bindlessTable;
+    bool bindlessSupported = false; // descriptor-indexing features are enabled on the device
+    bool bindlessEnabled = false;
+    bool _bindlessKeyDown = false;
+    VkPipelineLayout bindlessPipelineLayout = VK_NULL_HANDLE;
+
+    // The frame's CPU work runs as a task graph on the job system: scene update, then particle integration and
+    // uniform packing, then command recording. F6 switches to running it serially on the main thread, F5
+    // prints how long each task took.
+    JobSystem jobs;
+    TaskGraph frameGraph;
+    unsigned jobThreads = 0;
+    bool serialJobs = false;
+    bool _serialKeyDown = false;
+    bool _timingKeyDown = false;
+    uint32_t frameImageIndex = 0;     // swapchain image the graph's record task draws to
+    FrameSnapshot inlineFrame;        // frame constants drawFrame builds and uploads itself
+    const FrameSnapshot* frameBeingDrawn = &inlineFrame;
+    FrameRequests pendingRequests;    // key presses since the last frame was drawn or published
+
+    // Render thread mode (--render-thread, F4): the main thread polls input and simulates, then publishes a
+    // FrameSnapshot through a triple buffer; the render thread uploads, records and submits it. Simulating
+    // frame N + 1 overlaps drawing frame N, and the snapshot is the only state the two threads share.
+    bool renderThreadMode = false;
+    bool _renderThreadKeyDown = false;
+    std::thread renderThread;
+    TripleBuffer<FrameSnapshot> snapshots;
+    TaskGraph simulationGraph;        // main thread: fills simulationFrame
+    TaskGraph snapshotGraph;          // render thread: uploads and records frameBeingDrawn
+    FrameSnapshot* simulationFrame = nullptr;
+    std::vector<particleSystem*> snapshotParticles; // stepped by the main thread, streamed by the render thread
+    std::exception_ptr renderThreadError;
+    std::atomic<bool> renderThreadFailed{ false };
+    size_t pipelineBenchFrames = 0;
+
+    // Parallel recording: the scene list of the shadow and main passes is split across the job system's
+    // threads into secondary command buffers, which the primary executes in list order. F7 switches back to
+    // recording inline.
+    ParallelRecorder recorder;
+    unsigned recordThreads = 0;
+    bool parallelRecording = false;
+    bool _parallelKeyDown = false;
+    std::vector<VkCommandBuffer> passSecondaries; // reused by each pass
+
+    // Static content (the cabin, cylinder and globe, and every scene object) is recorded once per frame in flight
+    // into cached secondaries; each frame records only the post-process quad, skybox and particles. F11 switches
+    // back to recording everything every frame. The tallies count commands per frame in each mode.
+    enum StaticEntry : uint32_t { StaticShadow, StaticPresentOpaque, StaticPresentOutline, StaticEntryCount };
+    struct CommandTally {
+        uint64_t frames = 0;
+        CommandStats::Counts recorded; // written this frame, including any cache entry recorded again
+        CommandStats::Counts executed; // run from cached secondaries
+    };
+    StaticCommandCache staticCache;
+    bool staticCaching = true;
+    bool _staticCacheKeyDown = false;
+    uint64_t textureSwaps = 0;        // streamed images swapped in; each rewrites descriptors cached draws bind
+    std::array<std::array<CommandTally, 2>, 2> commandTallies; // [static cache][sorted draws]
+
+    // Scene objects of both passes as sort keys, rebuilt each frame before recording; F12 switches back to
+    // drawing them in GlobeScene::getObjects() order with a pipeline bind per object
+    enum ScenePass : uint32_t { ShadowScenePass, MainScenePass };
+    RenderQueue renderQueue;
+    bool sortedDraws = true;
+    bool _sortedDrawsKeyDown = false;
+    size_t recordBenchObjects = 0;
+    VkPipeline phongBindlessPipeline = VK_NULL_HANDLE;
+    VkPipeline gouraudBindlessPipeline = VK_NULL_HANDLE;
+    VkPipeline shadowBindlessPipeline = VK_NULL_HANDLE;
+
     std::vector<VkCommandBuffer> commandBuffers;
 
     std::vector<VkSemaphore> imageAvailableSemaphores;
     std::vector<VkSemaphore> renderFinishedSemaphores;
     std::vector<VkFence> inFlightFences;
     uint32_t currentFrame = 0;
+    // currentFrame cycles through [0, framesInFlight); the profile decides both, F10 switches it between frames
+    LatencyMode latencyMode = LatencyMode::Balanced;
+    uint32_t framesInFlight = LATENCY_PROFILES[static_cast<size_t>(LatencyMode::Balanced)].framesInFlight;
+    FrameLatency frameLatency;        // owned by whichever thread draws
+    bool _latencyKeyDown = false;
+    std::chrono::steady_clock::time_point inputSampleTime; // last glfwPollEvents(), stamped on the frame built from it
 
 	CameraManager cameraManager;
     Camera camera1;
@@ -262,6 +494,16 @@ private:
 	Camera camera3;
 
     textureManager texManager;
+    MeshLibrary meshLibrary;
+    GpuAllocator allocator;
+    bool memoryBudgetSupported = false; // VK_EXT_memory_budget is enabled on the device
+    MemoryReport memoryReport;
+    std::chrono::steady_clock::time_point _memoryReportStart;
+    std::chrono::steady_clock::time_point _lastMemorySample;
+    std::chrono::steady_clock::time_point _lastMemoryReport;
+    bool _memoryReportKeyDown = false;
+    UploadBatcher uploader;
+    GeometryArena geometryArena;
 
     std::vector<Light> _lights;
     Light pt;
@@ -283,12 +525,10 @@ private:
 
 	VkPipeline postProcessPipeline = VK_NULL_HANDLE;
 	VkPipelineLayout postProcessPipelineLayout = VK_NULL_HANDLE;
-	VkDescriptorPool postProcessDescriptorPool = VK_NULL_HANDLE;
-	std::vector<VkDescriptorSet> postProcessDescriptorSets;
 	VkDescriptorSetLayout postProcessDescriptorSetLayout = VK_NULL_HANDLE;
 
 	VkImage offscreenImage = VK_NULL_HANDLE;
-	VkDeviceMemory offscreenImageMemory = VK_NULL_HANDLE;
+	GpuAllocation offscreenImageAllocation{};
 	VkImageView offscreenImageView = VK_NULL_HANDLE;
 	VkSampler offscreenSampler = VK_NULL_HANDLE;
 
@@ -309,8 +549,9 @@ private:
     float _deltaTime = 0.0f;
 
     std::vector<particleSystem> _particleSystems;
+    uint32_t particleCheckSteps = 0;
 
-    bool framebufferResized = false;
+    std::atomic<bool> framebufferResized{ false }; // set by GLFW on the main thread, cleared by whichever thread presents
 
     float _burstTimer = 0.0f;
     float _burstInterval = 0.75f;
@@ -318,9 +559,9 @@ private:
     float _timeScale = 1.0f;
 
 	VkBuffer particleQuadVB = VK_NULL_HANDLE;
-	VkDeviceMemory particleQuadVBMemory = VK_NULL_HANDLE;
+	GpuAllocation particleQuadVBAllocation{};
 	VkBuffer particleQuadIB = VK_NULL_HANDLE;
-	VkDeviceMemory particleQuadIBMemory = VK_NULL_HANDLE;
+	GpuAllocation particleQuadIBAllocation{};
 	uint32_t particleQuadIndexCount = 0;
 
     // Simple rain settings
@@ -334,7 +575,7 @@ private:
     float _rainLifeMax = 2.5f;
 
     VkImage maskImage = VK_NULL_HANDLE;
-    VkDeviceMemory maskImageMemory = VK_NULL_HANDLE;
+    GpuAllocation maskImageAllocation{};
     VkImageView maskImageView = VK_NULL_HANDLE;
     VkSampler maskSampler = VK_NULL_HANDLE;
 
@@ -362,6 +603,32 @@ private:
     }
 
     void initVulkan() {
+        // Image decoding is CPU-only, so start it before any Vulkan setup and overlap the two
+        const auto startupBegin = std::chrono::high_resolution_clock::now();
+        auto phaseBegin = startupBegin;
+        auto markStartupPhase = [&phaseBegin](const char* phase) {
+            const auto now = std::chrono::high_resolution_clock::now();
+            std::cout << "Startup: " << phase << " " << std::chrono::duration<double, std::milli>(now - phaseBegin).count() << " ms" << std::endl;
+            phaseBegin = now;
+        };
+
+        const std::array<std::pair<const char*, const char*>, 6> namedTextures{ {
+            { "sand", "textures/sand.jpg" },
+            { "camel", "textures/CamelTexture.png" },
+            { "candle", "textures/CandleTexture.jpg" },
+            { "cabin", "textures/WoodCabinTexture.jpg" },
+            { "rock", "textures/rock.png" },
+            { "cactus", "textures/cactus.png" },
+        } };
+        const std::array<std::string, 6> skyboxFaces{ "textures/sky_right.tga","textures/sky_left.tga","textures/sky_up.tga","textures/sky_down.tga","textures/sky_back.tga","textures/sky_front.tga" };
+        const char* const defaultTexturePath = "textures/texture.jpg";
+
+        // Skybox faces and the default texture are needed before the first frame; named textures stream in later
+        std::vector<std::string> imagePaths(skyboxFaces.begin(), skyboxFaces.end());
+        imagePaths.push_back(defaultTexturePath);
+
+        ImageDecoder imageDecoder;
+        imageDecoder.start(std::move(imagePaths));
 
 		camera1 = Camera(glm::vec3(0.0f, 10.0f, -150.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 90.0f, WIDTH / (float)HEIGHT, 0.1f, 300.0f);
 		camera2 = Camera(glm::vec3(0.0f, 4.0f, -40.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 90.0f, WIDTH / (float)HEIGHT, 0.1f, 300.0f);
@@ -376,38 +643,115 @@ private:
         createSurface();
         pickPhysicalDevice();
         createLogicalDevice();
+        allocator.create(device, physicalDevice, GpuAllocator::kDefaultBlockSize, memoryBudgetSupported);
+        _ctx.allocator = &allocator;
+        deletionQueue.create(MAX_FRAMES_IN_FLIGHT);
+        frameLatency.create(MAX_FRAMES_IN_FLIGHT);
+        framesInFlight = latencyProfile().framesInFlight;
         createSwapChain();
         createImageViews();
         createRenderPass();
         createDescriptorSetLayout();
 		createShadowDescriptorSetLayoutOnly();
-		createDescriptorPool();
+		createDescriptorAllocator();
         createShadowResources();
         createGraphicsPipeline();
 		createPhongPipeline();
 		createGouraudPipeline();
         createCommandPool();
-        texManager.initialize(device, physicalDevice, commandPool, graphicsQueue);
-        texManager.addTexture("sand", "textures/sand.jpg");
-		texManager.addTexture("camel", "textures/CamelTexture.png");
-		texManager.addTexture("candle", "textures/CandleTexture.jpg");
-		texManager.addTexture("cabin", "textures/WoodCabinTexture.jpg");
-		texManager.addTexture("rock", "textures/rock.png");
-		texManager.addTexture("cactus", "textures/cactus.png");
+        jobs.create(jobThreads);
+        jobs.setSerial(serialJobs);
+        std::cout << "JobSystem: " << jobs.threadCount() << " threads" << (jobs.serial() ? ", serial" : "") << std::endl;
+        recorder.create(device, findQueueFamilies(physicalDevice).graphicsFamily.value(), MAX_FRAMES_IN_FLIGHT, jobs);
+        staticCache.create(device, findQueueFamilies(physicalDevice).graphicsFamily.value(), MAX_FRAMES_IN_FLIGHT, StaticEntryCount);
+        if (recordThreads > 0) {
+            recorder.setActiveThreads(recordThreads);
+        }
+        parallelRecording = recorder.activeThreads() > 1;
+        std::cout << "ParallelRecorder: " << recorder.activeThreads() << " recording threads" << std::endl;
+        uploader.create(device, physicalDevice, commandPool, graphicsQueue, &allocator);
+        _ctx.uploader = &uploader;
+        geometryArena.create(&allocator, &uploader);
+        _ctx.geometry = &geometryArena;
+        _ctx.framesInFlight = MAX_FRAMES_IN_FLIGHT;
+        VkShaderModule particleShader = createShaderModule(readFile("shaders/shader.comp.spv"));
+        particleCompute.create(device, particleShader, &descriptorAllocator);
+        vkDestroyShaderModule(device, particleShader, nullptr);
+        _ctx.particleCompute = &particleCompute;
+        markStartupPhase("device, swapchain and pipelines");
+
+        // Scene textures render with a placeholder until their decode finishes; see updateStreaming in drawFrame
+        texManager.initialize(device, physicalDevice, commandPool, graphicsQueue, &uploader, &allocator);
+        for (const auto& [name, path] : namedTextures) {
+            texManager.requestTexture(name, path);
+        }
+
+        // Upload each image as soon as a worker finishes decoding it
+        skybox = Cubemap(device, physicalDevice, commandPool, graphicsQueue, &uploader, &allocator);
+        std::array<DecodedImage, 6> skyboxPixels;
+        size_t skyboxFacesReady = 0;
+        double decodeWaitMs = 0.0;
+        ImageDecoder::Result decoded;
+        for (;;) {
+            const auto waitBegin = std::chrono::high_resolution_clock::now();
+            if (!imageDecoder.next(decoded)) break;
+            decodeWaitMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - waitBegin).count();
+
+            if (decoded.index < skyboxFaces.size()) {
+                skyboxPixels[decoded.index] = std::move(decoded.image);
+                if (++skyboxFacesReady == skyboxFaces.size()) {
+                    std::array<const void*, 6> faces{};
+                    for (size_t i = 0; i < faces.size(); ++i) {
+                        if (skyboxPixels[i].width != skyboxPixels[0].width || skyboxPixels[i].height != skyboxPixels[0].height) {
+                            throw std::runtime_error("Cubemap faces differ in size: " + skyboxFaces[i]);
+                        }
+                        faces[i] = skyboxPixels[i].pixels;
+                    }
+                    skybox.create(static_cast<uint32_t>(skyboxPixels[0].width), VK_FORMAT_R8G8B8A8_SRGB, faces);
+                    for (auto& face : skyboxPixels) face.release();
+                }
+            }
+            else {
+                createTextureImage(decoded.image);
+            }
+            decoded.image.release();
+        }
+        std::cout << "Startup: decoded " << imageDecoder.size() << " images, " << imageDecoder.totalDecodeMs()
+            << " ms of decode work across workers, main thread waited " << decodeWaitMs << " ms" << std::endl;
+        markStartupPhase("image decode + upload");
+
         createDepthResources();
         createFramebuffers();
 		createPerImageSemaphores();
         
-        createTextureImage();
         createTextureImageView();
-        createTextureSampler(textureSampler);
+        createTextureSampler(textureSampler, textureMipLevels);
 		
         loadModel();
-        createVertexBuffer();
-        createIndexBuffer();
+        createSkyboxGeometry();
 		createParticleQuadGeometry();
+
+		// The scene only needs its textures requested and its meshes parsed; uploading waits for the uniforms below
+		_scene = GlobeScene(texManager, cameraManager, meshLibrary);
+		_scene.initializeScene();
+		if (recordBenchObjects > 0) {
+			_scene.loadSceneFromFile(writeBenchmarkScene(recordBenchObjects));
+		}
+		else {
+			_scene.loadScene();
+		}
+
+        // One slot per scene object, so scene size is limited by memory rather than a fixed count
+        const size_t objectSlots = _scene.getObjects().size() + ENGINE_OBJECT_UNIFORM_SLOTS;
+        if (objectSlots > UINT32_MAX) {
+            throw std::runtime_error("too many scene objects for the object uniform slots!");
+        }
+        frameUniforms.create(&allocator, physicalDevice, MAX_FRAMES_IN_FLIGHT, static_cast<uint32_t>(objectSlots));
+        _ctx.uniforms = &frameUniforms;
         createUniformBuffers();
         setupPostProcess();
+        // Before any shape uploads, so each registers its material with the table
+        createBindlessResources();
 
         _material = Material(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), 0.5f, 0.5f, texManager.getTexture("cabin"));
 		_sphereMaterial = Material(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), 0.5f, 0.5f, texManager.getTexture("sand"));
@@ -445,30 +789,6 @@ private:
 
         createSkyboxDescriptorSetLayout();
         createSkyboxPipelineLayout();
-		skybox = Cubemap(device, physicalDevice, commandPool, graphicsQueue);
-        
-        int texWidth, texHeight, texChannels;
-
-        const std::array<std::string, 6> filenames{ "textures/sky_right.tga","textures/sky_left.tga","textures/sky_up.tga","textures/sky_down.tga","textures/sky_back.tga","textures/sky_front.tga" };
-        std::vector<stbi_uc*> pixels(6);
-        VkDeviceSize layerSize = 0;
-
-        for (int i = 0; i < 6; i++)
-        {
-            pixels[i] = stbi_load(filenames[i].c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-            if (!pixels[i])
-            {
-                throw std::runtime_error("Failed to load cubemap face: " + filenames[i]);
-            }
-            layerSize = texWidth * texHeight * 4;
-        }
-
-        std::array<const void*, 6> faces{ pixels[0],pixels[1],pixels[2],pixels[3],pixels[4],pixels[5] };
-
-        skybox.create(static_cast<uint32_t>(texWidth), VK_FORMAT_R8G8B8A8_SRGB, faces);
-        for (int i = 0; i < 6; ++i) {
-            stbi_image_free(pixels[i]);
-        }
         allocateSkyboxDescriptorSet(skybox.view(), skybox.sampler());
 		createGlobePipeline();
 		createGlobeOutlinePipeline();
@@ -480,10 +800,7 @@ private:
         _ctx.graphicsQueue = graphicsQueue;
         _ctx.commandPool = commandPool;
         _ctx.descriptorSetLayout = descriptorSetLayout;
-        _ctx.descriptorPool = descriptorPool;
-		_scene = GlobeScene(texManager, cameraManager);
-		_scene.initializeScene();
-		_scene.loadScene();
+        _ctx.descriptors = &descriptorAllocator;
         _scene.uploadScene(_ctx, MAX_FRAMES_IN_FLIGHT, textureImageView, textureSampler, lightinBufferInfos);
 		auto candleLights = _scene.getCandleLights();
         for (const auto& light : candleLights)
@@ -505,26 +822,441 @@ private:
         
         _particleSystems.clear();
         _particleSystems.push_back(particleSystem(glm::vec3(0.0f, 0.0f, 0.0f), 20000));
+        _particleSystems[0].setSimulation(ParticleSimulation::Gpu);
         for (auto& ps : _particleSystems) {
             ps.create(_ctx);
             // Do not burst; rain will emit continuously
             ps.uploadDescriptors(_ctx);
         }
 		_scene.setRainParticleSystem(&_particleSystems[0]);
+        if (_particleSystems[0].simulation() == ParticleSimulation::Gpu) {
+            std::cout << "Particles: rain simulated by shader.comp with an indirect draw" << std::endl;
+        }
+        else {
+            std::cout << "Particles: instances streamed through persistently mapped "
+                << (_particleSystems[0].instancesInDeviceLocalMemory() ? "device-local (ReBAR)" : "system") << " memory" << std::endl;
+        }
 
         createCommandBuffers();
         createSyncObjects();
 
+        // Everything staged above goes to the GPU in a single submit; the first frame is queued behind it
+        uploader.flush();
+        const UploadBatcher::Stats& uploadStats = uploader.stats();
+        std::cout << "Startup: " << uploadStats.uploads << " uploads (" << uploadStats.bytes / (1024.0 * 1024.0) << " MB) in "
+            << uploadStats.submits << " submits, " << uploadStats.ringStalls << " staging ring stalls" << std::endl;
+        markStartupPhase("scene, meshes and remaining resources");
+        std::cout << "Startup: total " << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startupBegin).count() << " ms" << std::endl;
+        allocator.printStats(std::cout);
+        const GeometryArena::Stats& geometryStats = geometryArena.stats();
+        std::cout << "GeometryArena: " << geometryStats.ranges << " meshes, " << geometryStats.vertexBytes / 1024 << " KiB of vertices, "
+            << geometryStats.indexBytes / 1024 << " KiB of indices in one VB/IB" << std::endl;
+        std::cout << "FrameUniforms: " << frameUniforms.slotsInUse() << "/" << frameUniforms.capacity() << " object slots in one "
+            << frameUniforms.bufferSize() / 1024 << " KiB uniform buffer" << std::endl;
+        const DescriptorAllocator::Stats descriptorStats = descriptorAllocator.stats();
+        std::cout << "DescriptorAllocator: " << descriptorStats.liveSets << " long-lived sets in " << descriptorStats.pools << " pools" << std::endl;
+        if (bindlessTable.valid()) {
+            const BindlessTable::Stats bindlessStats = bindlessTable.stats();
+            std::cout << "BindlessTable: " << bindlessStats.textures << "/" << bindlessStats.textureCapacity << " textures, "
+                << bindlessStats.materials << " materials; one descriptor bind per pass (F8 switches to per-object sets)" << std::endl;
+        }
+        else {
+            std::cout << "BindlessTable: descriptor indexing unavailable, drawing with per-object descriptor sets" << std::endl;
+        }
+        _memoryReportStart = std::chrono::steady_clock::now();
+        _lastMemoryReport = _memoryReportStart;
+        sampleMemory();
+        std::cout << "Memory: " << memoryReport.cpuBytes() / 1024 << " KiB of CPU geometry, heap budgets from "
+            << (memoryBudgetSupported ? "VK_EXT_memory_budget" : "heap sizes") << "; F9 writes " << MEMORY_REPORT_PATH << std::endl;
+
+        buildFrameGraph();
+
 		_lastFrameTime = std::chrono::steady_clock::now();
     }
 
+    // Tasks read currentFrame and frameImageIndex, which drawFrame sets before running the graph
+    void buildFrameGraph()
+    {
+        snapshotParticles.clear();
+        for (auto& sys : _particleSystems) {
+            snapshotParticles.push_back(&sys);
+        }
+        _scene.collectParticleSystems(snapshotParticles);
+
+        frameGraph.clear();
+        const TaskGraph::TaskId sceneUpdate = frameGraph.add("scene update", [this] {
+            _scene.updateScene(_deltaTime * _timeScale, &jobs);
+        });
+        // The scene update sets the rain emitter
+        const TaskGraph::TaskId particles = frameGraph.add("particles", [this] {
+            for (auto& sys : _particleSystems) {
+                sys.update(_deltaTime, &jobs);
+            }
+        });
+        // Camera, lights and shadow matrices follow the day-night cycle the scene update advanced
+        const TaskGraph::TaskId frameConstants = frameGraph.add("frame uniforms", [this] {
+            buildFrameConstants(inlineFrame);
+            writeFrameConstants(currentFrame, inlineFrame);
+        });
+        const TaskGraph::TaskId objectUniforms = frameGraph.add("object uniforms", [this] {
+            updateObjectUniforms(currentFrame, inlineFrame);
+        });
+        // Records the particle simulation with the step the particles task accumulated
+        const TaskGraph::TaskId record = frameGraph.add("record", [this] {
+            vkResetCommandBuffer(commandBuffers[currentFrame], /*VkCommandBufferResetFlagBits*/ 0);
+            recordCommandBuffer(commandBuffers[currentFrame], frameImageIndex);
+        });
+
+        frameGraph.precede(sceneUpdate, particles);
+        frameGraph.precede(sceneUpdate, frameConstants);
+        frameGraph.precede(frameConstants, objectUniforms);
+        frameGraph.precede(particles, record);
+        frameGraph.precede(objectUniforms, record);
+
+        buildSnapshotGraphs();
+    }
+
+    // The same stages split at the snapshot: the main thread's graph ends once everything the frame draws has
+    // been copied out of the simulation, and the render thread's graph starts from that copy
+    void buildSnapshotGraphs()
+    {
+        simulationGraph.clear();
+        const TaskGraph::TaskId sceneUpdate = simulationGraph.add("scene update", [this] {
+            _scene.updateScene(_deltaTime * _timeScale, &jobs);
+        });
+        // Also captures the flames the scene update stepped
+        const TaskGraph::TaskId particles = simulationGraph.add("particles", [this] {
+            for (auto& sys : _particleSystems) {
+                sys.update(_deltaTime, &jobs);
+            }
+            for (size_t i = 0; i < snapshotParticles.size(); ++i) {
+                snapshotParticles[i]->capture(simulationFrame->particles[i]);
+            }
+        });
+        const TaskGraph::TaskId frameConstants = simulationGraph.add("frame constants", [this] {
+            buildFrameConstants(*simulationFrame);
+        });
+        const TaskGraph::TaskId transforms = simulationGraph.add("object transforms", [this] {
+            _scene.captureModelMatrices(simulationFrame->sceneModel, simulationFrame->objectModels, &jobs);
+        });
+        simulationGraph.precede(sceneUpdate, particles);
+        simulationGraph.precede(sceneUpdate, frameConstants);
+        simulationGraph.precede(frameConstants, transforms);
+
+        snapshotGraph.clear();
+        const TaskGraph::TaskId frameUniforms = snapshotGraph.add("frame uniforms", [this] {
+            writeFrameConstants(currentFrame, *frameBeingDrawn);
+        });
+        const TaskGraph::TaskId objectUniforms = snapshotGraph.add("object uniforms", [this] {
+            updateObjectUniforms(currentFrame, *frameBeingDrawn);
+        });
+        const TaskGraph::TaskId particleStream = snapshotGraph.add("particles", [this] {
+            for (size_t i = 0; i < snapshotParticles.size(); ++i) {
+                snapshotParticles[i]->apply(frameBeingDrawn->particles[i]);
+            }
+        });
+        const TaskGraph::TaskId record = snapshotGraph.add("record", [this] {
+            vkResetCommandBuffer(commandBuffers[currentFrame], /*VkCommandBufferResetFlagBits*/ 0);
+            recordCommandBuffer(commandBuffers[currentFrame], frameImageIndex);
+        });
+        snapshotGraph.precede(frameUniforms, record);
+        snapshotGraph.precede(objectUniforms, record);
+        snapshotGraph.precede(particleStream, record);
+    }
+
+    // Call from the thread that runs graph, or once it has stopped
+    void printGraphTimings(const char* label, const TaskGraph& graph) const
+    {
+        if (graph.runs() == 0) return;
+        const JobSystem::Stats jobStats = jobs.stats();
+        std::cout << label << ": " << graph.lastRunMs() << " ms last frame over " << graph.runs() << " frames, "
+            << jobs.threadCount() << " threads" << (jobs.serial() ? " (serial)" : "") << ", "
+            << jobStats.jobs << " jobs, " << jobStats.steals << " stolen" << std::endl;
+        for (const TaskGraph::Timing& t : graph.timings()) {
+            std::cout << "  " << t.name << ": " << t.lastMs << " ms last, " << t.averageMs << " ms average, "
+                << t.peakMs << " ms peak, thread " << t.thread << std::endl;
+        }
+    }
+
+    // Call from the thread that draws, or while the render thread is stopped
+    void printCommandCounts() const
+    {
+        for (bool cached : { false, true }) {
+            for (bool sorted : { false, true }) {
+                const CommandTally& tally = commandTallies[cached][sorted];
+                if (tally.frames == 0) continue;
+                const double frames = static_cast<double>(tally.frames);
+                std::cout << "Commands per frame, static cache " << (cached ? "on" : "off") << ", "
+                    << (sorted ? "sorted" : "unsorted") << " draws, over " << tally.frames << " frames: "
+                    << tally.recorded.total() / frames << " recorded (" << tally.recorded.binds() / frames << " binds, "
+                    << tally.recorded.draws() / frames << " draws)";
+                if (cached) {
+                    std::cout << ", " << tally.executed.total() / frames << " executed from cached secondaries ("
+                        << tally.executed.binds() / frames << " binds)";
+                }
+                std::cout << std::endl;
+            }
+        }
+        const RenderQueue::Stats& queueStats = renderQueue.stats();
+        if (queueStats.sorts > 0) {
+            std::cout << "RenderQueue: " << queueStats.sorts << " sorts of " << queueStats.items / queueStats.sorts
+                << " draws on average, " << static_cast<double>(queueStats.digitPasses) / queueStats.sorts
+                << " radix passes per sort" << std::endl;
+        }
+        const StaticCommandCache::Stats& cacheStats = staticCache.stats();
+        if (cacheStats.recordings > 0) {
+            std::cout << "StaticCommandCache: " << cacheStats.recordings << " entries recorded, " << cacheStats.reuses << " reused" << std::endl;
+        }
+    }
+
+    // Everything the cached static entries capture. Pipelines and layouts are created once, but their handles
+    // are part of the key so a rebuilt pipeline would re-record the entries too.
+    uint64_t staticContentKey() const
+    {
+        uint64_t key = 0;
+        auto mix = [&key](uint64_t value) {
+            key ^= value + 0x9e3779b97f4a7c15ull + (key << 6) + (key >> 2);
+        };
+        auto mixHandle = [&mix](auto handle) {
+            if constexpr (std::is_pointer_v<decltype(handle)>) mix(reinterpret_cast<uintptr_t>(handle));
+            else mix(handle);
+        };
+        mix(bindlessEnabled);
+        mix(swapChainExtent.width);
+        mix(swapChainExtent.height);
+        mix(_scene.getObjects().size());
+        mix(textureSwaps);
+        mix(bindlessTable.valid() ? bindlessTable.stats().descriptorWrites : 0);
+        mix(sortedDraws);
+        mix(renderQueue.orderHash());
+        const GeometryArena::Stats arena = geometryArena.stats();
+        mix(arena.ranges);
+        mix(arena.vertexBytes);
+        mix(arena.indexBytes);
+        for (VkPipeline pipeline : { phongPipeline, gouraudPipeline, shadowPipeline, outlinePipeline,
+            phongBindlessPipeline, gouraudBindlessPipeline, shadowBindlessPipeline }) {
+            mixHandle(pipeline);
+        }
+        mixHandle(pipelineLayout);
+        mixHandle(shadowPipelineLayout);
+        mixHandle(bindlessPipelineLayout);
+        return key;
+    }
+
+    // Call from the thread that draws, or while the render thread is stopped
+    void printLatency() const
+    {
+        const FrameLatency::Stats& stats = frameLatency.stats();
+        if (stats.frames == 0) return;
+        std::cout << "Latency, " << latencyProfile().name << " (" << framesInFlight << " frames in flight, "
+            << swapChainImages.size() << " swapchain images, " << presentModeName(swapChainPresentMode) << "), over "
+            << stats.frames << " frames:" << std::endl;
+        std::cout << "  input to present: " << stats.presentLastMs << " ms last, " << stats.presentAverageMs << " ms average, "
+            << stats.presentPeakMs << " ms peak" << std::endl;
+        std::cout << "  input to GPU done: " << stats.completeLastMs << " ms last, " << stats.completeAverageMs << " ms average, "
+            << stats.completePeakMs << " ms peak" << std::endl;
+    }
+
+    const LatencyProfile& latencyProfile() const
+    {
+        return LATENCY_PROFILES[static_cast<size_t>(latencyMode)];
+    }
+
+    // Main thread, render thread stopped and no frame begun. Reports the profile being left, then rebuilds the
+    // swapchain for the new one.
+    void switchLatencyProfile(LatencyMode mode)
+    {
+        vkDeviceWaitIdle(device);
+        for (uint32_t i = 0; i < framesInFlight; ++i) {
+            frameLatency.completed(i);
+        }
+        printLatency();
+
+        // Every fence has signalled, so the frames can restart from slot 0 with another count
+        latencyMode = mode;
+        framesInFlight = latencyProfile().framesInFlight;
+        currentFrame = 0;
+        recreateSwapChain();
+        frameLatency.reset();
+        std::cout << "Latency profile: " << latencyProfile().name << ", " << framesInFlight << " frames in flight, "
+            << swapChainImages.size() << " swapchain images, " << presentModeName(swapChainPresentMode)
+            << (latencyProfile().sampleAfterWait ? ", input polled after the frame wait" : "") << std::endl;
+    }
+
+    void pollInput()
+    {
+        glfwPollEvents();
+        inputSampleTime = std::chrono::steady_clock::now();
+    }
+
+    void printFrameTimings() const
+    {
+        printGraphTimings("Frame graph", frameGraph);
+        printGraphTimings("Simulation graph (main thread)", simulationGraph);
+        printGraphTimings("Snapshot graph (render thread)", snapshotGraph);
+    }
+
+    // Runs on whichever thread draws
+    void applyRequests(const FrameRequests& requests)
+    {
+        if (requests.printTimings) {
+            printGraphTimings(renderThread.joinable() ? "Snapshot graph (render thread)" : "Frame graph",
+                renderThread.joinable() ? snapshotGraph : frameGraph);
+            printLatency();
+            printCommandCounts();
+        }
+        if (requests.toggleSerialJobs && jobs.threadCount() > 1) {
+            jobs.setSerial(!jobs.serial());
+            frameGraph.resetTimings();
+            snapshotGraph.resetTimings();
+            std::cout << "Frame tasks " << (jobs.serial() ? "run serially on the thread that submits them" : "run on " + std::to_string(jobs.threadCount()) + " threads") << std::endl;
+        }
+        if (requests.toggleParallelRecording && recorder.activeThreads() > 1) {
+            parallelRecording = !parallelRecording;
+            std::cout << "Recording " << (parallelRecording ? "scene passes on " + std::to_string(recorder.activeThreads()) + " threads" : "inline") << std::endl;
+        }
+        if (requests.toggleStaticCache) {
+            staticCaching = !staticCaching;
+            std::cout << "Static scene content " << (staticCaching ? "replayed from cached secondaries" : "recorded every frame") << std::endl;
+        }
+        if (requests.toggleSortedDraws) {
+            sortedDraws = !sortedDraws;
+            std::cout << "Scene draws " << (sortedDraws ? "sorted by state and depth" : "in scene order") << std::endl;
+        }
+        if (requests.toggleBindless && bindlessTable.valid()) {
+            bindlessEnabled = !bindlessEnabled;
+            std::cout << "Drawing with " << (bindlessEnabled ? "the bindless table" : "per-object descriptor sets") << std::endl;
+        }
+        // The allocator is only used by the thread that draws
+        if (requests.writeMemoryReport) {
+            writeMemoryReport();
+        }
+        updateMemoryTracking();
+    }
+
+    void startRenderThread()
+    {
+        if (renderThread.joinable()) return;
+        // From here on the main thread only steps particles and the render thread streams them
+        for (particleSystem* sys : snapshotParticles) {
+            sys->setDeferredStreaming(true);
+        }
+        renderThreadError = nullptr;
+        renderThreadFailed = false;
+        renderThread = std::thread(&HelloTriangleApplication::renderLoop, this);
+        std::cout << "Rendering on a separate thread" << std::endl;
+    }
+
+    // Lets the render thread finish the snapshots already published, then joins it and rethrows what it threw
+    void stopRenderThread(bool rethrow = true)
+    {
+        if (!renderThread.joinable()) return;
+        snapshots.back().quit = true;
+        snapshots.waitUntilConsumed();
+        snapshots.publish();
+        renderThread.join();
+
+        frameBeingDrawn = &inlineFrame;
+        for (particleSystem* sys : snapshotParticles) {
+            sys->setDeferredStreaming(false);
+        }
+        std::cout << "Rendering on the main thread" << std::endl;
+        if (renderThreadError && rethrow) {
+            std::rethrow_exception(std::exchange(renderThreadError, nullptr));
+        }
+    }
+
+    void renderLoop()
+    {
+        // Recording ranges this thread runs use a command pool of their own, not the main thread's
+        jobs.attachThread();
+        for (;;) {
+            snapshots.waitForPublish();
+            snapshots.acquire();
+            const FrameSnapshot& frame = snapshots.front();
+            if (frame.quit) break;
+            // After a failure, keep taking snapshots so the main thread never waits on this one
+            if (renderThreadFailed) continue;
+            try {
+                drawSnapshot(frame);
+            }
+            catch (...) {
+                renderThreadError = std::current_exception();
+                renderThreadFailed = true;
+            }
+        }
+        jobs.detachThread();
+    }
+
+    // Main thread, render thread mode: simulates into the back snapshot and publishes it
+    void publishFrame()
+    {
+        advanceFrameClock();
+
+        FrameSnapshot& frame = snapshots.back();
+        frame.quit = false;
+        frame.requests = std::exchange(pendingRequests, FrameRequests{});
+        frame.sampleTime = inputSampleTime;
+        glfwGetFramebufferSize(window, &frame.framebufferWidth, &frame.framebufferHeight);
+        if (frame.framebufferWidth == 0 || frame.framebufferHeight == 0) {
+            // Minimized: nothing is drawn, so sleep until the window changes rather than spin
+            glfwWaitEvents();
+        }
+        frame.particles.resize(snapshotParticles.size());
+
+        simulationFrame = &frame;
+        simulationGraph.run(jobs);
+        simulationFrame = nullptr;
+
+        // At most one snapshot waits for the render thread, so the simulation runs at most a frame ahead
+        snapshots.waitUntilConsumed();
+        snapshots.publish();
+
+        if (renderThreadFailed) {
+            stopRenderThread();
+        }
+    }
+
+    // Draws pipelineBenchFrames frames inline, then as many through the render thread, and prints the time per
+    // frame of each. Present waits cap both at the refresh rate unless the present mode is mailbox or immediate.
+    void runPipelineBenchmark()
+    {
+        auto msPerFrame = [&](bool threaded) {
+            frameLatency.reset();
+            if (threaded) startRenderThread();
+            auto step = [&] {
+                pollInput();
+                if (threaded) publishFrame();
+                else drawFrame();
+            };
+            for (int i = 0; i < PIPELINE_BENCH_WARMUP; ++i) step();
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < pipelineBenchFrames; ++i) step();
+            // The last snapshots are still being drawn; they count
+            if (threaded) stopRenderThread();
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+                / static_cast<double>(pipelineBenchFrames);
+        };
+
+        std::cout << "Render thread benchmark: " << _scene.getObjects().size() << " scene objects, "
+            << pipelineBenchFrames << " frames per mode" << std::endl;
+        const double inlineMs = msPerFrame(false);
+        std::cout << "  main thread only: " << inlineMs << " ms per frame" << std::endl;
+        printLatency();
+        const double threadedMs = msPerFrame(true);
+        std::cout << "  render thread:    " << threadedMs << " ms per frame, " << inlineMs / threadedMs << "x" << std::endl;
+        printLatency();
+        vkDeviceWaitIdle(device);
+        printFrameTimings();
+    }
+
     void createShadowResources()
     {
         // 1) Depth image used as sampled shadow map
         VkFormat shadowFormat = VK_FORMAT_D32_SFLOAT;
-        createImage(swapChainExtent.width, swapChainExtent.height, shadowFormat, VK_IMAGE_TILING_OPTIMAL,
+        createImage(SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, shadowFormat, VK_IMAGE_TILING_OPTIMAL,
             VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, shadowImage, shadowImageMemory);
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuMemoryCategory::RenderTarget, "shadow map", shadowImage, shadowImageAllocation);
 
         shadowImageView = createImageView(shadowImage, shadowFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
 
@@ -596,8 +1328,8 @@ private:
         fbci.renderPass = shadowRenderPass;
         fbci.attachmentCount = 1;
         fbci.pAttachments = &shadowImageView;
-        fbci.width = swapChainExtent.width;
-        fbci.height = swapChainExtent.height;
+        fbci.width = SHADOW_MAP_SIZE;
+        fbci.height = SHADOW_MAP_SIZE;
         fbci.layers = 1;
         if (vkCreateFramebuffer(device, &fbci, nullptr, &shadowFrameBuffer) != VK_SUCCESS) {
             throw std::runtime_error("failed to create shadow framebuffer!");
@@ -632,27 +1364,17 @@ private:
         // 6) Shadow uniform buffers (per-frame)
         VkDeviceSize shUBOSize = sizeof(ShadowUBO);
         shadowUniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-        shadowUniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+        shadowUniformBuffersAllocations.resize(MAX_FRAMES_IN_FLIGHT);
         shadowUniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
             createBuffer(shUBOSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                shadowUniformBuffers[i], shadowUniformBuffersMemory[i]);
-            if (vkMapMemory(device, shadowUniformBuffersMemory[i], 0, shUBOSize, 0, &shadowUniformBuffersMapped[i]) != VK_SUCCESS) {
-                throw std::runtime_error("failed to map shadow UBO");
-            }
+                GpuMemoryCategory::Uniform, "shadow uniforms", shadowUniformBuffers[i], shadowUniformBuffersAllocations[i]);
+            shadowUniformBuffersMapped[i] = shadowUniformBuffersAllocations[i].mapped;
         }
 
-        // 7) Allocate descriptor sets for shadow (re-using existing descriptorPool)
-        std::vector<VkDescriptorSetLayout> shLayouts(MAX_FRAMES_IN_FLIGHT, shadowDescriptorSetLayout);
-        VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
-        allocInfo.descriptorPool = descriptorPool;
-        allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-        allocInfo.pSetLayouts = shLayouts.data();
-
+        // 7) Allocate descriptor sets for shadow (long-lived, from the shared descriptor allocator)
         shadowDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-        if (vkAllocateDescriptorSets(device, &allocInfo, shadowDescriptorSets.data()) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate shadow descriptor sets!");
-        }
+        descriptorAllocator.allocate(shadowDescriptorSetLayout, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT), shadowDescriptorSets.data());
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
             VkDescriptorBufferInfo bufInfo{};
@@ -823,25 +1545,9 @@ private:
         imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-        if (vkCreateImage(device, &imageInfo, nullptr, &maskImage) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create mask image!");
-        }
-
-        VkMemoryRequirements memReq{};
-        vkGetImageMemoryRequirements(device, maskImage, &memReq);
+        allocator.createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuMemoryCategory::RenderTarget, "post-process mask", maskImage, maskImageAllocation, true);
 
-        VkMemoryAllocateInfo alloc{ VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
-        alloc.allocationSize = memReq.size;
-        alloc.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-        if (vkAllocateMemory(device, &alloc, nullptr, &maskImageMemory) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate mask image memory!");
-        }
-        vkBindImageMemory(device, maskImage, maskImageMemory, 0);
-
-        // view + sampler
         maskImageView = createImageView(maskImage, VK_FORMAT_R8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
-        createTextureSampler(maskSampler);
     }
 
     void createMaskRenderPass()
@@ -1001,37 +1707,16 @@ private:
         particleQuadIndexCount = static_cast<uint32_t>(idx.size());
 
         // VB
-        VkDeviceSize vbSize = sizeof(Vertex) * verts.size();
-        VkBuffer stagingVB; VkDeviceMemory stagingVBMem;
-        createBuffer(vbSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingVB, stagingVBMem);
-        void* mapped = nullptr;
-        vkMapMemory(device, stagingVBMem, 0, vbSize, 0, &mapped);
-        std::memcpy(mapped, verts.data(), static_cast<size_t>(vbSize));
-        vkUnmapMemory(device, stagingVBMem);
-
+        const VkDeviceSize vbSize = sizeof(Vertex) * verts.size();
         createBuffer(vbSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, particleQuadVB, particleQuadVBMemory);
-        copyBuffer(stagingVB, particleQuadVB, vbSize);
-        vkDestroyBuffer(device, stagingVB, nullptr);
-        vkFreeMemory(device, stagingVBMem, nullptr);
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuMemoryCategory::Particles, "particle quad", particleQuadVB, particleQuadVBAllocation);
+        uploader.uploadBuffer(particleQuadVB, verts.data(), vbSize);
 
         // IB
-        VkDeviceSize ibSize = sizeof(uint16_t) * idx.size();
-        VkBuffer stagingIB; VkDeviceMemory stagingIBMem;
-        createBuffer(ibSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingIB, stagingIBMem);
-        vkMapMemory(device, stagingIBMem, 0, ibSize, 0, &mapped);
-        std::memcpy(mapped, idx.data(), static_cast<size_t>(ibSize));
-        vkUnmapMemory(device, stagingIBMem);
-
+        const VkDeviceSize ibSize = sizeof(uint16_t) * idx.size();
         createBuffer(ibSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, particleQuadIB, particleQuadIBMemory);
-        copyBuffer(stagingIB, particleQuadIB, ibSize);
-        vkDestroyBuffer(device, stagingIB, nullptr);
-        vkFreeMemory(device, stagingIBMem, nullptr);
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuMemoryCategory::Particles, "particle quad", particleQuadIB, particleQuadIBAllocation);
+        uploader.uploadBuffer(particleQuadIB, idx.data(), ibSize);
     }
 
     void createsceneOffscreenPipeline()
@@ -1138,27 +1823,9 @@ private:
         imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-        if (vkCreateImage(device, &imageInfo, nullptr, &offscreenImage) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create post-process image!");
-        }
-
-        VkMemoryRequirements memRequirements;
-        vkGetImageMemoryRequirements(device, offscreenImage, &memRequirements);
-
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-        if (vkAllocateMemory(device, &allocInfo, nullptr, &offscreenImageMemory) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate offscreen image memory!");
-        }
-
-        vkBindImageMemory(device, offscreenImage, offscreenImageMemory, 0);
+        allocator.createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuMemoryCategory::RenderTarget, "offscreen color", offscreenImage, offscreenImageAllocation, true);
 
-        // create view + sampler
         createPostProcessImageView();
-        createPostProcessSampler();
     }
 
     void createPostProcessImageView()
@@ -1326,41 +1993,12 @@ private:
         }
     }
 
-    void createPostProcessDescriptorPool()
-    {
-        std::array<VkDescriptorPoolSize, 2> poolSizes{};
-        // 1 UBO per set
-        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-        // 2 samplers per set: scene + mask
-        poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        poolSizes[1].descriptorCount = static_cast<uint32_t>(2 * MAX_FRAMES_IN_FLIGHT);
-
-        VkDescriptorPoolCreateInfo poolInfo{};
-        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-        poolInfo.pPoolSizes = poolSizes.data();
-        poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-
-        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &postProcessDescriptorPool) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create descriptor pool!");
-        }
-    }
-
-    void createPostProcessDescriptorSets()
+    // Transient: written every frame from the frame's descriptor pools, so the offscreen image can be
+    // recreated on resize without reallocating anything
+    VkDescriptorSet writePostProcessDescriptorSet(uint32_t i)
     {
-        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, postProcessDescriptorSetLayout);
-        VkDescriptorSetAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
-        allocInfo.descriptorPool = postProcessDescriptorPool;
-        allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-        allocInfo.pSetLayouts = layouts.data();
-
-        postProcessDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-        if (vkAllocateDescriptorSets(device, &allocInfo, postProcessDescriptorSets.data()) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to allocate descriptor sets!");
-        }
-
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        const VkDescriptorSet set = descriptorAllocator.allocateTransient(i, postProcessDescriptorSetLayout);
+        {
             VkDescriptorBufferInfo bufferInfo{};
             bufferInfo.buffer = timeBuffer[i];
             bufferInfo.offset = 0;
@@ -1381,7 +2019,7 @@ private:
 
             // (0) Scene sampler
             writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            writes[0].dstSet = postProcessDescriptorSets[i];
+            writes[0].dstSet = set;
             writes[0].dstBinding = 0;
             writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
             writes[0].descriptorCount = 1;
@@ -1389,7 +2027,7 @@ private:
 
             // (1) Time UBO
             writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            writes[1].dstSet = postProcessDescriptorSets[i];
+            writes[1].dstSet = set;
             writes[1].dstBinding = 1;
             writes[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
             writes[1].descriptorCount = 1;
@@ -1397,7 +2035,7 @@ private:
 
             // NEW (2) Mask sampler
             writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            writes[2].dstSet = postProcessDescriptorSets[i];
+            writes[2].dstSet = set;
             writes[2].dstBinding = 2;
             writes[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
             writes[2].descriptorCount = 1;
@@ -1405,19 +2043,20 @@ private:
 
             vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
         }
+        return set;
     }
 
     void setupPostProcess()
     {
         createPostProcessImage();
+        createPostProcessSampler();
         createOffscreenRenderPass();
         createOffscreenFramebuffer();
         createMaskImage();
+        createTextureSampler(maskSampler);
         createMaskRenderPass();
         createMaskFramebuffer();
         createPostProcessDescriptorSetLayout();
-        createPostProcessDescriptorPool();
-        createPostProcessDescriptorSets();
         createsceneOffscreenPipeline();
         // create the mask pipeline before we try to use it
         createMaskPipeine();
@@ -1548,15 +2187,7 @@ private:
     }
 
     void allocateSkyboxDescriptorSet(VkImageView cubeView, VkSampler cubeSampler) {
-        VkDescriptorSetAllocateInfo ai{};
-        ai.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        ai.descriptorPool = descriptorPool;                 // reuse existing pool
-        ai.descriptorSetCount = 1;
-        ai.pSetLayouts = &skyboxDescriptorSetLayout;
-
-        if (vkAllocateDescriptorSets(device, &ai, &skyboxDescriptorSet) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate skybox descriptor set!");
-        }
+        skyboxDescriptorSet = descriptorAllocator.allocate(skyboxDescriptorSetLayout);
 
         VkDescriptorImageInfo imageInfo{};
         imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -1622,15 +2253,8 @@ private:
     
     void allocateGlobeDescriptorSet(VkImageView view, VkSampler sampler)
     {
-        VkDescriptorSetAllocateInfo ai{};
-        ai.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        ai.descriptorPool = descriptorPool;
-        ai.descriptorSetCount = 1;
-        ai.pSetLayouts = &descriptorSetLayout; // use the same layout: UBO(0), sampler(1), lighting(2)
-
-        if (vkAllocateDescriptorSets(device, &ai, &globeDescriptorSet) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate globe descriptor set!");
-        }
+        // Same layout as the frame sets: UBO(0), sampler(1), lighting(2)
+        globeDescriptorSet = descriptorAllocator.allocate(descriptorSetLayout);
 
         // Per-frame UBO and lighting remain bound via frame descriptorSets[currentFrame],
         // but for simplicity we also bind texture here using a dedicated set if needed.
@@ -1642,10 +2266,7 @@ private:
         // We still need to provide UBO + Lighting for this set if we intend to use it alone.
         // Alternatively, bind the frame descriptor set for UBO+Lighting, and bind this globe set
         // only for its sampler at binding 1. That requires the same set layout. Here we write all three.
-        VkDescriptorBufferInfo uboInfo{};
-        uboInfo.buffer = uniformBuffers[0]; // any valid buffer; we overwrite each frame at bind time using frame set
-        uboInfo.offset = 0;
-        uboInfo.range = sizeof(UniformBufferObject);
+        VkDescriptorBufferInfo uboInfo = frameUniforms.objectBufferInfo(); // slot picked by the dynamic offset at bind time
 
         VkDescriptorBufferInfo lightInfo{};
         lightInfo.buffer = lightUniformBuffers[0];
@@ -1657,7 +2278,7 @@ private:
         writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         writes[0].dstSet = globeDescriptorSet;
         writes[0].dstBinding = 0;
-        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writes[0].descriptorCount = 1;
         writes[0].pBufferInfo = &uboInfo;
 
@@ -1735,8 +2356,34 @@ private:
     }
 
     void mainLoop() {
+        if (renderThreadMode) {
+            startRenderThread();
+        }
+        try {
+            runMainLoop();
+        }
+        catch (...) {
+            // The render thread must not outlive the loop; the first error is the one to report
+            stopRenderThread(false);
+            throw;
+        }
+        stopRenderThread();
+
+        vkDeviceWaitIdle(device);
+        writeMemoryReport();
+    }
+
+    void runMainLoop() {
         while (!glfwWindowShouldClose(window)) {
-            glfwPollEvents();
+            // Low latency: wait for the frame slot and swapchain image first, so the input the frame is built from
+            // is as fresh as possible when recording starts
+            uint32_t imageIndex = 0;
+            bool frameBegun = false;
+            if (latencyProfile().sampleAfterWait) {
+                if (renderThread.joinable()) snapshots.waitUntilConsumed();
+                else frameBegun = beginFrame(imageIndex);
+            }
+            pollInput();
 			int camera1Index = 0;
 			int camera2Index = 1;
 			int camera3Index = 2;
@@ -1744,7 +2391,8 @@ private:
             if(InputManager::isKeyPressed(GLFW_KEY_ESCAPE))
             {
                 glfwSetWindowShouldClose(window, GLFW_TRUE);
-                continue;
+                // A begun frame still has to be submitted; the loop ends after it
+                if (!frameBegun) continue;
 			}
 
             if(InputManager::isKeyPressed(GLFW_KEY_R))
@@ -1841,52 +2489,180 @@ private:
 
                 _timeScale = std::clamp(_timeScale, 0.0f, 10.0f);
             }
-            drawFrame();
-        }
 
-        vkDeviceWaitIdle(device);
-    }
+            const bool parallelKeyDown = InputManager::isKeyPressed(GLFW_KEY_F7);
+            if (parallelKeyDown && !_parallelKeyDown) {
+                pendingRequests.toggleParallelRecording = true;
+            }
+            _parallelKeyDown = parallelKeyDown;
 
-    void cleanupSwapChain() {
-		cleanupPostProcess();
-        vkDestroyImageView(device, depthImageView, nullptr);
-        vkDestroyImage(device, depthImage, nullptr);
-        vkFreeMemory(device, depthImageMemory, nullptr);
-        for (auto& shape : _shapes) {
-            shape->destroy({ device, physicalDevice, graphicsQueue, commandPool, descriptorSetLayout, descriptorPool });
-        }
+            const bool bindlessKeyDown = InputManager::isKeyPressed(GLFW_KEY_F8);
+            if (bindlessKeyDown && !_bindlessKeyDown) {
+                pendingRequests.toggleBindless = true;
+            }
+            _bindlessKeyDown = bindlessKeyDown;
+
+            // Mode switches wait until this iteration's frame is out
+            const bool renderThreadKeyDown = InputManager::isKeyPressed(GLFW_KEY_F4);
+            const bool toggleRenderThread = renderThreadKeyDown && !_renderThreadKeyDown;
+            _renderThreadKeyDown = renderThreadKeyDown;
+
+            const bool latencyKeyDown = InputManager::isKeyPressed(GLFW_KEY_F10);
+            const bool cycleLatency = latencyKeyDown && !_latencyKeyDown;
+            _latencyKeyDown = latencyKeyDown;
+
+            // Render settings change on the thread that draws, between its frames
+            const bool timingKeyDown = InputManager::isKeyPressed(GLFW_KEY_F5);
+            if (timingKeyDown && !_timingKeyDown) {
+                pendingRequests.printTimings = true;
+                if (renderThread.joinable()) {
+                    printGraphTimings("Simulation graph (main thread)", simulationGraph);
+                }
+            }
+            _timingKeyDown = timingKeyDown;
 
-		_globe.destroy({ device, physicalDevice, graphicsQueue, commandPool, descriptorSetLayout, descriptorPool });
+            const bool serialKeyDown = InputManager::isKeyPressed(GLFW_KEY_F6);
+            if (serialKeyDown && !_serialKeyDown) {
+                pendingRequests.toggleSerialJobs = true;
+            }
+            _serialKeyDown = serialKeyDown;
 
-        _scene.destroyScene({ device, physicalDevice, graphicsQueue, commandPool, descriptorSetLayout, descriptorPool });
+            const bool staticCacheKeyDown = InputManager::isKeyPressed(GLFW_KEY_F11);
+            if (staticCacheKeyDown && !_staticCacheKeyDown) {
+                pendingRequests.toggleStaticCache = true;
+            }
+            _staticCacheKeyDown = staticCacheKeyDown;
 
-        for(auto sem: imagePresentSemaphores)
-        {
-            vkDestroySemaphore(device, sem, nullptr);
-		}
-		imagePresentSemaphores.clear();
+            const bool sortedDrawsKeyDown = InputManager::isKeyPressed(GLFW_KEY_F12);
+            if (sortedDrawsKeyDown && !_sortedDrawsKeyDown) {
+                pendingRequests.toggleSortedDraws = true;
+            }
+            _sortedDrawsKeyDown = sortedDrawsKeyDown;
+
+            const bool reportKeyDown = InputManager::isKeyPressed(GLFW_KEY_F9);
+            if (reportKeyDown && !_memoryReportKeyDown) {
+                pendingRequests.writeMemoryReport = true;
+            }
+            _memoryReportKeyDown = reportKeyDown;
+
+            if (renderThread.joinable()) {
+                publishFrame();
+            }
+            else {
+                applyRequests(std::exchange(pendingRequests, FrameRequests{}));
+                if (frameBegun) drawBegunFrame(imageIndex);
+                else drawFrame();
+            }
 
-        for (auto framebuffer : swapChainFramebuffers) {
-            vkDestroyFramebuffer(device, framebuffer, nullptr);
+            if (cycleLatency) {
+                const bool threaded = renderThread.joinable();
+                if (threaded) stopRenderThread();
+                switchLatencyProfile(static_cast<LatencyMode>((static_cast<size_t>(latencyMode) + 1) % LATENCY_PROFILES.size()));
+                if (threaded) startRenderThread();
+            }
+            if (toggleRenderThread) {
+                if (renderThread.joinable()) stopRenderThread();
+                else startRenderThread();
+            }
         }
+    }
+
+    // CPU geometry copies and heap budgets; GPU ranges are tracked by the allocator as they change
+    void sampleMemory() {
+        std::vector<CpuMemoryEntry> entries;
+        meshLibrary.collectCpuMemory(entries);
+        _scene.collectCpuMemory(entries);
+        for (const Shape* shape : _shapes) {
+            entries.push_back({ "shape vertices", "engine shapes", shape->vertexDataBytes() });
+            entries.push_back({ "mesh local vertices", "engine shapes", shape->localDataBytes() });
+        }
+        entries.push_back({ "shape vertices", "globe", _globe.vertexDataBytes() });
+        entries.push_back({ "mesh local vertices", "globe", _globe.localDataBytes() });
+        memoryReport.sampleCpu(entries);
+
+        // Refreshes the heap usage high-water marks
+        allocator.stats();
+        _lastMemorySample = std::chrono::steady_clock::now();
+    }
 
-        for (auto imageView : swapChainImageViews) {
-            vkDestroyImageView(device, imageView, nullptr);
+    void writeMemoryReport() {
+        sampleMemory();
+        _lastMemoryReport = _lastMemorySample;
+        const double seconds = std::chrono::duration<double>(_lastMemoryReport - _memoryReportStart).count();
+        try {
+            memoryReport.write(MEMORY_REPORT_PATH, allocator, seconds);
+            std::cout << "Memory: report written to " << MEMORY_REPORT_PATH << std::endl;
+        }
+        catch (const std::runtime_error& e) {
+            // A report is diagnostics only; never take the frame loop down for it
+            std::cerr << e.what() << std::endl;
         }
+    }
 
-        if (!commandBuffers.empty()) {
-            vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
-            commandBuffers.clear();
+    void updateMemoryTracking() {
+        const auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<float>(now - _lastMemoryReport).count() >= MEMORY_REPORT_INTERVAL) {
+            writeMemoryReport();
         }
+        else if (std::chrono::duration<float>(now - _lastMemorySample).count() >= MEMORY_SAMPLE_INTERVAL) {
+            sampleMemory();
+        }
+    }
 
-        if (skyboxPipeline != VK_NULL_HANDLE) {
-            vkDestroyPipeline(device, skyboxPipeline, nullptr);
-            skyboxPipeline = VK_NULL_HANDLE;
+    // Hands every object sized to the swapchain to the deletion queue. The callbacks capture the handles, so
+    // the members can be recreated straight away while frames still in flight use the old ones.
+    void retireSwapChainResources() {
+        for (VkFramebuffer framebuffer : swapChainFramebuffers) {
+            deletionQueue.retire([this, framebuffer]() { vkDestroyFramebuffer(device, framebuffer, nullptr); });
+        }
+        swapChainFramebuffers.clear();
+
+        for (VkImageView imageView : swapChainImageViews) {
+            deletionQueue.retire([this, imageView]() { vkDestroyImageView(device, imageView, nullptr); });
+        }
+        swapChainImageViews.clear();
+
+        // Presents wait on these but are not fenced (that needs VK_EXT_swapchain_maintenance1); by the time
+        // the frame fences cover them, the presents queued ahead of them have been taken by the engine
+        for (VkSemaphore semaphore : imagePresentSemaphores) {
+            deletionQueue.retire([this, semaphore]() { vkDestroySemaphore(device, semaphore, nullptr); });
         }
+        imagePresentSemaphores.clear();
+
+        retireFramebuffer(offscreenFramebuffer);
+        retireFramebuffer(maskFramebuffer);
+        retireImage(depthImage, depthImageView, depthImageAllocation);
+        retireImage(offscreenImage, offscreenImageView, offscreenImageAllocation);
+        retireImage(maskImage, maskImageView, maskImageAllocation);
+
+        offscreenInitialized = false;
+    }
+
+    void retireFramebuffer(VkFramebuffer& framebuffer) {
+        if (framebuffer == VK_NULL_HANDLE) return;
+        deletionQueue.retire([this, framebuffer]() { vkDestroyFramebuffer(device, framebuffer, nullptr); });
+        framebuffer = VK_NULL_HANDLE;
+    }
+
+    void retireImage(VkImage& image, VkImageView& view, GpuAllocation& allocation) {
+        if (image == VK_NULL_HANDLE) return;
+        deletionQueue.retire([this, image, view, allocation]() mutable {
+            vkDestroyImageView(device, view, nullptr);
+            allocator.destroyImage(image, allocation);
+        });
+        image = VK_NULL_HANDLE;
+        view = VK_NULL_HANDLE;
+        allocation = {};
+    }
 
-        vkDestroySwapchainKHR(device, swapChain, nullptr);
+    void cleanupSwapChain() {
+        retireSwapChainResources();
+        const VkSwapchainKHR retiredSwapChain = swapChain;
+        deletionQueue.retire([this, retiredSwapChain]() { vkDestroySwapchainKHR(device, retiredSwapChain, nullptr); });
+        swapChain = VK_NULL_HANDLE;
     }
 
+    // Post-process objects that outlive a resize; the images and framebuffers go with the swapchain
     void cleanupPostProcess()
     {
         if (postProcessPipeline != VK_NULL_HANDLE) {
@@ -1897,15 +2673,13 @@ private:
             vkDestroyPipelineLayout(device, postProcessPipelineLayout, nullptr);
             postProcessPipelineLayout = VK_NULL_HANDLE;
         }
-        if (postProcessDescriptorPool != VK_NULL_HANDLE) {
-            vkDestroyDescriptorPool(device, postProcessDescriptorPool, nullptr);
-            postProcessDescriptorPool = VK_NULL_HANDLE;
-            postProcessDescriptorSets.clear();
+        if (postProcessDescriptorSetLayout != VK_NULL_HANDLE) {
+            vkDestroyDescriptorSetLayout(device, postProcessDescriptorSetLayout, nullptr);
+            postProcessDescriptorSetLayout = VK_NULL_HANDLE;
         }
-
-        if (offscreenFramebuffer != VK_NULL_HANDLE) {
-            vkDestroyFramebuffer(device, offscreenFramebuffer, nullptr);
-            offscreenFramebuffer = VK_NULL_HANDLE;
+        if (sceneOffscreenPipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, sceneOffscreenPipeline, nullptr);
+            sceneOffscreenPipeline = VK_NULL_HANDLE;
         }
         if (offscreenRenderPass != VK_NULL_HANDLE) {
             vkDestroyRenderPass(device, offscreenRenderPass, nullptr);
@@ -1915,52 +2689,56 @@ private:
             vkDestroySampler(device, offscreenSampler, nullptr);
             offscreenSampler = VK_NULL_HANDLE;
         }
-        if (offscreenImageView != VK_NULL_HANDLE) {
-            vkDestroyImageView(device, offscreenImageView, nullptr);
-            offscreenImageView = VK_NULL_HANDLE;
+
+        if (maskPipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, maskPipeline, nullptr);
+            maskPipeline = VK_NULL_HANDLE;
         }
-        if (offscreenImage != VK_NULL_HANDLE) {
-            vkDestroyImage(device, offscreenImage, nullptr);
-            offscreenImage = VK_NULL_HANDLE;
+        if (maskPipelineLayout != VK_NULL_HANDLE) {
+            vkDestroyPipelineLayout(device, maskPipelineLayout, nullptr);
+            maskPipelineLayout = VK_NULL_HANDLE;
         }
-        if (offscreenImageMemory != VK_NULL_HANDLE) {
-            vkFreeMemory(device, offscreenImageMemory, nullptr);
-            offscreenImageMemory = VK_NULL_HANDLE;
+        if (maskRenderPass != VK_NULL_HANDLE) {
+            vkDestroyRenderPass(device, maskRenderPass, nullptr);
+            maskRenderPass = VK_NULL_HANDLE;
+        }
+        if (maskSampler != VK_NULL_HANDLE) {
+            vkDestroySampler(device, maskSampler, nullptr);
+            maskSampler = VK_NULL_HANDLE;
         }
-
-        offscreenInitialized = false;
     }
 
     void cleanup() {
+        // mainLoop waited for the device to idle, so everything retired can go now
         cleanupSwapChain();
+        deletionQueue.flush();
+        const DeletionQueue::Stats& deletionStats = deletionQueue.stats();
+        std::cout << "DeletionQueue: " << deletionStats.retired << " objects retired, " << deletionStats.destroyed << " destroyed, peak "
+            << deletionStats.peakPending << " pending" << std::endl;
+        cleanupPostProcess();
+
+        if (!commandBuffers.empty()) {
+            vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+            commandBuffers.clear();
+        }
+
+        // Shapes, the globe and the scene keep their geometry and descriptor sets across swapchain recreation
+        for (auto& shape : _shapes) {
+            shape->destroy(_ctx);
+        }
+        _globe.destroy(_ctx);
+        _scene.destroyScene(_ctx);
 
         vkDestroyPipeline(device, graphicsPipeline, nullptr);
         vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
         vkDestroyRenderPass(device, renderPass, nullptr);
 
-        if (particleQuadIB != VK_NULL_HANDLE) {
-            vkDestroyBuffer(device, particleQuadIB, nullptr);
-            particleQuadIB = VK_NULL_HANDLE;
-        }
-        if (particleQuadIBMemory != VK_NULL_HANDLE) {
-            vkFreeMemory(device, particleQuadIBMemory, nullptr);
-            particleQuadIBMemory = VK_NULL_HANDLE;
-        }
-        if (particleQuadVB != VK_NULL_HANDLE) {
-            vkDestroyBuffer(device, particleQuadVB, nullptr);
-            particleQuadVB = VK_NULL_HANDLE;
-        }
-        if (particleQuadVBMemory != VK_NULL_HANDLE) {
-            vkFreeMemory(device, particleQuadVBMemory, nullptr);
-            particleQuadVBMemory = VK_NULL_HANDLE;
-        }
+        allocator.destroyBuffer(particleQuadIB, particleQuadIBAllocation);
+        allocator.destroyBuffer(particleQuadVB, particleQuadVBAllocation);
 
+        frameUniforms.releaseSlot(frameObjectSlot);
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            vkDestroyBuffer(device, uniformBuffers[i], nullptr);
-            vkFreeMemory(device, uniformBuffersMemory[i], nullptr);
-
-            vkDestroyBuffer(device, lightUniformBuffers[i], nullptr);
-            vkFreeMemory(device, lightUniformBuffersMemory[i], nullptr);
+            allocator.destroyBuffer(lightUniformBuffers[i], lightUniformBuffersAllocations[i]);
         }
 
         if (outlinePipeline != VK_NULL_HANDLE) {
@@ -1996,29 +2774,47 @@ private:
         ctx.graphicsQueue = graphicsQueue;
         ctx.commandPool = commandPool;
         ctx.descriptorSetLayout = descriptorSetLayout;
-        ctx.descriptorPool = descriptorPool;
+        ctx.descriptors = &descriptorAllocator;
+        ctx.allocator = &allocator;
         for (auto& sys : _particleSystems) {
             sys.destroy(ctx);
         }
         _particleSystems.clear();
+        particleCompute.destroy();
 
         skybox.destroy();
         texManager.destroy();
 
-        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        const ParallelRecorder::Stats& recorderStats = recorder.stats();
+        std::cout << "ParallelRecorder: " << recorderStats.dispatches << " parallel dispatches, " << recorderStats.secondaries
+            << " secondary command buffers" << std::endl;
+        recorder.destroy();
+        printCommandCounts();
+        staticCache.destroy();
+        printFrameTimings();
+        printLatency();
+        frameGraph.clear();
+        jobs.destroy();
+
+        const DescriptorAllocator::Stats descriptorStats = descriptorAllocator.stats();
+        std::cout << "DescriptorAllocator: " << descriptorStats.liveSets << " long-lived sets in " << descriptorStats.pools << " pools, "
+            << descriptorStats.transientPools << " transient pools, peak " << descriptorStats.peakTransientSets << " transient sets per frame" << std::endl;
+        descriptorAllocator.destroy();
+
+        if (bindlessTable.valid()) {
+            const BindlessTable::Stats bindlessStats = bindlessTable.stats();
+            std::cout << "BindlessTable: " << bindlessStats.textures << " textures, " << bindlessStats.materials << " materials, "
+                << bindlessStats.descriptorWrites << " texture descriptor writes" << std::endl;
+        }
+        destroyBindlessResources();
 
         vkDestroySampler(device, textureSampler, nullptr);
         vkDestroyImageView(device, textureImageView, nullptr);
-        vkDestroyImage(device, textureImage, nullptr);
-        vkFreeMemory(device, textureImageMemory, nullptr);
+        allocator.destroyImage(textureImage, textureImageAllocation);
 
         vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 
-        vkDestroyBuffer(device, indexBuffer, nullptr);
-        vkFreeMemory(device, indexBufferMemory, nullptr);
-
-        vkDestroyBuffer(device, vertexBuffer, nullptr);
-        vkFreeMemory(device, vertexBufferMemory, nullptr);
+        geometryArena.remove(skyboxGeometry);
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
             vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
@@ -2026,7 +2822,21 @@ private:
             vkDestroyFence(device, inFlightFences[i], nullptr);
         }
 
-        vkDestroyCommandPool(device, commandPool, nullptr);
+        const UploadBatcher::Stats& uploadStats = uploader.stats();
+        std::cout << "UploadBatcher: " << uploadStats.uploads << " uploads in " << uploadStats.submits << " submits ("
+            << uploadStats.submitsPerUpload() << " submits per upload), " << uploadStats.ringStalls << " ring stalls, "
+            << uploadStats.oversized << " oversized" << std::endl;
+        uploader.destroy();
+
+        const GeometryArena::Stats& geometryStats = geometryArena.stats();
+        std::cout << "GeometryArena: " << geometryStats.binds << " VB/IB binds for " << geometryStats.draws << " draws" << std::endl;
+        geometryArena.destroy();
+        frameUniforms.destroy();
+
+        allocator.printStats(std::cout);
+        allocator.destroy();
+
+        vkDestroyCommandPool(device, commandPool, nullptr);
 
 
         vkDestroyDevice(device, nullptr);
@@ -2042,67 +2852,39 @@ private:
         glfwTerminate();
     }
 
+    // Rebuilds only what is sized to the window. Render passes and pipelines depend on the surface format,
+    // which chooseSwapSurfaceFormat picks the same way every time, and take the viewport dynamically; geometry,
+    // uniforms, the shadow map and long-lived descriptor sets are untouched. Nothing waits for the device:
+    // the old objects go to the deletion queue and are destroyed once the frames using them have completed.
     void recreateSwapChain() {
         int width = 0, height = 0;
-        glfwGetFramebufferSize(window, &width, &height);
+        framebufferSize(width, height);
+        // Only drawFrame gets here minimized; drawSnapshot skips frames of a minimized window
         while (width == 0 || height == 0) {
-            glfwGetFramebufferSize(window, &width, &height);
             glfwWaitEvents();
+            framebufferSize(width, height);
         }
 
-        vkDeviceWaitIdle(device);
-
-        cleanupSwapChain();
+        retireSwapChainResources();
 
+        // The new swapchain is created with the old one as oldSwapchain, which retires it
+        const VkSwapchainKHR oldSwapChain = swapChain;
+        const VkFormat oldFormat = swapChainImageFormat;
         createSwapChain();
+        deletionQueue.retire([this, oldSwapChain]() { vkDestroySwapchainKHR(device, oldSwapChain, nullptr); });
+        if (swapChainImageFormat != oldFormat) {
+            throw std::runtime_error("swap chain format changed on recreation; render passes would need rebuilding");
+        }
+
         createImageViews();
-        createRenderPass();
-        createGraphicsPipeline();
         createDepthResources();
         createFramebuffers();
         createPerImageSemaphores();
-        createCommandBuffers();
-        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
-        createDescriptorPool();
-        createDescriptorSets();
         createPostProcessImage();
-		createOffscreenRenderPass();
-		createOffscreenFramebuffer();
-        createPostProcessDescriptorPool();
-        createPostProcessDescriptorSets();
-		createsceneOffscreenPipeline();
-        createPostProcessPipeline();
-        offscreenInitialized = false;
-
-
-
-        allocateSkyboxDescriptorSet(skybox.view(), skybox.sampler());
-        createSkyboxPipeline();
-
-
-        // Re-upload shape descriptor sets from the new pool
-        _ctx.device = device;
-        _ctx.physicalDevice = physicalDevice;
-        _ctx.graphicsQueue = graphicsQueue;
-        _ctx.commandPool = commandPool;
-        _ctx.descriptorSetLayout = descriptorSetLayout;
-        _ctx.descriptorPool = descriptorPool;
-
-        std::vector<VkDescriptorBufferInfo> lightinBufferInfos(MAX_FRAMES_IN_FLIGHT);
-        for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            lightinBufferInfos[i] = { lightUniformBuffers[i], 0, sizeof(LightingUBOCPU) };
-        }
-        for (auto& shape : _shapes) {
-            shape->create();
-            shape->upload(_ctx, MAX_FRAMES_IN_FLIGHT,
-                shape->getMaterial().getTextureImageView(),
-                shape->getMaterial().getTextureSampler(),
-                lightinBufferInfos);
-        }
-
-		_globe.create();
-		_globe.upload(_ctx, MAX_FRAMES_IN_FLIGHT, _globe.getMaterial().getTextureImageView(), _globe.getMaterial().getTextureSampler(), lightinBufferInfos);
-        _scene.uploadScene(_ctx, MAX_FRAMES_IN_FLIGHT, textureImageView, textureSampler, lightinBufferInfos);
+        createOffscreenFramebuffer();
+        createMaskImage();
+        createMaskFramebuffer();
+        // The post-process set is transient and rewritten every frame, so it picks up the new views
     }
 
     void createInstance() {
@@ -2215,8 +2997,18 @@ private:
         features13.synchronization2 = VK_TRUE;
 
 
+        // Descriptor indexing for the bindless table is optional; without it objects bind their own sets
+        VkPhysicalDeviceVulkan12Features features12{};
+        features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        bindlessSupported = BindlessTable::supported(physicalDevice);
+        if (bindlessSupported) {
+            BindlessTable::enableFeatures(features12);
+            features13.pNext = &features12;
+        }
+
         VkPhysicalDeviceFeatures deviceFeatures{};
         deviceFeatures.samplerAnisotropy = VK_TRUE;
+        deviceFeatures.shaderSampledImageArrayDynamicIndexing = bindlessSupported ? VK_TRUE : VK_FALSE;
 
         VkDeviceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -2227,8 +3019,14 @@ private:
 
         createInfo.pEnabledFeatures = &deviceFeatures;
 
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+        // VK_EXT_memory_budget is optional: without it the memory report falls back to heap sizes
+        std::vector<const char*> enabledExtensions = deviceExtensions;
+        memoryBudgetSupported = deviceSupportsExtension(physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        if (memoryBudgetSupported) {
+            enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+        createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
         if (enableValidationLayers) {
             createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -2253,7 +3051,7 @@ private:
         VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
         VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
 
-        uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
+        uint32_t imageCount = swapChainSupport.capabilities.minImageCount + latencyProfile().extraSwapchainImages;
         if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount) {
             imageCount = swapChainSupport.capabilities.maxImageCount;
         }
@@ -2285,6 +3083,8 @@ private:
         createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
         createInfo.presentMode = presentMode;
         createInfo.clipped = VK_TRUE;
+        // On a resize the presentation engine can hand over from the current swapchain; null at startup
+        createInfo.oldSwapchain = swapChain;
 
         if (vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapChain) != VK_SUCCESS) {
             throw std::runtime_error("failed to create swap chain!");
@@ -2296,6 +3096,7 @@ private:
 
         swapChainImageFormat = surfaceFormat.format;
         swapChainExtent = extent;
+        swapChainPresentMode = presentMode;
     }
 
     void createImageViews() {
@@ -2446,7 +3247,7 @@ private:
         VkDescriptorSetLayoutBinding uboLayoutBinding{};
         uboLayoutBinding.binding = 0;
         uboLayoutBinding.descriptorCount = 1;
-        uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC; // per-object model slot
         uboLayoutBinding.pImmutableSamplers = nullptr;
 		uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 
@@ -2478,7 +3279,14 @@ private:
 		shadowLayoutBinding.pImmutableSamplers = nullptr;
 		shadowLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-        std::array<VkDescriptorSetLayoutBinding, 5> bindings = { uboLayoutBinding, samplerLayoutBinding, lightingLayoutBinding, timeLayoutBinding, shadowLayoutBinding };
+		VkDescriptorSetLayoutBinding cameraLayoutBinding{};
+		cameraLayoutBinding.binding = 5;
+		cameraLayoutBinding.descriptorCount = 1;
+		cameraLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		cameraLayoutBinding.pImmutableSamplers = nullptr;
+		cameraLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        std::array<VkDescriptorSetLayoutBinding, 6> bindings = { uboLayoutBinding, samplerLayoutBinding, lightingLayoutBinding, timeLayoutBinding, shadowLayoutBinding, cameraLayoutBinding };
         VkDescriptorSetLayoutCreateInfo layoutInfo{};
         layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
         layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
@@ -2659,7 +3467,7 @@ private:
     void createDepthResources() {
         VkFormat depthFormat = findDepthFormat();
 
-        createImage(swapChainExtent.width, swapChainExtent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthImage, depthImageMemory);
+        createImage(swapChainExtent.width, swapChainExtent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuMemoryCategory::RenderTarget, "depth buffer", depthImage, depthImageAllocation);
         depthImageView = createImageView(depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
     }
 
@@ -2691,41 +3499,26 @@ private:
         return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
     }
 
-    void createTextureImage() {
-        int texWidth, texHeight, texChannels;
-        stbi_uc* pixels = stbi_load("textures/texture.jpg", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-        VkDeviceSize imageSize = texWidth * texHeight * 4;
-
-        if (!pixels) {
+    void createTextureImage(const DecodedImage& image) {
+        const int texWidth = image.width;
+        const int texHeight = image.height;
+        if (!image.pixels) {
             throw std::runtime_error("failed to load texture image!");
         }
 
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-        void* data;
-        vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-        memcpy(data, pixels, static_cast<size_t>(imageSize));
-        vkUnmapMemory(device, stagingBufferMemory);
-
-        stbi_image_free(pixels);
+        textureMipLevels = MipChain::levelCount(static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+        createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuMemoryCategory::Texture, "default texture", textureImage, textureImageAllocation, textureMipLevels);
 
-        createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory);
-
-        transitionImageLayout(textureImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-        copyBufferToImage(stagingBuffer, textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-        transitionImageLayout(textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-        vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
+        const void* layers[] = { image.pixels };
+        MipChain::upload(uploader, physicalDevice, textureImage, VK_FORMAT_R8G8B8A8_SRGB,
+            static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), layers, 1, textureMipLevels);
     }
 
     void createTextureImageView() {
-        textureImageView = createImageView(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+        textureImageView = createImageView(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, textureMipLevels);
     }
 
-    void createTextureSampler(VkSampler& sampler) {
+    void createTextureSampler(VkSampler& sampler, uint32_t mipLevels = 1) {
         VkPhysicalDeviceProperties properties{};
         vkGetPhysicalDeviceProperties(physicalDevice, &properties);
 
@@ -2743,13 +3536,15 @@ private:
         samplerInfo.compareEnable = VK_FALSE;
         samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
         samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        samplerInfo.minLod = 0.0f;
+        samplerInfo.maxLod = static_cast<float>(mipLevels);
 
         if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
             throw std::runtime_error("failed to create texture sampler!");
         }
     }
 
-    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags) {
+    VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1) {
         VkImageViewCreateInfo viewInfo{};
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         viewInfo.image = image;
@@ -2757,7 +3552,7 @@ private:
         viewInfo.format = format;
         viewInfo.subresourceRange.aspectMask = aspectFlags;
         viewInfo.subresourceRange.baseMipLevel = 0;
-        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.levelCount = mipLevels;
         viewInfo.subresourceRange.baseArrayLayer = 0;
         viewInfo.subresourceRange.layerCount = 1;
 
@@ -2769,14 +3564,14 @@ private:
         return imageView;
     }
 
-    void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) {
+    void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, GpuMemoryCategory category, std::string_view owner, VkImage& image, GpuAllocation& imageAllocation, uint32_t mipLevels = 1) {
         VkImageCreateInfo imageInfo{};
         imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
         imageInfo.imageType = VK_IMAGE_TYPE_2D;
         imageInfo.extent.width = width;
         imageInfo.extent.height = height;
         imageInfo.extent.depth = 1;
-        imageInfo.mipLevels = 1;
+        imageInfo.mipLevels = mipLevels;
         imageInfo.arrayLayers = 1;
         imageInfo.format = format;
         imageInfo.tiling = tiling;
@@ -2785,270 +3580,61 @@ private:
         imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
         imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-        if (vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create image!");
-        }
-
-        VkMemoryRequirements memRequirements;
-        vkGetImageMemoryRequirements(device, image, &memRequirements);
-
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate image memory!");
-        }
-
-        vkBindImageMemory(device, image, imageMemory, 0);
+        // Swapchain-sized attachments are recreated on resize, so they get their own allocation
+        allocator.createImage(imageInfo, properties, category, owner, image, imageAllocation, category == GpuMemoryCategory::RenderTarget);
     }
 
-    void transitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout) {
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = oldLayout;
-        barrier.newLayout = newLayout;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = image;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-
-        VkPipelineStageFlags sourceStage;
-        VkPipelineStageFlags destinationStage;
-
-        if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-            barrier.srcAccessMask = 0;
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-            sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        }
-        else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        }
-        else {
-            throw std::invalid_argument("unsupported layout transition!");
-        }
-
-        vkCmdPipelineBarrier(
-            commandBuffer,
-            sourceStage, destinationStage,
-            0,
-            0, nullptr,
-            0, nullptr,
-            1, &barrier
-        );
-
-        endSingleTimeCommands(commandBuffer);
-    }
-
-    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-        VkBufferImageCopy region{};
-        region.bufferOffset = 0;
-        region.bufferRowLength = 0;
-        region.bufferImageHeight = 0;
-        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0;
-        region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = 1;
-        region.imageOffset = { 0, 0, 0 };
-        region.imageExtent = {
-            width,
-            height,
-            1
-        };
-
-        vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-        endSingleTimeCommands(commandBuffer);
-    }
-
-    void createVertexBuffer() {
-        VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-        void* data;
-        vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, vertices.data(), (size_t)bufferSize);
-        vkUnmapMemory(device, stagingBufferMemory);
-
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory);
-
-        copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
-
-        vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
-    }
-
-    void createIndexBuffer() {
-        VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-        void* data;
-        vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, indices.data(), (size_t)bufferSize);
-        vkUnmapMemory(device, stagingBufferMemory);
-
-        createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory);
-
-        copyBuffer(stagingBuffer, indexBuffer, bufferSize);
-
-        vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
+    void createSkyboxGeometry() {
+        const std::vector<uint32_t> cubeIndices(indices.begin(), indices.end());
+        skyboxGeometry = geometryArena.add(vertices, cubeIndices, VK_INDEX_TYPE_UINT16);
     }
 
     void createUniformBuffers() {
-        VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-
-        uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-        uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-        uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
-
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uniformBuffers[i], uniformBuffersMemory[i]);
-
-            VkResult mapRes = vkMapMemory(device, uniformBuffersMemory[i], 0, bufferSize, 0, &uniformBuffersMapped[i]);
-            if (mapRes != VK_SUCCESS || uniformBuffersMapped[i] == nullptr) {
-                throw std::runtime_error("vkMapMemory failed for uniform buffer " + std::to_string(i));
-            }
-        }
+        // The frame descriptor sets bind their own object slot; camera data is shared with every object
+        frameObjectSlot = frameUniforms.acquireSlot();
 
         VkDeviceSize lightBufferSize = sizeof(LightingUBOCPU);
 
 		lightUniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-		lightUniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+		lightUniformBuffersAllocations.resize(MAX_FRAMES_IN_FLIGHT);
 		lightUniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            createBuffer(lightBufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, lightUniformBuffers[i], lightUniformBuffersMemory[i]);
-            void* p = nullptr;
-            if (vkMapMemory(device, lightUniformBuffersMemory[i], 0, lightBufferSize, 0, &p) != VK_SUCCESS || p == nullptr)
-            {
-                throw std::runtime_error("vkMapMemory failed for light uniform buffer " + std::to_string(i));
-            }
-            lightUniformBuffersMapped[i] = p;
+            createBuffer(lightBufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, GpuMemoryCategory::Uniform, "light uniforms", lightUniformBuffers[i], lightUniformBuffersAllocations[i]);
+            lightUniformBuffersMapped[i] = lightUniformBuffersAllocations[i].mapped;
         }
 
 		VkDeviceSize timeBufferSize = sizeof(TimeUBO);
 
 		timeBuffer.resize(MAX_FRAMES_IN_FLIGHT);
-		timeBufferMemory.resize(MAX_FRAMES_IN_FLIGHT);
+		timeBufferAllocations.resize(MAX_FRAMES_IN_FLIGHT);
 		timeBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            createBuffer(timeBufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, timeBuffer[i], timeBufferMemory[i]);
-            void* p = nullptr;
-            if (vkMapMemory(device, timeBufferMemory[i], 0, timeBufferSize, 0, &p) != VK_SUCCESS || p == nullptr)
-            {
-                throw std::runtime_error("vkMapMemory failed for time uniform buffer " + std::to_string(i));
-            }
-            timeBuffersMapped[i] = p;
+            createBuffer(timeBufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, GpuMemoryCategory::Uniform, "time uniforms", timeBuffer[i], timeBufferAllocations[i]);
+            timeBuffersMapped[i] = timeBufferAllocations[i].mapped;
         }
     }
 
-    void createDescriptorPool() {
-        // Per-frame descriptor sets (frame UBOs)
-        const uint32_t frameSets = MAX_FRAMES_IN_FLIGHT;
-
-        // Use conservative upper bounds because the pool is created before shapes/scene are populated.
-        // Adjust these if your scene may require more descriptor sets.
-        const uint32_t maxShapes = 32;         // conservative max number of Shapes (including globe)
-        const uint32_t maxSceneObjects = 256;  // conservative max number of scene objects
-        const uint32_t shapeSets = maxShapes * MAX_FRAMES_IN_FLIGHT;
-        const uint32_t sceneSets = maxSceneObjects * MAX_FRAMES_IN_FLIGHT;
-
-        // Skybox: single set
-        const uint32_t skyboxSets = 1;
-
-        // Particle compute sets (if any)
-        const uint32_t computeSets = 2;
-
-        // Shadow descriptor sets (per-frame)
-        const uint32_t shadowSets = MAX_FRAMES_IN_FLIGHT;
-
-        // Total sets we must support
-        const uint32_t totalSets = frameSets + shapeSets + sceneSets + skyboxSets + computeSets + shadowSets;
-
-        // Layout bindings per main set:
-        // - UBOs at bindings 0,2,3 (3 UBOS)
-        // - Combined image samplers at bindings 1 and 4 (texture + shadow)
-        const uint32_t ubosPerSet = 3;      // bindings 0, 2, 3
-        const uint32_t samplersPerSet = 2; // bindings 1 and 4
-
-        // Aggregate descriptor counts
-        const uint32_t totalUboDescriptors =
-            (frameSets + shapeSets + sceneSets) * ubosPerSet
-            // shadow sets also contain a uniform buffer (shadow UBO)
-            + shadowSets * 1
-            // compute parameter UBOs
-            + computeSets * 1;
-
-        const uint32_t totalSamplerDescriptors =
-            // main sets have two samplers each (texture + shadow)
-            (frameSets + shapeSets + sceneSets) * samplersPerSet
-            // skybox has one cubemap sampler
-            + skyboxSets * 1
-            // shadow descriptor sets include one sampler each
-            + shadowSets * 1;
-
-        const uint32_t totalStorageDescriptors =
-            computeSets * 2; // storage buffers for compute
-
-        // Safety margin for fragmentation and future growth
-        const uint32_t safety = 64;
-
-        std::array<VkDescriptorPoolSize, 3> poolSizes{};
-        poolSizes[0] = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,  totalUboDescriptors + safety };
-        poolSizes[1] = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, totalSamplerDescriptors + safety };
-        poolSizes[2] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,  totalStorageDescriptors + safety };
-
-        VkDescriptorPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
-        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-        poolInfo.pPoolSizes = poolSizes.data();
-        poolInfo.maxSets = totalSets + safety;
-
-        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create descriptor pool!");
-        }
+    void createDescriptorAllocator() {
+        // Average descriptors per set across the engine's layouts: the main set has the dynamic object UBO,
+        // three UBOs (lighting, time, camera) and two samplers; shadow, skybox, post-process and particle
+        // compute sets are smaller. A pool that runs short of one type is simply followed by another.
+        descriptorAllocator.create(device, MAX_FRAMES_IN_FLIGHT, {
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3.0f },
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f },
+            { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2.0f },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f },
+        });
     }
 
     void createDescriptorSets() {
-        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
-        VkDescriptorSetAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocInfo.descriptorPool = descriptorPool;
-        allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-        allocInfo.pSetLayouts = layouts.data();
-
         descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-        if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate descriptor sets!");
-        }
+        descriptorAllocator.allocate(descriptorSetLayout, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT), descriptorSets.data());
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            VkDescriptorBufferInfo bufferInfo{};
-            bufferInfo.buffer = uniformBuffers[i];
-            bufferInfo.offset = 0;
-            bufferInfo.range = sizeof(UniformBufferObject);
+            VkDescriptorBufferInfo bufferInfo = frameUniforms.objectBufferInfo();
+            VkDescriptorBufferInfo cameraBufferInfo = frameUniforms.cameraBufferInfo(static_cast<uint32_t>(i));
 
             VkDescriptorImageInfo imageInfo{};
             imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -3065,13 +3651,13 @@ private:
 			timeBufferInfo.offset = 0;
 			timeBufferInfo.range = sizeof(TimeUBO);
 
-            std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
+            std::array<VkWriteDescriptorSet, 5> descriptorWrites{};
 
             descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
             descriptorWrites[0].dstSet = descriptorSets[i];
             descriptorWrites[0].dstBinding = 0;
             descriptorWrites[0].dstArrayElement = 0;
-            descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
             descriptorWrites[0].descriptorCount = 1;
             descriptorWrites[0].pBufferInfo = &bufferInfo;
 
@@ -3099,59 +3685,27 @@ private:
 			descriptorWrites[3].descriptorCount = 1;
 			descriptorWrites[3].pBufferInfo = &timeBufferInfo;
 
-            vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
-        }
-    }
-
-    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
-        VkBufferCreateInfo bufferInfo{};
-        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        bufferInfo.size = size;
-        bufferInfo.usage = usage;
-        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create buffer!");
-        }
+			descriptorWrites[4].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[4].dstSet = descriptorSets[i];
+			descriptorWrites[4].dstBinding = 5;
+			descriptorWrites[4].dstArrayElement = 0;
+			descriptorWrites[4].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			descriptorWrites[4].descriptorCount = 1;
+			descriptorWrites[4].pBufferInfo = &cameraBufferInfo;
 
-        VkMemoryRequirements memRequirements;
-        vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
-
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate buffer memory!");
+            vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
         }
-
-        vkBindBufferMemory(device, buffer, bufferMemory, 0);
     }
 
-    VkCommandBuffer beginSingleTimeCommands() {
-        VkCommandBufferAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandPool = commandPool;
-        allocInfo.commandBufferCount = 1;
-
-        VkCommandBuffer commandBuffer;
-        vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-        vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-        return commandBuffer;
+    void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, GpuMemoryCategory category, std::string_view owner, VkBuffer& buffer, GpuAllocation& bufferAllocation) {
+        allocator.createBuffer(size, usage, properties, category, owner, buffer, bufferAllocation);
     }
 
-    void createGouraudPipeline()
+    // Phong, Gouraud and their bindless variants share every fixed-function state; only shaders and layout differ
+    VkPipeline buildLitPipeline(const char* vertPath, const char* fragPath, VkPipelineLayout layout)
     {
-        auto vertCode = readFile("shaders/Gouraud.vert.spv");
-        auto fragCode = readFile("shaders/Gouraud.frag.spv");
+        auto vertCode = readFile(vertPath);
+        auto fragCode = readFile(fragPath);
         VkShaderModule v = createShaderModule(vertCode);
         VkShaderModule f = createShaderModule(fragCode);
 
@@ -3168,7 +3722,7 @@ private:
         GraphicsPipelineBuilder b;
         b.setDevice(device)
             .setRenderPass(renderPass)
-            .setPipelineLayout(pipelineLayout)
+            .setPipelineLayout(layout)
             .setVertexInput(vi)
             .setInputAssembly(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
             .setRasterFill(VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE)
@@ -3179,97 +3733,593 @@ private:
             .setDynamicStates({ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR })
             .setShaderStages(v, f);
 
-        gouraudPipeline = b.build();
+        VkPipeline pipeline = b.build();
 
         vkDestroyShaderModule(device, f, nullptr);
         vkDestroyShaderModule(device, v, nullptr);
+        return pipeline;
+    }
+
+    void createGouraudPipeline()
+    {
+        gouraudPipeline = buildLitPipeline("shaders/Gouraud.vert.spv", "shaders/Gouraud.frag.spv", pipelineLayout);
     }
 
     void createPhongPipeline()
     {
-        auto vertCode = readFile("shaders/Phong.vert.spv");
-        auto fragCode = readFile("shaders/Phong.frag.spv");
+        phongPipeline = buildLitPipeline("shaders/Phong.vert.spv", "shaders/Phong.frag.spv", pipelineLayout);
+    }
+
+    // Needs the default texture, frame uniforms and the shadow render pass; must run before shapes upload
+    void createBindlessResources()
+    {
+        if (!bindlessSupported) return;
+        if (!frameUniforms.objectStorageFits()) {
+            std::cout << "BindlessTable: one frame's " << frameUniforms.capacity()
+                << " object slots exceed maxStorageBufferRange; drawing with per-object sets" << std::endl;
+            return;
+        }
+        // A build that skipped the bindless shaders still runs, through the per-object sets
+        for (const char* path : { "shaders/Phong_bindless.vert.spv", "shaders/Phong_bindless.frag.spv",
+            "shaders/Gouraud_bindless.vert.spv", "shaders/Gouraud_bindless.frag.spv", "shaders/shadow_bindless.vert.spv" }) {
+            if (!std::ifstream(path, std::ios::binary).is_open()) {
+                std::cout << "BindlessTable: " << path << " is missing; drawing with per-object sets" << std::endl;
+                return;
+            }
+        }
+
+        bindlessTable.create(device, physicalDevice, &allocator, &frameUniforms, MAX_FRAMES_IN_FLIGHT, textureImageView, textureSampler);
+        for (Texture* texture : texManager.textures()) {
+            bindlessTable.addTexture(texture);
+        }
+        _ctx.bindless = &bindlessTable;
+
+        // set 0 = frame set, set 1 = shadow set, set 2 = table
+        const std::array<VkDescriptorSetLayout, 3> setLayouts{ descriptorSetLayout, shadowDescriptorSetLayout, bindlessTable.layout() };
+        const VkPushConstantRange pushRange = BindlessTable::pushConstantRange();
+        VkPipelineLayoutCreateInfo pli{ VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+        pli.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+        pli.pSetLayouts = setLayouts.data();
+        pli.pushConstantRangeCount = 1;
+        pli.pPushConstantRanges = &pushRange;
+        if (vkCreatePipelineLayout(device, &pli, nullptr, &bindlessPipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create bindless pipeline layout!");
+        }
+
+        phongBindlessPipeline = buildLitPipeline("shaders/Phong_bindless.vert.spv", "shaders/Phong_bindless.frag.spv", bindlessPipelineLayout);
+        gouraudBindlessPipeline = buildLitPipeline("shaders/Gouraud_bindless.vert.spv", "shaders/Gouraud_bindless.frag.spv", bindlessPipelineLayout);
+
+        // Depth-only, position-only; matches the state of the shadow pipeline in createShadowResources
+        auto vertCode = readFile("shaders/shadow_bindless.vert.spv");
+        auto fragCode = readFile("shaders/shadow.frag.spv");
         VkShaderModule v = createShaderModule(vertCode);
         VkShaderModule f = createShaderModule(fragCode);
 
         auto bindingDesc = Vertex::getBindingDescription();
-        auto attrDescs = Vertex::getAttributeDescriptions();
+        VkVertexInputAttributeDescription posAttr{};
+        posAttr.location = 0;
+        posAttr.binding = bindingDesc.binding;
+        posAttr.format = VK_FORMAT_R32G32B32_SFLOAT;
+        posAttr.offset = static_cast<uint32_t>(offsetof(Vertex, pos));
 
         VkPipelineVertexInputStateCreateInfo vi{};
         vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
         vi.vertexBindingDescriptionCount = 1;
         vi.pVertexBindingDescriptions = &bindingDesc;
-        vi.vertexAttributeDescriptionCount = static_cast<uint32_t>(attrDescs.size());
-        vi.pVertexAttributeDescriptions = attrDescs.data();
+        vi.vertexAttributeDescriptionCount = 1;
+        vi.pVertexAttributeDescriptions = &posAttr;
 
         GraphicsPipelineBuilder b;
         b.setDevice(device)
-            .setRenderPass(renderPass)
-            .setPipelineLayout(pipelineLayout)
+            .setRenderPass(shadowRenderPass)
+            .setPipelineLayout(bindlessPipelineLayout)
             .setVertexInput(vi)
             .setInputAssembly(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
-            .setRasterFill(VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE)
+            .setRasterFill(VK_POLYGON_MODE_FILL, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE)
             .setMultisample(VK_SAMPLE_COUNT_1_BIT)
-            .enableDepthTest(VK_COMPARE_OP_LESS, VK_TRUE)
-            .addColorBlendAttachment(VK_FALSE)
-            .setColorBlendLogic(VK_FALSE)
+            .enableDepthTest(VK_COMPARE_OP_LESS_OR_EQUAL, VK_TRUE)
+            .setColorBlendLogic(VK_FALSE) // no colour attachments
             .setDynamicStates({ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR })
             .setShaderStages(v, f);
 
-        phongPipeline = b.build();
+        shadowBindlessPipeline = b.build();
 
         vkDestroyShaderModule(device, f, nullptr);
         vkDestroyShaderModule(device, v, nullptr);
+
+        bindlessEnabled = true;
     }
 
-    void endSingleTimeCommands(VkCommandBuffer commandBuffer) {
-        vkEndCommandBuffer(commandBuffer);
+    void destroyBindlessResources()
+    {
+        for (VkPipeline* pipeline : { &phongBindlessPipeline, &gouraudBindlessPipeline, &shadowBindlessPipeline }) {
+            if (*pipeline != VK_NULL_HANDLE) {
+                vkDestroyPipeline(device, *pipeline, nullptr);
+                *pipeline = VK_NULL_HANDLE;
+            }
+        }
+        if (bindlessPipelineLayout != VK_NULL_HANDLE) {
+            vkDestroyPipelineLayout(device, bindlessPipelineLayout, nullptr);
+            bindlessPipelineLayout = VK_NULL_HANDLE;
+        }
+        bindlessTable.destroy();
+        _ctx.bindless = nullptr;
+        bindlessEnabled = false;
+    }
 
-        VkFenceCreateInfo fenceInfo{};
-        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        VkFence fence = VK_NULL_HANDLE;
-        if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create fence for one-time submit!");
+    // Binds pipeline and the frame, shadow and table sets for a whole pass; draws then only push constants
+    void bindBindlessPass(VkCommandBuffer commandBuffer, VkPipeline pipeline, uint32_t frameObjectOffset)
+    {
+        const std::array<VkDescriptorSet, 3> sets{ descriptorSets[currentFrame], shadowDescriptorSets[currentFrame], bindlessTable.set(currentFrame) };
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bindlessPipelineLayout,
+            0, static_cast<uint32_t>(sets.size()), sets.data(), 1, &frameObjectOffset);
+        CommandStats::add(CommandStats::PipelineBind);
+        CommandStats::add(CommandStats::DescriptorBind);
+    }
+
+    void setViewportAndScissor(VkCommandBuffer commandBuffer, VkExtent2D extent)
+    {
+        VkViewport viewport{ 0.f, 0.f, (float)extent.width, (float)extent.height, 0.f, 1.f };
+        VkRect2D scissor{ {0,0}, extent };
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+        CommandStats::add(CommandStats::DynamicState, 2);
+    }
+
+    // The pipeline the pass binds for scene objects, and the one their queue items carry
+    VkPipeline scenePipeline(ScenePass pass) const
+    {
+        if (bindlessEnabled) {
+            return pass == ShadowScenePass ? shadowBindlessPipeline : phongBindlessPipeline;
         }
+        return pass == ShadowScenePass ? shadowPipeline : phongPipeline;
+    }
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
+    // Queues both passes' scene objects from frameBeingDrawn and sorts them; call before recording either pass
+    void buildRenderQueue()
+    {
+        renderQueue.clear();
+        if (!sortedDraws) return;
+
+        // Cached entries keep the order they were recorded in, so with the cache on opaque objects are ordered
+        // by state alone; following the camera would record them again every frame
+        const FrameSnapshot& frame = *frameBeingDrawn;
+        const bool opaqueDepth = !staticCaching;
+        _scene.queueObjects(renderQueue, ShadowScenePass, scenePipeline(ShadowScenePass),
+            frame.hasShadow ? frame.shadow.lightView : frame.camera.view, frame.sceneModel, frame.objectModels, opaqueDepth);
+        _scene.queueObjects(renderQueue, MainScenePass, scenePipeline(MainScenePass),
+            frame.camera.view, frame.sceneModel, frame.objectModels, opaqueDepth);
+        renderQueue.sort();
+    }
+
+    // Scene objects [first, last) with the pass's pipeline; the pass state is already bound in commandBuffer.
+    // With sorted draws the range is of the pass's queue items rather than of getObjects().
+    void drawSceneRange(VkCommandBuffer commandBuffer, ScenePass pass, VkPipelineLayout layout, VkPipeline pipeline, size_t first, size_t last)
+    {
+        if (sortedDraws) {
+            const auto [begin, end] = renderQueue.passRange(pass);
+            first = std::min(begin + first, end);
+            last = std::min(begin + last, end);
+            if (bindlessEnabled) {
+                _scene.drawQueuedBindless(commandBuffer, renderQueue, first, last, bindlessPipelineLayout, scenePipeline(pass));
+            }
+            else {
+                _scene.drawQueued(commandBuffer, renderQueue, first, last, layout, pipeline, currentFrame);
+            }
+            return;
+        }
+        if (bindlessEnabled) {
+            _scene.drawObjectsBindless(commandBuffer, bindlessPipelineLayout, first, last);
+        }
+        else {
+            _scene.drawObjects(commandBuffer, layout, pipeline, currentFrame, first, last);
+        }
+    }
+
+    // Secondaries start with nothing bound, so each one sets the dynamic state, geometry and sets it draws with
+    VkCommandBufferInheritanceInfo passInheritance(VkRenderPass pass, VkFramebuffer framebuffer) const
+    {
+        VkCommandBufferInheritanceInfo inheritance{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO };
+        inheritance.renderPass = pass;
+        inheritance.subpass = 0;
+        inheritance.framebuffer = framebuffer;
+        return inheritance;
+    }
 
-        if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, fence) != VK_SUCCESS) {
-            vkDestroyFence(device, fence, nullptr);
-            throw std::runtime_error("failed to submit one-time command buffer!");
+    // Pipeline and sets (set0 = frame UBOs, set1 = shadow set) for shadow-pass draws
+    void bindShadowPass(VkCommandBuffer commandBuffer, uint32_t frameObjectOffset)
+    {
+        if (bindlessEnabled) {
+            bindBindlessPass(commandBuffer, shadowBindlessPipeline, frameObjectOffset);
+            return;
         }
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shadowPipeline);
+        VkDescriptorSet setsShadow[] = { descriptorSets[currentFrame], shadowDescriptorSets[currentFrame] };
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shadowPipelineLayout, 0, 2, setsShadow, 1, &frameObjectOffset);
+        CommandStats::add(CommandStats::PipelineBind);
+        CommandStats::add(CommandStats::DescriptorBind);
+    }
 
-        // Wait only for this work, not the whole queue
-        vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
-        vkDestroyFence(device, fence, nullptr);
+    // The frame and shadow sets under the main pipeline layout, which the lit, particle and outline pipelines share
+    void bindFrameSets(VkCommandBuffer commandBuffer, uint32_t frameObjectOffset)
+    {
+        VkDescriptorSet sets[] = { descriptorSets[currentFrame], shadowDescriptorSets[currentFrame] };
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 2, sets, 1, &frameObjectOffset);
+        CommandStats::add(CommandStats::DescriptorBind);
+    }
 
-        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+    // Phong pipeline and sets for the scene in the main pass
+    void bindScenePass(VkCommandBuffer commandBuffer, uint32_t frameObjectOffset)
+    {
+        if (bindlessEnabled) {
+            bindBindlessPass(commandBuffer, phongBindlessPipeline, frameObjectOffset);
+            return;
+        }
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, phongPipeline);
+        CommandStats::add(CommandStats::PipelineBind);
+        bindFrameSets(commandBuffer, frameObjectOffset);
     }
 
-    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+    void recordShadowPass(VkCommandBuffer commandBuffer, uint32_t frameObjectOffset)
+    {
+        std::array<VkClearValue, 1> shadowClear{};
+        shadowClear[0].depthStencil = { 1.0f, 0 };
+
+        const VkExtent2D shadowExtent{ SHADOW_MAP_SIZE, SHADOW_MAP_SIZE };
+        VkRenderPassBeginInfo shadowRp{};
+        shadowRp.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        shadowRp.renderPass = shadowRenderPass;
+        shadowRp.framebuffer = shadowFrameBuffer;
+        shadowRp.renderArea.extent = shadowExtent;
+        shadowRp.clearValueCount = static_cast<uint32_t>(shadowClear.size());
+        shadowRp.pClearValues = shadowClear.data();
+
+        // Depth only, so the order the shapes and the scene land in does not matter
+        auto drawShapes = [&](VkCommandBuffer cmd) {
+            if (bindlessEnabled) {
+                _mesh.drawBindless(cmd, bindlessPipelineLayout);
+                _cylinder.drawBindless(cmd, bindlessPipelineLayout);
+                _globe.drawBindless(cmd, bindlessPipelineLayout);
+            }
+            else {
+                _mesh.draw(cmd, shadowPipeline, shadowPipelineLayout, currentFrame);
+                _cylinder.draw(cmd, shadowPipeline, shadowPipelineLayout, currentFrame);
+                _globe.draw(cmd, shadowPipeline, shadowPipelineLayout, currentFrame);
+            }
+        };
+        const size_t objectCount = _scene.getObjects().size();
+        // Keep what this returns alive until the secondary's last draw
+        auto beginShadow = [&](VkCommandBuffer cmd) {
+            setViewportAndScissor(cmd, shadowExtent);
+            bindShadowPass(cmd, frameObjectOffset);
+            return GeometryArena::Recording(geometryArena, cmd);
+        };
 
-        VkBufferCopy copyRegion{};
-        copyRegion.size = size;
-        vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+        if (!parallelRecording && !staticCaching) {
+            vkCmdBeginRenderPass(commandBuffer, &shadowRp, VK_SUBPASS_CONTENTS_INLINE);
+            setViewportAndScissor(commandBuffer, shadowExtent);
+            bindShadowPass(commandBuffer, frameObjectOffset);
+            drawShapes(commandBuffer);
+            drawSceneRange(commandBuffer, ShadowScenePass, shadowPipelineLayout, shadowPipeline, 0, objectCount);
+            vkCmdEndRenderPass(commandBuffer);
+            return;
+        }
+
+        vkCmdBeginRenderPass(commandBuffer, &shadowRp, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        const VkCommandBufferInheritanceInfo inheritance = passInheritance(shadowRenderPass, shadowFrameBuffer);
 
-        endSingleTimeCommands(commandBuffer);
+        // Nothing in the shadow pass changes between frames
+        if (staticCaching) {
+            const VkCommandBuffer cached = staticCache.get(currentFrame, StaticShadow, inheritance, [&](VkCommandBuffer cmd) {
+                const auto geometry = beginShadow(cmd);
+                drawShapes(cmd);
+                drawSceneRange(cmd, ShadowScenePass, shadowPipelineLayout, shadowPipeline, 0, objectCount);
+            });
+            vkCmdExecuteCommands(commandBuffer, 1, &cached);
+            vkCmdEndRenderPass(commandBuffer);
+            return;
+        }
+
+        passSecondaries.clear();
+        const VkCommandBuffer shapes = recorder.beginSecondary(currentFrame, inheritance);
+        {
+            const auto geometry = beginShadow(shapes);
+            drawShapes(shapes);
+        }
+        recorder.endSecondary(shapes);
+        passSecondaries.push_back(shapes);
+
+        recorder.record(currentFrame, inheritance, objectCount, [&](VkCommandBuffer cmd, size_t first, size_t last) {
+            const auto geometry = beginShadow(cmd);
+            drawSceneRange(cmd, ShadowScenePass, shadowPipelineLayout, shadowPipeline, first, last);
+        }, passSecondaries);
+
+        vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(passSecondaries.size()), passSecondaries.data());
+        vkCmdEndRenderPass(commandBuffer);
     }
 
-    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-        VkPhysicalDeviceMemoryProperties memProperties;
-        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+    // Post-process quad, skybox, shapes, the scene, particles and the globe outline into the swapchain image
+    void recordPresentPass(VkCommandBuffer commandBuffer, uint32_t imageIndex, uint32_t frameObjectOffset)
+    {
+        std::array<VkClearValue, 2> swapClears{};
+        swapClears[0].color = { {0.f, 0.f, 0.f, 1.f} };
+        swapClears[1].depthStencil = { 1.f, 0 };
+
+        VkRenderPassBeginInfo rpBegin2{ };
+        rpBegin2.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        rpBegin2.renderPass = renderPass; // your swapchain render pass
+        rpBegin2.framebuffer = swapChainFramebuffers[imageIndex];
+        rpBegin2.renderArea.offset = { 0, 0 };
+        rpBegin2.renderArea.extent = swapChainExtent;
+        rpBegin2.clearValueCount = static_cast<uint32_t>(swapClears.size());
+        rpBegin2.pClearValues = swapClears.data();
+
+        // Post-process quad and skybox: the post-process set is written every frame and the skybox follows the camera
+        auto drawBackground = [&](VkCommandBuffer cmd) {
+            // Bind post-process pipeline + descriptor set BEFORE drawing fullscreen quad
+            const VkDescriptorSet postProcessSet = writePostProcessDescriptorSet(currentFrame);
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, postProcessPipeline);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                postProcessPipelineLayout, 0, 1, &postProcessSet, 0, nullptr);
+
+            // Draw fullscreen triangle/quad (now that the pipeline is bound)
+            vkCmdDraw(cmd, 6, 1, 0, 0);
+            CommandStats::add(CommandStats::PipelineBind);
+            CommandStats::add(CommandStats::DescriptorBind);
+            CommandStats::add(CommandStats::Draw);
+
+            if (_globe.WithinBounds(glm::vec3(frameBeingDrawn->camera.eye)))
+            {
+                // Bind skybox pipeline and descriptor sets
+                vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, skyboxPipeline);
+
+                // Bind both descriptor sets: frame UBO set (set 0) and skybox cubemap set (set 1)
+                VkDescriptorSet sets[] = { descriptorSets[currentFrame], skyboxDescriptorSet };
+                vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, skyboxPipelineLayout,
+                    0, 2, sets, 1, &frameObjectOffset);
+                CommandStats::add(CommandStats::PipelineBind);
+                CommandStats::add(CommandStats::DescriptorBind);
+
+                // Cube geometry lives in the arena bound at the start of recording
+                geometryArena.draw(cmd, skyboxGeometry);
+            }
+        };
+
+        // The cabin and cylinder; ends with the scene's pipeline and sets bound
+        auto drawShapes = [&](VkCommandBuffer cmd) {
+            if (bindlessEnabled) {
+                bindBindlessPass(cmd, gouraudBindlessPipeline, frameObjectOffset);
+                _mesh.drawBindless(cmd, bindlessPipelineLayout);
+
+                // Same layout, so the sets stay bound across the pipeline change
+                vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, phongBindlessPipeline);
+                CommandStats::add(CommandStats::PipelineBind);
+                _cylinder.drawBindless(cmd, bindlessPipelineLayout);
+            }
+            else {
+                vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, gouraudPipeline);
+                CommandStats::add(CommandStats::PipelineBind);
+                _mesh.draw(cmd, gouraudPipeline, pipelineLayout, currentFrame);
+
+                bindScenePass(cmd, frameObjectOffset);
+                _cylinder.draw(cmd, phongPipeline, pipelineLayout, currentFrame);
+            }
+        };
+
+        // Everything drawn before the scene
+        auto drawBeforeScene = [&](VkCommandBuffer cmd) {
+            drawBackground(cmd);
+            drawShapes(cmd);
+        };
+
+        auto drawParticles = [&](VkCommandBuffer cmd) {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, particlePipeline);
+            CommandStats::add(CommandStats::PipelineBind);
+
+            for (const auto& sys : _particleSystems) {
+                sys.recordDraw(cmd, particlePipeline, particleQuadVB, particleQuadIB, particleQuadIndexCount);
+            }
+            // Particles bind their own quad and instance buffers
+            geometryArena.bind(cmd);
+        };
+
+        auto drawOutline = [&](VkCommandBuffer cmd) {
+            // NOTE: post-process draw already executed earlier
+            // bind outline and draw globe outline
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, outlinePipeline);
+            CommandStats::add(CommandStats::PipelineBind);
+            _globe.draw(cmd, outlinePipeline, pipelineLayout, currentFrame);
+        };
+
+        auto drawAfterScene = [&](VkCommandBuffer cmd) {
+            drawParticles(cmd);
+            drawOutline(cmd);
+        };
+        const size_t objectCount = _scene.getObjects().size();
+
+        if (!parallelRecording && !staticCaching) {
+            vkCmdBeginRenderPass(commandBuffer, &rpBegin2, VK_SUBPASS_CONTENTS_INLINE);
+            setViewportAndScissor(commandBuffer, swapChainExtent);
+            drawBeforeScene(commandBuffer);
+            drawSceneRange(commandBuffer, MainScenePass, pipelineLayout, phongPipeline, 0, objectCount);
+            drawAfterScene(commandBuffer);
+            vkCmdEndRenderPass(commandBuffer);
+            return;
+        }
+
+        vkCmdBeginRenderPass(commandBuffer, &rpBegin2, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        const VkCommandBufferInheritanceInfo inheritance = passInheritance(renderPass, swapChainFramebuffers[imageIndex]);
+        // The shapes and particles rely on the frame sets an inline pass would still have bound from earlier passes
+        // Keep what this returns alive until the secondary's last draw
+        auto beginPresent = [&](VkCommandBuffer cmd) {
+            setViewportAndScissor(cmd, swapChainExtent);
+            bindFrameSets(cmd, frameObjectOffset);
+            return GeometryArena::Recording(geometryArena, cmd);
+        };
+
+        // Same draw order as inline, with the static pieces from the cache. They run against every swapchain
+        // image, so they name no framebuffer.
+        if (staticCaching) {
+            const VkCommandBufferInheritanceInfo anyFramebuffer = passInheritance(renderPass, VK_NULL_HANDLE);
+            passSecondaries.clear();
+            const VkCommandBuffer background = recorder.beginSecondary(currentFrame, inheritance);
+            {
+                const auto geometry = beginPresent(background);
+                drawBackground(background);
+            }
+            recorder.endSecondary(background);
+            passSecondaries.push_back(background);
+
+            passSecondaries.push_back(staticCache.get(currentFrame, StaticPresentOpaque, anyFramebuffer, [&](VkCommandBuffer cmd) {
+                const auto geometry = beginPresent(cmd);
+                drawShapes(cmd);
+                drawSceneRange(cmd, MainScenePass, pipelineLayout, phongPipeline, 0, objectCount);
+            }));
 
-        for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-            if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-                return i;
+            const VkCommandBuffer particles = recorder.beginSecondary(currentFrame, inheritance);
+            {
+                const auto geometry = beginPresent(particles);
+                drawParticles(particles);
             }
+            recorder.endSecondary(particles);
+            passSecondaries.push_back(particles);
+
+            passSecondaries.push_back(staticCache.get(currentFrame, StaticPresentOutline, anyFramebuffer, [&](VkCommandBuffer cmd) {
+                const auto geometry = beginPresent(cmd);
+                drawOutline(cmd);
+            }));
+
+            vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(passSecondaries.size()), passSecondaries.data());
+            vkCmdEndRenderPass(commandBuffer);
+            return;
         }
 
-        throw std::runtime_error("failed to find suitable memory type!");
+        passSecondaries.clear();
+        const VkCommandBuffer before = recorder.beginSecondary(currentFrame, inheritance);
+        {
+            const auto geometry = beginPresent(before);
+            drawBeforeScene(before);
+        }
+        recorder.endSecondary(before);
+        passSecondaries.push_back(before);
+
+        recorder.record(currentFrame, inheritance, objectCount, [&](VkCommandBuffer cmd, size_t first, size_t last) {
+            const auto geometry = beginPresent(cmd);
+            bindScenePass(cmd, frameObjectOffset);
+            drawSceneRange(cmd, MainScenePass, pipelineLayout, phongPipeline, first, last);
+        }, passSecondaries);
+
+        const VkCommandBuffer after = recorder.beginSecondary(currentFrame, inheritance);
+        {
+            const auto geometry = beginPresent(after);
+            drawAfterScene(after);
+        }
+        recorder.endSecondary(after);
+        passSecondaries.push_back(after);
+
+        vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(passSecondaries.size()), passSecondaries.data());
+        vkCmdEndRenderPass(commandBuffer);
+    }
+
+    // Cactus and rock instances on a grid, written as a scene CSV for the normal loader to convert
+    std::string writeBenchmarkScene(size_t objects)
+    {
+        std::ofstream file(RECORD_BENCH_SCENE_PATH, std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error(std::string("failed to write ") + RECORD_BENCH_SCENE_PATH);
+        }
+        file << "type,x,y,z\n";
+        const size_t side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(objects))));
+        const float spacing = 1.5f;
+        for (size_t i = 0; i < objects; ++i) {
+            const float x = (static_cast<float>(i % side) - side * 0.5f) * spacing;
+            const float z = (static_cast<float>(i / side) - side * 0.5f) * spacing;
+            file << (i % 2 ? "Rock" : "Cactus") << ',' << x << ",3," << z << '\n';
+        }
+        if (!file) {
+            throw std::runtime_error(std::string("failed to write ") + RECORD_BENCH_SCENE_PATH);
+        }
+        return RECORD_BENCH_SCENE_PATH;
+    }
+
+    // Times recording the shadow and main passes inline, then split across 1..N threads. The command buffer
+    // is never submitted; the offscreen pass and particle simulation are left out because recording them
+    // changes state the next real frame depends on.
+    void runRecordingBenchmark()
+    {
+        // Real frames first, so uploads have gone out and every descriptor set has been written
+        for (int i = 0; i <= MAX_FRAMES_IN_FLIGHT; ++i) {
+            pollInput();
+            drawFrame();
+        }
+        vkDeviceWaitIdle(device);
+
+        const VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+        const uint32_t frameObjectOffset = frameUniforms.objectOffset(currentFrame, frameObjectSlot);
+        const bool wasParallel = parallelRecording;
+        const unsigned wasActive = recorder.activeThreads();
+        const bool wasCaching = staticCaching;
+        const bool wasSorted = sortedDraws;
+
+        uint64_t binds = 0; // in the last iteration
+        auto bestMs = [&]() {
+            double best = std::numeric_limits<double>::max();
+            for (int i = 0; i < RECORD_BENCH_ITERATIONS; ++i) {
+                descriptorAllocator.resetFrame(currentFrame);
+                recorder.beginFrame(currentFrame);
+                vkResetCommandBuffer(commandBuffer, 0);
+
+                const CommandStats::Counts before = CommandStats::read();
+                const auto start = std::chrono::high_resolution_clock::now();
+                VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+                vkBeginCommandBuffer(commandBuffer, &beginInfo);
+                {
+                    const GeometryArena::Recording geometry(geometryArena, commandBuffer);
+                    recordShadowPass(commandBuffer, frameObjectOffset);
+                    recordPresentPass(commandBuffer, 0, frameObjectOffset);
+                }
+                vkEndCommandBuffer(commandBuffer);
+                best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+                binds = (CommandStats::read() - before).binds();
+            }
+            return best;
+        };
+
+        std::cout << "Recording benchmark: " << _scene.getObjects().size() << " scene objects, shadow and main passes, "
+            << (bindlessEnabled ? "bindless" : "per-object sets") << ", best of " << RECORD_BENCH_ITERATIONS << std::endl;
+        staticCaching = false;
+        parallelRecording = false;
+        sortedDraws = false;
+        buildRenderQueue();
+        std::cout << "  inline, scene order: " << bestMs() << " ms, " << binds << " binds" << std::endl;
+        sortedDraws = true;
+        buildRenderQueue();
+        std::cout << "  inline, sorted: " << bestMs() << " ms, " << binds << " binds" << std::endl;
+
+        parallelRecording = true;
+        double single = 0.0;
+        for (unsigned threads = 1; threads <= recorder.threadCount(); ++threads) {
+            recorder.setActiveThreads(threads);
+            const double ms = bestMs();
+            if (threads == 1) single = ms;
+            std::cout << "  " << threads << " thread" << (threads == 1 ? ": " : "s: ") << ms << " ms, "
+                << single / ms << "x" << std::endl;
+        }
+
+        // Only the first iteration records the static entries, so the best is the steady state
+        staticCaching = true;
+        buildRenderQueue();
+        staticCache.beginFrame(currentFrame, staticContentKey());
+        std::cout << "  static cache: " << bestMs() << " ms" << std::endl;
+
+        recorder.setActiveThreads(wasActive);
+        parallelRecording = wasParallel;
+        staticCaching = wasCaching;
+        sortedDraws = wasSorted;
+        descriptorAllocator.resetFrame(currentFrame);
+        recorder.beginFrame(currentFrame);
+        vkResetCommandBuffer(commandBuffer, 0);
     }
 
     void createCommandBuffers() {
@@ -3297,37 +4347,25 @@ private:
             throw std::runtime_error("failed to begin recording command buffer!");
         }
 
-        // Begin shadow pass
-        std::array<VkClearValue, 1> shadowClear{};
-        shadowClear[0].depthStencil = { 1.0f, 0 };
+        const CommandStats::Counts commandsBefore = CommandStats::read();
+        const CommandStats::Counts executedBefore = staticCache.stats().replayed;
+        buildRenderQueue();
+        // The frame's fence has signalled, so its cached entries can be recorded again if what they captured changed
+        staticCache.beginFrame(currentFrame, staticContentKey());
 
-        VkRenderPassBeginInfo shadowRp{};
-        shadowRp.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        shadowRp.renderPass = shadowRenderPass;
-        shadowRp.framebuffer = shadowFrameBuffer;
-        shadowRp.renderArea.extent = swapChainExtent;
-        shadowRp.clearValueCount = static_cast<uint32_t>(shadowClear.size());
-        shadowRp.pClearValues = shadowClear.data();
+        // GPU particle steps go before any render pass; their barriers order them against the previous frame's draws
+        for (auto& sys : _particleSystems) {
+            sys.recordSimulation(commandBuffer, particleQuadIndexCount);
+        }
 
-        vkCmdBeginRenderPass(commandBuffer, &shadowRp, VK_SUBPASS_CONTENTS_INLINE);
+        // Every mesh draws from the arena's VB/IB; bindings carry across the passes below
+        const GeometryArena::Recording geometry(geometryArena, commandBuffer);
 
-        VkViewport shadowVp{ 0.f, 0.f, (float)swapChainExtent.width, (float)swapChainExtent.height, 0.f, 1.f };
-        VkRect2D shadowSc{ {0,0}, swapChainExtent };
-        vkCmdSetViewport(commandBuffer, 0, 1, &shadowVp);
-        vkCmdSetScissor(commandBuffer, 0, 1, &shadowSc);
+        // drawScene emptied the post-process set at the start of the shadow pass; keep that now the scene is drawn in ranges
+        _scene.clearPostProcessables();
 
-        // bind shadow pipeline and descriptor sets (set0 = frame UBOs, set1 = shadow set)
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shadowPipeline);
-        VkDescriptorSet setsShadow[] = { descriptorSets[currentFrame], shadowDescriptorSets[currentFrame] };
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shadowPipelineLayout, 0, 2, setsShadow, 0, nullptr);
-
-        // draw shapes similarly to your other passes (mesh/shape draw accept pipeline + layout)
-        _mesh.draw(commandBuffer, shadowPipeline, shadowPipelineLayout, currentFrame);
-        _cylinder.draw(commandBuffer, shadowPipeline, shadowPipelineLayout, currentFrame);
-        _scene.drawScene(commandBuffer, shadowPipelineLayout, shadowPipeline, currentFrame); // adjust if signature differs
-        _globe.draw(commandBuffer, shadowPipeline, shadowPipelineLayout, currentFrame);
-
-        vkCmdEndRenderPass(commandBuffer);
+        const uint32_t frameObjectOffset = frameUniforms.objectOffset(currentFrame, frameObjectSlot);
+        recordShadowPass(commandBuffer, frameObjectOffset);
 
         // After render, transition shadowImage to SHADER_READ_ONLY_OPTIMAL for sampling
         VkImageMemoryBarrier barrier{};
@@ -3388,94 +4426,33 @@ private:
 
         vkCmdBeginRenderPass(commandBuffer, &rpBegin1, VK_SUBPASS_CONTENTS_INLINE);
 
-        VkViewport vp{ 0.f,0.f,(float)swapChainExtent.width,(float)swapChainExtent.height,0.f,1.f };
-        VkRect2D sc{ {0,0}, swapChainExtent };
-        vkCmdSetViewport(commandBuffer, 0, 1, &vp);
-        vkCmdSetScissor(commandBuffer, 0, 1, &sc);
+        setViewportAndScissor(commandBuffer, swapChainExtent);
 
-        VkDescriptorSet sets[] = { descriptorSets[currentFrame], shadowDescriptorSets[currentFrame] };
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout,
-            0, 2, sets, 0, nullptr);
+        if (bindlessEnabled) {
+            bindBindlessPass(commandBuffer, phongBindlessPipeline, frameObjectOffset);
+            _scene.drawPostProcessablesBindless(commandBuffer, bindlessPipelineLayout);
+        }
+        else {
+            bindFrameSets(commandBuffer, frameObjectOffset);
 
-        _scene.drawPostProcessables(commandBuffer, pipelineLayout, phongPipeline, currentFrame);
+            _scene.drawPostProcessables(commandBuffer, pipelineLayout, phongPipeline, currentFrame);
+        }
 
         vkCmdEndRenderPass(commandBuffer);
 
         offscreenInitialized = true;
 
         // ----- Pass 2: post-process to swapchain framebuffer -----
-        std::array<VkClearValue, 2> swapClears{};
-        swapClears[0].color = { {0.f, 0.f, 0.f, 1.f} };
-        swapClears[1].depthStencil = { 1.f, 0 };
-
-        VkRenderPassBeginInfo rpBegin2{ };
-        rpBegin2.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        rpBegin2.renderPass = renderPass; // your swapchain render pass
-        rpBegin2.framebuffer = swapChainFramebuffers[imageIndex];
-        rpBegin2.renderArea.offset = { 0, 0 };
-        rpBegin2.renderArea.extent = swapChainExtent;
-        rpBegin2.clearValueCount = static_cast<uint32_t>(swapClears.size());
-        rpBegin2.pClearValues = swapClears.data();
-
-        vkCmdBeginRenderPass(commandBuffer, &rpBegin2, VK_SUBPASS_CONTENTS_INLINE);
-
-        vkCmdSetViewport(commandBuffer, 0, 1, &vp);
-        vkCmdSetScissor(commandBuffer, 0, 1, &sc);
-
-        // Bind post-process pipeline + descriptor set BEFORE drawing fullscreen quad
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, postProcessPipeline);
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-            postProcessPipelineLayout, 0, 1, &postProcessDescriptorSets[currentFrame], 0, nullptr);
-
-        // Draw fullscreen triangle/quad (now that the pipeline is bound)
-        vkCmdDraw(commandBuffer, 6, 1, 0, 0);
-
-        if (_globe.WithinBounds(cameraManager.getCurrentCamera().getEye()))
-        {
-            // Bind skybox pipeline and descriptor sets
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, skyboxPipeline);
-
-            // Bind both descriptor sets: frame UBO set (set 0) and skybox cubemap set (set 1)
-            VkDescriptorSet sets[] = { descriptorSets[currentFrame], skyboxDescriptorSet };
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, skyboxPipelineLayout,
-                0, 2, sets, 0, nullptr);
-
-            // Bind skybox vertex/index buffers (use your cube geometry)
-            VkBuffer vertexBuffers[] = { vertexBuffer };
-            VkDeviceSize offsets[] = { 0 };
-            vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-            vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
-
-            // Draw the cube (36 indices for a box)
-            vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
-        }
-
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gouraudPipeline);
-        _mesh.draw(commandBuffer, gouraudPipeline, pipelineLayout, currentFrame);
-
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, phongPipeline);
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout,
-            0, 2, sets, 0, nullptr);
-
-        _cylinder.draw(commandBuffer, phongPipeline, pipelineLayout, currentFrame);
-        _scene.drawScene(commandBuffer, pipelineLayout, phongPipeline, currentFrame);
-
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, particlePipeline);
-
-        for (const auto& sys : _particleSystems) {
-            sys.recordDraw(commandBuffer, particlePipeline, particleQuadVB, particleQuadIB, particleQuadIndexCount);
-        }
-
-        // NOTE: post-process draw already executed earlier
-        // bind outline and draw globe outline
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, outlinePipeline);
-        _globe.draw(commandBuffer, outlinePipeline, pipelineLayout, currentFrame);
-
-        vkCmdEndRenderPass(commandBuffer);
+        recordPresentPass(commandBuffer, imageIndex, frameObjectOffset);
 
         if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
             throw std::runtime_error("failed to record command buffer!");
         }
+
+        CommandTally& tally = commandTallies[staticCaching][sortedDraws];
+        ++tally.frames;
+        tally.recorded += CommandStats::read() - commandsBefore;
+        tally.executed += staticCache.stats().replayed - executedBefore;
     }
 
     void createSyncObjects() {
@@ -3499,41 +4476,23 @@ private:
         }
     }
 
-    void updateUniformBuffer(uint32_t currentImage) {
+    // Camera, lights, shadow matrices and time from the simulation's state; nothing is written to the GPU here
+    void buildFrameConstants(FrameSnapshot& frame) {
         static auto startTime = std::chrono::high_resolution_clock::now();
 
         auto currentTime = std::chrono::high_resolution_clock::now();
         float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
 
-        uint32_t idx = currentFrame;
-
-        UniformBufferObject ubo{};
-        ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-		ubo.view = cameraManager.getCurrentCamera().getViewMatrix();
-        ubo.proj = cameraManager.getCurrentCamera().getProjectionMatrix();
-        ubo.proj[1][1] *= -1;
-
-        for(Shape* shape : _shapes)
-        {
-            shape->updateUniformBuffer(idx,ubo.model,ubo.view,ubo.proj);
-		}
-
-		_globe.updateUniformBuffer(idx, ubo.model, ubo.view, ubo.proj);
-		_scene.updateSceneUniformBuffers(idx, ubo.model, ubo.view, ubo.proj);
-
-        void* dst = uniformBuffersMapped[currentImage];
-        if (!dst) {
-            throw std::runtime_error("uniformBuffersMapped[currentImage] is null after resize/recreate.");
-        }
-        std::memcpy(dst, &ubo, sizeof(ubo));
+        const glm::mat4 model = glm::rotate(glm::mat4(1.0f), time * glm::radians(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        frame.sceneModel = model;
 
-        for (auto& sys : _particleSystems)
-        {
-            sys.update(_deltaTime);
-        }
+        CameraUniforms& cam = frame.camera;
+		cam.view = cameraManager.getCurrentCamera().getViewMatrix();
+        cam.proj = cameraManager.getCurrentCamera().getProjectionMatrix();
+        cam.proj[1][1] *= -1;
+        cam.eye = glm::inverse(cam.view)[3];
 
-		glm::mat4 invView = glm::inverse(ubo.view);
-		glm::vec3 camPos(invView[3]);
+		glm::vec3 camPos(cam.eye);
 
         // Day-night cycle from GlobeScene
         const float secondsPerCycle = _scene.getDayNightCycleDuration();
@@ -3594,6 +4553,7 @@ private:
             _lights[1].setSpecular(moonSpecular);
         }
 
+        frame.hasShadow = false;
         if (_lights.size() > 0)
         {
             // example for directional light: use an orthographic projection that covers scene extents
@@ -3608,7 +4568,8 @@ private:
             sh.lightProj = glm::ortho(-orthoSize, orthoSize, -orthoSize, orthoSize, 1.0f, 400.0f);
             sh.lightProj[1][1] *= -1; // if your clip-space flips Y for Vulkan
 
-            std::memcpy(shadowUniformBuffersMapped[currentImage], &sh, sizeof(sh));
+            frame.shadow = sh;
+            frame.hasShadow = true;
         }
 
         LightingUBOCPU l{};
@@ -3630,44 +4591,122 @@ private:
 			l.lightCount = 0;
         }
 
-        std::memcpy(lightUniformBuffersMapped[currentImage], &l, sizeof(LightingUBOCPU));
-		TimeUBO ti{};
-		ti.time = time;
-		std::memcpy(timeBuffersMapped[currentImage], &ti, sizeof(TimeUBO));
+        frame.lighting = l;
+		frame.time = TimeUBO{};
+		frame.time.time = time;
     }
 
-    void drawFrame() {
-        
+    void writeFrameConstants(uint32_t currentImage, const FrameSnapshot& frame) {
+        frameUniforms.writeCamera(currentImage, frame.camera);
+        if (frame.hasShadow) {
+            std::memcpy(shadowUniformBuffersMapped[currentImage], &frame.shadow, sizeof(ShadowUBO));
+        }
+        std::memcpy(lightUniformBuffersMapped[currentImage], &frame.lighting, sizeof(LightingUBOCPU));
+        std::memcpy(timeBuffersMapped[currentImage], &frame.time, sizeof(TimeUBO));
+    }
+
+    // Every object writes only its own slot, so the scene's objects are packed in parallel ranges. A snapshot
+    // from the main thread carries the scene's matrices; drawFrame's own frame computes them here.
+    void updateObjectUniforms(uint32_t currentImage, const FrameSnapshot& frame) {
+        frameUniforms.writeObject(currentImage, frameObjectSlot, frame.sceneModel);
+
+        for (Shape* shape : _shapes)
+        {
+            shape->updateUniformBuffer(currentImage, frame.sceneModel);
+        }
+
+        _globe.updateUniformBuffer(currentImage, frame.sceneModel);
+        if (frame.objectModels.empty()) {
+            _scene.updateSceneUniformBuffers(currentImage, frame.sceneModel, &jobs);
+        }
+        else {
+            _scene.writeModelMatrices(currentImage, frame.objectModels, &jobs);
+        }
+    }
+
+    void advanceFrameClock() {
 		auto now = std::chrono::high_resolution_clock::now();
 		_deltaTime = std::chrono::duration<float>(now - _lastFrameTime).count();
         _lastFrameTime = now;
+    }
 
-		_scene.updateScene(_deltaTime * _timeScale);
+    void drawFrame() {
+        uint32_t imageIndex;
+        if (!beginFrame(imageIndex)) return;
+        drawBegunFrame(imageIndex);
+    }
 
-        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    // The frame's fence has signalled and imageIndex is acquired; the low latency profile polls input in between
+    void drawBegunFrame(uint32_t imageIndex) {
+        advanceFrameClock();
+        frameBeingDrawn = &inlineFrame;
+        inlineFrame.sampleTime = inputSampleTime;
+
+        // Scene update, particle integration, uniform packing and recording. The particle systems write their
+        // instances straight into this frame's mapped region, so the graph only runs once the fence has signalled.
+        frameImageIndex = imageIndex;
+        frameGraph.run(jobs);
+
+        submitFrame(imageIndex);
+    }
+
+    // Render thread: draws a snapshot the main thread published
+    void drawSnapshot(const FrameSnapshot& frame) {
+        applyRequests(frame.requests);
+        // Minimized; the main thread waits for the window to come back
+        if (frame.framebufferWidth == 0 || frame.framebufferHeight == 0) return;
+        frameBeingDrawn = &frame;
 
         uint32_t imageIndex;
+        if (!beginFrame(imageIndex)) return;
+
+        frameImageIndex = imageIndex;
+        snapshotGraph.run(jobs);
+
+        submitFrame(imageIndex);
+    }
+
+    // Waits for the frame's fence and acquires an image; false when the swapchain had to be recreated instead
+    bool beginFrame(uint32_t& imageIndex) {
+        // Earlier frames that have finished by now, so their latency is not taken only when their slot comes round
+        for (uint32_t i = 0; i < framesInFlight; ++i) {
+            if (i != currentFrame && frameLatency.pending(i) && vkGetFenceStatus(device, inFlightFences[i]) == VK_SUCCESS) {
+                frameLatency.completed(i);
+            }
+        }
+        vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+        frameLatency.completed(currentFrame);
+        // Objects retired by a resize before this frame's last submission are no longer in use
+        deletionQueue.collect(currentFrame);
+
+        // Swap in streamed textures; their uploads go out with this frame's uploader flush
+        textureSwaps += texManager.updateStreaming(MAX_FRAMES_IN_FLIGHT);
+
         VkResult result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR) {
             recreateSwapChain();
-            return;
+            return false;
         }
         else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
             throw std::runtime_error("failed to acquire swap chain image!");
         }
 
-        updateUniformBuffer(currentFrame);
-
-        for (auto& sys : _particleSystems)
-        {
-            sys.uploadInstances(_ctx);
-		}
-
         vkResetFences(device, 1, &inFlightFences[currentFrame]);
 
-        vkResetCommandBuffer(commandBuffers[currentFrame], /*VkCommandBufferResetFlagBits*/ 0);
-        recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
+        // The fence has signalled, so this frame's transient descriptor sets are no longer in use
+        descriptorAllocator.resetFrame(currentFrame);
+        recorder.beginFrame(currentFrame);
+        // Textures registered or swapped by streaming since this frame's table set was last written
+        if (bindlessTable.valid()) {
+            bindlessTable.update(currentFrame);
+        }
+        return true;
+    }
+
+    void submitFrame(uint32_t imageIndex) {
+        // Uploads recorded this frame are submitted ahead of the frame on the same queue
+        uploader.flush();
 
         VkSubmitInfo submitInfo{};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -3690,6 +4729,7 @@ private:
             std::cerr << "vkQueueSubmit failed with VkResult = " << static_cast<int>(submitRes) << std::endl;
             throw std::runtime_error("failed to submit draw command buffer! VkResult=" + std::to_string(static_cast<int>(submitRes)));
         }
+        deletionQueue.submitted(currentFrame);
 
         VkPresentInfoKHR presentInfo{};
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -3703,7 +4743,8 @@ private:
 
         presentInfo.pImageIndices = &imageIndex;
 
-        result = vkQueuePresentKHR(presentQueue, &presentInfo);
+        const VkResult result = vkQueuePresentKHR(presentQueue, &presentInfo);
+        frameLatency.presented(currentFrame, frameBeingDrawn->sampleTime);
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized) {
             framebufferResized = false;
@@ -3713,7 +4754,7 @@ private:
             throw std::runtime_error("failed to present swap chain image!");
         }
 
-        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        currentFrame = (currentFrame + 1) % framesInFlight;
     }
 
     VkShaderModule createShaderModule(const std::vector<char>& code) {
@@ -3741,22 +4782,34 @@ private:
     }
 
     VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
-        for (const auto& availablePresentMode : availablePresentModes) {
-            if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-                return availablePresentMode;
+        for (VkPresentModeKHR preferred : latencyProfile().presentModes) {
+            for (const auto& availablePresentMode : availablePresentModes) {
+                if (availablePresentMode == preferred) {
+                    return availablePresentMode;
+                }
             }
         }
 
         return VK_PRESENT_MODE_FIFO_KHR;
     }
 
+    // GLFW may only be called from the main thread, so the render thread takes the size the snapshot carries
+    void framebufferSize(int& width, int& height) const {
+        if (frameBeingDrawn != &inlineFrame) {
+            width = frameBeingDrawn->framebufferWidth;
+            height = frameBeingDrawn->framebufferHeight;
+            return;
+        }
+        glfwGetFramebufferSize(window, &width, &height);
+    }
+
     VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities) {
         if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
             return capabilities.currentExtent;
         }
         else {
             int width, height;
-            glfwGetFramebufferSize(window, &width, &height);
+            framebufferSize(width, height);
 
             VkExtent2D actualExtent = {
                 static_cast<uint32_t>(width),
@@ -3827,6 +4880,18 @@ private:
         return requiredExtensions.empty();
     }
 
+    bool deviceSupportsExtension(VkPhysicalDevice device, const char* name) {
+        uint32_t extensionCount;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+        return std::any_of(availableExtensions.begin(), availableExtensions.end(), [name](const VkExtensionProperties& extension) {
+            return std::strcmp(extension.extensionName, name) == 0;
+        });
+    }
+
     QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device) {
         QueueFamilyIndices indices;
 
@@ -3923,11 +4988,96 @@ private:
     }
 };
 
-int main() {
+int main(int argc, char** argv) {
+    // --bench-obj [faces]: compare the OBJ loaders without opening a window
+    if (argc > 1 && std::string(argv[1]) == "--bench-obj") {
+        try {
+            return runObjLoaderBenchmark(argc > 2 ? std::stoull(argv[2]) : 3000000);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // --mesh-report [dir]: print vertex cache stats before and after MeshOptimizer for every OBJ
+    if (argc > 1 && std::string(argv[1]) == "--mesh-report") {
+        try {
+            return runMeshOptimizerReport(argc > 2 ? argv[2] : "models");
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // --check-mips: compare the CPU mip chain with a float box filter without opening a window
+    if (argc > 1 && std::string(argv[1]) == "--check-mips") {
+        try {
+            return runMipChainCheck();
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
     HelloTriangleApplication app;
 
     try {
-        app.run();
+        // --jobs N: job system threads including the main thread (default: every hardware thread)
+        // --serial-jobs: run the frame's tasks in order on the main thread
+        // --record-threads N: cap on the threads parallel command recording uses (default: every job system thread)
+        // --render-thread: record and submit on a thread of their own, fed snapshots by the main thread
+        // --bench-render-thread [frames]: time frames drawn on the main thread, then on the render thread, then exit
+        // --latency low|balanced|throughput: frames in flight, swapchain depth and present mode (default: balanced)
+        // --no-static-cache: record static scene content every frame instead of replaying cached secondaries
+        // --no-sort-draws: draw scene objects in scene order instead of through the sorted render queue
+        // --bench-record [objects]: time recording a synthetic scene on 1..N threads, then exit
+        // --check-particles [steps]: compare CPU particles with shader.comp step by step, then exit
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--jobs" && i + 1 < argc) {
+                app.setJobThreads(static_cast<unsigned>(std::stoul(argv[++i])));
+            }
+            else if (arg == "--serial-jobs") {
+                app.setSerialJobs(true);
+            }
+            else if (arg == "--render-thread") {
+                app.setRenderThread(true);
+            }
+            else if (arg == "--no-static-cache") {
+                app.setStaticCaching(false);
+            }
+            else if (arg == "--no-sort-draws") {
+                app.setSortedDraws(false);
+            }
+            else if (arg == "--latency" && i + 1 < argc) {
+                LatencyMode mode;
+                if (!parseLatencyMode(argv[++i], mode)) {
+                    throw std::runtime_error(std::string("unknown latency profile '") + argv[i] + "', expected low, balanced or throughput");
+                }
+                app.setLatencyMode(mode);
+            }
+            else if (arg == "--bench-render-thread") {
+                const bool hasCount = i + 1 < argc && argv[i + 1][0] != '-';
+                app.setPipelineBenchmark(hasCount ? std::stoull(argv[++i]) : PIPELINE_BENCH_FRAMES);
+            }
+            else if (arg == "--record-threads" && i + 1 < argc) {
+                app.setRecordThreads(static_cast<unsigned>(std::stoul(argv[++i])));
+            }
+            else if (arg == "--bench-record") {
+                const bool hasCount = i + 1 < argc && argv[i + 1][0] != '-';
+                app.setRecordBenchmark(hasCount ? std::stoull(argv[++i]) : RECORD_BENCH_OBJECTS);
+            }
+            else if (arg == "--check-particles") {
+                const bool hasCount = i + 1 < argc && argv[i + 1][0] != '-';
+                app.setParticleCheck(hasCount ? static_cast<uint32_t>(std::stoul(argv[++i])) : PARTICLE_CHECK_STEPS);
+            }
+        }
+        if (app.run() != 0) {
+            return EXIT_FAILURE;
+        }
     }
     catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
@@ -18,6 +18,7 @@ public:
     void create() override;
 	void move() override;
 	bool WithinBounds(const glm::vec3& point, float buffer = 0.0f) const;
+    size_t localDataBytes() const override { return _localVertices.capacity() * sizeof(Vertex) + _localIndices.capacity() * sizeof(uint16_t); }
 
 };
 
@@ -0,0 +1,93 @@
+#include "StaticCommandCache.h"
+#include <stdexcept>
+
+void StaticCommandCache::create(VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, uint32_t entriesPerFrame)
+{
+	if (framesInFlight == 0) {
+		throw std::runtime_error("StaticCommandCache: at least one frame in flight is required");
+	}
+
+	_device = device;
+	VkCommandPoolCreateInfo poolInfo{ VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+	// Entries are re-recorded one at a time, never as a whole pool
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	poolInfo.queueFamilyIndex = queueFamily;
+
+	_frames.assign(framesInFlight, Frame{});
+	for (Frame& frame : _frames) {
+		if (vkCreateCommandPool(_device, &poolInfo, nullptr, &frame.pool) != VK_SUCCESS) {
+			throw std::runtime_error("StaticCommandCache: failed to create a frame's command pool");
+		}
+		frame.entries.assign(entriesPerFrame, Entry{});
+
+		VkCommandBufferAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+		allocInfo.commandPool = frame.pool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		allocInfo.commandBufferCount = 1;
+		for (Entry& entry : frame.entries) {
+			if (vkAllocateCommandBuffers(_device, &allocInfo, &entry.cmd) != VK_SUCCESS) {
+				throw std::runtime_error("StaticCommandCache: failed to allocate a secondary command buffer");
+			}
+		}
+	}
+	_stats = {};
+}
+
+void StaticCommandCache::destroy()
+{
+	// Destroying a pool frees its secondaries
+	for (Frame& frame : _frames) {
+		vkDestroyCommandPool(_device, frame.pool, nullptr);
+	}
+	_frames.clear();
+	_device = VK_NULL_HANDLE;
+}
+
+void StaticCommandCache::beginFrame(uint32_t frame, uint64_t key)
+{
+	Frame& f = _frames.at(frame);
+	if (f.key == key) return;
+	for (Entry& entry : f.entries) {
+		entry.recorded = false;
+	}
+	f.key = key;
+}
+
+void StaticCommandCache::invalidate()
+{
+	for (Frame& frame : _frames) {
+		for (Entry& entry : frame.entries) {
+			entry.recorded = false;
+		}
+	}
+}
+
+VkCommandBuffer StaticCommandCache::get(uint32_t frame, uint32_t entry, const VkCommandBufferInheritanceInfo& inheritance, const Record& record)
+{
+	Entry& e = _frames.at(frame).entries.at(entry);
+	if (e.recorded) {
+		++_stats.reuses;
+		_stats.replayed += e.commands;
+		return e.cmd;
+	}
+
+	// Not one-time-submit: the entry is executed by every frame that comes round to this slot
+	VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	beginInfo.pInheritanceInfo = &inheritance;
+	if (vkBeginCommandBuffer(e.cmd, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("StaticCommandCache: failed to begin a secondary command buffer");
+	}
+	const CommandStats::Counts before = CommandStats::read();
+	record(e.cmd);
+	e.commands = CommandStats::read() - before;
+	if (vkEndCommandBuffer(e.cmd) != VK_SUCCESS) {
+		throw std::runtime_error("StaticCommandCache: failed to record a secondary command buffer");
+	}
+
+	e.recorded = true;
+	++_stats.recordings;
+	_stats.recorded += e.commands;
+	_stats.replayed += e.commands;
+	return e.cmd;
+}
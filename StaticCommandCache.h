@@ -0,0 +1,70 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "CommandStats.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Secondary command buffers for content whose commands are the same every frame, recorded once and executed
+// until something they captured changes. Entries are kept per frame in flight because the draws bind that
+// frame's descriptor sets and dynamic offsets: the uniform data behind them changes every frame, the commands
+// do not. The caller folds everything the commands capture (pipelines, sets, viewport, the static object set)
+// into a key; a frame's entries are re-recorded the first time they are used under a different key.
+// A frame's entries are only touched by the thread recording that frame, after its fence has signalled.
+class StaticCommandCache final
+{
+public:
+	// Records the entry into cmd, which has begun inside the pass; secondaries inherit no bound state
+	using Record = std::function<void(VkCommandBuffer cmd)>;
+
+	struct Stats {
+		uint64_t recordings = 0;       // entries recorded, the first time or after an invalidation
+		uint64_t reuses = 0;           // entries executed without recording
+		CommandStats::Counts recorded; // commands recorded into entries
+		CommandStats::Counts replayed; // commands executed from entries, recorded or reused
+	};
+
+	StaticCommandCache() = default;
+	~StaticCommandCache() = default;
+
+	// Owns command pools; release them through destroy()
+	StaticCommandCache(const StaticCommandCache&) = delete;
+	StaticCommandCache& operator=(const StaticCommandCache&) = delete;
+	StaticCommandCache(StaticCommandCache&&) = delete;
+	StaticCommandCache& operator=(StaticCommandCache&&) = delete;
+
+	void create(VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, uint32_t entriesPerFrame);
+	// The GPU must be done with every entry
+	void destroy();
+	bool valid() const { return _device != VK_NULL_HANDLE; }
+
+	// Drops the frame's entries if they were recorded under another key; call once the frame's fence has
+	// signalled and before get()
+	void beginFrame(uint32_t frame, uint64_t key);
+	// Every frame's entries are recorded again on next use
+	void invalidate();
+
+	// The entry's secondary for frame, recorded first with record if it is missing. Pass a framebuffer of
+	// VK_NULL_HANDLE in inheritance when the pass's framebuffer changes between frames.
+	VkCommandBuffer get(uint32_t frame, uint32_t entry, const VkCommandBufferInheritanceInfo& inheritance, const Record& record);
+
+	const Stats& stats() const { return _stats; }
+
+private:
+	struct Entry {
+		VkCommandBuffer cmd{ VK_NULL_HANDLE };
+		bool recorded = false;
+		CommandStats::Counts commands;
+	};
+
+	struct Frame {
+		VkCommandPool pool{ VK_NULL_HANDLE };
+		std::vector<Entry> entries;
+		uint64_t key = 0;
+	};
+
+	VkDevice _device{ VK_NULL_HANDLE };
+	std::vector<Frame> _frames;
+
+	Stats _stats;
+};
@@ -0,0 +1,153 @@
+#include "TaskGraph.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	double millisecondsSince(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+}
+
+TaskGraph::TaskId TaskGraph::add(std::string name, std::function<void()> task)
+{
+	Task t;
+	t.name = std::move(name);
+	t.work = std::move(task);
+	_tasks.push_back(std::move(t));
+	_remaining.reset();
+	return static_cast<TaskId>(_tasks.size() - 1);
+}
+
+void TaskGraph::precede(TaskId before, TaskId after)
+{
+	if (before >= _tasks.size() || after >= _tasks.size() || before == after) {
+		throw std::runtime_error("TaskGraph: invalid dependency between tasks " + std::to_string(before) + " and " + std::to_string(after));
+	}
+	std::vector<TaskId>& successors = _tasks[before].successors;
+	if (std::find(successors.begin(), successors.end(), after) != successors.end()) return;
+	successors.push_back(after);
+	++_tasks[after].dependencies;
+	_validated = false;
+}
+
+void TaskGraph::clear()
+{
+	_tasks.clear();
+	_remaining.reset();
+	_validated = false;
+	resetTimings();
+}
+
+void TaskGraph::validate() const
+{
+	// Kahn's algorithm: every task is reached from the roots only if there is no cycle
+	std::vector<uint32_t> remaining(_tasks.size());
+	std::vector<TaskId> ready;
+	for (TaskId id = 0; id < _tasks.size(); ++id) {
+		remaining[id] = _tasks[id].dependencies;
+		if (remaining[id] == 0) ready.push_back(id);
+	}
+	size_t reached = 0;
+	while (!ready.empty()) {
+		const TaskId id = ready.back();
+		ready.pop_back();
+		++reached;
+		for (TaskId next : _tasks[id].successors) {
+			if (--remaining[next] == 0) ready.push_back(next);
+		}
+	}
+	if (reached == _tasks.size()) return;
+
+	const auto stuck = std::find_if(remaining.begin(), remaining.end(), [](uint32_t r) { return r > 0; });
+	throw std::runtime_error("TaskGraph: the dependencies of '" + _tasks[stuck - remaining.begin()].name + "' form a cycle");
+}
+
+void TaskGraph::run(JobSystem& jobs)
+{
+	if (_tasks.empty()) return;
+	if (!_validated) {
+		validate();
+		_validated = true;
+	}
+	if (!_remaining) {
+		_remaining = std::make_unique<std::atomic<uint32_t>[]>(_tasks.size());
+	}
+
+	const Clock::time_point start = Clock::now();
+	for (TaskId id = 0; id < _tasks.size(); ++id) {
+		_remaining[id].store(_tasks[id].dependencies, std::memory_order_relaxed);
+	}
+	_failed.store(false, std::memory_order_relaxed);
+
+	JobSystem::Group group;
+	for (TaskId id = 0; id < _tasks.size(); ++id) {
+		if (_tasks[id].dependencies == 0) {
+			jobs.submit(group, [this, &jobs, &group, id] { runTask(jobs, group, id); });
+		}
+	}
+	jobs.wait(group);
+
+	_lastRunMs = millisecondsSince(start);
+	++_runs;
+}
+
+void TaskGraph::runTask(JobSystem& jobs, JobSystem::Group& group, TaskId id)
+{
+	Task& task = _tasks[id];
+	std::exception_ptr error;
+	if (!_failed.load(std::memory_order_acquire)) {
+		const Clock::time_point start = Clock::now();
+		try {
+			task.work();
+		}
+		catch (...) {
+			error = std::current_exception();
+			_failed.store(true, std::memory_order_release);
+		}
+		task.lastMs = millisecondsSince(start);
+		task.totalMs += task.lastMs;
+		task.peakMs = std::max(task.peakMs, task.lastMs);
+		task.thread = jobs.currentThread();
+	}
+
+	// Successors are released even after a failure so the run still completes; they skip their work
+	for (TaskId next : task.successors) {
+		if (_remaining[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			jobs.submit(group, [this, &jobs, &group, next] { runTask(jobs, group, next); });
+		}
+	}
+	// The group keeps the first exception and wait() rethrows it
+	if (error) std::rethrow_exception(error);
+}
+
+std::vector<TaskGraph::Timing> TaskGraph::timings() const
+{
+	std::vector<Timing> out;
+	out.reserve(_tasks.size());
+	for (const Task& task : _tasks) {
+		Timing t;
+		t.name = task.name;
+		t.lastMs = task.lastMs;
+		t.averageMs = _runs > 0 ? task.totalMs / static_cast<double>(_runs) : 0.0;
+		t.peakMs = task.peakMs;
+		t.thread = task.thread;
+		out.push_back(std::move(t));
+	}
+	return out;
+}
+
+void TaskGraph::resetTimings()
+{
+	for (Task& task : _tasks) {
+		task.lastMs = 0.0;
+		task.totalMs = 0.0;
+		task.peakMs = 0.0;
+	}
+	_lastRunMs = 0.0;
+	_runs = 0;
+}
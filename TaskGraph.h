@@ -0,0 +1,73 @@
+#pragma once
+#include "JobSystem.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A fixed set of named tasks and the order between them, built once and run every frame on a JobSystem.
+// A task is queued as soon as the last task it depends on finishes, so independent stages overlap, and a
+// task may itself fan out with JobSystem::parallelFor. Each run times every task.
+// In serial mode the tasks run on the calling thread, depth first from the roots in the order they were added.
+class TaskGraph final
+{
+public:
+	using TaskId = uint32_t;
+
+	struct Timing {
+		std::string name;
+		double lastMs = 0.0;    // wall time of the task in the last run, including any parallelFor inside it
+		double averageMs = 0.0; // over every run since resetTimings()
+		double peakMs = 0.0;
+		unsigned thread = 0;    // JobSystem thread the task last ran on
+	};
+
+	TaskGraph() = default;
+	~TaskGraph() = default;
+
+	TaskGraph(const TaskGraph&) = delete;
+	TaskGraph& operator=(const TaskGraph&) = delete;
+
+	TaskId add(std::string name, std::function<void()> task);
+	// after does not start until before has finished
+	void precede(TaskId before, TaskId after);
+	void clear();
+
+	// Runs every task once and returns when all have finished. If a task throws, the tasks after it are skipped
+	// and the exception is rethrown here. Throws if the dependencies form a cycle.
+	void run(JobSystem& jobs);
+
+	size_t size() const { return _tasks.size(); }
+	std::vector<Timing> timings() const;
+	// Wall time of the last run, against which the task times show how much of it overlapped
+	double lastRunMs() const { return _lastRunMs; }
+	uint64_t runs() const { return _runs; }
+	void resetTimings();
+
+private:
+	struct Task {
+		std::string name;
+		std::function<void()> work;
+		std::vector<TaskId> successors;
+		uint32_t dependencies = 0;
+		double lastMs = 0.0;
+		double totalMs = 0.0;
+		double peakMs = 0.0;
+		unsigned thread = 0;
+	};
+
+	void validate() const;
+	void runTask(JobSystem& jobs, JobSystem::Group& group, TaskId id);
+
+	std::vector<Task> _tasks;
+	bool _validated{ false };
+
+	// Per run: dependencies each task is still waiting on
+	std::unique_ptr<std::atomic<uint32_t>[]> _remaining;
+	std::atomic<bool> _failed{ false };
+
+	double _lastRunMs{ 0.0 };
+	uint64_t _runs{ 0 };
+};
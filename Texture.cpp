@@ -1,40 +1,59 @@
 #include "Texture.h"
+#include "MipChain.h"
 
 void Texture::createTextureImage()
 {
-    int texWidth, texHeight, texChannels;
-	const char* const path = _texturePath.c_str();
-    stbi_uc* const pixels = stbi_load(path, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    const VkDeviceSize imageSize = texWidth * texHeight * 4;
+    uploadTextureImage(DecodedImage::load(_texturePath));
+}
 
-    if (!pixels) {
+void Texture::uploadTextureImage(const DecodedImage& image)
+{
+    if (!image.pixels) {
         throw std::runtime_error("failed to load texture image!");
     }
+    uploadPixels(image.pixels, static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height));
+}
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+void Texture::uploadPixels(const void* rgba, uint32_t width, uint32_t height)
+{
+    if (!_uploader) {
+        throw std::runtime_error("Texture: no uploader to stage pixels through");
+    }
 
-    void* data;
-    vkMapMemory(_device, stagingBufferMemory, 0, imageSize, 0, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
-    vkUnmapMemory(_device, stagingBufferMemory);
+    _mipLevels = MipChain::levelCount(width, height);
+    _image.createImage(width, height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        _texturePath.empty() ? "decoded texture" : _texturePath, _textureImage, _textureImageAllocation, _mipLevels);
 
-    stbi_image_free(pixels);
+    // Level 0 and the rest of the chain are recorded into the shared batch instead of blocking submits
+    const void* layers[] = { rgba };
+    MipChain::upload(*_uploader, _physicalDevice, _textureImage, VK_FORMAT_R8G8B8A8_SRGB, width, height, layers, 1, _mipLevels);
+}
 
-    _image.createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _textureImage, _textureImageMemory);
+Texture::Resources Texture::replaceImage(const DecodedImage& image)
+{
+    if (!image.pixels) {
+        throw std::runtime_error("Texture: no pixels to replace " + _texturePath + " with");
+    }
 
-    _image.transitionImageLayout(_textureImage,VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    _image.copyBufferToImage(stagingBuffer, _textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-    _image.transitionImageLayout(_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    const Resources previous{ _textureImage, _textureImageAllocation, _textureImageView, _textureSampler };
+    uploadTextureImage(image);
+    createTextureImageView();
+    createTextureSampler();
+    _placeholder = false;
+    return previous;
+}
 
-    vkDestroyBuffer(_device, stagingBuffer, nullptr);
-    vkFreeMemory(_device, stagingBufferMemory, nullptr);
+void Texture::destroyResources(Resources& resources) const
+{
+    if (resources.sampler != VK_NULL_HANDLE) vkDestroySampler(_device, resources.sampler, nullptr);
+    if (resources.view != VK_NULL_HANDLE) vkDestroyImageView(_device, resources.view, nullptr);
+    _image.allocator()->destroyImage(resources.image, resources.memory);
+    resources = {};
 }
 
 void Texture::createTextureImageView()
 {
-    _textureImageView = _image.createImageView(_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+    _textureImageView = _image.createImageView(_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, _mipLevels);
 }
 
 void Texture::createTextureSampler()
@@ -56,36 +75,11 @@ void Texture::createTextureSampler()
     samplerInfo.compareEnable = VK_FALSE;
     samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
     samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = static_cast<float>(_mipLevels);
 
     if (vkCreateSampler(_device, &samplerInfo, nullptr, &_textureSampler) != VK_SUCCESS) {
         throw std::runtime_error("failed to create texture sampler!");
     }
 }
- 
-void Texture::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
-{
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = size;
-    bufferInfo.usage = usage;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-    if (vkCreateBuffer(_device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create buffer!");
-    }
-
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(_device, buffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = _image.findMemoryType(memRequirements.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(_device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate buffer memory!");
-    }
-
-    vkBindBufferMemory(_device, buffer, bufferMemory, 0);
-}
-
@@ -3,6 +3,8 @@
 #include <stb_image.h>
 #include <stdexcept>
 #include "Image.h"
+#include "ImageDecoder.h"
+#include "UploadBatcher.h"
 #include <string>
 
 class Texture final
@@ -16,60 +18,108 @@ class Texture final
 	VkPhysicalDevice _physicalDevice{ VK_NULL_HANDLE };
 	VkCommandPool _commandPool{ VK_NULL_HANDLE }; // if needed in ctor via Image
 	VkQueue _graphicsQueue{ VK_NULL_HANDLE };     // if needed in ctor via Image
+	UploadBatcher* _uploader{ nullptr };          // pixels are staged here; usable once it has flushed
 
 	VkImage _textureImage{ VK_NULL_HANDLE };
 	VkImageView _textureImageView{ VK_NULL_HANDLE };
-	VkDeviceMemory _textureImageMemory{ VK_NULL_HANDLE };
+	GpuAllocation _textureImageAllocation{};
 	VkSampler _textureSampler{ VK_NULL_HANDLE };
+	uint32_t _mipLevels{ 1 };
+	bool _placeholder{ false };
 
 	public:
 		Texture() = default;
 		~Texture() = default;
 
-		Texture(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue graphicsQueue, const std::string& texturePath)
+		Texture(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue graphicsQueue, UploadBatcher* uploader, GpuAllocator* allocator, const std::string& texturePath)
 			: _texturePath(texturePath)
-			, _image(device, physicalDevice, commandPool, graphicsQueue)
+			, _image(device, physicalDevice, commandPool, graphicsQueue, allocator)
 			, _device(device)
 			, _physicalDevice(physicalDevice)
 			, _commandPool(commandPool)
 			, _graphicsQueue(graphicsQueue)
+			, _uploader(uploader)
 		{
 			createTextureImage();
 			createTextureImageView();
 			createTextureSampler();
 		}
 
+		// Upload-only path for pixels already decoded off the main thread
+		Texture(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue graphicsQueue, UploadBatcher* uploader, GpuAllocator* allocator, const DecodedImage& image)
+			: _texturePath(image.path)
+			, _image(device, physicalDevice, commandPool, graphicsQueue, allocator)
+			, _device(device)
+			, _physicalDevice(physicalDevice)
+			, _commandPool(commandPool)
+			, _graphicsQueue(graphicsQueue)
+			, _uploader(uploader)
+		{
+			uploadTextureImage(image);
+			createTextureImageView();
+			createTextureSampler();
+		}
+
+		// Solid-colour texel used until a streamed image arrives
+		struct Placeholder {
+			uint8_t rgba[4]{ 128, 128, 128, 255 };
+		};
+
+		// 1x1 stand-in for texturePath; the real pixels are swapped in later with replaceImage
+		Texture(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue graphicsQueue, UploadBatcher* uploader, GpuAllocator* allocator, const std::string& texturePath, const Placeholder& placeholder)
+			: _texturePath(texturePath)
+			, _image(device, physicalDevice, commandPool, graphicsQueue, allocator)
+			, _device(device)
+			, _physicalDevice(physicalDevice)
+			, _commandPool(commandPool)
+			, _graphicsQueue(graphicsQueue)
+			, _uploader(uploader)
+			, _placeholder(true)
+		{
+			uploadPixels(placeholder.rgba, 1, 1);
+			createTextureImageView();
+			createTextureSampler();
+		}
+
 		Texture(const Texture& other) = default;
 		Texture& operator=(const Texture& other) = default;
 		Texture(Texture&& other) = default;
 		Texture& operator=(Texture&& other) = default;
 
 		void createTextureImage();
+		void uploadTextureImage(const DecodedImage& image);
+		void uploadPixels(const void* rgba, uint32_t width, uint32_t height);
 		void createTextureImageView();
 		void createTextureSampler();
-		void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
 		VkImageView getTextureImageView() const { return _textureImageView; }
 		VkSampler getTextureSampler() const { return _textureSampler; }
+		uint32_t mipLevels() const { return _mipLevels; }
+		const std::string& texturePath() const { return _texturePath; }
+		bool isPlaceholder() const { return _placeholder; }
+
+		// Image, memory, view and sampler of one version of the texture
+		struct Resources {
+			VkImage image{ VK_NULL_HANDLE };
+			GpuAllocation memory{};
+			VkImageView view{ VK_NULL_HANDLE };
+			VkSampler sampler{ VK_NULL_HANDLE };
+		};
+
+		// Records the upload of image and switches to its view and sampler. Returns the previous
+		// resources, which frames already recorded may still sample; destroy them once those frames retire.
+		Resources replaceImage(const DecodedImage& image);
+		void destroyResources(Resources& resources) const;
+
 		void destroy()
 		{
 			if (_device == VK_NULL_HANDLE) return;
 
-			if (_textureSampler != VK_NULL_HANDLE) {
-				vkDestroySampler(_device, _textureSampler, nullptr);
-				_textureSampler = VK_NULL_HANDLE;
-			}
-			if (_textureImageView != VK_NULL_HANDLE) {
-				vkDestroyImageView(_device, _textureImageView, nullptr);
-				_textureImageView = VK_NULL_HANDLE;
-			}
-			if (_textureImage != VK_NULL_HANDLE) {
-				vkDestroyImage(_device, _textureImage, nullptr);
-				_textureImage = VK_NULL_HANDLE;
-			}
-			if (_textureImageMemory != VK_NULL_HANDLE) {
-				vkFreeMemory(_device, _textureImageMemory, nullptr);
-				_textureImageMemory = VK_NULL_HANDLE;
-			}
+			Resources current{ _textureImage, _textureImageAllocation, _textureImageView, _textureSampler };
+			destroyResources(current);
+			_textureImage = VK_NULL_HANDLE;
+			_textureImageAllocation = {};
+			_textureImageView = VK_NULL_HANDLE;
+			_textureSampler = VK_NULL_HANDLE;
 		}
 };
 
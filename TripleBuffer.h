@@ -0,0 +1,59 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Hands whole values from one producer thread to one consumer thread without locks. The producer fills
+// back() and publish() swaps it with the middle slot; the consumer's acquire() swaps the middle slot with
+// front() when something new was published. Neither side ever touches the slot the other is using, so a
+// value is written once and read in place.
+// The waits block on the atomic only for pacing: the consumer waiting for a first or next value, the
+// producer waiting for the consumer to take the last one so no value is overwritten unread.
+template <typename T>
+class TripleBuffer final
+{
+public:
+	TripleBuffer() = default;
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	// Producer side
+	T& back() { return _slots[_back]; }
+	void publish()
+	{
+		_back = _middle.exchange(static_cast<uint8_t>(_back | kFresh), std::memory_order_acq_rel) & kIndexMask;
+		_middle.notify_all();
+	}
+	// Returns once the consumer has acquired everything published so far
+	void waitUntilConsumed()
+	{
+		for (uint8_t middle = _middle.load(std::memory_order_acquire); middle & kFresh; middle = _middle.load(std::memory_order_acquire)) {
+			_middle.wait(middle, std::memory_order_acquire);
+		}
+	}
+
+	// Consumer side: false when nothing was published since the last acquire(), leaving front() as it was
+	bool acquire()
+	{
+		if ((_middle.load(std::memory_order_relaxed) & kFresh) == 0) return false;
+		_front = _middle.exchange(_front, std::memory_order_acq_rel) & kIndexMask;
+		_middle.notify_all();
+		return true;
+	}
+	void waitForPublish()
+	{
+		for (uint8_t middle = _middle.load(std::memory_order_acquire); (middle & kFresh) == 0; middle = _middle.load(std::memory_order_acquire)) {
+			_middle.wait(middle, std::memory_order_acquire);
+		}
+	}
+	T& front() { return _slots[_front]; }
+
+private:
+	static constexpr uint8_t kIndexMask = 0x3;
+	static constexpr uint8_t kFresh = 0x4; // set on the middle index by publish(), cleared by acquire()
+
+	std::array<T, 3> _slots{};
+	uint8_t _back{ 0 };                 // producer only
+	std::atomic<uint8_t> _middle{ 1 };
+	uint8_t _front{ 2 };                // consumer only
+};
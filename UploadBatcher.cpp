@@ -0,0 +1,356 @@
+#include "UploadBatcher.h"
+#include "GpuAllocator.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	// Stage and access mask that a layout is produced or consumed with
+	void layoutScope(VkImageLayout layout, VkPipelineStageFlags& stage, VkAccessFlags& access)
+	{
+		switch (layout) {
+		case VK_IMAGE_LAYOUT_UNDEFINED:
+			stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			access = 0;
+			break;
+		case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+			stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+			access = VK_ACCESS_TRANSFER_WRITE_BIT;
+			break;
+		case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+			stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+			access = VK_ACCESS_TRANSFER_READ_BIT;
+			break;
+		case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+			stage = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+			access = VK_ACCESS_SHADER_READ_BIT;
+			break;
+		case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+			stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+			access = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			break;
+		case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+			stage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+			access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			break;
+		default:
+			throw std::invalid_argument("UploadBatcher: unsupported layout transition");
+		}
+	}
+
+	constexpr uint64_t alignUp(uint64_t v, uint64_t a) {
+		return (v + a - 1) / a * a;
+	}
+}
+
+void UploadBatcher::create(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue queue, GpuAllocator* allocator, VkDeviceSize ringSize)
+{
+	if (_device != VK_NULL_HANDLE) {
+		throw std::runtime_error("UploadBatcher: already created");
+	}
+	_device = device;
+	_physicalDevice = physicalDevice;
+	_commandPool = commandPool;
+	_queue = queue;
+	_allocator = allocator;
+	_ringSize = ringSize;
+
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	_alignment = std::max<VkDeviceSize>(16, properties.limits.optimalBufferCopyOffsetAlignment);
+
+	createStagingBuffer(_ringSize, _ring, _ringAllocation);
+	_ringMapped = static_cast<uint8_t*>(_ringAllocation.mapped);
+	_head = 0;
+	_tail = 0;
+}
+
+void UploadBatcher::createStagingBuffer(VkDeviceSize size, VkBuffer& buffer, GpuAllocation& allocation)
+{
+	if (_allocator == nullptr) {
+		throw std::runtime_error("UploadBatcher: no GpuAllocator to create staging buffers with");
+	}
+	_allocator->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		GpuMemoryCategory::Staging, "upload staging", buffer, allocation);
+}
+
+void UploadBatcher::destroy()
+{
+	if (_device == VK_NULL_HANDLE) return;
+
+	flush();
+	wait();
+
+	for (VkFence fence : _freeFences) vkDestroyFence(_device, fence, nullptr);
+	_freeFences.clear();
+	if (!_freeCommandBuffers.empty()) {
+		vkFreeCommandBuffers(_device, _commandPool, static_cast<uint32_t>(_freeCommandBuffers.size()), _freeCommandBuffers.data());
+		_freeCommandBuffers.clear();
+	}
+
+	_allocator->destroyBuffer(_ring, _ringAllocation);
+	_ringMapped = nullptr;
+	_device = VK_NULL_HANDLE;
+}
+
+void UploadBatcher::begin()
+{
+	if (_recording) return;
+	if (_device == VK_NULL_HANDLE) {
+		throw std::runtime_error("UploadBatcher: create() must be called before recording uploads");
+	}
+
+	if (!_freeCommandBuffers.empty()) {
+		_pending.cmd = _freeCommandBuffers.back();
+		_freeCommandBuffers.pop_back();
+	}
+	else {
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = _commandPool;
+		allocInfo.commandBufferCount = 1;
+		if (vkAllocateCommandBuffers(_device, &allocInfo, &_pending.cmd) != VK_SUCCESS) {
+			throw std::runtime_error("UploadBatcher: vkAllocateCommandBuffers failed");
+		}
+	}
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	if (vkBeginCommandBuffer(_pending.cmd, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("UploadBatcher: vkBeginCommandBuffer failed");
+	}
+
+	// Mid-frame uploads may overwrite buffers that earlier frames are still reading
+	vkCmdPipelineBarrier(_pending.cmd,
+		VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+	_recording = true;
+}
+
+UploadBatcher::Allocation UploadBatcher::allocate(VkDeviceSize size)
+{
+	begin();
+	_stats.bytes += size;
+
+	if (size > _ringSize) {
+		// Too big for the ring; give it a buffer that is freed when this batch retires
+		Allocation a;
+		GpuAllocation memory;
+		createStagingBuffer(size, a.buffer, memory);
+		a.mapped = static_cast<uint8_t*>(memory.mapped);
+		_pending.oversized.emplace_back(a.buffer, memory);
+		++_stats.oversized;
+		return a;
+	}
+
+	for (;;) {
+		if (_tail == _head) {
+			// Nothing outstanding: restart at a ring boundary so any size up to the ring fits
+			_head = _tail = alignUp(_head, _ringSize);
+		}
+
+		uint64_t start = alignUp(_head, _alignment);
+		const uint64_t offset = start % _ringSize;
+		if (offset + size > _ringSize) {
+			start += _ringSize - offset; // keep each allocation contiguous
+		}
+		if (start + size - _tail <= _ringSize) {
+			_head = start + size;
+			Allocation a;
+			a.buffer = _ring;
+			a.offset = start % _ringSize;
+			a.mapped = _ringMapped + a.offset;
+			return a;
+		}
+
+		// Ring is full of work the GPU has not consumed yet
+		++_stats.ringStalls;
+		if (_inFlight.empty()) {
+			flush();
+		}
+		if (!_inFlight.empty()) {
+			retire(_inFlight.front().id);
+		}
+		begin();
+	}
+}
+
+void UploadBatcher::retire(uint64_t waitForId)
+{
+	while (!_inFlight.empty()) {
+		Batch& b = _inFlight.front();
+		if (b.id <= waitForId) {
+			vkWaitForFences(_device, 1, &b.fence, VK_TRUE, UINT64_MAX);
+		}
+		else if (vkGetFenceStatus(_device, b.fence) != VK_SUCCESS) {
+			break;
+		}
+
+		_tail = b.ringEnd;
+		for (auto& [buffer, memory] : b.oversized) {
+			_allocator->destroyBuffer(buffer, memory);
+		}
+		vkResetFences(_device, 1, &b.fence);
+		_freeFences.push_back(b.fence);
+		_freeCommandBuffers.push_back(b.cmd);
+		_inFlight.pop_front();
+	}
+}
+
+void UploadBatcher::uploadBuffer(VkBuffer dst, const void* data, VkDeviceSize size, VkDeviceSize dstOffset)
+{
+	if (size == 0) return;
+
+	const Allocation a = allocate(size);
+	std::memcpy(a.mapped, data, static_cast<size_t>(size));
+
+	VkBufferCopy region{};
+	region.srcOffset = a.offset;
+	region.dstOffset = dstOffset;
+	region.size = size;
+	vkCmdCopyBuffer(_pending.cmd, a.buffer, dst, 1, &region);
+	++_stats.uploads;
+}
+
+void UploadBatcher::uploadImage(VkImage image, uint32_t width, uint32_t height, uint32_t texelSize, const void* const* layers, uint32_t layerCount, VkImageLayout finalLayout, uint32_t mipLevels)
+{
+	const ImageLevel level{ width, height, layers };
+	uploadImageLevels(image, &level, 1, mipLevels, texelSize, layerCount, finalLayout);
+}
+
+void UploadBatcher::uploadImageLevels(VkImage image, const ImageLevel* levels, uint32_t levelCount, uint32_t mipLevels, uint32_t texelSize, uint32_t layerCount, VkImageLayout finalLayout)
+{
+	// Regions start on texel-size multiples inside one allocation
+	std::vector<VkDeviceSize> offsets(levelCount);
+	VkDeviceSize total = 0;
+	for (uint32_t level = 0; level < levelCount; ++level) {
+		total = alignUp(total, std::max<VkDeviceSize>(texelSize, 4));
+		offsets[level] = total;
+		total += static_cast<VkDeviceSize>(levels[level].width) * levels[level].height * texelSize * layerCount;
+	}
+	const Allocation a = allocate(total);
+
+	std::vector<VkBufferImageCopy> regions;
+	regions.reserve(size_t(levelCount) * layerCount);
+	for (uint32_t level = 0; level < levelCount; ++level) {
+		const ImageLevel& src = levels[level];
+		const VkDeviceSize layerBytes = static_cast<VkDeviceSize>(src.width) * src.height * texelSize;
+		for (uint32_t layer = 0; layer < layerCount; ++layer) {
+			if (!src.layers[layer]) {
+				throw std::runtime_error("UploadBatcher: missing pixel data for level " + std::to_string(level) + " layer " + std::to_string(layer));
+			}
+			const VkDeviceSize offset = offsets[level] + layer * layerBytes;
+			std::memcpy(a.mapped + offset, src.layers[layer], static_cast<size_t>(layerBytes));
+
+			VkBufferImageCopy region{};
+			region.bufferOffset = a.offset + offset;
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = level;
+			region.imageSubresource.baseArrayLayer = layer;
+			region.imageSubresource.layerCount = 1;
+			region.imageExtent = { src.width, src.height, 1 };
+			regions.push_back(region);
+		}
+	}
+
+	transitionImage(image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels, layerCount);
+	vkCmdCopyBufferToImage(_pending.cmd, a.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		static_cast<uint32_t>(regions.size()), regions.data());
+	if (finalLayout != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+		transitionImage(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, finalLayout, mipLevels, layerCount);
+	}
+	++_stats.uploads;
+}
+
+void UploadBatcher::transitionImage(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, uint32_t layerCount, VkImageAspectFlags aspect)
+{
+	begin();
+
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = oldLayout;
+	barrier.newLayout = newLayout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = aspect;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = mipLevels;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = layerCount;
+
+	VkPipelineStageFlags srcStage = 0;
+	VkPipelineStageFlags dstStage = 0;
+	layoutScope(oldLayout, srcStage, barrier.srcAccessMask);
+	layoutScope(newLayout, dstStage, barrier.dstAccessMask);
+
+	vkCmdPipelineBarrier(_pending.cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+VkCommandBuffer UploadBatcher::commandBuffer()
+{
+	begin();
+	return _pending.cmd;
+}
+
+uint64_t UploadBatcher::flush()
+{
+	if (!_recording) return 0;
+
+	// Make the copies visible to every later submission on this queue
+	VkMemoryBarrier visible{};
+	visible.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	visible.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	visible.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT
+		| VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+	vkCmdPipelineBarrier(_pending.cmd,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+		0, 1, &visible, 0, nullptr, 0, nullptr);
+
+	if (vkEndCommandBuffer(_pending.cmd) != VK_SUCCESS) {
+		throw std::runtime_error("UploadBatcher: vkEndCommandBuffer failed");
+	}
+
+	if (!_freeFences.empty()) {
+		_pending.fence = _freeFences.back();
+		_freeFences.pop_back();
+	}
+	else {
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		if (vkCreateFence(_device, &fenceInfo, nullptr, &_pending.fence) != VK_SUCCESS) {
+			throw std::runtime_error("UploadBatcher: vkCreateFence failed");
+		}
+	}
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &_pending.cmd;
+	if (vkQueueSubmit(_queue, 1, &submitInfo, _pending.fence) != VK_SUCCESS) {
+		throw std::runtime_error("UploadBatcher: vkQueueSubmit failed");
+	}
+
+	_pending.id = _nextBatchId++;
+	_pending.ringEnd = _head;
+	const uint64_t id = _pending.id;
+	_inFlight.push_back(std::move(_pending));
+	_pending = Batch{};
+	_recording = false;
+	++_stats.submits;
+
+	// Reclaim whatever the GPU has already finished without blocking
+	retire(0);
+	return id;
+}
+
+void UploadBatcher::wait(uint64_t batchId)
+{
+	if (_inFlight.empty()) return;
+	retire(std::min(batchId, _inFlight.back().id));
+}
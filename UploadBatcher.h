@@ -0,0 +1,121 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include "GpuAllocator.h"
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+// Records staging copies and layout transitions into one command buffer and submits them together on flush().
+// Staging space comes from a persistently mapped ring that is reclaimed as each batch's fence signals,
+// so nothing here waits on the queue unless the ring is full.
+class UploadBatcher final
+{
+public:
+	static constexpr VkDeviceSize kDefaultRingSize = 64ull * 1024 * 1024;
+
+	struct Stats {
+		uint64_t uploads = 0;    // buffer and image uploads recorded
+		uint64_t submits = 0;    // batches submitted
+		uint64_t bytes = 0;      // bytes copied through staging
+		uint64_t ringStalls = 0; // times the CPU had to wait for ring space
+		uint64_t oversized = 0;  // uploads larger than the ring, staged in their own buffer
+
+		double submitsPerUpload() const { return uploads ? static_cast<double>(submits) / static_cast<double>(uploads) : 0.0; }
+	};
+
+	UploadBatcher() = default;
+	~UploadBatcher() = default;
+
+	// Owns the ring, command buffers and fences; release them through destroy()
+	UploadBatcher(const UploadBatcher&) = delete;
+	UploadBatcher& operator=(const UploadBatcher&) = delete;
+	UploadBatcher(UploadBatcher&&) = delete;
+	UploadBatcher& operator=(UploadBatcher&&) = delete;
+
+	// commandPool must allow resetting individual command buffers and belong to queue's family; staging memory comes from allocator
+	void create(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue queue, GpuAllocator* allocator, VkDeviceSize ringSize = kDefaultRingSize);
+
+	// Submits anything pending and waits for every batch before freeing
+	void destroy();
+
+	// Copies size bytes into the ring now and records a copy into dst at dstOffset
+	void uploadBuffer(VkBuffer dst, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+
+	// Pixel data for one mip level: layerCount layers of width * height * texelSize bytes each
+	struct ImageLevel {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		const void* const* layers = nullptr;
+	};
+
+	// Fills mip 0 of layerCount array layers, each width * height * texelSize bytes.
+	// All mipLevels go UNDEFINED -> TRANSFER_DST -> finalLayout; pass TRANSFER_DST_OPTIMAL to keep recording on it.
+	void uploadImage(VkImage image, uint32_t width, uint32_t height, uint32_t texelSize, const void* const* layers, uint32_t layerCount = 1,
+		VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, uint32_t mipLevels = 1);
+
+	// Same as uploadImage for levels 0..levelCount-1 of an image with mipLevels levels, staged as one block
+	void uploadImageLevels(VkImage image, const ImageLevel* levels, uint32_t levelCount, uint32_t mipLevels, uint32_t texelSize, uint32_t layerCount,
+		VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	void transitionImage(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1, uint32_t layerCount = 1,
+		VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT);
+
+	// Command buffer of the open batch, for callers that record their own transfer work into it
+	VkCommandBuffer commandBuffer();
+
+	// Submits everything recorded since the last flush. Returns the batch id, or 0 if nothing was pending.
+	// Later submissions to the same queue see the uploaded data, so callers only need to flush before their own submit.
+	uint64_t flush();
+
+	// Blocks until the given batch has completed; the default waits for every submitted batch
+	void wait(uint64_t batchId = UINT64_MAX);
+
+	bool hasPending() const { return _recording; }
+	const Stats& stats() const { return _stats; }
+
+private:
+	struct Batch {
+		uint64_t id = 0;
+		VkCommandBuffer cmd = VK_NULL_HANDLE;
+		VkFence fence = VK_NULL_HANDLE;
+		uint64_t ringEnd = 0; // ring head at submit; space before it is free once the fence signals
+		std::vector<std::pair<VkBuffer, GpuAllocation>> oversized;
+	};
+
+	struct Allocation {
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		uint8_t* mapped = nullptr;
+	};
+
+	void begin();
+	Allocation allocate(VkDeviceSize size);
+	void retire(uint64_t waitForId);
+	void createStagingBuffer(VkDeviceSize size, VkBuffer& buffer, GpuAllocation& allocation);
+
+	VkDevice _device{ VK_NULL_HANDLE };
+	VkPhysicalDevice _physicalDevice{ VK_NULL_HANDLE };
+	VkCommandPool _commandPool{ VK_NULL_HANDLE };
+	VkQueue _queue{ VK_NULL_HANDLE };
+	GpuAllocator* _allocator{ nullptr };
+
+	VkBuffer _ring{ VK_NULL_HANDLE };
+	GpuAllocation _ringAllocation{};
+	uint8_t* _ringMapped{ nullptr };
+	VkDeviceSize _ringSize{ 0 };
+	VkDeviceSize _alignment{ 16 };
+
+	// Monotonic byte positions; the ring offset is position % _ringSize
+	uint64_t _head{ 0 };
+	uint64_t _tail{ 0 };
+
+	Batch _pending;
+	bool _recording{ false };
+	std::deque<Batch> _inFlight;
+	std::vector<VkCommandBuffer> _freeCommandBuffers;
+	std::vector<VkFence> _freeFences;
+	uint64_t _nextBatchId{ 1 };
+
+	Stats _stats;
+};
@@ -1,113 +1,15 @@
 #include "particleSystem.h"
+#include "CommandStats.h"
+#include "GpuAllocator.h"
+#include "JobSystem.h"
+#include "ParticleCompute.h"
+#include "UploadBatcher.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <random>
 #include <stdexcept>
 
-namespace {
-    uint32_t findMemoryType(VkPhysicalDevice phys, uint32_t typeFilter, VkMemoryPropertyFlags properties)
-    {
-        VkPhysicalDeviceMemoryProperties memProperties;
-        vkGetPhysicalDeviceMemoryProperties(phys, &memProperties);
-        for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-            if ((typeFilter & (1u << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-                return i;
-            }
-        }
-        throw std::runtime_error("particleSystem: failed to find suitable memory type");
-    }
-
-    VkCommandBuffer beginSingleTimeCommands(VkDevice device, VkCommandPool pool)
-    {
-        VkCommandBufferAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandPool = pool;
-        allocInfo.commandBufferCount = 1;
-
-        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
-        if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
-            throw std::runtime_error("particleSystem: vkAllocateCommandBuffers failed");
-        }
-
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-        if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
-            throw std::runtime_error("particleSystem: vkBeginCommandBuffer failed");
-        }
-
-        return commandBuffer;
-    }
-
-    void endSingleTimeCommands(VkDevice device, VkQueue queue, VkCommandPool pool, VkCommandBuffer commandBuffer)
-    {
-        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
-            throw std::runtime_error("particleSystem: vkEndCommandBuffer failed");
-        }
-
-        // Use a fence to wait for this single submission, avoiding full queue idle
-        const VkFenceCreateInfo fenceInfo{ VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
-        VkFence fence = VK_NULL_HANDLE;
-        if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
-            throw std::runtime_error("particleSystem: vkCreateFence failed");
-        }
-
-        VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
-
-        if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS) {
-            vkDestroyFence(device, fence, nullptr);
-            throw std::runtime_error("particleSystem: vkQueueSubmit failed");
-        }
-
-        vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
-        vkDestroyFence(device, fence, nullptr);
-
-        vkFreeCommandBuffers(device, pool, 1, &commandBuffer);
-    }
-
-    void copyBuffer(VkDevice device, VkQueue queue, VkCommandPool pool, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
-    {
-        const VkCommandBuffer cmd = beginSingleTimeCommands(device, pool);
-        VkBufferCopy copyRegion{};
-        copyRegion.size = size;
-        vkCmdCopyBuffer(cmd, srcBuffer, dstBuffer, 1, &copyRegion);
-        endSingleTimeCommands(device, queue, pool, cmd);
-    }
-
-    void createBuffer(VkDevice device,
-        VkPhysicalDevice phys,
-        VkDeviceSize size,
-        VkBufferUsageFlags usage,
-        VkMemoryPropertyFlags properties,
-        VkBuffer& buffer,
-        VkDeviceMemory& bufferMemory)
-    {
-        VkBufferCreateInfo bufferInfo{};
-        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        bufferInfo.size = size;
-        bufferInfo.usage = usage;
-        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
-            throw std::runtime_error("particleSystem: failed to create buffer");
-
-        VkMemoryRequirements memRequirements;
-        vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
-
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(phys, memRequirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
-            throw std::runtime_error("particleSystem: failed to allocate buffer memory");
-
-        vkBindBufferMemory(device, buffer, bufferMemory, 0);
-    }
-}
-
 void particleSystem::spawnBurst(uint32_t count, float speedMin, float speedMax)
 {
     if (count == 0 || _maxParticles == 0) return;
@@ -132,115 +34,350 @@ void particleSystem::spawnBurst(uint32_t count, float speedMin, float speedMax)
     _activeParticles = static_cast<uint32_t>(_particles.size());
 }
 
-void particleSystem::update(float deltaTime)
+uint32_t particleSystem::takeEmission(float deltaTime)
+{
+    if (_emitter.ratePerSecond <= 0.0f || deltaTime <= 0.0f) {
+        _emitCarry = 0.0f;
+        return 0;
+    }
+    _emitCarry += _emitter.ratePerSecond * deltaTime;
+    const float whole = std::floor(_emitCarry);
+    _emitCarry -= whole;
+    return static_cast<uint32_t>(std::min(whole, static_cast<float>(_maxParticles)));
+}
+
+namespace {
+    // Particles per parallel integration range; smaller ranges cost more to schedule than they save
+    constexpr size_t kIntegrateGrain = 4096;
+}
+
+void particleSystem::update(float deltaTime, JobSystem* jobs)
 {
-    if (_particles.empty()) return;
+    const uint32_t emit = takeEmission(deltaTime);
+    if (_simulation == ParticleSimulation::Gpu)
+    {
+        if (_deferStreaming)
+        {
+            _capturedDelta += deltaTime;
+            _capturedEmit = std::min(_capturedEmit + emit, _maxParticles);
+            return;
+        }
+        queueDispatch(deltaTime, emit, _emitter);
+        return;
+    }
 
-    // Simple Euler integration + damping
-    const glm::vec3 gravity(0.0f, -9.8f, 0.0f);
-    const float damping = 0.98f;
+    // Same capacity rule as shader.comp: new particles only take slots the previous step's particles left free
+    const uint32_t room = _maxParticles - std::min(_maxParticles, static_cast<uint32_t>(_particles.size()));
+    const uint32_t spawnCount = std::min(emit, room);
 
-    for (auto& p : _particles)
+    // Simple Euler integration + damping; each particle is independent, so ranges can run on any thread
+    auto integrateRange = [this, deltaTime](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            ParticleSim::integrate(_particles[i], deltaTime);
+        }
+    };
+    if (jobs != nullptr)
     {
-        if (p.lifetime <= 0.0f) continue;
-        p.velocity += gravity * deltaTime;
-        p.velocity *= damping;
-        p.position += p.velocity * deltaTime;
-        p.lifetime -= deltaTime;
+        jobs->parallelFor(_particles.size(), kIntegrateGrain, integrateRange);
+    }
+    else
+    {
+        integrateRange(0, _particles.size());
     }
 
-    // remove dead by compacting
+    // Remove dead by compacting; survivors are streamed to the mapped region in the same pass. The region is
+    // only ever written sequentially, never read, so write-combined memory stays fast.
+    Particle* out = _deferStreaming ? nullptr : beginRegion();
     size_t write = 0;
     for (size_t read = 0; read < _particles.size(); ++read)
     {
         if (_particles[read].lifetime > 0.0f)
         {
             if (write != read) _particles[write] = _particles[read];
+            if (out) out[write] = _particles[read];
             ++write;
         }
     }
     _particles.resize(write);
+
+    // Newborn particles are not stepped until the next update, as on the GPU
+    const uint32_t seed = ParticleSim::hash(_step++);
+    for (uint32_t i = 0; i < spawnCount; ++i)
+    {
+        const Particle p = ParticleSim::spawn(_emitter, seed, i);
+        _particles.push_back(p);
+        if (out) out[write] = p;
+        ++write;
+    }
+
     _activeParticles = static_cast<uint32_t>(_particles.size());
+    if (!_deferStreaming) endRegion(_activeParticles);
+}
+
+void particleSystem::queueDispatch(float deltaTime, uint32_t emit, const ParticleEmitter& emitter)
+{
+    _pendingDelta += deltaTime;
+    _pendingEmit = std::min(_pendingEmit + emit, _maxParticles);
+    _dispatchEmitter = emitter;
+}
+
+void particleSystem::setDeferredStreaming(bool defer)
+{
+    if (_deferStreaming && !defer && _simulation == ParticleSimulation::Gpu)
+    {
+        // Steps captured by nobody yet still reach the next dispatch
+        queueDispatch(_capturedDelta, _capturedEmit, _emitter);
+        _capturedDelta = 0.0f;
+        _capturedEmit = 0;
+    }
+    _deferStreaming = defer;
+}
+
+void particleSystem::capture(ParticleFrame& frame)
+{
+    if (_simulation == ParticleSimulation::Gpu)
+    {
+        frame.instances.clear();
+        frame.deltaTime = _capturedDelta;
+        frame.emit = _capturedEmit;
+        frame.emitter = _emitter;
+        _capturedDelta = 0.0f;
+        _capturedEmit = 0;
+        return;
+    }
+    // assign() reuses the frame's capacity, so a recycled frame does not allocate
+    frame.instances.assign(_particles.begin(), _particles.end());
+    frame.deltaTime = 0.0f;
+    frame.emit = 0;
+}
+
+void particleSystem::apply(const ParticleFrame& frame)
+{
+    if (_simulation == ParticleSimulation::Gpu)
+    {
+        queueDispatch(frame.deltaTime, frame.emit, frame.emitter);
+        return;
+    }
+    Particle* out = beginRegion();
+    if (out == nullptr) return;
+    const uint32_t count = std::min(static_cast<uint32_t>(frame.instances.size()), _maxParticles);
+    std::memcpy(out, frame.instances.data(), sizeof(Particle) * count);
+    endRegion(count);
+}
+
+void particleSystem::create(const RenderContext& ctx)
+{
+    if (_simulation == ParticleSimulation::Gpu && ctx.particleCompute != nullptr && ctx.particleCompute->valid())
+    {
+        ensureComputeBuffers(ctx);
+        return;
+    }
+    _simulation = ParticleSimulation::Cpu;
+    ensureGPUBuffer(ctx);
+}
+
+void particleSystem::uploadDescriptors(const RenderContext& ctx)
+{
+    if (_simulation == ParticleSimulation::Gpu) seedComputeBuffers(ctx);
+    else streamInstances();
 }
 
 void particleSystem::ensureGPUBuffer(const RenderContext& ctx)
 {
     if (_instanceBuffer != VK_NULL_HANDLE) return;
+    if (!ctx.allocator) {
+        throw std::runtime_error("particleSystem: RenderContext has no allocator");
+    }
+
+    _regionCount = ctx.framesInFlight > 0 ? ctx.framesInFlight : 1;
+    const VkDeviceSize size = sizeof(Particle) * _maxParticles * _regionCount;
+    if (size == 0) return;
+
+    // Prefer host-visible VRAM so the vertex fetch stays on the device; fall back to system memory
+    const VkMemoryPropertyFlags hostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    try {
+        ctx.allocator->createBuffer(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            hostVisible | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuMemoryCategory::Particles,
+            "particle instance ring", _instanceBuffer, _instanceAllocation);
+        _deviceLocal = true;
+    }
+    catch (const std::runtime_error&) {
+        ctx.allocator->createBuffer(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            hostVisible, GpuMemoryCategory::Particles,
+            "particle instance ring", _instanceBuffer, _instanceAllocation);
+        _deviceLocal = false;
+    }
 
-    _device = ctx.device;
-    _physicalDevice = ctx.physicalDevice;
-    _commandPool = ctx.commandPool;
-    _graphicsQueue = ctx.graphicsQueue;
+    _mapped = _instanceAllocation.mapped;
+    if (_mapped == nullptr) {
+        throw std::runtime_error("particleSystem: instance memory is not mapped");
+    }
+    _drawRegion = 0;
+    _drawCount = 0;
+}
 
-    const VkDeviceSize size = sizeof(Particle) * _maxParticles;
+Particle* particleSystem::beginRegion()
+{
+    if (_mapped == nullptr) return nullptr;
+    const uint32_t region = (_drawRegion + 1) % _regionCount;
+    return static_cast<Particle*>(_mapped) + static_cast<size_t>(region) * _maxParticles;
+}
 
-    createBuffer(_device, _physicalDevice, size,
-        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        _instanceBuffer, _instanceMemory);
+void particleSystem::endRegion(uint32_t count)
+{
+    if (_mapped == nullptr) return;
+    _drawRegion = (_drawRegion + 1) % _regionCount;
+    _drawCount = count;
+}
 
+void particleSystem::streamInstances()
+{
+    Particle* out = beginRegion();
+    if (out == nullptr) return;
+    std::memcpy(out, _particles.data(), sizeof(Particle) * _activeParticles);
+    endRegion(_activeParticles);
 }
 
-void particleSystem::uploadInstances(const RenderContext& ctx)
+void particleSystem::ensureComputeBuffers(const RenderContext& ctx)
 {
-    if (_activeParticles == 0 || _instanceBuffer == VK_NULL_HANDLE) return;
-
-    const VkDeviceSize size = sizeof(Particle) * _activeParticles;
-
-    VkBuffer staging = VK_NULL_HANDLE;
-    VkDeviceMemory stagingMem = VK_NULL_HANDLE;
-    createBuffer(ctx.device, ctx.physicalDevice, size,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        staging, stagingMem);
-
-    void* data = nullptr;
-    if (vkMapMemory(ctx.device, stagingMem, 0, size, 0, &data) != VK_SUCCESS || data == nullptr) {
-        vkDestroyBuffer(ctx.device, staging, nullptr);
-        vkFreeMemory(ctx.device, stagingMem, nullptr);
-        throw std::runtime_error("particleSystem: vkMapMemory failed for staging");
+    if (_gpuCounters != VK_NULL_HANDLE) return;
+    if (!ctx.allocator || !ctx.uploader) {
+        throw std::runtime_error("particleSystem: RenderContext has no allocator or uploader");
     }
-    std::memcpy(data, _particles.data(), static_cast<size_t>(size));
-    vkUnmapMemory(ctx.device, stagingMem);
+    _compute = ctx.particleCompute;
+
+    const VkDeviceSize size = sizeof(Particle) * std::max(_maxParticles, 1u);
+    for (size_t i = 0; i < _gpuParticles.size(); ++i)
+    {
+        ctx.allocator->createBuffer(size,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuMemoryCategory::Particles,
+            "particle simulation", _gpuParticles[i], _gpuParticleAllocations[i]);
+    }
+    ctx.allocator->createBuffer(ParticleCompute::kCounterStride * 2,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuMemoryCategory::Particles,
+        "particle draw counters", _gpuCounters, _gpuCounterAllocation);
+
+    _compute->allocateSets(_gpuParticles, _gpuCounters, _computeSets);
+
+    // Both draws start empty; the first dispatch fills in indexCount
+    const std::array<uint32_t, ParticleCompute::kCounterStride / sizeof(uint32_t) * 2> zeros{};
+    ctx.uploader->uploadBuffer(_gpuCounters, zeros.data(), sizeof(zeros));
+    _gpuSource = 0;
+}
 
-    // Use local copy helper with our stored device/queue/pool
-    copyBuffer(_device, _graphicsQueue, _commandPool, staging, _instanceBuffer, size);
+void particleSystem::seedComputeBuffers(const RenderContext& ctx)
+{
+    // Particles spawned on the CPU replace whatever the device holds; with none there is nothing to hand over
+    if (_particles.empty() || _gpuCounters == VK_NULL_HANDLE) return;
+
+    const uint32_t count = std::min(static_cast<uint32_t>(_particles.size()), _maxParticles);
+    ctx.uploader->uploadBuffer(_gpuParticles[_gpuSource], _particles.data(), sizeof(Particle) * count);
+    ctx.uploader->uploadBuffer(_gpuCounters, &count, sizeof(count), _gpuSource * ParticleCompute::kCounterStride + sizeof(uint32_t));
+    _particles.clear();
+    _activeParticles = 0;
+}
 
-    vkDestroyBuffer(ctx.device, staging, nullptr);
-    vkFreeMemory(ctx.device, stagingMem, nullptr);
+void particleSystem::recordSimulation(VkCommandBuffer cmd, uint32_t quadIndexCount)
+{
+    if (_simulation != ParticleSimulation::Gpu || _gpuCounters == VK_NULL_HANDLE) return;
+
+    const uint32_t src = _gpuSource;
+    const uint32_t dst = 1 - src;
+
+    // The previous frame drew from, and its dispatch read, the buffer this dispatch writes; its writes feed this read
+    VkMemoryBarrier before{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    before.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    before.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &before, 0, nullptr, 0, nullptr);
+
+    // Reset the destination draw: the dispatch counts survivors and newborns into instanceCount
+    const VkDrawIndexedIndirectCommand reset{ quadIndexCount, 0, 0, 0, 0 };
+    vkCmdUpdateBuffer(cmd, _gpuCounters, dst * ParticleCompute::kCounterStride, sizeof(reset), &reset);
+
+    VkMemoryBarrier resetDone{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    resetDone.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    resetDone.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 1, &resetDone, 0, nullptr, 0, nullptr);
+
+    ParticleCompute::PushConstants push{};
+    push.centerDt = glm::vec4(_dispatchEmitter.center, _pendingDelta);
+    push.extentWind = glm::vec4(_dispatchEmitter.halfExtentXZ, _dispatchEmitter.windXZ);
+    push.speedLifetime = glm::vec4(_dispatchEmitter.speed, _dispatchEmitter.lifetime);
+    push.counts = glm::uvec4(_pendingEmit, ParticleSim::hash(_step++), _maxParticles, src);
+    _compute->dispatch(cmd, _computeSets[src], push);
+
+    VkMemoryBarrier after{ VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    after.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    after.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        0, 1, &after, 0, nullptr, 0, nullptr);
+
+    _gpuSource = dst;
+    _pendingDelta = 0.0f;
+    _pendingEmit = 0;
+}
+
+VkDeviceSize particleSystem::gpuAliveCountOffset() const
+{
+    return _gpuSource * ParticleCompute::kCounterStride + sizeof(uint32_t);
 }
 
 void particleSystem::destroy(const RenderContext& ctx)
 {
     if (_instanceBuffer != VK_NULL_HANDLE)
     {
-        vkDestroyBuffer(ctx.device, _instanceBuffer, nullptr);
-        _instanceBuffer = VK_NULL_HANDLE;
+        ctx.allocator->destroyBuffer(_instanceBuffer, _instanceAllocation);
     }
-    if (_instanceMemory != VK_NULL_HANDLE)
+    _mapped = nullptr;
+    _drawCount = 0;
+
+    if (_compute != nullptr)
     {
-        vkFreeMemory(ctx.device, _instanceMemory, nullptr);
-        _instanceMemory = VK_NULL_HANDLE;
+        _compute->freeSets(_computeSets);
+        _compute = nullptr;
     }
-    _mapped = nullptr;
+    for (size_t i = 0; i < _gpuParticles.size(); ++i)
+    {
+        ctx.allocator->destroyBuffer(_gpuParticles[i], _gpuParticleAllocations[i]);
+    }
+    ctx.allocator->destroyBuffer(_gpuCounters, _gpuCounterAllocation);
 }
 
 void particleSystem::recordDraw(VkCommandBuffer cmd, VkPipeline pipeline, VkBuffer quadVB, VkBuffer quadIB, uint32_t quadIndexCount) const
 {
-    if (_activeParticles == 0) return;
+    const bool gpu = _simulation == ParticleSimulation::Gpu && _gpuCounters != VK_NULL_HANDLE;
+    if (!gpu && _drawCount == 0) return;
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    CommandStats::add(CommandStats::PipelineBind);
 
-    // Bind quad vertices (binding 0) and per-instance buffer (binding 1)
-    std::array<VkBuffer, 2> vertexBuffers = { quadVB, _instanceBuffer };
+    // Bind quad vertices (binding 0) and the latest particles (binding 1)
+    std::array<VkBuffer, 2> vertexBuffers = { quadVB, gpu ? _gpuParticles[_gpuSource] : _instanceBuffer };
     const std::span<VkBuffer, 2> vbSpan(vertexBuffers);
-    std::array<VkDeviceSize, 2> offsets = { 0, 0 };
+    std::array<VkDeviceSize, 2> offsets = { 0, gpu ? 0 : sizeof(Particle) * _maxParticles * _drawRegion };
     const std::span<VkDeviceSize, 2> offsetSpan(offsets);
     vkCmdBindVertexBuffers(cmd, 0, 2, vbSpan.data(), offsetSpan.data());
 
     // Use UINT16 to match how indexBuffer was created and bound elsewhere
     vkCmdBindIndexBuffer(cmd, quadIB, 0, VK_INDEX_TYPE_UINT16);
+    CommandStats::add(CommandStats::BufferBind, 2);
+    CommandStats::add(CommandStats::Draw);
 
-    vkCmdDrawIndexed(cmd, quadIndexCount, _activeParticles, 0, 0, 0);
+    if (gpu)
+    {
+        // Instance count was written by the last dispatch
+        vkCmdDrawIndexedIndirect(cmd, _gpuCounters, _gpuSource * ParticleCompute::kCounterStride, 1, sizeof(VkDrawIndexedIndirectCommand));
+        return;
+    }
+    vkCmdDrawIndexed(cmd, quadIndexCount, _drawCount, 0, 0, 0);
 }
 
 void particleSystem::spawnRainArea(const glm::vec3& centerXZ, const glm::vec2& halfSizeXZ, float yTop,
@@ -4,27 +4,76 @@
 #include <glm/glm.hpp>
 #include "Particle.h"
 #include "RenderContext.h"
+#include "GpuAllocator.h"
 #include <array>
 #include <span>
 
+class ParticleCompute;
+class JobSystem;
+
+// Cpu integrates and compacts on the host and streams instances each frame; it is also the reference for Gpu.
+// Gpu keeps the particles on the device and runs shader.comp each frame; only emitter parameters leave the CPU.
+enum class ParticleSimulation : uint8_t { Cpu, Gpu };
+
+// One step of a particle system handed from the thread that simulates it to the thread that renders it:
+// Cpu fills instances, Gpu the time step and emission its next dispatch runs.
+struct ParticleFrame {
+    std::vector<Particle> instances;
+    float deltaTime = 0.0f;
+    uint32_t emit = 0;
+    ParticleEmitter emitter{};
+};
+
 class particleSystem final
 {
     glm::vec3 _origin{};
     std::vector<Particle> _particles;
 
+    ParticleSimulation _simulation{ ParticleSimulation::Cpu };
+    ParticleEmitter _emitter{};
+    float _emitCarry{ 0.0f };  // fractional particles owed by the emission rate
+    uint32_t _step{ 0 };       // simulation steps taken; seeds the spawn hash
+
+    // One persistently mapped instance buffer split into a region per frame in flight. update() writes the
+    // survivors straight into the next region and draws read the last one written, so nothing is staged,
+    // submitted or waited on. A region is rewritten framesInFlight updates later, after its frame's fence.
     VkBuffer _instanceBuffer{ VK_NULL_HANDLE };
-    VkDeviceMemory _instanceMemory{ VK_NULL_HANDLE };
+    GpuAllocation _instanceAllocation{};
     void* _mapped{ nullptr };
+    bool _deviceLocal{ false }; // host-visible VRAM (ReBAR / SAM) rather than system memory
 
-    VkDevice _device{ VK_NULL_HANDLE };
-    VkPhysicalDevice _physicalDevice{ VK_NULL_HANDLE };
-    VkCommandPool _commandPool{ VK_NULL_HANDLE };
-    VkQueue _graphicsQueue{ VK_NULL_HANDLE };
+    uint32_t _regionCount{ 0 };
+    uint32_t _drawRegion{ 0 };  // region the next draw reads
+    uint32_t _drawCount{ 0 };   // instances written to _drawRegion
+
+    // Gpu: ping-pong particle buffers and one indexed indirect draw per buffer, whose instanceCount is the alive count
+    ParticleCompute* _compute{ nullptr };
+    std::array<VkBuffer, 2> _gpuParticles{ VK_NULL_HANDLE, VK_NULL_HANDLE };
+    std::array<GpuAllocation, 2> _gpuParticleAllocations{};
+    VkBuffer _gpuCounters{ VK_NULL_HANDLE };
+    GpuAllocation _gpuCounterAllocation{};
+    std::array<VkDescriptorSet, 2> _computeSets{ VK_NULL_HANDLE, VK_NULL_HANDLE };
+    uint32_t _gpuSource{ 0 };     // buffer holding the latest particles
+    float _pendingDelta{ 0.0f };  // time and emission queued by update() or apply() for the next dispatch
+    uint32_t _pendingEmit{ 0 };
+    ParticleEmitter _dispatchEmitter{}; // emitter the next dispatch spawns from
+
+    // Deferred streaming: update() only steps the simulation and the renderer takes each step through
+    // capture() and apply(), so simulating and recording can run on different threads
+    bool _deferStreaming{ false };
+    float _capturedDelta{ 0.0f }; // Gpu: time and emission stepped since the last capture()
+    uint32_t _capturedEmit{ 0 };
 
     uint32_t _maxParticles{};
     uint32_t _activeParticles{};
 
     void ensureGPUBuffer(const RenderContext& ctx);
+    void ensureComputeBuffers(const RenderContext& ctx);
+    void seedComputeBuffers(const RenderContext& ctx);
+    uint32_t takeEmission(float deltaTime);
+    void queueDispatch(float deltaTime, uint32_t emit, const ParticleEmitter& emitter);
+    Particle* beginRegion();
+    void endRegion(uint32_t count);
 
 public:
     particleSystem() = default;
@@ -34,8 +83,7 @@ public:
     particleSystem& operator=(particleSystem&&) noexcept = default;
 
     particleSystem(const glm::vec3& origin, uint32_t maxParticles)
-        : _origin(origin), _particles(), _instanceBuffer(VK_NULL_HANDLE), _instanceMemory(VK_NULL_HANDLE), _mapped(nullptr),
-        _device(VK_NULL_HANDLE), _physicalDevice(VK_NULL_HANDLE), _commandPool(VK_NULL_HANDLE), _graphicsQueue(VK_NULL_HANDLE),
+        : _origin(origin), _particles(), _instanceBuffer(VK_NULL_HANDLE), _instanceAllocation(), _mapped(nullptr),
         _maxParticles(maxParticles), _activeParticles(0)
     {
         _particles.reserve(maxParticles);
@@ -45,7 +93,26 @@ public:
 
     void setOrigin(const glm::vec3& origin) { _origin = origin; }
     void spawnBurst(uint32_t count, float speedMin, float speedMax);
-    void update(float deltaTime);
+    // Steps the simulation and streams the survivors to the GPU. Call at most once per frame, after the frame's fence wait
+    // unless streaming is deferred.
+    // Gpu only accumulates the time step and emission for recordSimulation().
+    // With jobs, Cpu integrates in parallel ranges; compaction and streaming stay on the calling thread.
+    void update(float deltaTime, JobSystem* jobs = nullptr);
+
+    // Simulating thread: with deferred streaming on, update() leaves the instance memory and the next dispatch
+    // alone and capture() copies out what the step produced
+    void setDeferredStreaming(bool defer);
+    bool deferredStreaming() const { return _deferStreaming; }
+    void capture(ParticleFrame& frame);
+    // Rendering thread: streams a captured Cpu step into the next region, or queues a Gpu step for
+    // recordSimulation(). Call after the frame's fence wait, as update() would be.
+    void apply(const ParticleFrame& frame);
+
+    // Call before create(); Gpu falls back to Cpu when the context has no particle compute pipeline
+    void setSimulation(ParticleSimulation simulation) { _simulation = simulation; }
+    ParticleSimulation simulation() const { return _simulation; }
+    void setEmitter(const ParticleEmitter& emitter) { _emitter = emitter; }
+    const ParticleEmitter& emitter() const { return _emitter; }
 
     // New: Spawn vertical rain in an XZ area at yTop with downward velocity and optional wind
     void spawnRainArea(const glm::vec3& centerXZ, const glm::vec2& halfSizeXZ, float yTop,
@@ -53,13 +120,27 @@ public:
         float lifetimeMin, float lifetimeMax,
         const glm::vec2& windXZ = glm::vec2(0.0f, 0.0f));
 
-    inline void create(const RenderContext& ctx) { ensureGPUBuffer(ctx); }
-    inline void uploadDescriptors(const RenderContext& ctx) { uploadInstances(ctx); }
+    void create(const RenderContext& ctx);
+    // Cpu streams the current particles; Gpu hands particles spawned on the CPU over to the device buffers
+    void uploadDescriptors(const RenderContext& ctx);
 
     void destroy(const RenderContext& ctx);
+    // Gpu: records the compute step and its barriers; must be outside a render pass, before recordDraw()
+    void recordSimulation(VkCommandBuffer cmd, uint32_t quadIndexCount);
     void recordDraw(VkCommandBuffer cmd, VkPipeline pipeline, VkBuffer quadVB, VkBuffer quadIB, uint32_t quadIndexCount) const;
-    void uploadInstances(const RenderContext& ctx);
+    // Writes the current particles to the next region without stepping them, e.g. after spawning at load time
+    void streamInstances();
     VkBuffer instanceBuffer() const { return _instanceBuffer; }
-    VkDeviceMemory instanceMemory() const { return _instanceMemory; }
+    bool instancesInDeviceLocalMemory() const { return _deviceLocal; }
+    VkDeviceMemory instanceMemory() const { return _instanceAllocation.memory; }
+    // Cpu only; the Gpu count never leaves the device
     uint32_t aliveCount() const { return _activeParticles; }
+    uint32_t capacity() const { return _maxParticles; }
+    // Cpu: the particles update() left alive, in order
+    std::span<const Particle> particles() const { return _particles; }
+    // Gpu: the buffer the last recorded dispatch wrote and where its alive count sits in the counter buffer,
+    // for copying back to the host
+    VkBuffer gpuParticleBuffer() const { return _gpuParticles[_gpuSource]; }
+    VkBuffer gpuCounterBuffer() const { return _gpuCounters; }
+    VkDeviceSize gpuAliveCountOffset() const;
 };
\ No newline at end of file
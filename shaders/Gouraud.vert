@@ -3,10 +3,14 @@
 const int MAX_LIGHTS = 8;
 
 layout(std140, set = 0, binding = 0) uniform UniformBufferObject {
-    mat4 model;
+    mat4 model; // per-object slot, bound with a dynamic offset
+} ubo;
+
+layout(std140, set = 0, binding = 5) uniform CameraUBO {
     mat4 view;
     mat4 proj;
-} ubo;
+    vec4 eye;
+} camera;
 
 // Match CPU GPULightCPU field order (std140 will pad vec3 to 16-byte boundaries)
 struct GPULight {
@@ -58,7 +62,7 @@ float spotFactor(vec3 Ldir, vec3 spotDir, float innerCos, float outerCos) {
 
 void main() {
     vec4 worldPos = ubo.model * vec4(inPosition, 1.0);
-    gl_Position = ubo.proj * ubo.view * worldPos;
+    gl_Position = camera.proj * camera.view * worldPos;
 
     mat3 normalMatrix = transpose(inverse(mat3(ubo.model)));
     vec3 N = normalize(normalMatrix * inNormal);
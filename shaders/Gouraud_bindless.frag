@@ -0,0 +1,35 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Matches BindlessTable::DrawConstants
+layout(push_constant) uniform DrawConstants {
+    uint objectIndex;
+    uint materialIndex;
+} draw;
+
+// Matches MaterialGpu
+struct Material {
+    vec4 albedo;
+    float metallic;
+    float roughness;
+    uint textureIndex;
+    uint pad;
+};
+
+layout(std430, set = 2, binding = 0) readonly buffer Materials {
+    Material materials[];
+} materialTable;
+
+// Every registered texture; the index comes from the push constant, so it is dynamically uniform
+layout(set = 2, binding = 2) uniform sampler2D textures[];
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    Material material = materialTable.materials[draw.materialIndex];
+    vec3 albedo = texture(textures[material.textureIndex], fragTexCoord).rgb * material.albedo.rgb;
+    outColor = vec4(fragColor * albedo, 1.0);
+}
\ No newline at end of file
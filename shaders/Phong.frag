@@ -13,9 +13,7 @@ layout(std140, set = 1, binding = 0) uniform ShadowUBO {
 layout(set = 1, binding = 1) uniform sampler2DShadow uShadowMap;
 
 layout(std140, set = 0, binding = 0) uniform UniformBufferObject {
-    mat4 model;
-    mat4 view;
-    mat4 proj;
+    mat4 model; // per-object slot, bound with a dynamic offset
 } ubo;
 
 // Match CPU GPULightCPU field order (std140 will pad vec3 to 16-byte boundaries)
@@ -1,10 +1,14 @@
 #version 450
 
 layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
+    mat4 model; // per-object slot, bound with a dynamic offset
+} ubo;
+
+layout(std140, set = 0, binding = 5) uniform CameraUBO {
     mat4 view;
     mat4 proj;
-} ubo;
+    vec4 eye;
+} camera;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;   // unused here
@@ -24,5 +28,5 @@ void main() {
 
     vTexCoord = inTexCoord;
 
-    gl_Position = ubo.proj * ubo.view * worldPos;
+    gl_Position = camera.proj * camera.view * worldPos;
 }
\ No newline at end of file
@@ -0,0 +1,40 @@
+#version 450
+
+// Matches BindlessTable::DrawConstants
+layout(push_constant) uniform DrawConstants {
+    uint objectIndex;
+    uint materialIndex;
+} draw;
+
+// Set 2 binding 1: every object slot of this frame; the push constant picks this draw's model matrix
+layout(std430, set = 2, binding = 1) readonly buffer Objects {
+    mat4 models[];
+} objects;
+
+layout(std140, set = 0, binding = 5) uniform CameraUBO {
+    mat4 view;
+    mat4 proj;
+    vec4 eye;
+} camera;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;   // unused here
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec3 inNormal;
+
+layout(location = 0) out vec3 vWorldPos;
+layout(location = 1) out vec3 vWorldNormal;
+layout(location = 2) out vec2 vTexCoord;
+
+void main() {
+    mat4 model = objects.models[draw.objectIndex];
+    vec4 worldPos = model * vec4(inPosition, 1.0);
+    vWorldPos = worldPos.xyz;
+
+    mat3 normalMatrix = transpose(inverse(mat3(model)));
+    vWorldNormal = normalize(normalMatrix * inNormal);
+
+    vTexCoord = inTexCoord;
+
+    gl_Position = camera.proj * camera.view * worldPos;
+}
\ No newline at end of file
@@ -5,9 +5,7 @@ const int MAX_LIGHTS = 8;
 layout(set = 0, binding = 1) uniform sampler2D uTexture;
 
 layout(std140, set = 0, binding = 0) uniform UniformBufferObject {
-    mat4 model;
-    mat4 view;
-    mat4 proj;
+    mat4 model; // per-object slot, bound with a dynamic offset
 } ubo;
 
 // Match CPU GPULightCPU field order (std140 will pad vec3 to 16-byte boundaries)
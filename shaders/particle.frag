@@ -8,9 +8,7 @@ layout(location = 0) out vec4 outColor;
 
 // Binding 0: UBO (model/view/proj)  matches your C++ UniformBufferObject
 layout(set = 0, binding = 0, std140) uniform UBO {
-    mat4 model;
-    mat4 view;
-    mat4 proj;
+    mat4 model; // per-object slot, bound with a dynamic offset
 } ubo;
 
 // Binding 3: TimeUBO  matches your C++ TimeUBO { float time; ... }
@@ -7,10 +7,14 @@
 #define particleSystemHeight 10.0
 
 layout(set = 0, binding = 0) uniform Matrices {
-    mat4 model;
+    mat4 model; // per-object slot, bound with a dynamic offset
+} uboMatrices;
+
+layout(std140, set = 0, binding = 5) uniform CameraUBO {
     mat4 view;
     mat4 proj;
-} uboMatrices;
+    vec4 eye;
+} camera;
 
 layout(set = 0, binding = 3) uniform TimeUBO {
     float time;
@@ -81,5 +85,5 @@ void main()
     fragTexCoord = inTexCoord;
     fragColor = inColor;
 
-    gl_Position = uboMatrices.proj * uboMatrices.view * vec4(worldPos, 1.0);
+    gl_Position = camera.proj * camera.view * vec4(worldPos, 1.0);
 }
\ No newline at end of file
@@ -6,16 +6,20 @@ layout(location = 2) in vec2 inTexCoord;
 layout(location = 3) in vec3 inNormal;    // added (not used, but now consumed)
 
 layout(set = 0, binding = 0) uniform Matrices {
-    mat4 model;
+    mat4 model; // per-object slot, bound with a dynamic offset
+} ubo;
+
+layout(std140, set = 0, binding = 5) uniform CameraUBO {
     mat4 view;
     mat4 proj;
-} ubo;
+    vec4 eye;
+} camera;
 
 layout(location = 0) out vec3 vColor;
 layout(location = 1) out vec2 fragTexCoord;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPos, 1.0);
+    gl_Position = camera.proj * camera.view * ubo.model * vec4(inPos, 1.0);
     fragTexCoord = inTexCoord;
     vColor = inColor; // consume location 1
     // inNormal (location 3) is present but not needed in this shader
@@ -2,9 +2,7 @@
 
 // set 0 binding 0 : per-object UBO (model, view, proj)
 layout(std140, set = 0, binding = 0) uniform UniformBufferObject {
-    mat4 model;
-    mat4 view; // unused here
-    mat4 proj; // unused here
+    mat4 model; // per-object slot, bound with a dynamic offset
 } ubo;
 
 // set 1 binding 0 : shadow/light matrices (lightView, lightProj)
@@ -0,0 +1,27 @@
+#version 450
+
+// Matches BindlessTable::DrawConstants
+layout(push_constant) uniform DrawConstants {
+    uint objectIndex;
+    uint materialIndex;
+} draw;
+
+// Set 2 binding 1: every object slot of this frame; the push constant picks this draw's model matrix
+layout(std430, set = 2, binding = 1) readonly buffer Objects {
+    mat4 models[];
+} objects;
+
+// set 1 binding 0 : shadow/light matrices (lightView, lightProj)
+layout(std140, set = 1, binding = 0) uniform ShadowUBO {
+    mat4 lightView;
+    mat4 lightProj;
+} shadowUBO;
+
+// vertex input: location 0 = position (matches Vertex::pos)
+layout(location = 0) in vec3 inPos;
+
+void main() {
+    // transform to world then to light clip space
+    vec4 worldPos = objects.models[draw.objectIndex] * vec4(inPos, 1.0);
+    gl_Position = shadowUBO.lightProj * shadowUBO.lightView * worldPos;
+}
\ No newline at end of file
@@ -3,9 +3,7 @@
 const int MAX_LIGHTS = 8;
 
 layout(set = 0, binding = 0) uniform UniformBufferObject {
-    mat4 model;
-    mat4 view;
-    mat4 proj;
+    mat4 model; // per-object slot, bound with a dynamic offset
 } ubo;
 
 struct GPULight {
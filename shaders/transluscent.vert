@@ -3,10 +3,14 @@
 const int MAX_LIGHTS = 8;
 
 layout(set = 0, binding = 0) uniform UniformBufferObject {
-    mat4 model;
+    mat4 model; // per-object slot, bound with a dynamic offset
+} ubo;
+
+layout(std140, set = 0, binding = 5) uniform CameraUBO {
     mat4 view;
     mat4 proj;
-} ubo;
+    vec4 eye;
+} camera;
 
 struct GPULight {
     uint  type;      // 0=Point, 1=Directional, 2=Spot
@@ -56,7 +60,7 @@ float spotFactor(vec3 Ldir, vec3 spotDir, float innerCos, float outerCos) {
 
 void main() {
     vec4 worldPos = ubo.model * vec4(inPosition, 1.0);
-    gl_Position = ubo.proj * ubo.view * worldPos;
+    gl_Position = camera.proj * camera.view * worldPos;
 
     mat3 normalMatrix = transpose(inverse(mat3(ubo.model)));
     vec3 N = normalize(normalMatrix * inNormal);
@@ -4,10 +4,14 @@ layout(location = 0) in vec3 inPos;
 layout(location = 1) in vec3 inNormal;
 
 layout(set = 0, binding = 0) uniform UBO {
-    mat4 model;
+    mat4 model; // per-object slot, bound with a dynamic offset
+} ubo;
+
+layout(std140, set = 0, binding = 5) uniform CameraUBO {
     mat4 view;
     mat4 proj;
-} ubo;
+    vec4 eye;
+} camera;
 
 layout(location = 0) out vec3 vNormalWS;
 layout(location = 1) out vec3 vViewDirWS;
@@ -19,8 +23,8 @@ void main()
     mat3 nrm = mat3(transpose(inverse(ubo.model)));
     vNormalWS = normalize(nrm * inNormal);
 
-    vec3 camPosWS = inverse(ubo.view)[3].xyz;
+    vec3 camPosWS = camera.eye.xyz;
     vViewDirWS = normalize(camPosWS - worldPos.xyz);
 
-    gl_Position = ubo.proj * ubo.view * worldPos;
+    gl_Position = camera.proj * camera.view * worldPos;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "textureManager.h"
+#include <iostream>
 
 textureManager::textureManager(textureManager&& other) noexcept
 	: _textures(std::move(other._textures))
@@ -7,12 +8,20 @@ textureManager::textureManager(textureManager&& other) noexcept
 	, _physicalDevice(other._physicalDevice)
 	, _commandPool(other._commandPool)
 	, _graphicsQueue(other._graphicsQueue)
+	, _uploader(other._uploader)
+	, _allocator(other._allocator)
 	, _activeIndex(other._activeIndex)
+	, _streamer(std::move(other._streamer))
+	, _streamRequests(std::move(other._streamRequests))
+	, _retired(std::move(other._retired))
+	, _frame(other._frame)
 {
 	other._device = VK_NULL_HANDLE;
 	other._physicalDevice = VK_NULL_HANDLE;
 	other._commandPool = VK_NULL_HANDLE;
 	other._graphicsQueue = VK_NULL_HANDLE;
+	other._uploader = nullptr;
+	other._allocator = nullptr;
 	other._activeIndex = -1;
 }
 
@@ -32,19 +41,108 @@ textureManager& textureManager::operator=(textureManager&& other) noexcept
 	_physicalDevice = other._physicalDevice;
 	_commandPool = other._commandPool;
 	_graphicsQueue = other._graphicsQueue;
+	_uploader = other._uploader;
+	_allocator = other._allocator;
 	_activeIndex = other._activeIndex;
+	_streamer = std::move(other._streamer);
+	_streamRequests = std::move(other._streamRequests);
+	_retired = std::move(other._retired);
+	_frame = other._frame;
 
 	other._device = VK_NULL_HANDLE;
 	other._physicalDevice = VK_NULL_HANDLE;
 	other._commandPool = VK_NULL_HANDLE;
 	other._graphicsQueue = VK_NULL_HANDLE;
+	other._uploader = nullptr;
+	other._allocator = nullptr;
 	other._activeIndex = -1;
 
 	return *this;
 }
 
+void textureManager::requireInitialized() const
+{
+	if (_device == VK_NULL_HANDLE || _physicalDevice == VK_NULL_HANDLE || _commandPool == VK_NULL_HANDLE || _graphicsQueue == VK_NULL_HANDLE || !_uploader || !_allocator) {
+		throw std::runtime_error("textureManager not initialized: call initialize(...) before addTexture.");
+	}
+}
+
+Texture* textureManager::requestTexture(const std::string& name, const std::string& texturePath)
+{
+	if (Texture* existing = getTexture(name)) {
+		return existing;
+	}
+	requireInitialized();
+
+	auto tex = std::make_unique<Texture>(_device, _physicalDevice, _commandPool, _graphicsQueue, _uploader, _allocator, texturePath, Texture::Placeholder{});
+	Texture* const raw = tex.get();
+	_loadedTextures.push_back(raw);
+	_textures.emplace(name, std::move(tex));
+	if (_activeIndex < 0) { _activeIndex = 0; }
+
+	if (!_streamer) {
+		_streamer = std::make_unique<ImageStreamer>();
+	}
+	const uint64_t ticket = _streamer->request(texturePath);
+	_streamRequests.emplace(ticket, StreamRequest{ raw, name, std::chrono::high_resolution_clock::now() });
+	return raw;
+}
+
+size_t textureManager::updateStreaming(uint32_t framesInFlight, size_t maxSwaps)
+{
+	++_frame;
+
+	// Every frame recorded before a swap has waited on its fence by the time framesInFlight more frames have started
+	for (size_t i = 0; i < _retired.size();) {
+		if (_retired[i].freeAtFrame <= _frame) {
+			_retired[i].owner->destroyResources(_retired[i].resources);
+			_retired[i] = _retired.back();
+			_retired.pop_back();
+		}
+		else {
+			++i;
+		}
+	}
+
+	if (!_streamer || _streamRequests.empty()) {
+		return 0;
+	}
+
+	std::vector<ImageStreamer::Result> finished;
+	_streamer->poll(finished, maxSwaps);
+	size_t swapped = 0;
+	for (auto& result : finished) {
+		const auto it = _streamRequests.find(result.ticket);
+		if (it == _streamRequests.end()) continue;
+		const StreamRequest request = it->second;
+		_streamRequests.erase(it);
+
+		if (!result.image.pixels) {
+			std::cerr << "textureManager: streaming " << request.texture->texturePath() << " failed, keeping placeholder: " << result.error << std::endl;
+			continue;
+		}
+
+		_retired.push_back(RetiredImage{ request.texture, request.texture->replaceImage(result.image), _frame + framesInFlight });
+		++swapped;
+
+		const double residentMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - request.requested).count();
+		std::cout << "textureManager: " << request.name << " resident after " << residentMs << " ms ("
+			<< result.image.width << "x" << result.image.height << ", decode " << result.image.decodeMs << " ms)" << std::endl;
+	}
+	return swapped;
+}
+
 void textureManager::destroy()
 {
+	if (_streamer) {
+		_streamer->stop();
+	}
+	_streamRequests.clear();
+	for (auto& retired : _retired) {
+		retired.owner->destroyResources(retired.resources);
+	}
+	_retired.clear();
+
 	for (const auto& kv : _textures) {
 		if (kv.second) {
 			kv.second->destroy();
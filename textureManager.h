@@ -1,5 +1,6 @@
 #pragma once
 #include <vulkan/vulkan.h>
+#include <chrono>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -13,9 +14,29 @@ class textureManager final
 	VkPhysicalDevice _physicalDevice;
 	VkCommandPool _commandPool;
 	VkQueue _graphicsQueue;
+	UploadBatcher* _uploader{ nullptr };
+	GpuAllocator* _allocator{ nullptr };
 
 	int _activeIndex{ -1 };
 
+	// Streaming: placeholders handed out by requestTexture until the decoded image is swapped in
+	struct StreamRequest {
+		Texture* texture{ nullptr };
+		std::string name;
+		std::chrono::high_resolution_clock::time_point requested;
+	};
+	struct RetiredImage {
+		Texture* owner{ nullptr };
+		Texture::Resources resources;
+		uint64_t freeAtFrame{ 0 };
+	};
+	std::unique_ptr<ImageStreamer> _streamer;
+	std::unordered_map<uint64_t, StreamRequest> _streamRequests;
+	std::vector<RetiredImage> _retired;
+	uint64_t _frame{ 0 };
+
+	void requireInitialized() const;
+
 public:
 	textureManager() = default;
 	~textureManager() = default;
@@ -28,21 +49,21 @@ public:
 	textureManager(textureManager&& other) noexcept;
 	textureManager& operator=(textureManager&& other) noexcept;
 
-	void initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue graphicsQueue)
+	void initialize(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue graphicsQueue, UploadBatcher* uploader, GpuAllocator* allocator)
 	{
 		_device = device;
 		_physicalDevice = physicalDevice;
 		_commandPool = commandPool;
 		_graphicsQueue = graphicsQueue;
+		_uploader = uploader;
+		_allocator = allocator;
 	}
 
 	Texture* addTexture(const std::string& name, const std::string& texturePath)
 	{
-		if (_device == VK_NULL_HANDLE || _physicalDevice == VK_NULL_HANDLE || _commandPool == VK_NULL_HANDLE || _graphicsQueue == VK_NULL_HANDLE) {
-			throw std::runtime_error("textureManager not initialized: call initialize(...) before addTexture.");
-		}
+		requireInitialized();
 
-		auto tex = std::make_unique<Texture>(_device, _physicalDevice, _commandPool, _graphicsQueue, texturePath);
+		auto tex = std::make_unique<Texture>(_device, _physicalDevice, _commandPool, _graphicsQueue, _uploader, _allocator, texturePath);
 		Texture* const raw = tex.get();
 		_loadedTextures.push_back(raw);
 		_textures.emplace(name, std::move(tex));
@@ -50,6 +71,33 @@ public:
 		return raw;
 	}
 
+	// Uploads an image decoded elsewhere (see ImageDecoder)
+	Texture* addTexture(const std::string& name, const DecodedImage& image)
+	{
+		requireInitialized();
+
+		auto tex = std::make_unique<Texture>(_device, _physicalDevice, _commandPool, _graphicsQueue, _uploader, _allocator, image);
+		Texture* const raw = tex.get();
+		_loadedTextures.push_back(raw);
+		_textures.emplace(name, std::move(tex));
+		if (_activeIndex < 0) { _activeIndex = 0; }
+		return raw;
+	}
+
+	// Returns at once with a 1x1 placeholder bound; the file is decoded in the background and
+	// swapped in by updateStreaming. Objects drawing it pick the new view up on their next bind.
+	Texture* requestTexture(const std::string& name, const std::string& texturePath);
+
+	// Call once per frame after waiting on that frame's fence and before recording. Swaps in at most
+	// maxSwaps finished images and frees replaced ones once framesInFlight frames have passed.
+	size_t updateStreaming(uint32_t framesInFlight, size_t maxSwaps = 2);
+
+	// Streamed textures still showing their placeholder
+	size_t pendingStreams() const { return _streamRequests.size(); }
+
+	// Every texture added or requested so far, in order
+	const std::vector<Texture*>& textures() const { return _loadedTextures; }
+
 	Texture* getTexture(const std::string& name) const
 	{
 		const auto it = _textures.find(name);